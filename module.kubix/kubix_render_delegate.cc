@@ -26,19 +26,26 @@ public:
         KubixResourceIndex index; // the index of all current resources where we store deduplicated data
     } resources;
 
-    template<class INDEX>
+    template<class INFO>
     struct ClarisseToKubixObjectsMapping {
-        INDEX index; // index of all render object (can be geometries, lights or instancers) which are instances pointing to a object resource
+        CoreHashTable<R2cItemId, INFO> index; // index of all render object (can be geometries, lights or instancers) which are instances pointing to a object resource
         CoreVector<R2cItemId> inserted; // is filled by KubixRenderDelegate::insert_xxx when a object is inserted to the scene
         CoreVector<R2cItemId> removed; // is filled by KubixRenderDelegate::remove_xxx when a object is removed from the scene
 
-        bool dirty; // flag set when we receive dirtiness so that we don't need to iterate the whole index to know that it is dirty
-        bool is_dirty() { return inserted.get_count() != 0 || removed.get_count() != 0 || dirty; } // return true is index is dirty
+        CoreVector<R2cItemId> dirtied; // objects which received dirtiness since the last sync, each one being queued once when it gets dirty
+        bool is_dirty() { return inserted.get_count() != 0 || removed.get_count() != 0 || dirtied.get_count() != 0; } // return true is index is dirty
+
+        // add dirtiness to a render object and queue it for the next sync if it wasn't dirty yet
+        void set_dirty(R2cItemId id, INFO& info, const int& dirtiness)
+        {
+            if (info.dirtiness == R2cSceneDelegate::DIRTINESS_NONE) dirtied.add(id);
+            info.dirtiness |= dirtiness;
+        }
     };
 
-    ClarisseToKubixObjectsMapping<KubixGeometryIndex> geometries;
-    ClarisseToKubixObjectsMapping<KubixLightIndex> lights;
-    ClarisseToKubixObjectsMapping<KubixInstancerIndex> instancers;
+    ClarisseToKubixObjectsMapping<KubixGeometryInfo> geometries;
+    ClarisseToKubixObjectsMapping<KubixLightInfo> lights;
+    ClarisseToKubixObjectsMapping<KubixInstancerInfo> instancers;
 };
 
 IMPLEMENT_CLASS(KubixRenderDelegate, R2cRenderDelegate);
@@ -90,8 +97,7 @@ KubixRenderDelegate::dirty_light(R2cItemDescriptor item, const int& dirtiness)
 {
     KubixLightInfo *light = m->lights.index.is_key_exists(item.get_id());
     if (light != nullptr) { // make sure it is indeed in our index
-        m->lights.dirty = true;
-        light->dirtiness |= dirtiness;
+        m->lights.set_dirty(item.get_id(), *light, dirtiness);
     }
 }
 
@@ -116,8 +122,7 @@ KubixRenderDelegate::dirty_instancer(R2cItemDescriptor item, const int& dirtines
 {
     KubixInstancerInfo *instancer = m->instancers.index.is_key_exists(item.get_id());
     if (instancer != nullptr) { // make sure it is indeed in our index
-        m->instancers.dirty = true;
-        instancer->dirtiness |= dirtiness;
+        m->instancers.set_dirty(item.get_id(), *instancer, dirtiness);
     }
 }
 
@@ -142,8 +147,7 @@ KubixRenderDelegate::dirty_geometry(R2cItemDescriptor item, const int& dirtiness
 {
     KubixGeometryInfo *geometry = m->geometries.index.is_key_exists(item.get_id());
     if (geometry != nullptr) { // make sure it is indeed in our index
-        m->geometries.dirty = true;
-        geometry->dirtiness |= dirtiness;
+        m->geometries.set_dirty(item.get_id(), *geometry, dirtiness);
     }
 }
 
@@ -170,7 +174,7 @@ KubixRenderDelegate::clear()
     m->geometries.index.remove_all();
     m->geometries.removed.remove_all();
     m->geometries.inserted.remove_all();
-    m->geometries.dirty = R2cSceneDelegate::DIRTINESS_ALL;
+    m->geometries.dirtied.remove_all();
 
     // clearing meshes
     m->resources.index.remove_all();
@@ -179,13 +183,13 @@ KubixRenderDelegate::clear()
     m->instancers.index.remove_all();
     m->instancers.removed.remove_all();
     m->instancers.inserted.remove_all();
-    m->instancers.dirty = R2cSceneDelegate::DIRTINESS_ALL;
+    m->instancers.dirtied.remove_all();
 
     // clearing lights
     m->lights.index.remove_all();
     m->lights.removed.remove_all();
     m->lights.inserted.remove_all();
-    m->lights.dirty = R2cSceneDelegate::DIRTINESS_ALL;
+    m->lights.dirtied.remove_all();
 }
 
 void
@@ -208,7 +212,8 @@ sync_shading_groups(const R2cSceneDelegate& delegate, R2cItemId cgeometryid, Kub
 void
 KubixRenderDelegate::_sync_geometry(R2cItemId cgeometryid, KubixGeometryInfo& rgeometry, const bool& is_new)
 {
-    if (rgeometry.dirtiness & R2cSceneDelegate::DIRTINESS_GEOMETRY) {
+    // deformations are handled like any other geometry modification
+    if (rgeometry.dirtiness & (R2cSceneDelegate::DIRTINESS_GEOMETRY | R2cSceneDelegate::DIRTINESS_DEFORMATION)) {
         if (!is_new) {
             // mark as removed since we will need to recreate it
             m->geometries.removed.add(cgeometryid);
@@ -263,13 +268,16 @@ void
 KubixRenderDelegate::sync_geometries()
 {
     if (m->geometries.is_dirty()) {
-        // iterating through geometries to see if we need to sync any of them
+        // synching the geometries which received dirtiness. Only these ones are visited
+        // so the cost of the sync doesn't depend on the size of the scene.
         // it's VERY IMPORTANT to do this before everything else since if any
         // items received DIRTINESS_GEOMETRY, we need to remove it from the
         // scene to rebuild it!!!
-        for (auto geometry : m->geometries.index) {
-            if (geometry.get_value().dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
-                sync_geometry(geometry.get_key(), geometry.get_value());
+        for (auto dirtied_item : m->geometries.dirtied) {
+            KubixGeometryInfo *geometry = m->geometries.index.is_key_exists(dirtied_item);
+            // removed objects are skipped since their dirtiness is reset
+            if (geometry != nullptr && geometry->dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
+                sync_geometry(dirtied_item, *geometry);
             }
         }
         // let's see if we have to remove geometries from the scene
@@ -312,7 +320,7 @@ KubixRenderDelegate::sync_geometries()
         m->geometries.inserted.remove_all();
     }
     // our geometries are now perfectly synched
-    m->geometries.dirty = false;
+    m->geometries.dirtied.remove_all();
 }
 
 /*! \brief shading group synchronization helper */
@@ -382,13 +390,15 @@ void
 KubixRenderDelegate::sync_instancers()
 {
     if (m->instancers.is_dirty()) {
-        // iterating through instancers to see if we need to sync any of them
+        // synching the instancers which received dirtiness
         // it's VERY IMPORTANT to do this before everything else since if any
         // items received DIRTINESS_GEOMETRY, we need to remove it from the
         // scene to rebuild it!!!
-        for (auto instancer : m->instancers.index) {
-            if (instancer.get_value().dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
-                sync_instancer(instancer.get_key(), instancer.get_value());
+        for (auto dirtied_item : m->instancers.dirtied) {
+            KubixInstancerInfo *instancer = m->instancers.index.is_key_exists(dirtied_item);
+            // removed objects are skipped since their dirtiness is reset
+            if (instancer != nullptr && instancer->dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
+                sync_instancer(dirtied_item, *instancer);
             }
         }
 
@@ -432,7 +442,7 @@ KubixRenderDelegate::sync_instancers()
         m->instancers.inserted.remove_all();
     }
     // our instancers are now perfectly synched
-    m->instancers.dirty = false;
+    m->instancers.dirtied.remove_all();
 }
 
 /*! \brief light synchronization helper */
@@ -474,15 +484,17 @@ KubixRenderDelegate::sync_lights()
         }
         m->lights.inserted.remove_all();
 
-        // iterating through lights to see if we need to sync any of them
-        for (auto light : m->lights.index) {
-            if (light.get_value().dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
-                sync_light(*get_scene_delegate(), light.get_key(), light.get_value());
+        // synching the lights which received dirtiness
+        for (auto dirtied_item : m->lights.dirtied) {
+            KubixLightInfo *light = m->lights.index.is_key_exists(dirtied_item);
+            // removed objects are skipped since their dirtiness is reset
+            if (light != nullptr && light->dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
+                sync_light(*get_scene_delegate(), dirtied_item, *light);
             }
         }
     }
     // our lights are now perfectly synched
-    m->lights.dirty = false;
+    m->lights.dirtied.remove_all();
 }
 
 void
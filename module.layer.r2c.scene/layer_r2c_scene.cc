@@ -98,6 +98,8 @@ IX_MODULE_CLBK::get_image(OfObject& object, const QUALITY_LEVEL& quality, const
         const bool is_interrupted = object.get_application().must_stop_evaluation();
         canvas->finalize(is_interrupted == false);
         layer->stop_progress(cur_handle);
+        // the render delegate still has something to refine the image with so the layer is evaluated again
+        if (!is_interrupted && scene->get_render_delegate()->is_refresh_needed()) layer->refresh();
         return canvas;
     }
 }
@@ -0,0 +1,61 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Measures the conversion of grooms of 1k to 1M curves by RedshiftUtils::CreateHair() against the stub of
+// the Redshift API, in curves per second along with the peak resident set size. Usage:
+//     redshift_bench_hair [max_curve_count] [serial]
+
+#include <RS.h>
+#include <rs_stub.h>
+
+#include "bench_utils.h"
+
+// number of vertices of each curve
+static const unsigned int s_curve_vertex_count = 16;
+
+static void
+run(const unsigned int& curve_count)
+{
+    printf("%u curves\n", curve_count);
+    reset_peak_rss();
+
+    // curves standing on a grid, listed by segments like grooms may list them
+    HairDescription desc;
+    desc.positions.resize(curve_count * s_curve_vertex_count);
+    desc.curve_vertex_count.resize(curve_count);
+    desc.curve_vertex_ids.resize(curve_count * s_curve_vertex_count);
+    for (unsigned int i = 0; i < curve_count; i++) {
+        desc.curve_vertex_count[i] = s_curve_vertex_count - 1;
+        for (unsigned int j = 0; j < s_curve_vertex_count; j++) {
+            const unsigned int vertex = i * s_curve_vertex_count + j;
+            desc.positions[vertex] = GMathVec3f(static_cast<float>(i % 1000), static_cast<float>(j), static_cast<float>(i / 1000));
+            desc.curve_vertex_ids[vertex] = vertex;
+        }
+    }
+    desc.radius = 0.005f;
+    RSStub::reset();
+
+    BenchTimer layout_timer;
+    RedshiftUtils::ResolveHairLayout(desc);
+    print_result("layout", curve_count, layout_timer.get_elapsed());
+
+    RSMaterial *material = RS_Material_Get("bench");
+    BenchTimer hair_timer;
+    RSMeshHair *hair = RedshiftUtils::CreateHair(desc, material);
+    print_result("curves", hair->GetNumStrands(), hair_timer.get_elapsed());
+
+    print_peak_rss();
+    RSStub::print_statistics(stdout);
+    RS_MeshBase_Delete(hair);
+    RS_Material_Release(material);
+}
+
+int
+main(int argc, char **argv)
+{
+    const unsigned long long max_count = get_max_count(argc, argv, 1000000);
+    set_bench_executor(argc, argv);
+    for (unsigned long long count = 1000; count <= max_count; count *= 10) run(static_cast<unsigned int>(count));
+    return 0;
+}
@@ -0,0 +1,116 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Measures the triangulation of n-gons by PolygonTriangulator and the conversion of polygonal meshes of
+// 1k to 1M polygons by RedshiftUtils::CreatePolygonalMesh() against the stub of the Redshift API, in
+// triangles per second (a quad counting as two triangles). Usage:
+//     redshift_bench_polymesh [max_polygon_count]
+
+#include <RS.h>
+#include <rs_stub.h>
+
+#include <cmath>
+
+#include "bench_utils.h"
+
+static const double s_pi = 3.14159265358979323846;
+// number of vertices of the n-gons
+static const unsigned int s_ngon_vertex_count = 12;
+
+// fill a convex n-gon or a star shaped concave one of the specified number of vertices in the XZ plane
+static void
+make_ngon(CoreVector<GMathVec3f>& points, const unsigned int& count, const bool& is_concave)
+{
+    points.resize(count);
+    for (unsigned int i = 0; i < count; i++) {
+        const double angle = 2.0 * s_pi * i / count;
+        const double radius = is_concave && i % 2 == 0 ? 0.5 : 1.0;
+        points[i] = GMathVec3f(static_cast<float>(radius * cos(angle)), 0.0f, static_cast<float>(radius * sin(angle)));
+    }
+}
+
+// describe a mesh made of the specified number of copies of a polygon
+static void
+make_ngon_mesh(PolymeshDescription& desc, const CoreVector<GMathVec3f>& points, const unsigned int& polygon_count)
+{
+    const unsigned int count = points.get_count();
+    desc.positions.resize(count);
+    for (unsigned int i = 0; i < count; i++) desc.positions[i] = points[i];
+    desc.normals.resize(1);
+    desc.normals[0] = GMathVec3f(0.0f, 1.0f, 0.0f);
+    desc.polygon_vertex_count.resize(polygon_count);
+    desc.polygon_shading_groups.resize(polygon_count);
+    desc.polygon_vertex_ids.resize(polygon_count * count);
+    for (unsigned int i = 0; i < polygon_count; i++) {
+        desc.polygon_vertex_count[i] = count;
+        desc.polygon_shading_groups[i] = 0;
+        for (unsigned int j = 0; j < count; j++) desc.polygon_vertex_ids[i * count + j] = j;
+    }
+    desc.normal_indices.resize(polygon_count * count);
+    for (unsigned int i = 0; i < desc.normal_indices.get_count(); i++) desc.normal_indices[i] = 0;
+    desc.is_uv_defined = false;
+    desc.material_count = 1;
+}
+
+// triangulate the specified number of n-gons
+static void
+run_triangulation(const char *name, const unsigned int& polygon_count, const bool& is_concave)
+{
+    CoreVector<GMathVec3f> points;
+    make_ngon(points, s_ngon_vertex_count, is_concave);
+    PolygonTriangulator triangulator;
+    unsigned long long triangle_count = 0;
+    BenchTimer timer;
+    for (unsigned int i = 0; i < polygon_count; i++) triangle_count += triangulator.triangulate(points.get_data(), points.get_count()).get_count() / 3;
+    print_result(name, triangle_count, timer.get_elapsed());
+}
+
+// convert a mesh and report its triangles
+static void
+run_conversion(const char *name, const PolymeshDescription& desc, RSMaterial *material)
+{
+    BenchTimer timer;
+    RSMesh *mesh = RedshiftUtils::CreatePolygonalMesh(desc, material);
+    print_result(name, mesh->GetNumTriangles() + 2ull * mesh->GetNumQuads(), timer.get_elapsed());
+    RS_MeshBase_Delete(mesh);
+}
+
+static void
+run(const unsigned int& polygon_count)
+{
+    printf("%u polygons\n", polygon_count);
+    reset_peak_rss();
+    RSStub::reset();
+
+    // triangulation alone
+    run_triangulation("convex n-gons", polygon_count, false);
+    run_triangulation("concave n-gons", polygon_count, true);
+
+    // whole conversion of a quad grid and of meshes of n-gons
+    RSMaterial *material = RS_Material_Get("bench");
+    PolymeshDescription grid;
+    make_grid(grid, static_cast<unsigned int>(sqrt(static_cast<double>(polygon_count))));
+    run_conversion("quad mesh", grid, material);
+
+    CoreVector<GMathVec3f> points;
+    PolymeshDescription ngons;
+    make_ngon(points, s_ngon_vertex_count, false);
+    make_ngon_mesh(ngons, points, polygon_count);
+    run_conversion("convex n-gon mesh", ngons, material);
+    make_ngon(points, s_ngon_vertex_count, true);
+    make_ngon_mesh(ngons, points, polygon_count);
+    run_conversion("concave n-gon mesh", ngons, material);
+    RS_Material_Release(material);
+
+    print_peak_rss();
+    RSStub::print_statistics(stdout);
+}
+
+int
+main(int argc, char **argv)
+{
+    const unsigned long long max_count = get_max_count(argc, argv, 1000000);
+    for (unsigned long long count = 1000; count <= max_count; count *= 10) run(static_cast<unsigned int>(count));
+    return 0;
+}
@@ -0,0 +1,119 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Measures the cost of the incremental syncs of RedshiftScene, the code the render delegate runs, in scenes
+// of 1k to 1M geometries against the stub of the Redshift API. Each sync applies the same number of changes
+// spread over the whole scene: moves, reassignments of shading groups, removals along with insertions of new
+// geometries, and moves of instancers and lights. Since the sync only visits the queued items, the cost per
+// change must not depend on the size of the scene. The compaction of the removed items, which is proportional
+// to the size of the scene, is disabled here and measured by redshift_bench_translation. Usage:
+//     redshift_bench_sync [max_geometry_count] [serial]
+
+#include <RS.h>
+#include <rs_stub.h>
+
+#include <algorithm>
+
+#include "bench_utils.h"
+
+// number of geometries sharing the same mesh resource
+static const unsigned int s_geometries_per_resource = 100;
+// number of shading groups of each mesh resource
+static const unsigned int s_shading_group_count = 4;
+// number of geometries per instancer and per light
+static const unsigned int s_geometries_per_item = 1000;
+// number of prototypes and instances of each instancer
+static const unsigned int s_prototype_count = 4;
+static const unsigned int s_instances_per_instancer = 1000;
+// number of changes of each kind applied by a sync
+static const unsigned int s_change_count = 1000;
+// number of syncs measured for each kind of change
+static const unsigned int s_sync_count = 10;
+
+/*! \brief Geometries of the scene, which are the ids of a sliding window of indices since removed geometries
+           are replaced by new ones */
+struct BenchGeometries {
+    unsigned long long first; //!< index of the oldest geometry
+    unsigned long long count; //!< number of geometries
+
+    /*! \brief Return the id of the ith geometry of a change, the changed geometries being spread over the scene */
+    inline R2cItemId get_changed_id(const unsigned int& i) const
+    {
+        return BenchSceneSource::get_geometry_id(first + i * count / s_change_count);
+    }
+};
+
+// dirty the specified number of items of the scene by calling dirty and time the syncs applying them
+template<class DIRTY>
+static void
+time_syncs(const char *name, RedshiftScene& scene, BenchSceneSource& source, const unsigned int& change_count, DIRTY dirty)
+{
+    BenchTimer timer;
+    for (unsigned int sync = 0; sync < s_sync_count; sync++) {
+        for (unsigned int i = 0; i < change_count; i++) dirty(sync, i);
+        scene.sync(source);
+    }
+    print_result(name, static_cast<unsigned long long>(change_count) * s_sync_count, timer.get_elapsed());
+}
+
+static void
+run(const unsigned long long& geometry_count)
+{
+    printf("%llu geometries, %u changes per sync\n", geometry_count, s_change_count);
+    reset_peak_rss();
+    RSStub::reset();
+
+    BenchSceneSource source(s_geometries_per_resource, s_shading_group_count, s_prototype_count, s_instances_per_instancer);
+    RedshiftScene scene;
+    scene.ptr = RS_Scene_New();
+    // removed items stay in the render scene as tombstones
+    scene.compaction_ratio = static_cast<double>(~0u);
+    scene.compaction_max_removed_items = ~0u;
+    scene.compaction_max_removed_bytes = ~0ull;
+
+    // the scene isn't timed
+    BenchGeometries geometries = { 0, geometry_count };
+    const unsigned long long item_count = std::max(geometry_count / s_geometries_per_item, 1ull);
+    for (unsigned long long i = 0; i < geometry_count; i++) scene.insert_geometry(BenchSceneSource::get_geometry_id(i));
+    for (unsigned long long i = 0; i < item_count; i++) scene.insert_instancer(BenchSceneSource::get_instancer_id(i));
+    for (unsigned long long i = 0; i < item_count; i++) scene.insert_light(BenchSceneSource::get_light_id(i));
+    scene.sync(source);
+
+    BenchTimer empty_timer;
+    for (unsigned int sync = 0; sync < s_sync_count; sync++) scene.sync(source);
+    print_result("empty syncs", s_sync_count, empty_timer.get_elapsed());
+
+    time_syncs("geometry moves", scene, source, s_change_count, [&](const unsigned int& sync, const unsigned int& i) {
+        scene.dirty_geometry(geometries.get_changed_id(i), R2cSceneDelegate::DIRTINESS_KINEMATIC);
+    });
+    time_syncs("shading groups", scene, source, s_change_count, [&](const unsigned int& sync, const unsigned int& i) {
+        scene.dirty_geometry(geometries.get_changed_id(i), R2cSceneDelegate::DIRTINESS_SHADING_GROUP);
+    });
+    // the oldest geometries are replaced by new ones
+    time_syncs("replacements", scene, source, s_change_count, [&](const unsigned int& sync, const unsigned int& i) {
+        scene.remove_geometry(BenchSceneSource::get_geometry_id(geometries.first + i));
+        scene.insert_geometry(BenchSceneSource::get_geometry_id(geometries.first + geometries.count + i));
+        if (i == s_change_count - 1) geometries.first += s_change_count;
+    });
+
+    // a single instancer and light moved by each sync, lights being synced along with their attributes
+    time_syncs("instancer moves", scene, source, 1, [&](const unsigned int& sync, const unsigned int& i) {
+        scene.dirty_instancer(BenchSceneSource::get_instancer_id(sync % item_count), R2cSceneDelegate::DIRTINESS_KINEMATIC);
+    });
+    time_syncs("light moves", scene, source, 1, [&](const unsigned int& sync, const unsigned int& i) {
+        scene.dirty_light(BenchSceneSource::get_light_id(sync % item_count), R2cSceneDelegate::DIRTINESS_KINEMATIC | R2cSceneDelegate::DIRTINESS_LIGHT);
+    });
+
+    scene.clear(source);
+    print_peak_rss();
+}
+
+int
+main(int argc, char **argv)
+{
+    const unsigned long long max_count = get_max_count(argc, argv, 1000000);
+    set_bench_executor(argc, argv);
+    for (unsigned long long count = 1000; count <= max_count; count *= 10) run(count);
+    return 0;
+}
@@ -0,0 +1,110 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Measures the sync of synthetic scenes of 1k to 1M geometries by RedshiftScene, the code the render delegate
+// runs, against the stub of the Redshift API. Each stage of the sync is timed per item type: insertion of
+// geometries, instancers and lights, reassignment of shading groups, moves, removals, compaction of the
+// removed items and rebuild of the render scene. Geometries share their mesh resource by groups of 100
+// like instanced layouts do, and there is an instancer and a light per 1000 geometries. Usage:
+//     redshift_bench_translation [max_geometry_count] [serial]
+
+#include <RS.h>
+#include <rs_stub.h>
+
+#include <algorithm>
+
+#include "bench_utils.h"
+
+// number of geometries sharing the same mesh resource
+static const unsigned int s_geometries_per_resource = 100;
+// number of shading groups of each mesh resource
+static const unsigned int s_shading_group_count = 4;
+// number of geometries per instancer and per light
+static const unsigned int s_geometries_per_item = 1000;
+// number of prototypes and instances of each instancer
+static const unsigned int s_prototype_count = 4;
+static const unsigned int s_instances_per_instancer = 1000;
+
+static void
+run(const unsigned long long& geometry_count)
+{
+    printf("%llu geometries\n", geometry_count);
+    reset_peak_rss();
+    RSStub::reset();
+
+    BenchSceneSource source(s_geometries_per_resource, s_shading_group_count, s_prototype_count, s_instances_per_instancer);
+    RedshiftScene scene;
+    scene.ptr = RS_Scene_New();
+    const unsigned long long item_count = std::max(geometry_count / s_geometries_per_item, 1ull);
+
+    // insertion of each item type, geometries creating their mesh resources
+    RedshiftScene::CleanupFlags cleanup;
+    for (unsigned long long i = 0; i < geometry_count; i++) scene.insert_geometry(BenchSceneSource::get_geometry_id(i));
+    BenchTimer geometry_timer;
+    scene.sync_geometries(source, cleanup);
+    print_result("geometries", geometry_count, geometry_timer.get_elapsed());
+
+    for (unsigned long long i = 0; i < item_count; i++) scene.insert_instancer(BenchSceneSource::get_instancer_id(i));
+    BenchTimer instancer_timer;
+    scene.sync_instancers(source, cleanup);
+    print_result("instancers", item_count, instancer_timer.get_elapsed());
+
+    for (unsigned long long i = 0; i < item_count; i++) scene.insert_light(BenchSceneSource::get_light_id(i));
+    BenchTimer light_timer;
+    scene.sync_lights(source, cleanup);
+    print_result("lights", item_count, light_timer.get_elapsed());
+
+    // modifications of the geometries
+    for (unsigned long long i = 0; i < geometry_count; i++) scene.dirty_geometry(BenchSceneSource::get_geometry_id(i), R2cSceneDelegate::DIRTINESS_SHADING_GROUP);
+    BenchTimer shading_group_timer;
+    scene.sync_geometries(source, cleanup);
+    print_result("shading groups", geometry_count * s_shading_group_count, shading_group_timer.get_elapsed());
+
+    for (unsigned long long i = 0; i < geometry_count; i++) scene.dirty_geometry(BenchSceneSource::get_geometry_id(i), R2cSceneDelegate::DIRTINESS_KINEMATIC);
+    BenchTimer kinematic_timer;
+    scene.sync_geometries(source, cleanup);
+    print_result("geometry moves", geometry_count, kinematic_timer.get_elapsed());
+
+    // removal of half of the items of each type, the removed items being deleted by the compaction
+    for (unsigned long long i = 0; i < geometry_count; i += 2) scene.remove_geometry(BenchSceneSource::get_geometry_id(i));
+    BenchTimer geometry_removal_timer;
+    scene.sync_geometries(source, cleanup);
+    print_result("geometry removals", (geometry_count + 1) / 2, geometry_removal_timer.get_elapsed());
+
+    for (unsigned long long i = 0; i < item_count; i += 2) scene.remove_instancer(BenchSceneSource::get_instancer_id(i));
+    BenchTimer instancer_removal_timer;
+    scene.sync_instancers(source, cleanup);
+    print_result("instancer removals", (item_count + 1) / 2, instancer_removal_timer.get_elapsed());
+
+    for (unsigned long long i = 0; i < item_count; i += 2) scene.remove_light(BenchSceneSource::get_light_id(i));
+    BenchTimer light_removal_timer;
+    scene.sync_lights(source, cleanup);
+    print_result("light removals", (item_count + 1) / 2, light_removal_timer.get_elapsed());
+
+    const unsigned int removed_count = scene.tombstones.get_count();
+    BenchTimer compaction_timer;
+    scene.compact_scene(source, cleanup);
+    print_result("compaction", removed_count, compaction_timer.get_elapsed());
+
+    BenchTimer cleanup_timer;
+    scene.cleanup_scene(cleanup);
+    print_result("scene rebuild", scene.geometries.index.get_count() + scene.resources.index.get_count(), cleanup_timer.get_elapsed());
+
+    BenchTimer clear_timer;
+    const unsigned long long live_count = scene.geometries.index.get_count() + scene.instancers.index.get_count() + scene.lights.index.get_count();
+    scene.clear(source);
+    print_result("clear", live_count, clear_timer.get_elapsed());
+
+    print_peak_rss();
+    RSStub::print_statistics(stdout);
+}
+
+int
+main(int argc, char **argv)
+{
+    const unsigned long long max_count = get_max_count(argc, argv, 1000000);
+    set_bench_executor(argc, argv);
+    for (unsigned long long count = 1000; count <= max_count; count *= 10) run(count);
+    return 0;
+}
@@ -0,0 +1,199 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+#ifndef REDSHIFT_BENCH_UTILS_H
+#define REDSHIFT_BENCH_UTILS_H
+
+#include <cstdio>
+#include <cstring>
+
+#include <r2c_bench_utils.h>
+#include <redshift_task_pool.h>
+#include <redshift_utils.h>
+
+/*! \class BenchSerialExecutor
+    \brief Executor running the tasks of the conversions one after the other on the calling thread. */
+class BenchSerialExecutor : public RedshiftTaskExecutor {
+public:
+    unsigned int get_concurrency() const override { return 1; }
+    void run(const unsigned int& count, const std::function<void(const unsigned int&)>& task) override
+    {
+        for (unsigned int i = 0; i < count; i++) task(i);
+    }
+};
+
+/*! \brief Run the tasks of the conversions serially if the second argument of a benchmark is "serial",
+ *         by a pool of worker threads otherwise, standing for the thread manager of Clarisse */
+inline void
+set_bench_executor(int argc, char **argv)
+{
+    static BenchSerialExecutor serial;
+    static RedshiftTaskPool pool;
+    const bool is_serial = argc > 2 && strcmp(argv[2], "serial") == 0;
+    RedshiftUtils::set_task_executor(is_serial ? static_cast<RedshiftTaskExecutor *>(&serial) : &pool);
+    printf("%s executor\n", is_serial ? "serial" : "pool");
+}
+
+/*! \brief Describe a square grid of quads of the specified resolution, with normals and uvs */
+inline void
+make_grid(PolymeshDescription& desc, const unsigned int& resolution)
+{
+    const unsigned int row = resolution + 1;
+    desc.positions.resize(row * row);
+    desc.normals.resize(1);
+    desc.normals[0] = GMathVec3f(0.0f, 1.0f, 0.0f);
+    desc.uvs.resize(row * row);
+    for (unsigned int j = 0; j < row; j++) {
+        for (unsigned int i = 0; i < row; i++) {
+            const float u = static_cast<float>(i) / resolution;
+            const float v = static_cast<float>(j) / resolution;
+            desc.positions[j * row + i] = GMathVec3f(u, 0.0f, v);
+            desc.uvs[j * row + i] = GMathVec3f(u, v, 0.0f);
+        }
+    }
+    const unsigned int polygon_count = resolution * resolution;
+    desc.polygon_vertex_count.resize(polygon_count);
+    desc.polygon_shading_groups.resize(polygon_count);
+    desc.polygon_vertex_ids.resize(polygon_count * 4);
+    desc.normal_indices.resize(polygon_count * 4);
+    for (unsigned int j = 0; j < resolution; j++) {
+        for (unsigned int i = 0; i < resolution; i++) {
+            const unsigned int polygon = j * resolution + i;
+            desc.polygon_vertex_count[polygon] = 4;
+            desc.polygon_shading_groups[polygon] = 0;
+            unsigned int *ids = &desc.polygon_vertex_ids[polygon * 4];
+            ids[0] = j * row + i;
+            ids[1] = (j + 1) * row + i;
+            ids[2] = (j + 1) * row + i + 1;
+            ids[3] = j * row + i + 1;
+            for (unsigned int k = 0; k < 4; k++) desc.normal_indices[polygon * 4 + k] = 0;
+        }
+    }
+    desc.uv_indices = desc.polygon_vertex_ids;
+    desc.is_uv_defined = true;
+    desc.material_count = 1;
+}
+
+/*! \class BenchSceneSource
+    \brief Synthetic scene synchronized by RedshiftScene like the render delegate does it from its scene delegate.
+            Geometries share their grid mesh by groups, instancers scatter the meshes of the first geometries
+            and all lights are alike. The sync visits the items through their id returned by get_*_id(). */
+class BenchSceneSource : public RedshiftSceneSource {
+public:
+
+    BenchSceneSource(const unsigned int& geometries_per_resource, const unsigned int& shading_group_count,
+                     const unsigned int& prototype_count, const unsigned int& instances_per_instancer)
+        : m_geometries_per_resource(geometries_per_resource)
+        , m_prototype_count(prototype_count)
+    {
+        make_grid(m_grid, 16);
+        m_grid.material_count = shading_group_count;
+        for (unsigned int i = 0; i < m_grid.polygon_shading_groups.get_count(); i++) m_grid.polygon_shading_groups[i] = i % shading_group_count;
+        char name[32];
+        for (unsigned int i = 0; i < shading_group_count; i++) {
+            snprintf(name, sizeof(name), "bench_%u", i);
+            m_materials.add(RS_Material_Get(name));
+        }
+        m_instance_matrices.resize(instances_per_instancer);
+        m_instance_prototypes.resize(instances_per_instancer);
+        for (unsigned int i = 0; i < instances_per_instancer; i++) {
+            m_instance_matrices[i] = get_transform(i);
+            m_instance_prototypes[i] = i % prototype_count;
+        }
+    }
+
+    ~BenchSceneSource() override { for (auto material : m_materials) RS_Material_Release(material); }
+
+    /*! \brief Return the id of the geometry, instancer or light of the specified index */
+    static inline R2cItemId get_geometry_id(const unsigned long long& index) { return index + 1; }
+    static inline R2cItemId get_instancer_id(const unsigned long long& index) { return (1ull << 40) + index; }
+    static inline R2cItemId get_light_id(const unsigned long long& index) { return (2ull << 40) + index; }
+
+    R2cResourceId get_resource_id(R2cItemId geometry) override
+    {
+        return reinterpret_cast<R2cResourceId>(static_cast<size_t>((geometry - 1) / m_geometries_per_resource + 1));
+    }
+
+    void create_resources(RedshiftScene& scene, const CoreVector<R2cItemId>& geometries) override
+    {
+        for (auto geometry : geometries) acquire_resource(scene, get_resource_id(geometry), 0);
+    }
+
+    GMathMatrix4x4d get_transform(R2cItemId item) override
+    {
+        // items are laid out on a grid of 1000 by 1000
+        GMathMatrix4x4d transform(true);
+        transform[3][0] = static_cast<double>(item % 1000);
+        transform[3][2] = static_cast<double>((item / 1000) % 1000);
+        return transform;
+    }
+
+    bool get_visible(R2cItemId item) override { return true; }
+
+    RSMaterial *acquire_material(R2cItemId item, const unsigned int& shading_group, CoreVector<unsigned int>& references) override
+    {
+        const unsigned int material = shading_group % m_materials.get_count();
+        references.add(material);
+        return m_materials[material];
+    }
+
+    // materials live as long as the source
+    void release_material(const unsigned int& reference) override {}
+
+    void create_instancer(RedshiftScene& scene, R2cItemId instancer, RSInstancerInfo& rinstancer) override
+    {
+        // like RedshiftUtils::CreateInstancer, a point cloud per prototype, each prototype being a resource of the geometries
+        rinstancer.resources.resize(m_prototype_count);
+        rinstancer.ptrs.resize(m_prototype_count);
+        for (unsigned int i = 0; i < m_prototype_count; i++) {
+            rinstancer.resources[i] = get_resource_id(get_geometry_id(static_cast<unsigned long long>(i) * m_geometries_per_resource));
+            RSMeshBase *mesh = acquire_resource(scene, rinstancer.resources[i], 1);
+            rinstancer.ptrs[i] = RS_PointCloud_New();
+            rinstancer.ptrs[i]->SetIsTransformationBlurred(false);
+            rinstancer.ptrs[i]->SetPrimitiveType("RS_POINTCLOUDPRIMITIVETYPE_MESHINSTANCE");
+            rinstancer.ptrs[i]->SetInstanceTemplate(mesh);
+            rinstancer.ptrs[i]->SetNumMaterials(mesh->GetNumMaterials());
+        }
+        rinstancer.dirtiness = R2cSceneDelegate::DIRTINESS_KINEMATIC | R2cSceneDelegate::DIRTINESS_SHADING_GROUP | R2cSceneDelegate::DIRTINESS_VISIBILITY;
+        RedshiftUtils::FillPointClouds(rinstancer.ptrs, m_instance_matrices, m_instance_prototypes);
+        rinstancer.bytes = static_cast<unsigned long long>(m_instance_prototypes.get_count()) * sizeof(RSMatrix4x4);
+    }
+
+    void create_light(R2cItemId light, RSLightInfo& rlight) override
+    {
+        rlight.shader = RS_ShaderNode_Get("bench_light", "Light");
+        rlight.ptr = RS_Light_New("bench_light", "bench_light_shader");
+    }
+
+    void sync_light_attributes(R2cItemId light, RSLightInfo& rlight) override { rlight.ptr->SetAreaScaling(RSVector3(0.5f, 0.5f, 0.5f)); }
+
+private:
+
+    // return the mesh of a resource, creating it if it isn't in the index yet, and add references to it
+    RSMeshBase *acquire_resource(RedshiftScene& scene, R2cResourceId id, const unsigned int& references)
+    {
+        RSResourceInfo *resource = scene.resources.index.is_key_exists(id);
+        if (resource != nullptr) {
+            resource->refcount += references;
+            return resource->ptr;
+        }
+        RSResourceInfo new_resource;
+        new_resource.ptr = RedshiftUtils::CreatePolygonalMesh(m_grid, m_materials[0]);
+        new_resource.type = RSResourceInfo::TYPE_MESH;
+        new_resource.refcount = references;
+        new_resource.bytes = new_resource.ptr->GetDataSizeBytes();
+        scene.resources.index.add(id, new_resource);
+        scene.ptr->AddMesh(new_resource.ptr);
+        return new_resource.ptr;
+    }
+
+    PolymeshDescription m_grid;
+    CoreVector<RSMaterial *> m_materials; // material of each shading group
+    CoreArray<GMathMatrix4x4d> m_instance_matrices; // matrices of the instances of an instancer
+    CoreArray<unsigned int> m_instance_prototypes; // prototype of each instance of an instancer
+    unsigned int m_geometries_per_resource;
+    unsigned int m_prototype_count;
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <dso_export.h>
 #include <r2c_module_layer_scene.h>
 #include <redshift_render_delegate.h>
+#include <redshift_utils.h>
 
 #include "layer_redshift.cma"
 
@@ -18,6 +19,8 @@ IX_END_DECLARE_MODULE_CALLBACKS(ModuleLayerRedshift)
 R2cRenderDelegate *
 IX_MODULE_CLBK::get_render_delegate(OfObject& object)
 {
+    // the render falls back to the default materials
+    RedshiftUtils::create_default_materials(object.get_application());
     return new RedshiftRenderDelegate;
 }
 
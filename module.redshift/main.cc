@@ -27,6 +27,7 @@ IX_BEGIN_EXTERN_C
         LayerRedshift::on_register(app, new_classes);
         // Initializing Redshift Engine
         // We must initialize early on to register all shaders/lights etc...
+        // The engine itself (texture cache, devices) is started on demand by RedshiftUtils::start_engine()
         if (!RedshiftUtils::is_initialized()) {
             RedshiftUtils::initialize(app);
         }
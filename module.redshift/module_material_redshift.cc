@@ -2,6 +2,7 @@
 // Copyright 2020 - present Isotropix SAS. See License.txt for license information
 //
 
+#include <core_hash_table.h>
 #include <of_app.h>
 
 #include <RS.h>
@@ -13,18 +14,84 @@ IMPLEMENT_CLASS(ModuleMaterialRedshift, ModuleMaterial)
 
 static const char *base_class_name = "MaterialRedshift";
 
+// live materials by reference id so that the render delegate and the shaders connecting them can release the
+// materials they reference without dereferencing the ones whose item has been deleted meanwhile. The render scene
+// is synced by the thread evaluating the layer, which also creates, modifies and deletes the items
+static CoreHashTable<unsigned int, ModuleMaterialRedshift *> materials;
+static unsigned int next_reference_id = 1;
+
 ModuleMaterialRedshift::ModuleMaterialRedshift() : ModuleMaterial()
 {
+    m_parameters = nullptr;
     m_material = nullptr;
+    m_refcount = 0;
+    m_is_external = false;
+    m_reference_id = next_reference_id++;
+    materials.add(m_reference_id, this);
 }
 
-ModuleMaterialRedshift::~ModuleMaterialRedshift()
+/*! \brief Delete a Redshift material along with its surface shader
+ *  \note The material must be detached from its item first since the shader releases the inputs connected to it */
+static void
+delete_material(RSMaterial *material)
 {
-    if (m_material != nullptr) {
-        RSShaderNode *shader = get_material()->GetSurfaceShaderNodeGraph();
+    RSShaderNode *shader = material->GetSurfaceShaderNodeGraph();
+    if (shader != nullptr) {
+        RedshiftUtils::discard_shader_updates(*shader);
+        RedshiftUtils::release_shader_inputs(*shader);
+        RedshiftUtils::release_shader_textures(*shader);
         RS_ShaderNode_Release(shader);
-        RS_Material_Release(m_material);
     }
+    RS_Material_Release(material);
+}
+
+ModuleMaterialRedshift::~ModuleMaterialRedshift()
+{
+    materials.remove(m_reference_id);
+    RSMaterial *material = m_is_external ? nullptr : m_material;
+    m_material = nullptr;
+    if (material != nullptr) delete_material(material);
+}
+
+RSMaterial *
+ModuleMaterialRedshift::acquire_material()
+{
+    // external materials are owned by their creator and never deleted through the references
+    if (m_is_external) return m_material;
+    RSShaderNode *new_shader = nullptr;
+    if (m_material == nullptr) {
+        // materials of look-dev libraries which are never assigned don't cost anything until they are referenced
+        m_material = RS_Material_Get(get_object_name().get_data());
+        CoreString id;
+        id += get_of_module_id();
+        new_shader = RS_ShaderNode_Get(id.get_data(), m_shader_class_name.get_data());
+        if (new_shader != nullptr) m_material->SetSurfaceShaderNodeGraph(new_shader);
+    }
+    m_refcount++;
+    // the material is referenced before its attributes are read since they may connect other materials
+    RSMaterial *material = m_material;
+    if (new_shader != nullptr) {
+        // the texture files of the material are read in the background while the textures connected to it are created
+        RedshiftUtils::prefetch_shader_textures(*new_shader, *m_parameters, *get_object());
+        RedshiftUtils::sync_shader(*new_shader, *m_parameters, *get_object());
+    }
+    return material;
+}
+
+void
+ModuleMaterialRedshift::release_material(const unsigned int& reference_id)
+{
+    RSMaterial *released = nullptr;
+    ModuleMaterialRedshift **found = materials.is_key_exists(reference_id);
+    // the material item may have been deleted along with its Redshift material, and external materials aren't counted
+    if (found != nullptr && !(*found)->m_is_external) {
+        ModuleMaterialRedshift& material = **found;
+        if (material.m_refcount > 0 && --material.m_refcount == 0 && material.m_material != nullptr) {
+            released = material.m_material;
+            material.m_material = nullptr;
+        }
+    }
+    if (released != nullptr) delete_material(released);
 }
 
 void
@@ -32,8 +99,11 @@ ModuleMaterialRedshift::on_attribute_change(const OfAttr& attr, int& dirtiness,
 {
     ModuleMaterial::on_attribute_change(attr, dirtiness, dirtiness_flags);
 
-    if (RSShaderNode *shader = get_material()->GetSurfaceShaderNodeGraph()) {
-        RedshiftUtils::on_attribute_change(*shader, attr, dirtiness, dirtiness_flags);
+    // unreferenced materials don't have any shader. Their attributes are read when they get referenced
+    // and external materials don't reflect the attributes of the item
+    if (m_is_external || m_material == nullptr) return;
+    if (RSShaderNode *shader = m_material->GetSurfaceShaderNodeGraph()) {
+        RedshiftUtils::on_attribute_change(*shader, *m_parameters, attr, dirtiness, dirtiness_flags);
     }
 }
 
@@ -59,14 +129,10 @@ ModuleMaterialRedshift::module_constructor(OfObject& object)
 {
     ModuleMaterial::module_constructor(object);
     m_shader_class_name = object.get_class().get_name().get_data() + 16;
+    m_parameters = &RedshiftUtils::get_shader_parameter_index(m_shader_class_name);
     connect(*get_object(), EVT_ID_OF_OBJECT_RENAME, EVENT_METHOD(ModuleMaterialRedshift::on_material_rename));
     connect(*get_object(), EVT_ID_OF_OBJECT_CONTEXT_CHANGED, EVENT_METHOD(ModuleMaterialRedshift::on_material_rename));
-
-    m_material = RS_Material_Get(get_object_name().get_data());
-    CoreString id;
-    id += get_of_module_id();
-    RSShaderNode *shader = RS_ShaderNode_Get(id.get_data(), m_shader_class_name.get_data());
-    if (shader != nullptr) {
-        m_material->SetSurfaceShaderNodeGraph(shader);
-    }
+    // the scene is likely to be rendered with Redshift which falls back to the default materials
+    RedshiftUtils::create_default_materials(get_application());
+    // the Redshift material is only created once it is referenced by the render scene
 }
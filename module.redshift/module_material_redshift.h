@@ -8,6 +8,8 @@
 #include <module_material.h>
 
 class RSMaterial;
+class RSShaderNode;
+class RSShaderParameterIndex;
 
 class OfObject;
 
@@ -20,13 +22,23 @@ public:
     virtual ~ModuleMaterialRedshift() override;
 
     /*! \brief return the Redshift material attached to the Clarisse material item.
-     * \note The material is automatically synched. */
+     * \note The material is automatically synched. It is nullptr as long as the material isn't referenced. */
     inline RSMaterial *get_material() { return m_material; }
 
+    /*! \brief reference the Redshift material, creating it with the current attribute values if it wasn't referenced yet.
+     * \note Each call must be balanced by a call to release_material() with the id returned by get_reference_id(). */
+    RSMaterial *acquire_material();
+    /*! \brief return the id used to release the material, which stays valid even if the material item is deleted. */
+    inline unsigned int get_reference_id() const { return m_reference_id; }
+    /*! \brief release a reference to the material with the specified id. The Redshift material is deleted when it isn't referenced anymore.
+     * \note Does nothing if the material item has been deleted in the meantime. */
+    static void release_material(const unsigned int& reference_id);
+
     /* \brief set the Redshift material attached to the Clarisse material item.
      * \note It is not intended to be used except for particular case, 
-     * if you want to use this method, the result won't match the attributes values of the Clarisse material item. */
-	inline void set_material(RSMaterial *material) { m_material = material; }
+     * if you want to use this method, the result won't match the attributes values of the Clarisse material item.
+     * The material stays owned by the caller: it isn't reference counted nor deleted with the item. */
+	inline void set_material(RSMaterial *material) { m_material = material; m_is_external = material != nullptr; }
 
     /*! \brief return a Clarisse UI style name from the specified Redshift shader class name.
      * \param class_name Redshift shader class name. */
@@ -49,7 +61,11 @@ private:
     ModuleMaterialRedshift& operator=(const ModuleMaterialRedshift&) = delete;
 
     CoreString m_shader_class_name;
-    RSMaterial *m_material;
+    RSShaderParameterIndex *m_parameters; // parameter indices shared by all the materials of the same class
+    RSMaterial *m_material; // created on the first reference and deleted with the last one
+    unsigned int m_refcount; // number of references to the Redshift material
+    unsigned int m_reference_id; // unique id of the material used to release it safely
+    bool m_is_external; // true if the material has been set by set_material() and isn't owned by the item
     DECLARE_CLASS
 };
 
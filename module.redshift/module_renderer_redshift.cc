@@ -13,9 +13,15 @@
 
 IMPLEMENT_CLASS(ModuleRendererRedshift, ModuleRenderer)
 
-ModuleRendererRedshift::ModuleRendererRedshift() : ModuleRenderer() {}
+// Redshift render options are global so we keep track of the renderer item which set them last
+static const ModuleRendererRedshift *synced_renderer = nullptr;
 
-ModuleRendererRedshift::~ModuleRendererRedshift() {}
+ModuleRendererRedshift::ModuleRendererRedshift() : ModuleRenderer(), m_synced_sampling_quality(0.0f), m_synced_frame_id(0) {}
+
+ModuleRendererRedshift::~ModuleRendererRedshift()
+{
+    if (synced_renderer == this) synced_renderer = nullptr;
+}
 
 template <typename T>
 inline T GetValue(OfObject& object, const char *aname, T dvalue, bool force_default, const float& mult)
@@ -60,57 +66,161 @@ render_option_set_string(OfObject& object, const char *aname, const char *rs_ana
 
 
 void
-ModuleRendererRedshift::sync(const float& sampling_quality)
+ModuleRendererRedshift::sync(const float& sampling_quality, const CoreSet<CoreString>& dirty_attributes, const bool& force)
 {
     OfObject& object = *get_object();
 
     float current_frame = static_cast<float>(get_application().get_factory().get_time().get_current_frame());
     unsigned int frameid = *(unsigned int *) &current_frame; // hackish way to get a unique and consistent frame id from a float
-    RS_RenderOption_SetUInt("FrameID", frameid);
 
-    RS_RenderOption_SetBool("MotionBlurEnabled", false);
+    // everything is set again if another renderer item overwrote the options
+    const bool all = force || synced_renderer != this;
+    // animated attributes don't notify their changes when the time changes so they are all set again on a new frame
+    const bool all_attributes = all || frameid != m_synced_frame_id;
+    const bool quality_changed = all || sampling_quality != m_synced_sampling_quality;
+    const bool is_preview = sampling_quality == 0.0f;
+    const bool preview_changed = all || is_preview != (m_synced_sampling_quality == 0.0f);
+    auto is_dirty = [&](const char *aname) { return all_attributes || dirty_attributes.exists(aname); };
+    bool changed = false;
+
+    if (all || frameid != m_synced_frame_id) {
+        RS_RenderOption_SetUInt("FrameID", frameid);
+        changed = true;
+    }
+
+    if (quality_changed || is_dirty("min_samples")) {
+        render_option_set_uint(object, "min_samples", "UnifiedMinSamples", 8, false, sampling_quality);
+        changed = true;
+    }
+    if (quality_changed || is_dirty("max_samples")) {
+        render_option_set_uint(object, "max_samples", "UnifiedMaxSamples", 32, false, sampling_quality);
+        changed = true;
+    }
+    if (is_dirty("adaptive_error_threshold")) {
+        render_option_set_float(object, "adaptive_error_threshold", "UnifiedAdaptiveErrorThreshold", 0.005f);
+        changed = true;
+    }
+
+    if (preview_changed || (!is_preview && is_dirty("filter_type"))) {
+        if (is_preview) {
+            render_option_set_string(object, "filter_type", "UnifiedFilterType", "RS_AAFILTER_BOX", true);
+        } else {
+            render_option_set_string(object, "filter_type", "UnifiedFilterType", "RS_AAFILTER_GAUSS");
+        }
+        changed = true;
+    }
+    if (preview_changed || (!is_preview && is_dirty("filter_size"))) {
+        if (is_preview) {
+            render_option_set_float(object, "filter_size", "UnifiedFilterSize", 1.0f, true);
+        } else {
+            render_option_set_float(object, "filter_size", "UnifiedFilterSize", 2.0f);
+        }
+        changed = true;
+    }
+    if (is_dirty("max_subsample_intensity")) {
+        render_option_set_float(object, "max_subsample_intensity", "UnifiedMaxOverbright", 2.0f);
+        changed = true;
+    }
+    if (is_dirty("randomize_pattern_on_each_frame")) {
+        render_option_set_bool(object, "randomize_pattern_on_each_frame", "UnifiedRandomizePattern", true);
+        changed = true;
+    }
+
+    if (is_dirty("enable_progressive_rendering") || is_dirty("interactive_rendering")) {
+        // interactive rendering always refines the image by progressive passes
+        const bool interactive = get_interactive_rendering();
+        render_option_set_bool(object, "enable_progressive_rendering", "ProgressiveRenderingEnabled", interactive, interactive);
+        changed = true;
+    }
+    if (quality_changed || is_dirty("progressive_rendering_samples")) {
+        render_option_set_uint(object, "progressive_rendering_samples", "ProgressiveRenderingNumPasses", 64, false, sampling_quality);
+        changed = true;
+    }
+
+    if (all) {
+        // options which aren't exposed by the renderer item
+        RS_RenderOption_SetBool("MotionBlurEnabled", false);
+
+        RS_Renderer_SetDisplayGamma(1.0f);
+        RS_Renderer_SetColorInputGamma(1.0f);
+        RS_Renderer_SetSamplingGamma(1.0f);
 
-    render_option_set_uint(object, "min_samples", "UnifiedMinSamples", 8, false, sampling_quality);
-    render_option_set_uint(object, "max_samples", "UnifiedMaxSamples", 32, false, sampling_quality);
-    render_option_set_float(object, "adaptive_error_threshold", "UnifiedAdaptiveErrorThreshold", 0.005f);
+        RS_RenderOption_SetString("PrimaryGIEngine", "RS_GIENGINE_BRUTE_FORCE");
+        RS_RenderOption_SetString("SecondaryGIEngine", "RS_GIENGINE_BRUTE_FORCE");
 
-    if (sampling_quality == 0.0f) {
-        render_option_set_string(object, "filter_type", "UnifiedFilterType", "RS_AAFILTER_BOX", true);
-        render_option_set_float(object, "filter_size", "UnifiedFilterSize", 1.0f, true);
-    } else {
-        render_option_set_string(object, "filter_type", "UnifiedFilterType", "RS_AAFILTER_GAUSS");
-        render_option_set_float(object, "filter_size", "UnifiedFilterSize", 2.0f);
+        RS_RenderOption_SetUInt("NumGIBounces", 1);
+        RS_RenderOption_SetBool("ConserveGIReflectionEnergy", true);
+        changed = true;
     }
-    render_option_set_float(object, "max_subsample_intensity", "UnifiedMaxOverbright", 2.0f);
-    render_option_set_bool(object, "randomize_pattern_on_each_frame", "UnifiedRandomizePattern", true);
 
-    RS_Renderer_SetDisplayGamma(1.0f);
-    RS_Renderer_SetColorInputGamma(1.0f);
-    RS_Renderer_SetSamplingGamma(1.0f);
+    if (changed) RS_RenderOption_Validate();
+
+    synced_renderer = this;
+    m_synced_sampling_quality = sampling_quality;
+    m_synced_frame_id = frameid;
+}
+
+double
+ModuleRendererRedshift::get_compaction_ratio() const
+{
+    OfAttr *attr = get_object()->get_attribute("compaction_ratio");
+    return attr != nullptr ? attr->get_double() : 0.25;
+}
+
+unsigned int
+ModuleRendererRedshift::get_compaction_max_removed_items() const
+{
+    OfAttr *attr = get_object()->get_attribute("compaction_max_removed_items");
+    return attr != nullptr ? static_cast<unsigned int>(attr->get_long()) : 100000;
+}
+
+unsigned long long
+ModuleRendererRedshift::get_compaction_max_removed_bytes() const
+{
+    // the attribute is expressed in megabytes
+    OfAttr *attr = get_object()->get_attribute("compaction_max_removed_memory");
+    return (attr != nullptr ? static_cast<unsigned long long>(attr->get_long()) : 1024) * 1024 * 1024;
+}
+
+bool
+ModuleRendererRedshift::get_progressive_translation() const
+{
+    OfAttr *attr = get_object()->get_attribute("progressive_translation");
+    return attr != nullptr ? attr->get_bool() : false;
+}
 
-    render_option_set_bool(object, "enable_progressive_rendering", "ProgressiveRenderingEnabled", false);
-    render_option_set_uint(object, "progressive_rendering_samples", "ProgressiveRenderingNumPasses", 64, false, sampling_quality);
+bool
+ModuleRendererRedshift::get_frustum_preview() const
+{
+    OfAttr *attr = get_object()->get_attribute("frustum_preview");
+    return attr != nullptr ? attr->get_bool() : false;
+}
 
-    RS_RenderOption_SetString("PrimaryGIEngine", "RS_GIENGINE_BRUTE_FORCE");
-    RS_RenderOption_SetString("SecondaryGIEngine", "RS_GIENGINE_BRUTE_FORCE");
+double
+ModuleRendererRedshift::get_frustum_preview_margin() const
+{
+    OfAttr *attr = get_object()->get_attribute("frustum_preview_margin");
+    return attr != nullptr ? attr->get_double() : 0.1;
+}
 
-    RS_RenderOption_SetUInt("NumGIBounces", 1);
-    RS_RenderOption_SetBool("ConserveGIReflectionEnergy", true);
+bool
+ModuleRendererRedshift::get_interactive_rendering() const
+{
+    OfAttr *attr = get_object()->get_attribute("interactive_rendering");
+    return attr != nullptr ? attr->get_bool() : false;
+}
 
-    RS_RenderOption_Validate();
+bool
+ModuleRendererRedshift::get_log_sync_statistics() const
+{
+    OfAttr *attr = get_object()->get_attribute("log_sync_statistics");
+    return attr != nullptr ? attr->get_bool() : false;
 }
 
-// doing nothing there. Just here as an example
+// doing nothing there. Attribute changes are forwarded by the scene delegate to
+// RedshiftRenderDelegate::dirty_render_settings so that only modified options are set
 void
 ModuleRendererRedshift::on_attribute_change(const OfAttr& attr, int& dirtiness, const int& dirtiness_flags)
 {
     ModuleProjectItem::on_attribute_change(attr, dirtiness, dirtiness_flags);
-    if (attr.get_name() == "min_samples") {
-    } else if (attr.get_name() == "max_samples") {
-    } else if (attr.get_name() == "adaptive_error_threshold") {
-    } else if (attr.get_name() == "randomize_pattern_on_each_frame") {
-    } else if (attr.get_name() == "filter_type") {
-    } else if (attr.get_name() == "filter_size") {
-    } else if (attr.get_name() == "max_subsample_intensity") {
-    }
 }
@@ -5,6 +5,7 @@
 #ifndef MODULE_RENDERER_REDSHIFT_H
 #define MODULE_RENDERER_REDSHIFT_H
 
+#include <core_set.h>
 #include <module_renderer.h>
 
 class OfObject;
@@ -23,8 +24,28 @@ public:
 
     /*! \brief Synchronize Redshift renderer to the attributes of the actual renderer item
      *  \param sampling_quality global sampling multiplier.
-     *  \note  The multiplier should affect all sampling values so that a sampling_quality of 0.0 should result to 1 spp. */
-    void sync(const float& sampling_quality);
+     *  \param dirty_attributes names of the attributes modified since the last synchronization
+     *  \param force set whether all render options must be set regardless of the modified attributes
+     *  \note  The multiplier should affect all sampling values so that a sampling_quality of 0.0 should result to 1 spp.
+     *         Only the options depending on what changed are set so that Redshift doesn't invalidate its preparation. */
+    void sync(const float& sampling_quality, const CoreSet<CoreString>& dirty_attributes, const bool& force);
+
+    /*! \brief Return the ratio of removed items over live items above which the render scene is compacted */
+    double get_compaction_ratio() const;
+    /*! \brief Return the number of removed items above which the render scene is compacted */
+    unsigned int get_compaction_max_removed_items() const;
+    /*! \brief Return the size in bytes retained by removed items above which the render scene is compacted */
+    unsigned long long get_compaction_max_removed_bytes() const;
+    /*! \brief Return true if meshes are rendered as bounding boxes until they are converted in the background */
+    bool get_progressive_translation() const;
+    /*! \brief Return true if geometries outside of the camera frustum aren't translated until the camera reveals them */
+    bool get_frustum_preview() const;
+    /*! \brief Return the ratio by which the field of view of the camera is expanded to test the geometries in preview mode */
+    double get_frustum_preview_margin() const;
+    /*! \brief Return true if the render is interrupted and restarted as soon as the scene is modified */
+    bool get_interactive_rendering() const;
+    /*! \brief Return true if the time spent synchronizing each type of item is logged after each sync */
+    bool get_log_sync_statistics() const;
 
 protected:
 
@@ -36,6 +57,8 @@ protected:
 
 private:
 
+    float m_synced_sampling_quality; // sampling quality of the last synchronization
+    unsigned int m_synced_frame_id; // frame id of the last synchronization
     DECLARE_CLASS
 };
 
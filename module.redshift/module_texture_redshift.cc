@@ -2,6 +2,7 @@
 // Copyright 2020 - present Isotropix SAS. See License.txt for license information
 //
 
+#include <core_hash_table.h>
 #include <of_app.h>
 
 #include <RS.h>
@@ -13,16 +14,37 @@ IMPLEMENT_CLASS(ModuleTextureRedshift, ModuleTextureOperator)
 
 static const char *base_class_name = "TextureRedshift";
 
+// live textures by reference id so that the shaders connecting them can release them without dereferencing
+// the ones whose item has been deleted meanwhile
+static CoreHashTable<unsigned int, ModuleTextureRedshift *> textures;
+static unsigned int next_reference_id = 1;
+
 ModuleTextureRedshift::ModuleTextureRedshift() : ModuleTextureOperator()
 {
+    m_parameters = nullptr;
     m_shader = nullptr;
+    m_refcount = 0;
+    m_reference_id = next_reference_id++;
+    textures.add(m_reference_id, this);
+}
+
+/*! \brief Delete a Redshift texture shader along with the references it holds
+ *  \note The shader must be detached from its item first since it releases the textures connected to it */
+static void
+delete_shader(RSShaderNode *shader)
+{
+    RedshiftUtils::discard_shader_updates(*shader);
+    RedshiftUtils::release_shader_inputs(*shader);
+    RedshiftUtils::release_shader_textures(*shader);
+    RS_ShaderNode_Release(shader);
 }
 
 ModuleTextureRedshift::~ModuleTextureRedshift()
 {
-    if (m_shader != nullptr) {
-        RS_ShaderNode_Release(m_shader);
-    }
+    textures.remove(m_reference_id);
+    RSShaderNode *shader = m_shader;
+    m_shader = nullptr;
+    if (shader != nullptr) delete_shader(shader);
 }
 
 void
@@ -30,9 +52,47 @@ ModuleTextureRedshift::on_attribute_change(const OfAttr& attr, int& dirtiness, c
 {
     ModuleTextureOperator::on_attribute_change(attr, dirtiness, dirtiness_flags);
 
+    // unreferenced textures don't have any shader. Their attributes are read when they get referenced
     if (m_shader != nullptr) {
-        RedshiftUtils::on_attribute_change(*m_shader, attr, dirtiness, dirtiness_flags);
+        RedshiftUtils::on_attribute_change(*m_shader, *m_parameters, attr, dirtiness, dirtiness_flags);
+    }
+}
+
+RSShaderNode *
+ModuleTextureRedshift::acquire_shader()
+{
+    RSShaderNode *new_shader = nullptr;
+    if (m_shader == nullptr) {
+        // textures of look-dev libraries which are never used don't cost anything until a material connects them
+        CoreString id;
+        id += get_object()->get_factory_id();
+        m_shader = RS_ShaderNode_Get(id.get_data(), m_shader_class_name.get_data());
+        new_shader = m_shader;
+    }
+    if (m_shader != nullptr) m_refcount++;
+    // the texture is referenced before its attributes are read since they may connect other textures
+    RSShaderNode *shader = m_shader;
+    if (new_shader != nullptr) {
+        RedshiftUtils::prefetch_shader_textures(*new_shader, *m_parameters, *get_object());
+        RedshiftUtils::sync_shader(*new_shader, *m_parameters, *get_object());
     }
+    return shader;
+}
+
+void
+ModuleTextureRedshift::release_shader(const unsigned int& reference_id)
+{
+    RSShaderNode *released = nullptr;
+    ModuleTextureRedshift **found = textures.is_key_exists(reference_id);
+    // the texture item may have been deleted along with its Redshift shader
+    if (found != nullptr) {
+        ModuleTextureRedshift& texture = **found;
+        if (texture.m_refcount > 0 && --texture.m_refcount == 0 && texture.m_shader != nullptr) {
+            released = texture.m_shader;
+            texture.m_shader = nullptr;
+        }
+    }
+    if (released != nullptr) delete_shader(released);
 }
 
 CoreString
@@ -48,8 +108,8 @@ ModuleTextureRedshift::module_constructor(OfObject& object)
 {
     ModuleTextureOperator::module_constructor(object);
     m_shader_class_name = object.get_class().get_name().get_data() + 15;
-
-    CoreString id;
-    id += get_object()->get_factory_id();
-    m_shader = RS_ShaderNode_Get(id.get_data(), m_shader_class_name.get_data());
+    m_parameters = &RedshiftUtils::get_shader_parameter_index(m_shader_class_name);
+    // the scene is likely to be rendered with Redshift which falls back to the default materials
+    RedshiftUtils::create_default_materials(get_application());
+    // the Redshift shader is only created once a material uses the texture
 }
@@ -8,6 +8,7 @@
 #include <module_texture_operator.h>
 
 class RSShaderNode;
+class RSShaderParameterIndex;
 
 /*! \class ModuleTextureRedshift
     \brief This class implements the Redshift Texture abstract class in Clarisse. */
@@ -18,9 +19,18 @@ public:
     virtual ~ModuleTextureRedshift() override;
 
     /*! \brief return the Redshift shader attached to the Clarisse texture item.
-     * \note The shader is automatically synched. */
+     * \note The shader is automatically synched. It is nullptr as long as the texture isn't referenced. */
     inline RSShaderNode *get_shader() { return m_shader; }
 
+    /*! \brief reference the Redshift shader, creating it with the current attribute values if it wasn't referenced yet.
+     * \note Each call must be balanced by a call to release_shader() with the id returned by get_reference_id(). */
+    RSShaderNode *acquire_shader();
+    /*! \brief return the id used to release the shader, which stays valid even if the texture item is deleted. */
+    inline unsigned int get_reference_id() const { return m_reference_id; }
+    /*! \brief release a reference to the texture with the specified id. The Redshift shader is deleted when it isn't referenced anymore.
+     * \note Does nothing if the texture item has been deleted in the meantime. */
+    static void release_shader(const unsigned int& reference_id);
+
     /*! \brief return a Clarisse UI style name from the specified Redshift shader class name.
      * \param class_name Redshift shader class name. */
     static CoreString mangle_class(const CoreString& class_name);
@@ -38,7 +48,10 @@ private:
     ModuleTextureRedshift& operator=(const ModuleTextureRedshift&) = delete;
 
     CoreString m_shader_class_name;
-    RSShaderNode *m_shader;
+    RSShaderParameterIndex *m_parameters; // parameter indices shared by all the textures of the same class
+    RSShaderNode *m_shader; // created on the first reference and deleted with the last one
+    unsigned int m_refcount; // number of references to the Redshift shader
+    unsigned int m_reference_id; // unique id of the texture used to release it safely
     DECLARE_CLASS
 };
 
@@ -0,0 +1,624 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Conversions of RedshiftUtils which only depend on the core libraries of Clarisse and on the
+// Redshift API so that they can be benchmarked against the stub of the Redshift API (see stub/).
+
+#include "redshift_utils.h"
+
+#include <sys_thread_task_manager.h>
+
+#include <RS.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+/*! \class RedshiftThreadManagerExecutor
+    \brief Default executor of the tasks of the conversions, which feeds them to the thread manager of the application
+            so that they share its threads with the rest of Clarisse. Until a thread manager is set, and for a run
+            from a task, the tasks are run serially by the calling thread. */
+class RedshiftThreadManagerExecutor : public RedshiftTaskExecutor {
+public:
+    RedshiftThreadManagerExecutor() : m_thread_manager(nullptr) {}
+
+    /*! \brief Set the thread manager running the tasks, or nullptr to run them serially */
+    inline void set_thread_manager(SysThreadManager *thread_manager) { m_thread_manager = thread_manager; }
+
+    unsigned int get_concurrency() const override
+    {
+        // the thread manager runs a thread per core
+        return m_thread_manager == nullptr ? 1 : std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    void run(const unsigned int& count, const std::function<void(const unsigned int&)>& task) override
+    {
+        SysThreadManager *thread_manager = m_thread_manager;
+        if (count <= 1 || thread_manager == nullptr || is_running()) {
+            for (unsigned int i = 0; i < count; i++) task(i);
+            return;
+        }
+        SysThreadTaskManager task_manager(thread_manager);
+        CoreVector<Task> tasks(count);
+        for (unsigned int i = 0; i < count; i++) {
+            tasks[i].task = &task;
+            tasks[i].index = i;
+            task_manager.add_task(tasks[i], false);
+        }
+        task_manager.wait_until_completed();
+    }
+
+private:
+    /*! \brief Task of the specified index */
+    class Task : public SysThreadTask {
+    public:
+        Task() : task(nullptr), index(0) {}
+        virtual void execution_entry(const unsigned int& id)
+        {
+            is_running() = true;
+            (*task)(index);
+            is_running() = false;
+        }
+
+        const std::function<void(const unsigned int&)> *task;
+        unsigned int index;
+    };
+
+    /*! \brief Return true on the threads running a task */
+    static bool& is_running()
+    {
+        static thread_local bool is_running = false;
+        return is_running;
+    }
+
+    std::atomic<SysThreadManager *> m_thread_manager;
+};
+
+static RedshiftThreadManagerExecutor&
+get_default_task_executor()
+{
+    static RedshiftThreadManagerExecutor executor;
+    return executor;
+}
+
+// executor supplied by set_task_executor(), or nullptr to use the default one
+static std::atomic<RedshiftTaskExecutor *> s_task_executor(nullptr);
+
+void
+RedshiftUtils::set_thread_manager(SysThreadManager *thread_manager)
+{
+    get_default_task_executor().set_thread_manager(thread_manager);
+}
+
+void
+RedshiftUtils::set_task_executor(RedshiftTaskExecutor *executor)
+{
+    s_task_executor = executor;
+}
+
+RedshiftTaskExecutor&
+RedshiftUtils::get_task_executor()
+{
+    RedshiftTaskExecutor *executor = s_task_executor;
+    return executor != nullptr ? *executor : get_default_task_executor();
+}
+
+template <typename T>
+inline void SetVertexData(void *vtx_data_struct, unsigned int attribute_byte_offset, const T& data)
+{
+    memcpy((static_cast<char *>(vtx_data_struct)) + attribute_byte_offset, &data, sizeof(T));
+}
+
+// maximum number of polygon vertices converted at once to bound the memory used by the conversion
+static const unsigned int s_polymesh_chunk_size = 65536;
+
+/*! \class PolymeshChunk
+    \brief Attributes of the polygon vertices of a chunk of polygons, already converted to Redshift space. */
+class PolymeshChunk {
+public:
+    CoreVector<GMathVec3f> positions;
+    CoreVector<GMathVec3f> normals;
+    CoreVector<GMathVec2f> uvs;
+    PolygonTriangulator triangulator;
+};
+
+// 2d cross product of the triangle abc projected on the specified axes, computed in double
+// precision so that the sign of the nearly flat corners of polygons with many vertices holds
+static inline double
+get_projected_area(const GMathVec3f& a, const GMathVec3f& b, const GMathVec3f& c, const unsigned int& ax, const unsigned int& ay)
+{
+    return (static_cast<double>(b[ax]) - a[ax]) * (static_cast<double>(c[ay]) - a[ay]) -
+           (static_cast<double>(b[ay]) - a[ay]) * (static_cast<double>(c[ax]) - a[ax]);
+}
+
+const CoreVector<unsigned int>&
+PolygonTriangulator::triangulate(const GMathVec3f *points, const unsigned int& count)
+{
+    m_triangles.remove_all();
+    if (count < 3) return m_triangles;
+
+    // polygon normal using Newell's method which is robust to non planar polygons
+    GMathVec3f normal(0.0f, 0.0f, 0.0f);
+    for (unsigned int i = 0; i < count; i++) {
+        const GMathVec3f& a = points[i];
+        const GMathVec3f& b = points[(i + 1) % count];
+        normal[0] += (a[1] - b[1]) * (a[2] + b[2]);
+        normal[1] += (a[2] - b[2]) * (a[0] + b[0]);
+        normal[2] += (a[0] - b[0]) * (a[1] + b[1]);
+    }
+    // project on the plane the most aligned with the polygon
+    unsigned int axis = 0;
+    if (fabs(normal[1]) > fabs(normal[axis])) axis = 1;
+    if (fabs(normal[2]) > fabs(normal[axis])) axis = 2;
+    const unsigned int ax = (axis + 1) % 3;
+    const unsigned int ay = (axis + 2) % 3;
+    const double orientation = normal[axis] < 0.0f ? -1.0 : 1.0;
+
+    // the corners are evaluated once since they are needed by the ear clipping
+    m_prev.resize(count);
+    m_next.resize(count);
+    m_is_reflex.resize(count);
+    m_reflex.remove_all();
+    for (unsigned int i = 0; i < count; i++) {
+        m_prev[i] = (i + count - 1) % count;
+        m_next[i] = (i + 1) % count;
+        m_is_reflex[i] = get_projected_area(points[m_prev[i]], points[i], points[m_next[i]], ax, ay) * orientation < 0.0;
+        if (m_is_reflex[i]) m_reflex.add(i);
+    }
+
+    if (m_reflex.get_count() == 0) {
+        for (unsigned int i = 1; i + 1 < count; i++) {
+            m_triangles.add(0);
+            m_triangles.add(i);
+            m_triangles.add(i + 1);
+        }
+        return m_triangles;
+    }
+
+    // ear clipping on the linked list of the remaining vertices. A vertex inside a candidate ear of a simple
+    // polygon implies a reflex one is, so only the reflex vertices are tested, which keeps the cost of
+    // polygons with many vertices and few reflex ones linear. Flat corners are neither ears nor reflex.
+    unsigned int remaining = count;
+    unsigned int current = 0;
+    unsigned int attempts = 0;
+    while (remaining > 3 && attempts < remaining) {
+        const unsigned int prev = m_prev[current];
+        const unsigned int next = m_next[current];
+
+        bool is_ear = get_projected_area(points[prev], points[current], points[next], ax, ay) * orientation > 0.0;
+        for (unsigned int i = 0; i < m_reflex.get_count() && is_ear; i++) {
+            const unsigned int p = m_reflex[i];
+            if (m_is_reflex[p] && p != prev && p != next) {
+                is_ear = !(get_projected_area(points[prev], points[current], points[p], ax, ay) * orientation >= 0.0 &&
+                           get_projected_area(points[current], points[next], points[p], ax, ay) * orientation >= 0.0 &&
+                           get_projected_area(points[next], points[prev], points[p], ax, ay) * orientation >= 0.0);
+            }
+        }
+
+        if (is_ear) {
+            m_triangles.add(prev);
+            m_triangles.add(current);
+            m_triangles.add(next);
+            m_next[prev] = next;
+            m_prev[next] = prev;
+            remaining--;
+            // clipping an ear can only turn the corners of its neighbours from reflex to convex
+            if (m_is_reflex[prev]) m_is_reflex[prev] = get_projected_area(points[m_prev[prev]], points[prev], points[next], ax, ay) * orientation < 0.0;
+            if (m_is_reflex[next]) m_is_reflex[next] = get_projected_area(points[prev], points[next], points[m_next[next]], ax, ay) * orientation < 0.0;
+            // the previous vertex is likely to be the next ear
+            current = prev;
+            attempts = 0;
+        } else {
+            current = next;
+            attempts++;
+        }
+    }
+    // whatever remains (a triangle or a degenerated polygon) is output as a fan
+    for (unsigned int i = m_next[current]; m_next[i] != current; i = m_next[i]) {
+        m_triangles.add(current);
+        m_triangles.add(i);
+        m_triangles.add(m_next[i]);
+    }
+    return m_triangles;
+}
+
+template <bool HAS_UV>
+static inline void
+write_vertex(void *vtx_data, const unsigned int *offsets, const PolymeshChunk& chunk, const unsigned int& index)
+{
+    const GMathVec3f& p = chunk.positions[index];
+    const GMathVec3f& n = chunk.normals[index];
+    SetVertexData(vtx_data, offsets[0], RSVector3(p[0], p[1], p[2]));
+    SetVertexData(vtx_data, offsets[1], RSNormal(n[0], n[1], n[2]));
+    if (HAS_UV) SetVertexData(vtx_data, offsets[2], RSVector2(chunk.uvs[index][0], chunk.uvs[index][1]));
+}
+
+/*! \brief Add all the polygons of the description to the mesh. Polygon vertex attributes are converted
+ *         by chunks of whole polygons and polygons with more than four vertices are triangulated, unless
+ *         their triangles are specified, the triangles being then stored if they are requested. */
+template <bool HAS_UV>
+static void
+add_polygons(RSMesh *mesh, const PolymeshDescription& desc, const unsigned int *offsets, CoreVector<unsigned int> *triangulation)
+{
+    // polygons of n vertices are always split in n - 2 triangles so the triangles are read back in sequence
+    const bool is_triangulated = triangulation != nullptr && triangulation->get_count() != 0;
+    unsigned int triangulation_index = 0;
+
+    const unsigned int polygon_count = desc.polygon_vertex_count.get_count();
+    const unsigned int *counts = desc.polygon_vertex_count.get_data();
+    const unsigned int *vertex_ids = desc.polygon_vertex_ids.get_data();
+
+    PolymeshChunk chunk;
+    char vtx_data[4][1024]; // temporary vertex buffer data
+    unsigned int polygon = 0;
+    unsigned int vertex = 0;
+    while (polygon < polygon_count) {
+        // gather whole polygons until the chunk is full
+        unsigned int last_polygon = polygon;
+        unsigned int last_vertex = vertex;
+        do {
+            last_vertex += counts[last_polygon++];
+        } while (last_polygon < polygon_count && last_vertex - vertex + counts[last_polygon] <= s_polymesh_chunk_size);
+
+        // converting the attributes of the chunk in bulk (Redshift is left handed so Z is flipped)
+        const unsigned int chunk_count = last_vertex - vertex;
+        chunk.positions.resize(chunk_count);
+        chunk.normals.resize(chunk_count);
+        for (unsigned int i = 0; i < chunk_count; i++) {
+            const GMathVec3f& p = desc.positions[vertex_ids[vertex + i]];
+            chunk.positions[i] = GMathVec3f(p[0], p[1], -p[2]);
+        }
+        for (unsigned int i = 0; i < chunk_count; i++) {
+            const GMathVec3f& n = desc.normals[desc.normal_indices[vertex + i]];
+            chunk.normals[i] = GMathVec3f(n[0], n[1], -n[2]);
+        }
+        if (HAS_UV) {
+            chunk.uvs.resize(chunk_count);
+            for (unsigned int i = 0; i < chunk_count; i++) {
+                const GMathVec3f& uv = desc.uvs[desc.uv_indices[vertex + i]];
+                chunk.uvs[i] = GMathVec2f(uv[0], uv[1]);
+            }
+        }
+
+        unsigned int local = 0; // index of the first vertex of the polygon in the chunk
+        for (; polygon < last_polygon; polygon++) {
+            const unsigned int count = counts[polygon];
+            const unsigned int *ids = &vertex_ids[vertex + local];
+            // FIXME: potential problems with shading group since Redshift also support short
+            const unsigned short shading_group_id = static_cast<unsigned short>(desc.polygon_shading_groups[polygon]);
+
+            if (count == 3) {
+                for (unsigned int i = 0; i < 3; i++) write_vertex<HAS_UV>(vtx_data[i], offsets, chunk, local + i);
+                mesh->AddTri(vtx_data[0], vtx_data[1], vtx_data[2],
+                             0.0f, 0.0f, 0.0f, 0.0f,0.0f,0.0f,
+                             ids[0], ids[1], ids[2], shading_group_id);
+            } else if (count == 4) {
+                for (unsigned int i = 0; i < 4; i++) write_vertex<HAS_UV>(vtx_data[i], offsets, chunk, local + i);
+                mesh->AddQuad(vtx_data[0], vtx_data[1], vtx_data[2], vtx_data[3],
+                              0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,0.0f,0.0f,
+                              ids[0], ids[1], ids[2], ids[3], shading_group_id);
+            } else if (count > 4) {
+                const unsigned int triangle_vertex_count = 3 * (count - 2);
+                const unsigned int *triangles;
+                if (is_triangulated) {
+                    triangles = &(*triangulation)[triangulation_index];
+                    triangulation_index += triangle_vertex_count;
+                } else {
+                    triangles = chunk.triangulator.triangulate(&chunk.positions[local], count).get_data();
+                    if (triangulation != nullptr) {
+                        for (unsigned int t = 0; t < triangle_vertex_count; t++) triangulation->add(triangles[t]);
+                    }
+                }
+                for (unsigned int t = 0; t < triangle_vertex_count; t += 3) {
+                    const unsigned int *tri = &triangles[t];
+                    for (unsigned int i = 0; i < 3; i++) write_vertex<HAS_UV>(vtx_data[i], offsets, chunk, local + tri[i]);
+                    mesh->AddTri(vtx_data[0], vtx_data[1], vtx_data[2],
+                                 0.0f, 0.0f, 0.0f, 0.0f,0.0f,0.0f,
+                                 ids[tri[0]], ids[tri[1]], ids[tri[2]], shading_group_id);
+                }
+            }
+            local += count;
+        }
+        vertex = last_vertex;
+    }
+}
+
+void
+RedshiftUtils::FillPolygonalMesh(RSMesh *mesh, const PolymeshDescription& desc, RSMaterial *material, CoreVector<unsigned int> *triangles)
+{
+    const unsigned int attribute_count = 3;
+    const unsigned int material_count = desc.material_count;
+
+    RSArray<RSMaterial *> materials;
+    for (unsigned int i = 0; i < material_count; i++) materials.Add(material);
+
+    RSVertexData* pMyVertexFormatData = RS_VertexData_New();
+    pMyVertexFormatData->SetNumAttributes(attribute_count);
+
+    const unsigned int positionStreamOriginalIndex = 0;
+    const unsigned int normalStreamOriginalIndex = 1;
+    const unsigned int uv0StreamOriginalIndex = 2;
+
+    pMyVertexFormatData->SetAttributeDefinition(positionStreamOriginalIndex, "RS_ATTRIBUTETYPE_FLOAT3", "RS_ATTRIBUTEUSAGETYPE_POSITION", "<<position>>");
+    pMyVertexFormatData->SetAttributeDefinition(normalStreamOriginalIndex, "RS_ATTRIBUTETYPE_NORMAL", "RS_ATTRIBUTEUSAGETYPE_NORMAL", "<<normal>>");
+	// Note : For now, we only support one UV map per mesh, it can be easily extended to support multiple UV maps
+	pMyVertexFormatData->SetAttributeDefinition(uv0StreamOriginalIndex, "RS_ATTRIBUTETYPE_FLOAT2", "RS_ATTRIBUTEUSAGETYPE_TEXCOORD", "uv0");			// requires 'AddVertexAttributeMeshAssociation' on shader node that is accessing this attribute stream, otherwise it can be optimized out (see notes above)
+	//pMyVertexFormatData->SetAttributeDefinition(uv0StreamOriginalIndex, "RS_ATTRIBUTETYPE_FLOAT2", "RS_ATTRIBUTEUSAGETYPE_TEXCOORD", "uv0", false);	// does not require 'AddVertexAttributeMeshAssociation' on shader node that is accessing this attribute stream
+
+	// Note : The first parameter is set to False, otherwise, the attribute for UVs seems to be always considered as unused and textures are not working ...
+	// If someone understand why it is not working and how to optimize it, feel free to set it to True and to update the code accordingly
+    pMyVertexFormatData->FinalizeAttributeFormatAndAllocate(false, 1, false, mesh->GetName(), materials);
+
+    // Cache the re-mapped offsets into the finalized vertex data structure
+    unsigned int vtx_attr_offsets[attribute_count];
+    for (unsigned int originalAttributeIndex = 0; originalAttributeIndex < attribute_count; originalAttributeIndex++) {
+        // Check to see if the remapped attribute has been stripped by the 'RS_GenerateVertexFormatFromMeshMaterials' function. If it has, the remapped index will be 'RS_INVALIDATTRIBUTEINDEX'
+        if (pMyVertexFormatData->IsAttributeUsed(originalAttributeIndex))
+            vtx_attr_offsets[originalAttributeIndex] = pMyVertexFormatData->GetAttributeOffsetBytes(originalAttributeIndex);
+        else
+            vtx_attr_offsets[originalAttributeIndex] = 0xFFFF; // an invalid offset (see AddTrianglesToMesh for usage)
+    }
+
+    mesh->SetAttributesFormat(pMyVertexFormatData);
+    mesh->BeginPrimitives(1);
+
+    // branching once for the whole mesh instead of once per vertex
+    if (vtx_attr_offsets[uv0StreamOriginalIndex] != 0xFFFF && desc.is_uv_defined) {
+        add_polygons<true>(mesh, desc, vtx_attr_offsets, triangles);
+    } else {
+        add_polygons<false>(mesh, desc, vtx_attr_offsets, triangles);
+    }
+
+    mesh->CompactDataAndPrepareForRendering();
+    RS_VertexData_Delete(pMyVertexFormatData);
+}
+
+RSMesh *
+RedshiftUtils::CreatePolygonalMesh(const PolymeshDescription& desc, RSMaterial *material)
+{
+    RSMesh *mesh = RS_Mesh_New(get_new_unique_name("GeometrySmoothed").get_data());
+    mesh->SetIsTransformationBlurred(false);
+    mesh->SetNumMaterials(desc.material_count);
+    for (unsigned int i = 0; i < desc.material_count; i++) mesh->SetMaterial(i, material);
+
+    FillPolygonalMesh(mesh, desc, material);
+    return mesh;
+}
+
+void
+RedshiftUtils::CreatePolygonalMeshes(const unsigned int& count, const std::function<void(const unsigned int&, PolymeshDescription&)>& describe,
+                                     RSMaterial *material, CoreArray<RSMesh *>& meshes)
+{
+    meshes.resize(count);
+    if (count == 0) return;
+
+    // meshes are described in parallel by waves of one mesh per task of the executor, the calling thread
+    // creating the meshes of the wave once it's described. Only a wave of descriptions is held at once.
+    RedshiftTaskExecutor& executor = get_task_executor();
+    const unsigned int wave_size = std::min(std::max(executor.get_concurrency(), 1u), count);
+    CoreVector<PolymeshDescription> descriptions(wave_size);
+    for (unsigned int first = 0; first < count; first += wave_size) {
+        const unsigned int last = std::min(first + wave_size, count);
+        executor.run(last - first, [&](const unsigned int& i) { describe(first + i, descriptions[i]); });
+
+        for (unsigned int i = first; i < last; i++) {
+            meshes[i] = CreatePolygonalMesh(descriptions[i - first], material);
+            descriptions[i - first] = PolymeshDescription();
+        }
+    }
+}
+
+RSMatrix4x4
+RedshiftUtils::ToRSMatrix4x4(const GMathMatrix4x4d& m)
+{
+    // Redshift is left handed so Z is flipped on both sides of the matrix (S.M.S with S the
+    // (1, 1, -1) scaling). Instead of doing the two matrix products, this is folded in a sign
+    // pattern negating the third row and column except their intersection. Redshift matrices
+    // are also transposed.
+    return RSMatrix4x4(static_cast<float>(m[0][0]), static_cast<float>(m[1][0]), static_cast<float>(-m[2][0]), static_cast<float>(m[3][0]),
+                       static_cast<float>(m[0][1]), static_cast<float>(m[1][1]), static_cast<float>(-m[2][1]), static_cast<float>(m[3][1]),
+                       static_cast<float>(-m[0][2]), static_cast<float>(-m[1][2]), static_cast<float>(m[2][2]), static_cast<float>(-m[3][2]),
+                       static_cast<float>(m[0][3]), static_cast<float>(m[1][3]), static_cast<float>(-m[2][3]), static_cast<float>(m[3][3]));
+}
+
+// maximum number of instance matrices converted at once to bound the memory used by the conversion
+static const unsigned int s_instance_chunk_size = 1 << 20;
+// minimum number of matrices converted by a task, below which running it in parallel costs more than it saves
+static const unsigned int s_matrices_per_task = 1 << 16;
+
+// convert the matrices of the specified instances in parallel
+static void
+convert_matrices(const GMathMatrix4x4d *matrices, const unsigned int *instances, const unsigned int& count, RSMatrix4x4 *output)
+{
+    auto convert = [=](const unsigned int& first, const unsigned int& last) {
+        for (unsigned int i = first; i < last; i++) output[i] = RedshiftUtils::ToRSMatrix4x4(matrices[instances[i]]);
+    };
+    RedshiftTaskExecutor& executor = RedshiftUtils::get_task_executor();
+    const unsigned int range_count = std::min(std::max(executor.get_concurrency(), 1u), (count + s_matrices_per_task - 1) / s_matrices_per_task);
+    executor.run(range_count, [&](const unsigned int& i) {
+        convert(static_cast<unsigned int>(static_cast<unsigned long long>(count) * i / range_count),
+                static_cast<unsigned int>(static_cast<unsigned long long>(count) * (i + 1) / range_count));
+    });
+}
+
+void
+RedshiftUtils::FillPointClouds(const CoreArray<RSPointCloud *>& ptcs, const CoreArray<GMathMatrix4x4d>& matrices, const CoreArray<unsigned int>& indices)
+{
+    // sorting instances per point cloud so that each point cloud is filled at once
+    const unsigned int ptc_count = ptcs.get_count();
+    CoreArray<unsigned int> offsets(ptc_count + 1);
+    for (unsigned int i = 0; i <= ptc_count; i++) offsets[i] = 0;
+    for (unsigned int i = 0; i < indices.get_count(); i++) offsets[indices[i] + 1]++;
+    for (unsigned int i = 0; i < ptc_count; i++) offsets[i + 1] += offsets[i];
+
+    CoreArray<unsigned int> instances(indices.get_count());
+    CoreArray<unsigned int> cursors(offsets);
+    for (unsigned int i = 0; i < indices.get_count(); i++) instances[cursors[indices[i]]++] = i;
+
+    // matrices are converted in parallel by chunks of sorted instances which are then added by this thread
+    CoreArray<RSMatrix4x4> chunk(std::min(indices.get_count(), s_instance_chunk_size));
+    unsigned int chunk_start = 0;
+    unsigned int chunk_end = 0;
+    for (unsigned int i = 0; i < ptc_count; i++) {
+        RSPointCloud *ptc = ptcs[i];
+        ptc->BeginPrimitives(1);
+        for (unsigned int j = offsets[i]; j < offsets[i + 1]; j++) {
+            if (j == chunk_end) {
+                chunk_start = chunk_end;
+                chunk_end = std::min(chunk_start + s_instance_chunk_size, indices.get_count());
+                convert_matrices(matrices.get_data(), instances.get_data() + chunk_start, chunk_end - chunk_start, chunk.get_data());
+            }
+            ptc->AddInstance(chunk[j - chunk_start]);
+        }
+        ptc->CompactDataAndPrepareForRendering();
+    }
+}
+
+/*! \class DescriptionHairSource
+    \brief Source reading the curves of a description. */
+class DescriptionHairSource : public HairSource {
+public:
+    DescriptionHairSource(const HairDescription& desc) : m_counts(desc.curve_vertex_count.get_data())
+    {
+        positions = desc.positions.get_data();
+        point_count = desc.positions.get_count();
+        curve_vertex_ids = desc.curve_vertex_ids.get_data();
+        index_count = desc.curve_vertex_ids.get_count();
+        curve_count = desc.curve_vertex_count.get_count();
+        radius = desc.radius;
+    }
+
+    unsigned int get_curve_edge_count(const unsigned int& curve) const override { return m_counts[curve]; }
+
+private:
+    const unsigned int *m_counts;
+};
+
+bool
+RedshiftUtils::ResolveHairLayout(HairDescription& desc)
+{
+    DescriptionHairSource source(desc);
+    if (!ResolveHairLayout(source)) return false;
+    // the description lists the number of vertices of each curve once resolved
+    for (unsigned int i = 0; i < desc.curve_vertex_count.get_count(); i++) desc.curve_vertex_count[i] += source.edge_offset;
+    return true;
+}
+
+bool
+RedshiftUtils::ResolveHairLayout(HairSource& source)
+{
+    unsigned long long edge_count = 0;
+    for (unsigned int i = 0; i < source.curve_count; i++) edge_count += source.get_curve_edge_count(i);
+
+    if (edge_count + source.curve_count == source.index_count) {
+        // edge counts are segment counts
+        source.edge_offset = 1;
+    } else if (edge_count == source.index_count) {
+        source.edge_offset = 0;
+    } else {
+        return false;
+    }
+    for (unsigned int i = 0; i < source.index_count; i++) {
+        if (source.curve_vertex_ids[i] >= source.point_count) return false;
+    }
+    return true;
+}
+
+// maximum number of curve vertices converted by a task to bound the memory used by the conversion
+static const unsigned int s_hair_chunk_size = 65536;
+
+/*! \class HairChunk
+    \brief Chunk of whole curves converted to Redshift space. */
+class HairChunk {
+public:
+    HairChunk() : first_vertex(0) {}
+
+    void convert(const HairSource& source)
+    {
+        unsigned int vertex_count = 0;
+        for (auto count : counts) vertex_count += count;
+        points.resize(vertex_count);
+        const unsigned int *ids = source.curve_vertex_ids + first_vertex;
+        for (unsigned int i = 0; i < vertex_count; i++) {
+            const GMathVec3f& p = source.positions[ids[i]];
+            points[i] = RSVector4(p[0], p[1], -p[2], source.radius); // Redshift is left handed so Z is flipped
+        }
+    }
+
+    unsigned int first_vertex; //!< index of the first vertex of the chunk
+    CoreVector<unsigned int> counts; //!< number of vertices of each curve of the chunk
+    CoreVector<RSVector4> points; //!< converted vertices (position and radius) of the chunk
+};
+
+RSMeshHair *
+RedshiftUtils::CreateHair(const HairDescription& desc, RSMaterial *material)
+{
+    return CreateHair(DescriptionHairSource(desc), material);
+}
+
+RSMeshHair *
+RedshiftUtils::CreateHair(const HairSource& source, RSMaterial *material)
+{
+    const unsigned int curve_count = source.curve_count;
+    unsigned int strand_count = 0;
+    for (unsigned int i = 0; i < curve_count; i++) {
+        if (source.get_curve_vertex_count(i) > 1) strand_count++;
+    }
+
+    RSMeshHair *hair = RS_MeshHair_New(get_new_unique_name("GeometryFur").get_data());
+    hair->SetIsTransformationBlurred(false);
+    hair->SetNumMaterials(1);
+    hair->SetMaterial(0, material);
+    hair->BeginPrimitives(strand_count);
+
+    // chunks are read from the source and converted in parallel by waves of one chunk per task of the executor and
+    // added to the hair object in order by this thread. The memory used by the conversion is then bounded whatever
+    // the size of the groom.
+    RedshiftTaskExecutor& executor = get_task_executor();
+    const unsigned int wave_size = std::max(executor.get_concurrency(), 1u);
+    CoreVector<HairChunk> chunks(wave_size);
+    unsigned int curve = 0;
+    unsigned int vertex = 0;
+    unsigned int count = curve_count > 0 ? source.get_curve_vertex_count(0) : 0; // vertex count of the current curve
+    while (curve < curve_count) {
+        unsigned int chunk_count = 0;
+        for (; chunk_count < wave_size && curve < curve_count; chunk_count++) {
+            HairChunk& chunk = chunks[chunk_count];
+            chunk.first_vertex = vertex;
+            chunk.counts.remove_all();
+            // gather whole curves until the chunk is full
+            do {
+                chunk.counts.add(count);
+                vertex += count;
+                count = ++curve < curve_count ? source.get_curve_vertex_count(curve) : 0;
+            } while (curve < curve_count && vertex - chunk.first_vertex + count <= s_hair_chunk_size);
+        }
+        executor.run(chunk_count, [&](const unsigned int& c) { chunks[c].convert(source); });
+
+        for (unsigned int c = 0; c < chunk_count; c++) {
+            const HairChunk& chunk = chunks[c];
+            unsigned int local = 0; // index of the first vertex of the curve in the chunk
+            for (auto strand_vertex_count : chunk.counts) {
+                if (strand_vertex_count > 1) hair->AddStrand(&chunk.points[local], strand_vertex_count, 0);
+                local += strand_vertex_count;
+            }
+        }
+    }
+    hair->CompactDataAndPrepareForRendering();
+    return hair;
+}
+
+CoreString
+RedshiftUtils::get_new_unique_name(const CoreString& prefix)
+{
+    // atomic since geometries are created concurrently during the sync
+    static std::atomic<unsigned long long> id(0);
+    CoreString result = "FromClarisse::";
+    result += prefix;
+    result += (++id);
+    return result;
+}
@@ -0,0 +1,86 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Control flow of the interactive renders which calls neither Clarisse nor Redshift so that
+// it can be tested against the stub of the Redshift API (see stub/).
+
+#include "redshift_utils.h"
+
+#include <chrono>
+
+void
+InteractiveRender::restart(const std::function<bool()>& sync, const std::function<void()>& render_passes, const std::function<void()>& abort_passes)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_lock);
+    std::unique_lock<std::mutex> state(m_state_lock);
+    // the background thread is started by the first render and kept until stopped
+    if (m_thread == nullptr) {
+        m_is_stopped = false;
+        m_thread = new std::thread(&InteractiveRender::run, this);
+    }
+    // the render scene mustn't be modified while its passes are rendered
+    if (m_is_requested || m_is_rendering) {
+        abort_passes();
+        m_done.wait(state, [this]() { return !m_is_requested && !m_is_rendering; });
+    }
+    state.unlock();
+    if (!sync()) return;
+    state.lock();
+    m_render_passes = render_passes;
+    m_is_requested = true;
+    m_requested.notify_one();
+}
+
+bool
+InteractiveRender::wait_for_passes(const unsigned int& timeout)
+{
+    std::unique_lock<std::mutex> state(m_state_lock);
+    return m_done.wait_for(state, std::chrono::milliseconds(timeout), [this]() { return !m_is_requested && !m_is_rendering; });
+}
+
+bool
+InteractiveRender::is_rendering() const
+{
+    std::lock_guard<std::mutex> state(m_state_lock);
+    return m_is_requested || m_is_rendering;
+}
+
+void
+InteractiveRender::stop(const std::function<void()>& abort_passes)
+{
+    // restart() can't start a new thread, nor sync the scene, while the thread is stopped
+    std::lock_guard<std::recursive_mutex> lock(m_lock);
+    std::unique_lock<std::mutex> state(m_state_lock);
+    if (m_thread == nullptr) return;
+    m_is_stopped = true;
+    // passes requested but not started yet are dropped
+    m_is_requested = false;
+    if (m_is_rendering && abort_passes) abort_passes();
+    m_requested.notify_one();
+    // joined without holding the state lock which the thread takes to return
+    state.unlock();
+    m_thread->join();
+    state.lock();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+void
+InteractiveRender::run()
+{
+    std::unique_lock<std::mutex> state(m_state_lock);
+    for (;;) {
+        m_requested.wait(state, [this]() { return m_is_stopped || m_is_requested; });
+        if (m_is_stopped) break;
+        m_is_requested = false;
+        m_is_rendering = true;
+        const std::function<void()> render_passes = m_render_passes;
+        state.unlock();
+        render_passes();
+        state.lock();
+        m_is_rendering = false;
+        m_done.notify_all();
+    }
+    m_done.notify_all();
+}
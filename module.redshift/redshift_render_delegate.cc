@@ -3,7 +3,7 @@
 //
 
 #include <core_log.h>
-#include <sys_thread_lock.h>
+#include <core_set.h>
 #include <of_object.h>
 
 #include <image_canvas.h>
@@ -11,6 +11,7 @@
 #include <module_layer.h>
 #include <module_camera.h>
 #include <module_particle.h>
+#include <module_scene_object.h>
 
 #include <r2c_scene_delegate.h>
 #include <r2c_render_buffer.h>
@@ -23,59 +24,391 @@
 
 #include "redshift_render_delegate.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/*! \class PreviewFrustum
+    \brief Camera frustum expanded by a margin which is used in preview mode to defer the translation of the geometries out of view. */
+class PreviewFrustum {
+public:
+
+    PreviewFrustum() : m_tan_h(0.0), m_tan_v(0.0) {}
+
+    /*! \brief Set the frustum from the camera
+     *  \param camera camera to world transformation
+     *  \param hfov horizontal field of view in degrees
+     *  \param vfov vertical field of view in degrees
+     *  \param margin ratio by which the fields of view are expanded
+     *  \return true if the frustum changed */
+    bool init(const GMathMatrix4x4d& camera, const double& hfov, const double& vfov, const double& margin)
+    {
+        GMathMatrix4x4d world_to_camera;
+        GMathMatrix4x4d::get_inverse(camera, world_to_camera);
+        const double tan_h = tan(gmath_radians(gmath_min(hfov * (1.0 + margin), 179.0)) / 2.0);
+        const double tan_v = tan(gmath_radians(gmath_min(vfov * (1.0 + margin), 179.0)) / 2.0);
+
+        bool is_changed = tan_h != m_tan_h || tan_v != m_tan_v;
+        for (unsigned int i = 0; i < 4; i++) {
+            for (unsigned int j = 0; j < 4; j++) is_changed |= world_to_camera[i][j] != m_world_to_camera[i][j];
+        }
+        m_world_to_camera = world_to_camera;
+        m_tan_h = tan_h;
+        m_tan_v = tan_v;
+        return is_changed;
+    }
+
+    /*! \brief Return false if the specified bounding box is fully outside of the frustum
+     *  \param bbox bounding box in object space
+     *  \param transform object to world transformation */
+    bool intersects(const GMathBbox3d& bbox, const GMathMatrix4x4d& transform) const
+    {
+        const GMathVec3d& bmin = bbox.get_min();
+        const GMathVec3d& bmax = bbox.get_max();
+        // the box is outside if all its corners are on the outer side of the same plane
+        bool is_right = true, is_left = true, is_above = true, is_below = true, is_behind = true;
+        for (unsigned int i = 0; i < 8; i++) {
+            const GMathVec3d corner(i & 1 ? bmax[0] : bmin[0], i & 2 ? bmax[1] : bmin[1], i & 4 ? bmax[2] : bmin[2]);
+            GMathVec3d world, p;
+            GMathMatrix4x4d::multiply(world, corner, transform);
+            GMathMatrix4x4d::multiply(p, world, m_world_to_camera);
+            const double depth = -p[2]; // the camera looks down -Z
+            is_right &= p[0] > depth * m_tan_h;
+            is_left &= -p[0] > depth * m_tan_h;
+            is_above &= p[1] > depth * m_tan_v;
+            is_below &= -p[1] > depth * m_tan_v;
+            is_behind &= depth <= 0.0;
+        }
+        return !(is_right || is_left || is_above || is_below || is_behind);
+    }
+
+private:
+
+    GMathMatrix4x4d m_world_to_camera;
+    double m_tan_h; // tangent of the half horizontal field of view
+    double m_tan_v; // tangent of the half vertical field of view
+};
+
+// maximum time in seconds spent by a sync creating the meshes of the descriptions gathered in the background
+static const double s_swap_budget = 0.25;
+
+// maximum time in milliseconds an evaluation waits for the passes rendered in the background before displaying their progress
+static const unsigned int s_progress_refresh_interval = 100;
+
+/*! \class ProgressiveTranslation
+    \brief Gathers the topology and attributes of geometry resources on background threads while bounding box
+           proxies stand for them in the render scene. Background threads only read the Clarisse geometries,
+           the Redshift meshes being created from the gathered descriptions by the sync. */
+class ProgressiveTranslation {
+public:
+
+    struct Job {
+        R2cResourceId resource_id; // resource to convert
+        const GeometryObject *geometry; // polygonal geometry of the resource
+        RSMeshBase *proxy; // bounding box standing for the resource in the render scene
+        std::shared_ptr<PolymeshDescription> description; // gathered description, nullptr until the job is done
+        double screen_size; // projected size of the resource from the camera used to convert the largest first
+    };
+
+    ProgressiveTranslation() : enabled(false), m_next(0), m_next_done(0), m_running(0), m_canceled(false) {}
+    ~ProgressiveTranslation() { cancel(); }
+
+    /*! \brief Queue the specified jobs and start the background threads if they aren't running */
+    void schedule(const CoreVector<Job>& jobs);
+    /*! \brief Pop the next job whose description has been gathered
+     *  \return false if no job is done
+     *  \note The description of a job is nullptr if it has been discarded after being gathered */
+    bool collect(Job& job);
+    /*! \brief Drop the job of a resource which is about to be released, waiting for it if it is being gathered */
+    void discard(R2cResourceId resource_id);
+    /*! \brief Return true if jobs are waiting to be gathered or collected */
+    bool is_pending();
+    /*! \brief Stop the background threads and drop the jobs which haven't been collected */
+    void cancel();
+
+    bool enabled; // true if new meshes are represented by proxies until they are converted
+
+private:
+
+    void run();
+
+    std::mutex m_lock;
+    CoreVector<Job> m_queue; // pending jobs sorted by decreasing screen size
+    unsigned int m_next; // index of the next pending job in the queue
+    CoreSet<R2cResourceId> m_converting; // resources being gathered
+    std::condition_variable m_converted; // notified when a resource has been gathered
+    CoreVector<Job> m_done; // gathered descriptions waiting to be collected
+    unsigned int m_next_done; // index of the next job to collect
+    CoreVector<std::thread *> m_threads;
+    unsigned int m_running; // number of threads still processing the queue
+    bool m_canceled;
+};
+
+void
+ProgressiveTranslation::schedule(const CoreVector<Job>& jobs)
+{
+    if (jobs.get_count() == 0) return;
+    m_lock.lock();
+    // compacting the remaining jobs before merging the new ones
+    CoreVector<Job> queue(0, m_queue.get_count() - m_next + jobs.get_count());
+    for (unsigned int i = m_next; i < m_queue.get_count(); i++) queue.add(m_queue[i]);
+    for (auto& job : jobs) queue.add(job);
+    std::sort(&queue[0], &queue[0] + queue.get_count(), [](const Job& a, const Job& b) { return a.screen_size > b.screen_size; });
+    m_queue = queue;
+    m_next = 0;
+
+    if (m_running == 0) { // previous threads are done with the queue
+        for (auto thread : m_threads) {
+            thread->join();
+            delete thread;
+        }
+        m_threads.remove_all();
+    }
+    // leaving a core to Clarisse since it keeps on evaluating the scene while we render
+    const unsigned int thread_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    const unsigned int wanted = std::min(thread_count, m_queue.get_count());
+    while (m_running < wanted) {
+        m_running++;
+        m_threads.add(new std::thread(&ProgressiveTranslation::run, this));
+    }
+    m_lock.unlock();
+}
+
+void
+ProgressiveTranslation::run()
+{
+    for (;;) {
+        m_lock.lock();
+        if (m_canceled || m_next == m_queue.get_count()) {
+            m_running--;
+            m_lock.unlock();
+            return;
+        }
+        Job job = m_queue[m_next++];
+        if (job.geometry == nullptr) { // discarded
+            m_lock.unlock();
+            continue;
+        }
+        m_converting.add(job.resource_id);
+        m_lock.unlock();
+
+        // no Redshift call is made here, the geometry is only read
+        job.description = std::make_shared<PolymeshDescription>();
+        RedshiftUtils::DescribePolygonalMesh(*job.geometry, *job.description);
+
+        m_lock.lock();
+        unsigned int idx;
+        if (m_converting.exists(job.resource_id, idx)) m_converting.remove(idx);
+        if (!m_canceled) m_done.add(job);
+        m_lock.unlock();
+        m_converted.notify_all();
+    }
+}
+
+bool
+ProgressiveTranslation::collect(Job& job)
+{
+    m_lock.lock();
+    // jobs are collected in the order they are done which is by decreasing screen size
+    const bool is_done = m_next_done < m_done.get_count();
+    if (is_done) {
+        job = m_done[m_next_done];
+        m_done[m_next_done++].description.reset();
+        if (m_next_done == m_done.get_count()) {
+            m_done.remove_all();
+            m_next_done = 0;
+        }
+    }
+    m_lock.unlock();
+    return is_done;
+}
+
+void
+ProgressiveTranslation::discard(R2cResourceId resource_id)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    for (unsigned int i = m_next; i < m_queue.get_count(); i++) {
+        if (m_queue[i].resource_id == resource_id) m_queue[i].geometry = nullptr; // not started yet so the job is simply skipped
+    }
+    // the geometry may be released after we return so a running job must complete first
+    m_converted.wait(lock, [&]() { return !m_converting.exists(resource_id); });
+    for (unsigned int i = m_next_done; i < m_done.get_count(); i++) {
+        if (m_done[i].resource_id == resource_id) m_done[i].description.reset();
+    }
+}
+
+bool
+ProgressiveTranslation::is_pending()
+{
+    m_lock.lock();
+    const bool is_pending = m_next < m_queue.get_count() || m_converting.get_count() > 0 || m_next_done < m_done.get_count();
+    m_lock.unlock();
+    return is_pending;
+}
+
+void
+ProgressiveTranslation::cancel()
+{
+    m_lock.lock();
+    m_canceled = true;
+    m_queue.remove_all();
+    m_next = 0;
+    m_lock.unlock();
+    // the threads exit as soon as their current job is done
+    for (auto thread : m_threads) {
+        thread->join();
+        delete thread;
+    }
+    m_threads.remove_all();
+    m_done.remove_all();
+    m_next_done = 0;
+    m_canceled = false;
+}
+
+/*! \class RSDelegateSceneSource
+    \brief Reads the items synchronized by the render scene from the scene delegate of the render delegate. */
+class RSDelegateSceneSource : public RedshiftSceneSource {
+public:
+
+    RSDelegateSceneSource(RedshiftRenderDelegate& delegate) : m_delegate(delegate) {}
+
+    R2cResourceId get_resource_id(R2cItemId geometry) override { return m_delegate.get_resource_id(geometry); }
+    void create_resources(RedshiftScene& scene, const CoreVector<R2cItemId>& geometries) override { m_delegate.create_geometry_resources(geometries); }
+    bool deform_geometry(RedshiftScene& scene, R2cItemId geometry, RSGeometryInfo& rgeometry) override { return m_delegate.deform_geometry(geometry, rgeometry); }
+    void filter_inserted_geometries(RedshiftScene& scene) override { m_delegate.defer_geometries(); }
+    GMathMatrix4x4d get_transform(R2cItemId item) override;
+    bool get_visible(R2cItemId item) override { return m_delegate.get_scene_delegate()->get_visible(item); }
+    RSMaterial *acquire_material(R2cItemId item, const unsigned int& shading_group, CoreVector<unsigned int>& references) override;
+    void release_material(const unsigned int& reference) override { ModuleMaterialRedshift::release_material(reference); }
+    void create_instancer(RedshiftScene& scene, R2cItemId instancer, RSInstancerInfo& rinstancer) override;
+    void create_light(R2cItemId light, RSLightInfo& rlight) override { RedshiftUtils::CreateLight(*m_delegate.get_scene_delegate(), light, rlight); }
+    void sync_light_attributes(R2cItemId light, RSLightInfo& rlight) override;
+
+private:
+
+    RedshiftRenderDelegate& m_delegate;
+};
+
+GMathMatrix4x4d
+RSDelegateSceneSource::get_transform(R2cItemId item)
+{
+    GMathMatrix4x4d transform = m_delegate.get_scene_delegate()->get_transform(item);
+    CoreString primitive;
+    GMathVec3d scale;
+    if (RedshiftUtils::GetPrimitive(*m_delegate.get_scene_delegate(), item, primitive, scale)) {
+        // shared primitives are canonical so the parameters of the geometry are applied to its instance
+        for (unsigned int i = 0; i < 3; i++) {
+            for (unsigned int j = 0; j < 3; j++) transform[i][j] *= scale[i];
+        }
+    }
+    return transform;
+}
+
+RSMaterial *
+RSDelegateSceneSource::acquire_material(R2cItemId item, const unsigned int& shading_group, CoreVector<unsigned int>& references)
+{
+    const R2cShadingGroupInfo& info = m_delegate.get_scene_delegate()->get_shading_group_info(item, shading_group);
+    if (info.get_material().is_null()) return RedshiftUtils::get_default_material();
+    ModuleMaterialRedshift *material = static_cast<ModuleMaterialRedshift *>(info.get_material().get_item()->get_module());
+    references.add(material->get_reference_id());
+    return material->acquire_material();
+}
+
+void
+RSDelegateSceneSource::create_instancer(RedshiftScene& scene, R2cItemId instancer, RSInstancerInfo& rinstancer)
+{
+    RedshiftUtils::CreateInstancer(rinstancer, scene.resources.index, *m_delegate.get_scene_delegate(), scene.ptr, instancer);
+}
+
+void
+RSDelegateSceneSource::sync_light_attributes(R2cItemId light, RSLightInfo& rlight)
+{
+    OfObject *clight = m_delegate.get_scene_delegate()->get_render_item(light).get_item();
+    OfAttr *color = clight->attribute_exists("color");
+    rlight.shader->BeginUpdate();
+    rlight.shader->SetParameterData("color", color != nullptr ? RedshiftUtils::ToRSColor(color->get_vec3d()) : RSColor(1.0,1.0,1.0));
+
+    OfAttr *radius = clight->attribute_exists("radius");
+    if (radius != nullptr) {
+        float value =  static_cast<float>(radius->get_double());
+        rlight.ptr->SetAreaScaling(RSVector3(value, value, value));
+    }
+    rlight.shader->EndUpdate();
+}
+
 // private implementation
 class RSDelegateImpl {
 public:
 
-    RSScene *scene; // actual Redshift render scene
+    RedshiftScene scene; // Redshift render scene along with the index of its items
+    RSDelegateSceneSource source; // items of the scene delegate read by the sync of the render scene
     RSCamera *camera; // Redshift render camera
     RenderingBlockSink *sink; // Redshift BlockSink that fills the Clarisse's render buffer
     RenderingAbortChecker *abort_checker; // Redshift AbortChecker that notifies the renderer to stop
     RenderingProgress *progress; // Redshift rendering progress
 
     struct {
-        RSResourceIndex index; // the index of all current resources where we store deduplicated data
-    } resources;
+        CoreHashTable<R2cItemId, unsigned long long> geometries; // geometries outside of the preview frustum with the estimated size of their mesh
+        unsigned long long bytes; // estimated size of the meshes of all deferred geometries
+    } deferred;
 
     struct {
-        RSGeometryIndex index; // index of all render geometries which are mesh instances pointing to a geometry resource
-        CoreVector<R2cItemId> inserted; // is filled by RedshiftRenderDelegate::insert_geometry when a geometry is inserted to the scene
-        CoreVector<R2cItemId> removed; // is filled by RedshiftRenderDelegate::remove_geometry when a geometry is removed from the scene
-
-        bool dirty; // flag set when we receive dirtiness so that we don't need to iterate the whole index to know that it is dirty
-        bool is_dirty() { return inserted.get_count() != 0 || removed.get_count() != 0 || dirty; } // return true is index is dirty
+        CoreSet<CoreString> attributes; // names of the renderer attributes modified since the last render
+        bool all; // true when all render options must be set again
+    } render_settings;
 
-    } geometries;
+    ProgressiveTranslation translation; // background conversion of the meshes represented by a proxy
+    InteractiveRender ipr; // background passes of the render, whose lock guards the modifications recorded until the next sync
+    bool interactive; // true if the render is restarted as soon as the scene is modified
+    RenderingFrameBuffer frame_buffer; // image of the passes rendered in the background, copied to the render buffer of each evaluation
+    std::atomic<bool> is_progress_refresh; // true if the next evaluation is only requested to display the progress of the passes
 
     struct {
-        RSLightIndex index; // index of all render lights
-        CoreVector<R2cItemId> inserted; // is filled by RedshiftRenderDelegate::insert_light when a light is inserted to the scene
-        CoreVector<R2cItemId> removed; // is filled by RedshiftRenderDelegate::remove_light when a light is removed from the scene
-        bool dirty; // flag set when we receive dirtiness so that we don't need to iterate the whole index to know that it is dirty
+        GMathMatrix4x4d matrix; // global matrix of the camera
+        double hfov, vfov; // fields of view of the camera
+        unsigned int width, height; // size of the rendered image
+        float sampling_quality;
+        bool is_valid; // false until the passes are first started
+    } view; // view the passes in progress were started with, whose changes restart them
 
-        bool is_dirty() { return inserted.get_count() != 0 || removed.get_count() != 0 || dirty; } // return true is index is dirty
-
-    } lights;
+    // parametric primitives are shared by all the geometries with the same key. An allocated copy of the
+    // key is used as their resource id so that it can't collide with the id of a Clarisse resource
+    CoreHashTable<CoreString, CoreString *> primitives;
 
     struct {
-        RSInstancerIndex index; // index of all render instancers
-        CoreVector<R2cItemId> inserted; // is filled by RedshiftRenderDelegate::insert_instancer when an instancer is inserted to the scene
-        CoreVector<R2cItemId> removed; // is filled by RedshiftRenderDelegate::remove_instancer when an instancer is removed from the scene
-        bool dirty; // flag set when we receive dirtiness so that we don't need to iterate the whole index to know that it is dirty
-
-        bool is_dirty() { return inserted.get_count() != 0 || removed.get_count() != 0 || dirty; } // return true is index is dirty
+        bool enabled; // true if the geometries outside of the frustum aren't translated
+        double margin; // ratio by which the field of view of the camera is expanded
+        PreviewFrustum frustum;
+        bool is_dirty; // true if the camera or the preview settings changed so the deferred geometries must be tested again
+        unsigned int reported_count; // number of deferred geometries last reported to the log
+    } preview;
 
-    } instancers;
+    bool log_sync_statistics; // true if the time spent in each stage of the sync is logged
 
-    inline RSDelegateImpl()
-        : scene(nullptr)
+    inline RSDelegateImpl(RedshiftRenderDelegate& delegate)
+        : source(delegate)
         , camera(nullptr)
         , sink(nullptr)
         , abort_checker(nullptr)
-        , progress(nullptr) {
+        , progress(nullptr)
+        , interactive(false)
+        , is_progress_refresh(false)
+        , log_sync_statistics(false) {
+        view.is_valid = false;
+        render_settings.all = true;
+        deferred.bytes = 0;
+        preview.enabled = false;
+        preview.margin = 0.1;
+        preview.is_dirty = false;
+        preview.reported_count = 0;
     }
 
     ~RSDelegateImpl() {
+        for (auto primitive : primitives) delete primitive.get_value();
     }
 };
 
@@ -88,11 +421,11 @@ const CoreVector<CoreString> RedshiftRenderDelegate::s_unsupported_lights     =
 const CoreVector<CoreString> RedshiftRenderDelegate::s_supported_materials    = { "MaterialRedshift" }; // we only support redshift materials
 const CoreVector<CoreString> RedshiftRenderDelegate::s_unsupported_materials  = {};
 const CoreVector<CoreString> RedshiftRenderDelegate::s_supported_geometries   = { "SceneObject" };
-const CoreVector<CoreString> RedshiftRenderDelegate::s_unsupported_geometries = { "GeometryVolume", "GeometryFur", "GeometryBundle", "GeometrySphere", "GeometryCylinder" };
+const CoreVector<CoreString> RedshiftRenderDelegate::s_unsupported_geometries = { "GeometryVolume", "GeometryBundle", "GeometryCylinder" };
 
 RedshiftRenderDelegate::RedshiftRenderDelegate() : R2cRenderDelegate()
 {
-    m = new RSDelegateImpl;
+    m = new RSDelegateImpl(*this);
 }
 
 RedshiftRenderDelegate::~RedshiftRenderDelegate()
@@ -114,7 +447,18 @@ RedshiftRenderDelegate::sync_render_settings(const float& sampling_quality)
         R2cItemDescriptor renderer = get_scene_delegate()->get_render_settings();
         if (!renderer.is_null() && renderer.get_item()->get_module()->is_kindof(ModuleRendererRedshift::class_info())) {
             ModuleRendererRedshift *settings = static_cast<ModuleRendererRedshift *>(renderer.get_item()->get_module());
-            settings->sync(sampling_quality);
+            settings->sync(sampling_quality, m->render_settings.attributes, m->render_settings.all);
+            m->render_settings.attributes.remove_all();
+            m->render_settings.all = false;
+            m->scene.compaction_ratio = settings->get_compaction_ratio();
+            m->scene.compaction_max_removed_items = settings->get_compaction_max_removed_items();
+            m->scene.compaction_max_removed_bytes = settings->get_compaction_max_removed_bytes();
+            m->translation.enabled = settings->get_progressive_translation();
+            m->interactive = settings->get_interactive_rendering();
+            m->log_sync_statistics = settings->get_log_sync_statistics();
+            m->preview.is_dirty |= m->preview.enabled != settings->get_frustum_preview();
+            m->preview.enabled = settings->get_frustum_preview();
+            m->preview.margin = settings->get_frustum_preview_margin();
             return true;
         }
 
@@ -122,177 +466,348 @@ RedshiftRenderDelegate::sync_render_settings(const float& sampling_quality)
     return false;
 }
 
+void
+RedshiftRenderDelegate::dirty_render_settings(R2cItemDescriptor item, const OfAttr *attr)
+{
+    std::lock_guard<std::recursive_mutex> lock(m->ipr.get_lock());
+    interrupt_render();
+    if (attr != nullptr) {
+        m->render_settings.attributes.add(attr->get_name());
+    } else {
+        m->render_settings.all = true;
+    }
+}
+
 void
 RedshiftRenderDelegate::insert_light(R2cItemDescriptor item)
 {
-    m->lights.inserted.add(item.get_id());
+    std::lock_guard<std::recursive_mutex> lock(m->ipr.get_lock());
+    interrupt_render();
+    m->scene.insert_light(item.get_id());
 }
 
 void
 RedshiftRenderDelegate::remove_light(R2cItemDescriptor item)
 {
-    RSLightInfo *light = m->lights.index.is_key_exists(item.get_id());
-    if (light != nullptr) { // make sure it is indeed in our index
-        m->lights.removed.add(item.get_id());
-    }
+    std::lock_guard<std::recursive_mutex> lock(m->ipr.get_lock());
+    interrupt_render();
+    m->scene.remove_light(item.get_id());
 }
 
 void
 RedshiftRenderDelegate::dirty_light(R2cItemDescriptor item, const int& dirtiness)
 {
-    RSLightInfo *light = m->lights.index.is_key_exists(item.get_id());
-    if (light != nullptr) { // make sure it is indeed in our index
-        m->lights.dirty = true;
-        light->dirtiness |= dirtiness;
-    }
+    std::lock_guard<std::recursive_mutex> lock(m->ipr.get_lock());
+    interrupt_render();
+    m->scene.dirty_light(item.get_id(), dirtiness);
 }
 
 void
 RedshiftRenderDelegate::insert_instancer(R2cItemDescriptor item)
 {
-    m->instancers.inserted.add(item.get_id());
+    std::lock_guard<std::recursive_mutex> lock(m->ipr.get_lock());
+    interrupt_render();
+    m->scene.insert_instancer(item.get_id());
 }
 
 void
 RedshiftRenderDelegate::remove_instancer(R2cItemDescriptor item)
 {
-    RSInstancerInfo *instancer = m->instancers.index.is_key_exists(item.get_id());
-    if (instancer != nullptr) { // make sure it is indeed in our index
-        m->instancers.removed.add(item.get_id());
-        instancer->dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
-    }
+    std::lock_guard<std::recursive_mutex> lock(m->ipr.get_lock());
+    interrupt_render();
+    m->scene.remove_instancer(item.get_id());
 }
 
 void
 RedshiftRenderDelegate::dirty_instancer(R2cItemDescriptor item, const int& dirtiness)
 {
-    RSInstancerInfo *instancer = m->instancers.index.is_key_exists(item.get_id());
-    if (instancer != nullptr) { // make sure it is indeed in our index
-        m->instancers.dirty = true;
-        instancer->dirtiness |= dirtiness;
-    }
+    std::lock_guard<std::recursive_mutex> lock(m->ipr.get_lock());
+    interrupt_render();
+    m->scene.dirty_instancer(item.get_id(), dirtiness);
 }
 
 void
 RedshiftRenderDelegate::insert_geometry(R2cItemDescriptor item)
 {
-    m->geometries.inserted.add(item.get_id());
+    std::lock_guard<std::recursive_mutex> lock(m->ipr.get_lock());
+    interrupt_render();
+    m->scene.insert_geometry(item.get_id());
 }
 
 void
 RedshiftRenderDelegate::remove_geometry(R2cItemDescriptor item)
 {
-    RSGeometryInfo *geometry = m->geometries.index.is_key_exists(item.get_id());
-    if (geometry != nullptr) { // make sure it is indeed in our index
-        m->geometries.removed.add(item.get_id());
-        geometry->dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
+    std::lock_guard<std::recursive_mutex> lock(m->ipr.get_lock());
+    interrupt_render();
+    unsigned long long *deferred_bytes = m->deferred.geometries.is_key_exists(item.get_id());
+    if (deferred_bytes != nullptr) { // it was never translated so there's nothing else to remove
+        m->deferred.bytes -= *deferred_bytes;
+        m->deferred.geometries.remove(item.get_id());
+        return;
     }
+    RSGeometryInfo *geometry = m->scene.remove_geometry(item.get_id());
+    if (geometry != nullptr) discard_proxy(*geometry);
 }
 
 void
 RedshiftRenderDelegate::dirty_geometry(R2cItemDescriptor item, const int& dirtiness)
 {
-    RSGeometryInfo *geometry = m->geometries.index.is_key_exists(item.get_id());
-    if (geometry != nullptr) { // make sure it is indeed in our index
-        m->geometries.dirty = true;
-        geometry->dirtiness |= dirtiness;
+    std::lock_guard<std::recursive_mutex> lock(m->ipr.get_lock());
+    interrupt_render();
+    unsigned long long *deferred_bytes = m->deferred.geometries.is_key_exists(item.get_id());
+    if (deferred_bytes != nullptr) {
+        // a deferred geometry which moved may enter the frustum so it's tested again by the next sync
+        if (dirtiness & (R2cSceneDelegate::DIRTINESS_KINEMATIC | R2cSceneDelegate::DIRTINESS_GEOMETRY | R2cSceneDelegate::DIRTINESS_DEFORMATION)) {
+            m->deferred.bytes -= *deferred_bytes;
+            m->deferred.geometries.remove(item.get_id());
+            m->scene.insert_geometry(item.get_id());
+        }
+        return;
     }
+    RSGeometryInfo *geometry = m->scene.dirty_geometry(item.get_id(), dirtiness);
+    if (geometry != nullptr && (dirtiness & (R2cSceneDelegate::DIRTINESS_GEOMETRY | R2cSceneDelegate::DIRTINESS_DEFORMATION))) discard_proxy(*geometry);
+}
+
+void
+RedshiftRenderDelegate::discard_proxy(const RSGeometryInfo& rgeometry)
+{
+    // the Clarisse resource may be released as soon as its only geometry is modified or removed
+    // so it mustn't be converted anymore. Shared resources stay alive thanks to the other geometries.
+    RSResourceInfo *resource = m->scene.resources.index.is_key_exists(rgeometry.resource);
+    if (resource != nullptr && resource->is_proxy && resource->refcount == 1) m->translation.discard(rgeometry.resource);
 }
 
 void
 RedshiftRenderDelegate::render(R2cRenderBuffer *render_buffer, const float& sampling_quality)
 {
-    if (render_buffer != nullptr && sync_render_settings(sampling_quality)) { // make sure we have what we need to render
-        const unsigned int w = static_cast<unsigned int>(render_buffer->get_width());
-        const unsigned int h = static_cast<unsigned int>(render_buffer->get_height());
+    // the engine is only started by the first render since bringing it up is slow
+    if (!RedshiftUtils::start_engine("first render")) return;
+
+    if (render_buffer == nullptr) return;
+    const unsigned int w = static_cast<unsigned int>(render_buffer->get_width());
+    const unsigned int h = static_cast<unsigned int>(render_buffer->get_height());
+
+    if (is_interactive()) {
+        render_interactive(*render_buffer, w, h, sampling_quality);
+    } else {
+        // the passes of a previous interactive render mustn't run while the render scene is modified
+        m->ipr.stop([this]() { m->abort_checker->interrupt(); });
+        {
+            // the render settings and the camera are synchronized along with the modifications of the scene
+            std::lock_guard<std::recursive_mutex> lock(m->ipr.get_lock());
+            if (!prepare_render(w, h, sampling_quality)) return; // make sure we have what we need to render
+            m->abort_checker->set_evaluation_bound(true);
+            m->sink->SetFrameBuffer(nullptr);
+            m->sink->SetRenderBuffer(render_buffer); // set the sink to the input render buffer
+            // make sure to synchronize the render scene with the scene delegate
+            sync();
+        }
+        // main rendering call.
+        render_scene();
+        m->view.is_valid = false;
+    }
 
-        sync_camera(w, h, 0, 0, w, h); // this takes care of creating the camera
-        if (m->camera == nullptr) return; // no valid camera is set
+    // finalize the render buffer
+    render_buffer->finalize();
+}
 
-        // Create the render scene if it wasn't already created
-        if (m->scene == nullptr) {
-            m->scene = RS_Scene_New();
-        }
+void
+RedshiftRenderDelegate::render_interactive(R2cRenderBuffer& render_buffer, const unsigned int& w, const unsigned int& h, const float& sampling_quality)
+{
+    // an evaluation requested by is_refresh_needed() only displays the progress of the passes rendered in the background,
+    // unless the scene or the view has been modified since they were started
+    const bool is_progress_refresh = m->is_progress_refresh.exchange(false);
+    if (is_progress_refresh && m->ipr.is_rendering() && !m->abort_checker->is_interrupted() && !is_view_modified(w, h, sampling_quality)) {
+        // the layer is evaluated again as soon as the passes are done, or after a while to display their progress
+        m->ipr.wait_for_passes(s_progress_refresh_interval);
+    } else {
+        // the render scene is synchronized by this thread, which owns the Clarisse objects, once the passes in progress are
+        // aborted. The passes are then rendered in the background and write their blocks to the frame buffer of the delegate
+        // since the render buffer only lives until this call returns.
+        m->ipr.restart([&]() {
+            if (!prepare_render(w, h, sampling_quality)) return false;
+            m->abort_checker->clear_interruption(); // the modifications recorded so far are synchronized
+            m->abort_checker->set_evaluation_bound(false);
+            m->frame_buffer.resize(w, h);
+            m->sink->SetRenderBuffer(nullptr);
+            m->sink->SetFrameBuffer(&m->frame_buffer);
+            sync();
+            store_view(w, h, sampling_quality);
+            return true;
+        }, [this]() {
+            render_scene();
+        }, [this]() {
+            m->abort_checker->interrupt();
+        });
+    }
+    m->frame_buffer.copy_to(render_buffer);
+}
 
-        // Create the sink if it wasn't already
-        if (m->sink == nullptr) {
-            m->sink = new RenderingBlockSink;
-            RS_RenderChannel_GetMain()->AddBlockSink(0, m->sink); // just for the beauty for now
-        }
+bool
+RedshiftRenderDelegate::prepare_render(const unsigned int& w, const unsigned int& h, const float& sampling_quality)
+{
+    if (!sync_render_settings(sampling_quality)) return false;
 
-        m->sink->SetRenderBuffer(render_buffer); // set the sink to the input render buffer
+    sync_camera(w, h, 0, 0, w, h); // this takes care of creating the camera
+    if (m->camera == nullptr) return false; // no valid camera is set
 
-        // Create the abort checker if it wasn't already
-        if (m->abort_checker == nullptr) {
-            m->abort_checker = new RenderingAbortChecker(get_scene_delegate()->get_application());
-        }
+    // Create the render scene if it wasn't already created
+    if (m->scene.ptr == nullptr) {
+        m->scene.ptr = RS_Scene_New();
+    }
 
-        // Create the progress class if it wasn't already
-        if (m->progress == nullptr) {
-            m->progress = new RenderingProgress();
-        }
+    // Create the sink if it wasn't already
+    if (m->sink == nullptr) {
+        m->sink = new RenderingBlockSink;
+        RS_RenderChannel_GetMain()->AddBlockSink(0, m->sink); // just for the beauty for now
+    }
 
-        // make sure to synchronize the render scene with the scene delegate
-        sync();
+    // Create the abort checker if it wasn't already
+    if (m->abort_checker == nullptr) {
+        m->abort_checker = new RenderingAbortChecker(get_scene_delegate()->get_application());
+    }
 
-        // main rendering call.
-        RS_Renderer_Render(m->camera, m->scene, true, m->abort_checker, m->progress);
+    // Create the progress class if it wasn't already
+    if (m->progress == nullptr) {
+        m->progress = new RenderingProgress();
+    }
+    return true;
+}
 
-        // finalize the render buffer
-        render_buffer->finalize();
+bool
+RedshiftRenderDelegate::is_interactive() const
+{
+    // read from the render settings before they are synchronized since the passes in progress must be aborted first
+    R2cItemDescriptor renderer = get_scene_delegate()->get_render_settings();
+    if (renderer.is_null() || !renderer.get_item()->get_module()->is_kindof(ModuleRendererRedshift::class_info())) return false;
+    return static_cast<ModuleRendererRedshift *>(renderer.get_item()->get_module())->get_interactive_rendering();
+}
+
+/*! \brief Read the global matrix and the fields of view of the camera of the scene delegate */
+static bool
+get_camera_view(const R2cSceneDelegate& delegate, const unsigned int& w, const unsigned int& h, GMathMatrix4x4d& matrix, double& hfov, double& vfov)
+{
+    if (delegate.get_camera().is_destroyed()) return false;
+    ModuleCamera *cam = static_cast<ModuleCamera *>(delegate.get_camera().get_item()->get_module());
+    matrix = cam->get_global_matrix();
+    cam->get_fovs(static_cast<double>(w) / static_cast<double>(h), hfov, vfov);
+    return true;
+}
+
+bool
+RedshiftRenderDelegate::is_view_modified(const unsigned int& w, const unsigned int& h, const float& sampling_quality) const
+{
+    if (!m->view.is_valid || w != m->view.width || h != m->view.height || sampling_quality != m->view.sampling_quality) return true;
+    // the camera isn't part of the modifications dispatched by the scene delegate so it's compared to the one of the passes
+    GMathMatrix4x4d matrix;
+    double hfov, vfov;
+    if (!get_camera_view(*get_scene_delegate(), w, h, matrix, hfov, vfov)) return true;
+    if (hfov != m->view.hfov || vfov != m->view.vfov) return true;
+    for (unsigned int i = 0; i < 4; i++) {
+        for (unsigned int j = 0; j < 4; j++) {
+            if (matrix[i][j] != m->view.matrix[i][j]) return true;
+        }
     }
+    return false;
 }
 
-float
-RedshiftRenderDelegate::get_render_progress() const
+void
+RedshiftRenderDelegate::store_view(const unsigned int& w, const unsigned int& h, const float& sampling_quality)
 {
-    return m->progress ? m->progress->get_current_progress() : 0.f;
+    m->view.is_valid = get_camera_view(*get_scene_delegate(), w, h, m->view.matrix, m->view.hfov, m->view.vfov);
+    m->view.width = w;
+    m->view.height = h;
+    m->view.sampling_quality = sampling_quality;
 }
 
 void
-RedshiftRenderDelegate::sync()
+RedshiftRenderDelegate::render_scene()
 {
-    CleanupFlags cleanup;
-    sync_geometries(cleanup);
-    sync_instancers(cleanup);
-    sync_lights(cleanup);
-    // cleanup the scene in the event we removed items
-    cleanup_scene(cleanup);
+    // blocks are streamed to the render buffer by the sink while the passes are rendered
+    RS_Renderer_Render(m->camera, m->scene.ptr, true, m->abort_checker, m->progress);
 }
 
 void
-RedshiftRenderDelegate::cleanup_scene(const CleanupFlags& cleanup)
+RedshiftRenderDelegate::interrupt_render()
 {
-    // since we can't remove geometries we must repopulate all geometries etc... :'(
-    if (cleanup.mesh_instances) {
-        m->scene->ClearInstanceMaterialOverrides();
-        m->scene->ClearMeshInstances();
-        // adding instances
-        for (auto geometry : m->geometries.index) {
-            const RSGeometryInfo& geo = geometry.get_value();
-            geo.ptr->SetTemplate(geo.materials->GetTemplate(), m->scene->AddInstanceMaterialOverride(geo.materials));
-            m->scene->AddMeshInstance(geometry.get_value().ptr);
-        }
-    }
+    // any modification recorded after the last sync, during the passes or between two renders,
+    // aborts the passes in progress so that they are restarted with it by the next render
+    if (m->interactive && m->abort_checker != nullptr) m->abort_checker->interrupt();
+}
 
-    if (cleanup.meshes) {
-        m->scene->ClearMeshes();
-        // adding mesh resources
-        for (auto resource: m->resources.index) m->scene->AddMesh(resource.get_value().ptr);
-    }
+void
+RedshiftRenderDelegate::interrupt_geometry(R2cItemDescriptor item)
+{
+    std::lock_guard<std::recursive_mutex> lock(m->ipr.get_lock());
+    interrupt_render();
+    // the proxy stays in the render scene until the dirtiness of the geometry is dispatched by the next sync
+    RSGeometryInfo *geometry = m->scene.geometries.index.is_key_exists(item.get_id());
+    if (geometry != nullptr) discard_proxy(*geometry);
+}
 
-    if (cleanup.point_clouds) {
-        m->scene->ClearMeshPointClouds();
-        for (auto instancer: m->instancers.index) {
-            for (auto point_cloud : instancer.get_value().ptrs) {
-                m->scene->AddMeshPointCloud(point_cloud);
-            }
-        }
+bool
+RedshiftRenderDelegate::is_refresh_needed() const
+{
+    // in interactive mode, the layer is evaluated again to display the progress of the passes rendered in the background
+    // and to restart them once they are interrupted by a modification of the scene
+    if (m->interactive && (m->ipr.is_rendering() || (m->abort_checker != nullptr && m->abort_checker->is_interrupted()))) {
+        m->is_progress_refresh = true;
+        return true;
     }
+    // with progressive translation, the image is rendered again as gathered meshes replace their proxies
+    return m->translation.is_pending();
+}
+
+float
+RedshiftRenderDelegate::get_render_progress() const
+{
+    return m->progress ? m->progress->get_current_progress() : 0.f;
+}
 
-    if (cleanup.lights) {
-        m->scene->ClearLights();
-        for (auto light : m->lights.index) m->scene->AddLight(light.get_value().ptr);
+void
+RedshiftRenderDelegate::sync()
+{
+    // elapsed time in ms of each stage which is only reported when statistics are enabled
+    double shader_time, geometry_time, instancer_time, compaction_time, light_time, cleanup_time;
+    auto clock = std::chrono::steady_clock::now();
+    auto lap = [&clock](double& time) {
+        const auto now = std::chrono::steady_clock::now();
+        time = std::chrono::duration<double, std::milli>(now - clock).count();
+        clock = now;
+    };
+    const unsigned int resource_count = m->scene.resources.index.get_count();
+
+    // apply the attribute changes of Redshift materials and textures received since the last sync
+    RedshiftUtils::flush_shader_updates();
+    lap(shader_time);
+
+    // the stages of RedshiftScene::sync() are run one by one to time them
+    RedshiftScene::CleanupFlags cleanup;
+    swap_proxies();
+    m->scene.sync_geometries(m->source, cleanup);
+    lap(geometry_time);
+    m->scene.sync_instancers(m->source, cleanup);
+    lap(instancer_time);
+    m->scene.compact_scene(m->source, cleanup);
+    lap(compaction_time);
+    m->scene.sync_lights(m->source, cleanup);
+    lap(light_time);
+    // cleanup the scene in the event we removed items
+    m->scene.cleanup_scene(cleanup);
+    lap(cleanup_time);
+
+    if (m->log_sync_statistics) {
+        const unsigned int new_resources = m->scene.resources.index.get_count() > resource_count ? m->scene.resources.index.get_count() - resource_count : 0;
+        LOG_INFO("Redshift sync: shaders " << shader_time << " ms, "
+                 << m->scene.geometries.index.get_count() << " geometries " << geometry_time << " ms ("
+                 << new_resources << " new resources, " << (geometry_time > 0.0 ? new_resources * 1000.0 / geometry_time : 0.0) << " resources/s), "
+                 << m->scene.instancers.index.get_count() << " instancers " << instancer_time << " ms, "
+                 << m->scene.lights.index.get_count() << " lights " << light_time << " ms, "
+                 << "cleanup and compaction " << compaction_time + cleanup_time << " ms (" << m->scene.tombstones.get_count() << " removed items, "
+                 << m->deferred.geometries.get_count() << " deferred geometries)\n");
+        const RedshiftUtils::TextureCacheStatistics textures = RedshiftUtils::get_texture_cache_statistics();
+        LOG_INFO("Redshift textures: " << textures.count << " cached, " << textures.hits << " hits, "
+                 << textures.misses << " misses, " << textures.bytes / (1024 * 1024) << " MB prefetched\n");
     }
 }
 
@@ -300,48 +815,13 @@ void
 RedshiftRenderDelegate::clear()
 {
     // !!! make sure to clear everything !!!
-    if (m->scene != nullptr) {
-        // clearing instances
-        for (auto geometry : m->geometries.index) {
-            const RSGeometryInfo& geo = geometry.get_value();
-            RS_InstanceMaterialOverrides_Delete(geo.materials);
-            RS_MeshInstance_Delete(geo.ptr);
-        }
-        m->geometries.index.remove_all();
-        m->geometries.removed.remove_all();
-        m->geometries.inserted.remove_all();
-        m->geometries.dirty = R2cSceneDelegate::DIRTINESS_ALL;
-        m->scene->ClearInstanceMaterialOverrides();
-        m->scene->ClearMeshInstances();
-
-        // clearing meshes
-        for (auto resource: m->resources.index) RS_MeshBase_Delete(resource.get_value().ptr);
-        m->scene->ClearMeshes();
-        m->resources.index.remove_all();
-
-        // clearing point clouds
-        for (auto instancer: m->instancers.index) {
-            for (auto point_cloud : instancer.get_value().ptrs) {
-                RS_PointCloud_Delete(point_cloud);
-            }
-        }
-        m->scene->ClearMeshPointClouds(); // not really necessary since we called ClearMeshes()
-        m->instancers.index.remove_all();
-        m->instancers.removed.remove_all();
-        m->instancers.inserted.remove_all();
-        m->instancers.dirty = R2cSceneDelegate::DIRTINESS_ALL;
-
-        // clearing lights
-        for (auto light : m->lights.index) RS_Light_Delete(light.get_value().ptr);
-        m->lights.index.remove_all();
-        m->lights.removed.remove_all();
-        m->lights.inserted.remove_all();
-        m->lights.dirty = R2cSceneDelegate::DIRTINESS_ALL;
-        m->scene->ClearLights();
-
-        RS_Scene_Delete(m->scene);
-        m->scene = nullptr;
-    }
+    // stopping the background render and conversions first since they reference the scene resources
+    m->ipr.stop([this]() { m->abort_checker->interrupt(); });
+    m->translation.cancel();
+    std::lock_guard<std::recursive_mutex> lock(m->ipr.get_lock());
+    m->scene.clear(m->source);
+    m->deferred.geometries.remove_all();
+    m->deferred.bytes = 0;
     if (m->camera != nullptr) {
         RS_Camera_Delete(m->camera);
         m->camera = nullptr;
@@ -355,6 +835,12 @@ RedshiftRenderDelegate::clear()
 
     delete m->progress;
     m->progress = nullptr;
+
+    // make sure render options are all set again at the next render
+    m->render_settings.attributes.remove_all();
+    m->render_settings.all = true;
+    m->view.is_valid = false;
+    m->is_progress_refresh = false;
 }
 
 void
@@ -378,6 +864,7 @@ RedshiftRenderDelegate::sync_camera(const unsigned int& w, const unsigned int& h
         float redshift_ratio = static_cast<float>(h) / static_cast<float>(w);
 		double clarisse_ratio = static_cast<double>(w) / static_cast<double>(h), hfov, vfov;
         cam->get_fovs(clarisse_ratio, hfov, vfov);
+        m->preview.is_dirty |= m->preview.frustum.init(cam->get_global_matrix(), hfov, vfov, m->preview.margin);
 
         // We need to ensure all steps are cleared because the scene might be using transformation blur!
         for(unsigned int i=0; i< m->camera->GetNumTransformationSteps(); i++) {
@@ -392,401 +879,268 @@ RedshiftRenderDelegate::sync_camera(const unsigned int& w, const unsigned int& h
     }
 }
 
-void
-sync_shading_groups(const R2cSceneDelegate& delegate, R2cItemId cgeometryid, RSGeometryInfo& rgeometry)
+/*! \brief Create the Redshift resource of a geometry which is either its canonical primitive or the conversion of its Clarisse resource */
+static void
+create_resource(const R2cSceneDelegate& delegate, R2cItemId geometry, RSResourceInfo& resource)
 {
-    for (unsigned int i = 0; i < rgeometry.materials->GetNumMaterials(); i++) {
-        const R2cShadingGroupInfo&  shading_group = delegate.get_shading_group_info(cgeometryid, i);
-        rgeometry.materials->SetMaterial(i, shading_group.get_material().is_null() ? RedshiftUtils::get_default_material() : static_cast<ModuleMaterialRedshift *>(shading_group.get_material().get_item()->get_module())->get_material());
+    CoreString primitive;
+    GMathVec3d scale;
+    if (RedshiftUtils::GetPrimitive(delegate, geometry, primitive, scale)) {
+        resource.ptr = RedshiftUtils::CreatePrimitive(primitive, RedshiftUtils::get_default_material(), resource.type);
+    } else {
+        resource.ptr = RedshiftUtils::CreateGeometry(delegate, geometry, RedshiftUtils::get_default_material(), resource.type);
     }
 }
 
-RSCachedMeshFlags
-RS_CachedMeshFlag_Hidden()
+R2cResourceId
+RedshiftRenderDelegate::get_resource_id(R2cItemId cgeometryid)
 {
-    static RSCachedMeshFlags hidden = RS_CachedMeshFlag_GetDefault();
-    static bool init = false;
-    if (!init) {
-        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_PRIMARYRAYVISIBLE", false);
-        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_AOCASTER", false);
-        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_SHADOWCASTER", false);
-        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_REFLECTIONVISIBLE", false);
-        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_REFRACTIONVISIBLE", false);
-        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_GIVISIBLE", false);
-        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_CAUSTICVISIBLE", false);
-        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_FGVISIBLE", false);
-        init = true;
+    CoreString primitive;
+    GMathVec3d scale;
+    if (RedshiftUtils::GetPrimitive(*get_scene_delegate(), cgeometryid, primitive, scale)) {
+        CoreString **key = m->primitives.is_key_exists(primitive);
+        if (key == nullptr) {
+            m->primitives.add(primitive, new CoreString(primitive));
+            key = m->primitives.is_key_exists(primitive);
+        }
+        return reinterpret_cast<R2cResourceId>(*key);
     }
-    return hidden;
+    return get_scene_delegate()->get_geometry_resource(cgeometryid).get_id();
 }
 
-void
-RedshiftRenderDelegate::_sync_geometry(R2cItemId cgeometryid, RSGeometryInfo& rgeometry, const bool& is_new)
+bool
+RedshiftRenderDelegate::deform_geometry(R2cItemId cgeometryid, RSGeometryInfo& rgeometry)
 {
-    if (rgeometry.dirtiness & R2cSceneDelegate::DIRTINESS_GEOMETRY) {
-        if (!is_new) {
-            // mark as removed since we will need to recreate it
-            m->geometries.removed.add(cgeometryid);
-            rgeometry.dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
-            // reinsert the removed geometry so it is added after the cleanup
-            m->geometries.inserted.add(cgeometryid);
-        } else {
-            // it's a new geometry so let's first see if the geometry already defined a resource
-            R2cGeometryResource cresource = get_scene_delegate()->get_geometry_resource(cgeometryid);
-            RSResourceInfo *stored_resource = m->resources.index.is_key_exists(cresource.get_id());
-            RSMeshBase *mesh = nullptr;
-
-            if (stored_resource == nullptr) { // the resource doesn't exists so let's create it
-                // create corresponding geometry resource according to the Clarisse geometry
-                RSResourceInfo new_resource;
-                mesh = new_resource.ptr = RedshiftUtils::CreateGeometry(*get_scene_delegate(), cgeometryid, RedshiftUtils::get_default_material(), new_resource.type);
-                new_resource.refcount = 1;
-                // adding the new resource
-                m->resources.index.add(cresource.get_id(), new_resource);
-                // we need to add the new mesh to instanciate it
-                m->scene->AddMesh(new_resource.ptr);
-            } else {
-                mesh = stored_resource->ptr;
-                stored_resource->refcount++;
-            }
-
-            // generating the instance to the resource
-            rgeometry.ptr = RS_MeshInstance_New();
-            rgeometry.ptr->SetIsTransformationBlurred(false);
-            // we need to create the material overrides for the instance since we can freely assign
-            // materials to instances in Clarisse
-            rgeometry.materials = RS_InstanceMaterialOverrides_New();
-            rgeometry.materials->SetTemplate(mesh);
-            rgeometry.materials->SetNumMaterials(mesh->GetNumMaterials());
-            // back pointer to the clarisse resource since when we are dirty it's too late to get it back
-            rgeometry.resource = cresource.get_id();
-
-            rgeometry.ptr->SetTemplate(mesh, m->scene->AddInstanceMaterialOverride(rgeometry.materials));
-            // since that was a new geometry we will need to set the matrix, materials and visibility flags
-            rgeometry.dirtiness = R2cSceneDelegate::DIRTINESS_KINEMATIC |
-                                  R2cSceneDelegate::DIRTINESS_SHADING_GROUP |
-                                  R2cSceneDelegate::DIRTINESS_VISIBILITY;
-        }
+    CoreString primitive;
+    GMathVec3d scale;
+    if (RedshiftUtils::GetPrimitive(*get_scene_delegate(), cgeometryid, primitive, scale)) {
+        // the shared primitive is unchanged, only the scale of the instance must be updated
+        if (get_resource_id(cgeometryid) != rgeometry.resource) return false;
+        rgeometry.dirtiness |= R2cSceneDelegate::DIRTINESS_KINEMATIC;
+        return true;
     }
 
-    if (rgeometry.dirtiness & R2cSceneDelegate::DIRTINESS_KINEMATIC) {
-        rgeometry.ptr->SetMatrix(RedshiftUtils::ToRSMatrix4x4(get_scene_delegate()->get_transform(cgeometryid)));
-    }
+    RSResourceInfo *resource = m->scene.resources.index.is_key_exists(rgeometry.resource);
+    if (resource == nullptr || resource->type != RSResourceInfo::TYPE_MESH || resource->is_proxy) return false;
 
-    if (rgeometry.dirtiness & R2cSceneDelegate::DIRTINESS_SHADING_GROUP) {
-        sync_shading_groups(*get_scene_delegate(), cgeometryid, rgeometry);
+    const R2cResourceId new_id = get_resource_id(cgeometryid);
+    if (new_id != rgeometry.resource) {
+        // the resource can only be moved to its new id if no one else uses it and if the new id isn't already known
+        if (resource->refcount != 1 || m->scene.resources.index.is_key_exists(new_id) != nullptr) return false;
     }
 
-    if (rgeometry.dirtiness & R2cSceneDelegate::DIRTINESS_VISIBILITY) {
-        const bool visibility = get_scene_delegate()->get_visible(cgeometryid);
-        rgeometry.ptr->SetCachedMeshFlags(visibility ? RS_CachedMeshFlag_GetDefault() : RS_CachedMeshFlag_Hidden());
+    if (!RedshiftUtils::DeformGeometry(*get_scene_delegate(), cgeometryid, *resource, RedshiftUtils::get_default_material())) {
+        return false;
     }
 
-    // setting the dirtiness back to none since the geometry is fully synched
-    rgeometry.dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
+    if (new_id != rgeometry.resource) {
+        const RSResourceInfo moved_resource = *resource;
+        m->scene.resources.index.remove(rgeometry.resource);
+        m->scene.resources.index.add(new_id, moved_resource);
+        rgeometry.resource = new_id;
+    }
+    return true;
 }
 
-
 void
-RedshiftRenderDelegate::sync_geometries(CleanupFlags& cleanup)
+RedshiftRenderDelegate::create_geometry_resources(const CoreVector<R2cItemId>& geometries)
 {
-    if (m->geometries.is_dirty()) {
-        // iterating through geometries to see if we need to sync any of them
-        // it's VERY IMPORTANT to do this before everything else since if any
-        // items received DIRTINESS_GEOMETRY, we need to remove it from the
-        // scene to rebuild it!!!
-        for (auto geometry : m->geometries.index) {
-            if (geometry.get_value().dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
-                sync_geometry(geometry.get_key(), geometry.get_value());
-            }
-        }
-        // check if geometries have been removed and in that case we will have to
-        // rebuild the render scene since we can't remove items from the scene using
-        // the Redshift API
-        cleanup.mesh_instances = m->geometries.removed.get_count() > 0;
-        // let's see if we have to remove geometries from the scene
-        for (auto removed_item : m->geometries.removed) {
-            RSGeometryInfo *geometry = m->geometries.index.is_key_exists(removed_item);
-            // check the current geometry exists in the scene
-            if (geometry != nullptr) {
-                // doing proper cleanup. Let's cleanup the resource
-                // get the resource if it exists
-                RSResourceInfo *stored_resource = m->resources.index.is_key_exists(geometry->resource);
-                if (stored_resource != nullptr) { // there's a resource bound to the current geometry
-                    stored_resource->refcount--;
-                    if (stored_resource->refcount == 0) { // no one is using that resource anymore so let's delete it
-                        RS_MeshBase_Delete(stored_resource->ptr);
-                        m->resources.index.remove(geometry->resource);
-                        switch(stored_resource->type) {
-                            case RSResourceInfo::TYPE_POINT_CLOUD:
-                                cleanup.point_clouds |= true;
-                                break;
-                            case RSResourceInfo::TYPE_HAIR:
-                                cleanup.hairs |= true;
-                                break;
-                            default:
-                                cleanup.meshes |= true;
-                                break;
-                        }
-                    }
-                }
-                RS_MeshInstance_Delete(geometry->ptr);
-                RS_InstanceMaterialOverrides_Delete(geometry->materials);
-
-                m->geometries.index.remove(removed_item);
-                if (m->geometries.index.get_count() == 0) break; // finished
-            }
-        }
-        // since we processed all pending removed geometries we have to clear our array
-        m->geometries.removed.remove_all();
-
-        // let's see if new geometries have been added. Interestingly it's possible
-        // that sync_geometry remove and add items if the topology changes. This
-        // is why it is very important to first sync the index, remove and finally add.
-        // let's see if we have to create new geometries
-        RSGeometryInfo geometry;
-        CoreVector<RSGeometryInfo> new_geometries(0, m->geometries.inserted.get_count());
-        for (auto inserted_item : m->geometries.inserted) {
-            // initializing the new geometry
-            geometry.ptr = nullptr;
-            geometry.dirtiness = R2cSceneDelegate::DIRTINESS_ALL;
-            // synching the new geometry
-            sync_new_geometry(inserted_item, geometry);
-            // adding it to our geometry index
-            m->geometries.index.add(inserted_item, geometry);
+    // gather the resources which don't exist yet. They are listed in the insertion order
+    // of the geometries so that the scene is always populated in the same order.
+    CoreVector<R2cItemId> new_geometries(0, geometries.get_count());
+    CoreVector<R2cResourceId> new_resources(0, geometries.get_count());
+    CoreHashTable<R2cResourceId, unsigned int> scheduled;
+    for (auto geometry : geometries) {
+        R2cResourceId resource_id = get_resource_id(geometry);
+        if (m->scene.resources.index.is_key_exists(resource_id) == nullptr && scheduled.is_key_exists(resource_id) == nullptr) {
+            scheduled.add(resource_id, new_resources.get_count());
             new_geometries.add(geometry);
+            new_resources.add(resource_id);
         }
-        // since we processed all pending inserted geometries we have to clear the array
-        m->geometries.inserted.remove_all();
-
-        if (!cleanup.mesh_instances) {
-            // we can just add new geometries to the scene since they are already synched!
-            for (auto new_geometry : new_geometries) {
-               m->scene->AddMeshInstance(new_geometry.ptr);
-            }
+    }
+    if (new_resources.get_count() == 0) return;
+
+    // with progressive translation, polygonal meshes are represented by their bounding box which
+    // is immediate to create. Their actual mesh is converted in the background.
+    CoreVector<ProgressiveTranslation::Job> jobs;
+    CoreVector<unsigned int> converted(0, new_resources.get_count()); // resources converted during the sync
+    GMathVec3d camera_position(0.0, 0.0, 0.0);
+    if (m->translation.enabled) {
+        const GMathMatrix4x4d& camera = static_cast<ModuleCamera *>(get_scene_delegate()->get_camera().get_item()->get_module())->get_global_matrix();
+        camera_position = GMathVec3d(camera[3][0], camera[3][1], camera[3][2]);
+    }
+    for (unsigned int i = 0; i < new_resources.get_count(); i++) {
+        const GeometryObject *geometry = m->translation.enabled ? RedshiftUtils::GetPolygonalGeometry(*get_scene_delegate(), new_geometries[i]) : nullptr;
+        if (geometry != nullptr) {
+            ModuleSceneObject *module = static_cast<ModuleSceneObject *>(get_scene_delegate()->get_render_item(new_geometries[i]).get_item()->get_module());
+            const GMathBbox3d& bbox = module->get_bbox();
+            ProgressiveTranslation::Job job;
+            job.resource_id = new_resources[i];
+            job.geometry = geometry;
+            job.proxy = RedshiftUtils::CreateBbox(bbox, RedshiftUtils::get_default_material());
+            // size of the bounding sphere of the geometry seen from the camera
+            const GMathMatrix4x4d& transform = get_scene_delegate()->get_transform(new_geometries[i]);
+            GMathVec3d center;
+            GMathMatrix4x4d::multiply(center, (bbox.get_min() + bbox.get_max()) / 2.0, transform);
+            const double scale = gmath_max(GMathVec3d(transform[0][0], transform[0][1], transform[0][2]).get_length(),
+                                 gmath_max(GMathVec3d(transform[1][0], transform[1][1], transform[1][2]).get_length(),
+                                           GMathVec3d(transform[2][0], transform[2][1], transform[2][2]).get_length()));
+            const double radius = (bbox.get_max() - bbox.get_min()).get_length() * scale / 2.0;
+            job.screen_size = radius / gmath_max((center - camera_position).get_length() - radius, gmath_epsilon);
+            jobs.add(job);
+
+            RSResourceInfo proxy;
+            proxy.ptr = job.proxy;
+            proxy.type = RSResourceInfo::TYPE_MESH;
+            proxy.is_proxy = true;
+            m->scene.resources.index.add(job.resource_id, proxy);
+            m->scene.ptr->AddMesh(proxy.ptr);
+        } else {
+            converted.add(i);
         }
     }
-    // our geometries are now perfectly synched
-    m->geometries.dirty = false;
-}
-
-/*! \brief shading group synchronization helper */
-void
-sync_shading_groups(const R2cSceneDelegate& delegate, R2cItemId cinstancerid, RSInstancerInfo& rinstancer)
-{
-    // retreive the clarisse instancer
-    R2cItemDescriptor cinstancer = delegate.get_render_item(cinstancerid);
-    // since the redshift instancer is mimicing Clarisse, shading groups/material association are perfect match
-    unsigned int shading_group_offset = 0;
-    for (auto instancer : rinstancer.ptrs) {
-        for (unsigned int sgindex = 0; sgindex < instancer->GetNumMaterials(); sgindex++) {
-            const R2cShadingGroupInfo& shading_group = delegate.get_shading_group_info(cinstancerid, sgindex + shading_group_offset);
-            instancer->SetMaterial(sgindex, shading_group.get_material().is_null() ? RedshiftUtils::get_default_material() : static_cast<ModuleMaterialRedshift *>(shading_group.get_material().get_item()->get_module())->get_material());
+    m->translation.schedule(jobs);
+    if (converted.get_count() == 0) return;
+
+    // converting polygonal meshes is by far the most expensive part of the sync. Their descriptions are
+    // gathered in parallel since it only reads the Clarisse geometries while the Redshift meshes are
+    // created by this thread, the Redshift API not being documented as thread safe.
+    CoreVector<const GeometryObject *> converted_geometries(converted.get_count()); // polygonal geometry of each converted resource or nullptr
+    CoreVector<const GeometryObject *> polygonal_geometries(0, converted.get_count());
+    for (unsigned int i = 0; i < converted.get_count(); i++) {
+        converted_geometries[i] = RedshiftUtils::GetPolygonalGeometry(*get_scene_delegate(), new_geometries[converted[i]]);
+        if (converted_geometries[i] != nullptr) polygonal_geometries.add(converted_geometries[i]);
+    }
+    CoreArray<RSMesh *> polygonal_meshes;
+    CoreArray<unsigned long long> polygonal_bytes(polygonal_geometries.get_count());
+    RedshiftUtils::CreatePolygonalMeshes(polygonal_geometries.get_count(), [&](const unsigned int& index, PolymeshDescription& description) {
+        RedshiftUtils::DescribePolygonalMesh(*polygonal_geometries[index], description);
+        polygonal_bytes[index] = RedshiftUtils::EstimatePolygonalMeshSize(description.polygon_vertex_ids.get_count(), description.polygon_vertex_count.get_count());
+    }, RedshiftUtils::get_default_material(), polygonal_meshes);
+
+    // registering resources serially in the insertion order of their geometries. Their refcount
+    // is incremented by the geometries instanciating them when they get synched.
+    unsigned int polygonal_mesh = 0;
+    for (unsigned int i = 0; i < converted.get_count(); i++) {
+        RSResourceInfo resource;
+        if (converted_geometries[i] != nullptr) {
+            resource.bytes = polygonal_bytes[polygonal_mesh];
+            resource.ptr = polygonal_meshes[polygonal_mesh++];
+            resource.type = RSResourceInfo::TYPE_MESH;
+        } else {
+            create_resource(*get_scene_delegate(), new_geometries[converted[i]], resource);
         }
-        shading_group_offset += instancer->GetNumMaterials();
+        resource.refcount = 0;
+        m->scene.resources.index.add(new_resources[converted[i]], resource);
+        m->scene.ptr->AddMesh(resource.ptr);
     }
 }
 
 void
-RedshiftRenderDelegate::_sync_instancer(R2cItemId cinstancerid, RSInstancerInfo& rinstancer, const bool& is_new)
+RedshiftRenderDelegate::defer_geometries()
 {
-    if (rinstancer.dirtiness & R2cSceneDelegate::DIRTINESS_GEOMETRY) {
-        if (!is_new) { // existing instancer
-            // mark as removed since we will need to recreate it
-            m->instancers.removed.add(cinstancerid);
-            // reinsert the removed instancer so it is added after the cleanup
-            m->instancers.inserted.add(cinstancerid);
-            // mark it as clean since we will rebuild it anyway
-            rinstancer.dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
-        } else { // it's a new instancer and let's create its resources
-            RedshiftUtils::CreateInstancer(rinstancer, m->resources.index, *get_scene_delegate(), m->scene, cinstancerid);
+    // deferred geometries are only tested again when the frustum or the preview settings changed
+    const bool is_preview_dirty = m->preview.is_dirty;
+    m->preview.is_dirty = false;
+    CoreVector<R2cItemId>& inserted_geometries = m->scene.geometries.inserted;
+    if (inserted_geometries.get_count() == 0 && (!is_preview_dirty || m->deferred.geometries.get_count() == 0)) return;
+
+    const R2cSceneDelegate& delegate = *get_scene_delegate();
+    auto is_visible = [&](R2cItemId geometry) {
+        ModuleSceneObject *module = static_cast<ModuleSceneObject *>(delegate.get_render_item(geometry).get_item()->get_module());
+        return m->preview.frustum.intersects(module->get_bbox(), delegate.get_transform(geometry));
+    };
+
+    // the camera may have revealed deferred geometries or the preview mode may be disabled
+    CoreVector<R2cItemId> inserted(0, inserted_geometries.get_count() + m->deferred.geometries.get_count());
+    CoreVector<R2cItemId> revealed;
+    if (is_preview_dirty) {
+        for (auto deferred : m->deferred.geometries) {
+            if (!m->preview.enabled || is_visible(deferred.get_key())) {
+                revealed.add(deferred.get_key());
+                inserted.add(deferred.get_key());
+                m->deferred.bytes -= deferred.get_value();
+            }
         }
+        for (auto geometry : revealed) m->deferred.geometries.remove(geometry);
     }
 
-    if (rinstancer.dirtiness & R2cSceneDelegate::DIRTINESS_KINEMATIC) {
-        const GMathMatrix4x4d& transform = get_scene_delegate()->get_transform(cinstancerid);
-        for (auto ptc : rinstancer.ptrs) ptc->SetMatrix(RedshiftUtils::ToRSMatrix4x4(transform));
-    }
-
-    if (rinstancer.dirtiness & R2cSceneDelegate::DIRTINESS_SHADING_GROUP) {
-        sync_shading_groups(*get_scene_delegate(), cinstancerid, rinstancer);
+    for (auto geometry : inserted_geometries) {
+        if (!m->preview.enabled || is_visible(geometry)) {
+            inserted.add(geometry);
+        } else {
+            const unsigned long long bytes = RedshiftUtils::EstimateGeometrySize(delegate, geometry);
+            m->deferred.geometries.add(geometry, bytes);
+            m->deferred.bytes += bytes;
+        }
     }
+    inserted_geometries = inserted;
 
-    if (rinstancer.dirtiness & R2cSceneDelegate::DIRTINESS_VISIBILITY) {
-        const bool visibility = get_scene_delegate()->get_visible(cinstancerid);
-        for (auto ptc : rinstancer.ptrs) ptc->SetCachedMeshFlags(visibility ? RS_CachedMeshFlag_GetDefault() : RS_CachedMeshFlag_Hidden());
+    if (m->deferred.geometries.get_count() != m->preview.reported_count) {
+        m->preview.reported_count = m->deferred.geometries.get_count();
+        LOG_INFO("Redshift preview: " << m->preview.reported_count << " geometries (" << m->deferred.bytes / (1024 * 1024) << " MB) deferred outside of the camera frustum\n");
     }
-    // setting the dirtiness back to none since the instancer is synched
-    rinstancer.dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
 }
 
-void
-RedshiftRenderDelegate::sync_instancers(CleanupFlags& cleanup)
+unsigned int
+RedshiftRenderDelegate::get_deferred_geometry_count() const
 {
-    if (m->instancers.is_dirty()) {
-        // iterating through instancers to see if we need to sync any of them
-        // it's VERY IMPORTANT to do this before everything else since if any
-        // items received DIRTINESS_GEOMETRY, we need to remove it from the
-        // scene to rebuild it!!!
-        for (auto instancer : m->instancers.index) {
-            if (instancer.get_value().dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
-                sync_instancer(instancer.get_key(), instancer.get_value());
-            }
-        }
-        // check if instancers have been removed and in that case we will have to
-        // rebuild the render scene since we can't remove items from the scene using
-        // the Redshift API
-
-        cleanup.point_clouds |= m->instancers.removed.get_count() > 0;
-
-        // let's see if we have to remove instancers from the scene
-        for (auto removed_item : m->instancers.removed) {
-            RSInstancerInfo *instancer = m->instancers.index.is_key_exists(removed_item);
-            // check the current instancer exists in the scene
-            if (instancer != nullptr) {
-                // removing all point clouds representing the current instancer
-                for (unsigned int i = 0; i < instancer->ptrs.get_count(); i++) RS_PointCloud_Delete(instancer->ptrs[i]);
-                // now doing proper cleanup. Let's cleanup resources
-                // get the resources if they exist
-
-                for (unsigned int i = 0; i < instancer->resources.get_count(); i++) {
-                    R2cResourceId resource_id = instancer->resources[i];
-                    RSResourceInfo *stored_resource = m->resources.index.is_key_exists(resource_id);
-                    if (stored_resource != nullptr) { // there's a resource bound to the current instancer
-                        stored_resource->refcount--;
-                        if (stored_resource->refcount == 0) { // no one is using that resource anymore so let's delete it
-                            RS_MeshBase_Delete(stored_resource->ptr);
-                            m->resources.index.remove(resource_id);
-                            switch(stored_resource->type) {
-                                case RSResourceInfo::TYPE_POINT_CLOUD: // spheres are point clouds....
-                                    cleanup.point_clouds |= true;
-                                    break;
-                                case RSResourceInfo::TYPE_HAIR:
-                                    cleanup.hairs |= true;
-                                    break;
-                                default:
-                                    cleanup.meshes |= true;
-                                    break;
-                            }
-                        }
-                    }
-                }
-                m->instancers.index.remove(removed_item);
-                if (m->instancers.index.get_count() == 0) break; // finished
-            }
-        }
-        // since we processed all pending removed instancers we have to clear our array
-        m->instancers.removed.remove_all();
-
-        // let's see if new instancers have been added. Interestingly it's possible
-        // that sync_instancers remove and add items if the topology changes. This
-        // is why it is very important to first sync the index, remove and finally add.
-        // let's see if we have to create new geometries
-        RSInstancerInfo instancer;
-        CoreVector<RSInstancerInfo> new_instancers(0, m->instancers.inserted.get_count());
-        for (auto inserted_item : m->instancers.inserted) {
-            // initializing the new instancer
-            instancer.ptrs.remove_all();
-            instancer.resources.remove_all();
-            // since we create them we need to make them as fully dirty
-            instancer.dirtiness = R2cSceneDelegate::DIRTINESS_ALL;
-            // synching the new instancer
-            sync_new_instancer(inserted_item, instancer);
-            // adding it to our instancer index
-            m->instancers.index.add(inserted_item, instancer);
-            new_instancers.add(instancer);
-        }
-        // since we processed all pending inserted instancers we have to clear the array
-        m->instancers.inserted.remove_all();
-
-        if (!cleanup.point_clouds) {
-            // we can just add new geometries to the scene since they are already synched!
-            for (auto new_instancer : new_instancers) {
-                for (auto point_cloud : new_instancer.ptrs) {
-                    m->scene->AddMeshPointCloud(point_cloud);
-                }
-            }
-        }
-    }
-    // our instancers are now perfectly synched
-    m->instancers.dirty = false;
+    return m->deferred.geometries.get_count();
 }
 
-/*! \brief light synchronization helper */
-void
-sync_light(const R2cSceneDelegate& delegate, R2cItemId clightid, RSLightInfo& rlight)
+unsigned long long
+RedshiftRenderDelegate::get_deferred_geometry_bytes() const
 {
-    if (rlight.dirtiness & R2cSceneDelegate::DIRTINESS_KINEMATIC) {
-        rlight.ptr->SetMatrix(RedshiftUtils::ToRSMatrix4x4(delegate.get_transform(clightid)));
-    }
-
-    if (rlight.dirtiness & R2cSceneDelegate::DIRTINESS_LIGHT) {
-        OfObject *clight = delegate.get_render_item(clightid).get_item();
-        // synching light's attributes only
-        OfAttr *color = clight->attribute_exists("color");
-        rlight.shader->BeginUpdate();
-        rlight.shader->SetParameterData("color", color != nullptr ? RedshiftUtils::ToRSColor(color->get_vec3d()) : RSColor(1.0,1.0,1.0));
-
-        OfAttr *radius = clight->attribute_exists("radius");
-        if (radius != nullptr) {
-            float value =  static_cast<float>(radius->get_double());
-            rlight.ptr->SetAreaScaling(RSVector3(value, value, value));
-        }
-        rlight.shader->EndUpdate();
-    }
-    // setting the dirtiness back to none since the light is synched
-    rlight.dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
+    return m->deferred.bytes;
 }
 
 void
-RedshiftRenderDelegate::sync_lights(CleanupFlags& cleanup)
+RedshiftRenderDelegate::swap_proxies()
 {
-    if (m->lights.is_dirty()) {
-        cleanup.lights = m->lights.removed.get_count() > 0;
-        // remove lights first
-        for (auto removed_item : m->lights.removed) {
-            RSLightInfo *light = m->lights.index.is_key_exists(removed_item);
-            // check the current light exists in the scene
-            if (light != nullptr) {
-                RS_Light_Delete(light->ptr);
-                RS_ShaderNode_Release(light->shader);
-                m->lights.index.remove(removed_item);
-                if (m->lights.index.get_count() == 0) break; // finished
-            }
-        }
-        m->lights.removed.remove_all();
-
-        // creating new lights
-        RSLightInfo light;
-        CoreVector<RSLightInfo> new_lights(0, m->lights.inserted.get_count());
-        for (auto inserted_item : m->lights.inserted) {
-            // create corresponding light according to the Clarisse light
-            RedshiftUtils::CreateLight(*get_scene_delegate(), inserted_item, light);
-            light.dirtiness = R2cSceneDelegate::DIRTINESS_ALL;
-            // and sync it to its attributes
-            // synching the new light
-            sync_light(*get_scene_delegate(), inserted_item, light);
-            // adding it to our light index
-            m->lights.index.add(inserted_item, light);
-            new_lights.add(light);
-        }
-        m->lights.inserted.remove_all();
-
-        if (!cleanup.lights) {
-            // we can just add new lights since they are already synched!
-            for (auto new_light : new_lights) {
-               m->scene->AddLight(new_light.ptr);
-            }
+    // creating the Redshift meshes is bounded in time so that the sync stays responsive,
+    // the remaining descriptions are collected by the next sync
+    const auto start = std::chrono::steady_clock::now();
+    CoreHashTable<R2cResourceId, RSMeshBase *> swapped;
+    ProgressiveTranslation::Job job;
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < s_swap_budget && m->translation.collect(job)) {
+        RSResourceInfo *resource = m->scene.resources.index.is_key_exists(job.resource_id);
+        // the resource may have been removed or created again in the meantime
+        if (job.description == nullptr || resource == nullptr || resource->ptr != job.proxy) continue;
+
+        RSMesh *mesh = RedshiftUtils::CreatePolygonalMesh(*job.description, RedshiftUtils::get_default_material());
+        // the proxy is buried since it stays in the render scene until it is compacted
+        RSResourceInfo proxy = *resource;
+        proxy.refcount = 0;
+        proxy.bytes = 0;
+        m->scene.tombstones.resources.add(proxy);
+        resource->ptr = mesh;
+        resource->is_proxy = false;
+        resource->bytes = RedshiftUtils::EstimatePolygonalMeshSize(job.description->polygon_vertex_ids.get_count(), job.description->polygon_vertex_count.get_count());
+        m->scene.ptr->AddMesh(mesh);
+        swapped.add(job.resource_id, mesh);
+    }
+    if (swapped.get_count() == 0) return;
+
+    // binding the instances of the swapped resources to their actual mesh in place
+    for (auto geometry : m->scene.geometries.index) {
+        RSGeometryInfo& rgeometry = geometry.get_value();
+        RSMeshBase **mesh = swapped.is_key_exists(rgeometry.resource);
+        if (mesh != nullptr) {
+            rgeometry.materials->SetTemplate(*mesh);
+            rgeometry.materials->SetNumMaterials((*mesh)->GetNumMaterials());
+            rgeometry.ptr->SetTemplate(*mesh, rgeometry.materials_index);
+            m->scene.dirty_geometry(geometry.get_key(), R2cSceneDelegate::DIRTINESS_SHADING_GROUP);
         }
-        // iterating through lights to see if we need to sync any of them
-        for (auto light : m->lights.index) {
-            if (light.get_value().dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
-                sync_light(*get_scene_delegate(), light.get_key(), light.get_value());
+    }
+    // instancers which picked a proxy are simply created again
+    for (auto instancer : m->scene.instancers.index) {
+        for (auto resource : instancer.get_value().resources) {
+            if (swapped.is_key_exists(resource) != nullptr) {
+                m->scene.dirty_instancer(instancer.get_key(), R2cSceneDelegate::DIRTINESS_GEOMETRY);
+                break;
             }
         }
     }
-    // our lights are now perfectly synched
-    m->lights.dirty = false;
 }
 
 void
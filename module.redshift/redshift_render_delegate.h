@@ -9,7 +9,6 @@
 
 class RSDelegateImpl;
 class RSGeometryInfo;
-class RSInstancerInfo;
 
 /*! \class RedshiftRenderDelegate
  *  \brief This class implements a Redshift render delegate to Clarisse
@@ -22,15 +21,6 @@ class RSInstancerInfo;
 class RedshiftRenderDelegate : public R2cRenderDelegate {
 public:
 
-    struct CleanupFlags { //!< Defines cleanup info used to cleanup the scene after a sync
-        CleanupFlags() : hairs(false), point_clouds(false), meshes(false), mesh_instances(false) {}
-        bool hairs; //!< true if curve/mesh geometry have been removed from the scene
-        bool point_clouds; //!< true if point clouds geometry have been removed from the scene
-        bool meshes; //!< true if meshes have been removed from the scene
-        bool mesh_instances; //!< true if mesh instances have been removed from the scene
-        bool lights; //!< true if lights have been removed from the scene
-    };
-
     RedshiftRenderDelegate();
     virtual ~RedshiftRenderDelegate() override;
 
@@ -48,14 +38,28 @@ public:
     void remove_instancer(R2cItemDescriptor item) override;
     void dirty_instancer(R2cItemDescriptor item, const int& dirtiness) override;
 
+    void dirty_render_settings(R2cItemDescriptor item, const OfAttr *attr) override;
+
     void render(R2cRenderBuffer *render_buffer, const float& sampling_quality) override;
     float get_render_progress() const override;
+    bool is_refresh_needed() const override;
+    bool is_deformation_supported() const override { return true; }
+    /*! \brief Abort the passes in progress in interactive mode since the scene has been modified
+     *  \note Modifications are recorded with the lock of the interactive render held so that they aren't synchronized concurrently */
+    void interrupt_render() override;
+    /*! \brief Drop the background conversion of the resource of a modified geometry, which may be released before the next sync */
+    void interrupt_geometry(R2cItemDescriptor item) override;
 
     void get_supported_cameras(CoreVector<CoreString>& supported_cameras, CoreVector<CoreString>& unsupported_cameras) const override;
     void get_supported_lights(CoreVector<CoreString>& supported_lights, CoreVector<CoreString>& unsupported_lights) const override;
     void get_supported_materials(CoreVector<CoreString>& supported_materials, CoreVector<CoreString>& unsupported_materials) const override;
     void get_supported_geometries(CoreVector<CoreString>& supported_geometries, CoreVector<CoreString>& unsupported_geometries) const override;
 
+    /*! \brief Return the number of geometries which aren't translated since they are outside of the camera frustum in preview mode */
+    unsigned int get_deferred_geometry_count() const;
+    /*! \brief Return an estimate of the size in bytes of the meshes of the deferred geometries */
+    unsigned long long get_deferred_geometry_bytes() const;
+
 	ModuleMaterial * get_default_material() const override;
 	ModuleMaterial * get_error_material() const override;
 
@@ -76,43 +80,43 @@ private:
     void sync();
     /*! \brief Synchronize the render settings */
     bool sync_render_settings(const float& sampling_quality);
-
-    /*! \brief Add a new geometry (never been processed yet) to the render scene and synchronize it
-     *  \param cgeometryid id of the new geometry in the scene delegate
-     *  \param rgeometry redshift geometry handle */
-    void sync_new_geometry(R2cItemId cgeometryid, RSGeometryInfo& rgeometry) { _sync_geometry(cgeometryid, rgeometry, true); }
-    /*! \brief Synchronize an existing render geometry with the one defined in the scene delegate
-     *  \param cgeometryid id of the geometry in the scene delegate
-     *  \param rgeometry redshift geometry handle */
-    void sync_geometry(R2cItemId cgeometryid, RSGeometryInfo& rgeometry) { _sync_geometry(cgeometryid, rgeometry, false); }
-    /*! \brief Actual implementation of geometry synchronization whereas it is a new or an existing one
+    /*! \brief Render the passes of the synchronized render scene on the calling thread */
+    void render_scene();
+    /*! \brief Synchronize the render scene and restart its passes in the background if the scene or the view has been modified,
+     *         then copy the latest image of the passes to the render buffer without waiting for them */
+    void render_interactive(R2cRenderBuffer& render_buffer, const unsigned int& w, const unsigned int& h, const float& sampling_quality);
+    /*! \brief Synchronize the render settings and the camera and create what the render needs
+     *  \return false if the scene can't be rendered */
+    bool prepare_render(const unsigned int& w, const unsigned int& h, const float& sampling_quality);
+    /*! \brief Return true if the render settings enable the interactive mode */
+    bool is_interactive() const;
+    /*! \brief Return true if the camera, the size of the image or the sampling quality changed since the passes were started */
+    bool is_view_modified(const unsigned int& w, const unsigned int& h, const float& sampling_quality) const;
+    /*! \brief Store the view the passes are started with */
+    void store_view(const unsigned int& w, const unsigned int& h, const float& sampling_quality);
+
+    /*! \brief Update in place the resource of a geometry whose points moved without changing its topology
      *  \param cgeometryid id of the geometry in the scene delegate
      *  \param rgeometry redshift geometry definition handle
-     *  \param is_new set whether the input geometry is new or existing (there are two different codepaths) */
-    void _sync_geometry(R2cItemId cgeometryid, RSGeometryInfo& rgeometry, const bool& is_new);
-    /*! \brief Synchronize all needed geometries with the render scene
-     *  \param cleanup output cleanup flags to do post cleanup with the render scene */
-    void sync_geometries(CleanupFlags& cleanup);
-
-    /*! \brief Add a new instancer (never been processed yet) to the render scene and synchronize it
-     *  \param cinstancerid id of the new instancer in the scene delegate
-     *  \param rinstancer redshift instancer definition handle */
-    inline void sync_new_instancer(R2cItemId cinstancerid, RSInstancerInfo& rinstancer) { _sync_instancer(cinstancerid, rinstancer, true); }
-    /*! \brief Synchronize an existing instancer with the one defined in the scene delegate
-     *  \param cinstancerid id of the instancer in the scene delegate
-     *  \param rinstancer redshift instancer definition handle */
-    inline void sync_instancer(R2cItemId cinstancerid, RSInstancerInfo& rinstancer) { _sync_instancer(cinstancerid, rinstancer, false); }
-    /*! \brief Actual implementation of instancer synchronization whereas it is a new or an existing one
-     *  \param cinstancerid id of the instancer in the scene delegate
-     *  \param rinstancer redshift geometry definition handle
-     *  \param is_new set whether the input instancer is new or existing (there are two different codepaths) */
-    void _sync_instancer(R2cItemId cinstancerid, RSInstancerInfo& rinstancer, const bool& is_new);
-    /*! \brief Synchronize all needed instancers with the render scene
-     *  \param cleanup output cleanup flags to do post cleanup with the render scene */
-    void sync_instancers(CleanupFlags& cleanup);
-    /*! \brief Synchronize the render scene lights with the scene delegate
-     *  \param cleanup output cleanup flags to do post cleanup with the render scene */
-    void sync_lights(CleanupFlags& cleanup);
+     *  \return false if the geometry must be created again */
+    bool deform_geometry(R2cItemId cgeometryid, RSGeometryInfo& rgeometry);
+    /*! \brief Create in parallel the Redshift resources of the specified geometries which don't exist yet
+     *  \param geometries ids of the geometries in the scene delegate
+     *  \note Resources are registered to the render scene in the order of the input geometries */
+    void create_geometry_resources(const CoreVector<R2cItemId>& geometries);
+    /*! \brief Return the id of the resource of a geometry in the resource index
+     *  \param cgeometryid id of the geometry in the scene delegate
+     *  \note Parametric primitives with the same key share a single resource whatever their Clarisse resource */
+    R2cResourceId get_resource_id(R2cItemId cgeometryid);
+    /*! \brief In preview mode, move the inserted geometries outside of the camera frustum to the deferred ones
+     *         and insert back the deferred geometries revealed by the camera */
+    void defer_geometries();
+    /*! \brief Replace the bounding box proxies of the resources gathered in the background by their actual mesh
+     *  \note Meshes are created within a time budget, the remaining ones are swapped by the next syncs */
+    void swap_proxies();
+    /*! \brief Stop converting the resource of a geometry if it is a proxy which is about to be released
+     *  \param rgeometry redshift geometry definition handle */
+    void discard_proxy(const RSGeometryInfo& rgeometry);
     /*! \brief Synchronize the render camera with the scene delegate
      *  \param w width of the rendered image
      *  \param h hight of the rendered image
@@ -123,11 +127,7 @@ private:
     void sync_camera(const unsigned int& w, const unsigned int& h,
                      const unsigned int& cox, const unsigned int& coy,
                      const unsigned int& cw, const unsigned int& ch);
-    /*! \brief Cleanup the render scene according to the specified flags
-     *  \note This post cleanup is there to rebuild the render scene since redshift can only
-     *        add new items not remove them. We are then obliged to remove the corresponding
-              item collections (mesh, lights...) if an item has been removed from the scene. */
-    void cleanup_scene(const CleanupFlags& cleanup);
+    friend class RSDelegateSceneSource;
 
     RSDelegateImpl *m; // private implementation
     DECLARE_CLASS
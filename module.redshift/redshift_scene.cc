@@ -0,0 +1,621 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+#include <RS.h>
+
+#include "redshift_utils.h"
+
+/*! \brief Return the flags hiding the removed items which stay in the render scene until it is compacted */
+static RSCachedMeshFlags
+get_hidden_flags()
+{
+    static RSCachedMeshFlags hidden = RS_CachedMeshFlag_GetDefault();
+    static bool init = false;
+    if (!init) {
+        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_PRIMARYRAYVISIBLE", false);
+        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_AOCASTER", false);
+        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_SHADOWCASTER", false);
+        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_REFLECTIONVISIBLE", false);
+        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_REFRACTIONVISIBLE", false);
+        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_GIVISIBLE", false);
+        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_CAUSTICVISIBLE", false);
+        RS_CachedMeshFlag_Set(hidden, "MESHFLAG_FGVISIBLE", false);
+        init = true;
+    }
+    return hidden;
+}
+
+/*! \brief Delete a resource which isn't used by the render scene anymore and flag the scene accordingly */
+static void
+delete_resource(const RSResourceInfo& resource, RedshiftScene::CleanupFlags& cleanup)
+{
+    RS_MeshBase_Delete(resource.ptr);
+    delete resource.topology;
+    switch(resource.type) {
+        case RSResourceInfo::TYPE_POINT_CLOUD:
+            // point cloud resources such as spheres are registered as meshes like any other resource
+            cleanup.point_clouds |= true;
+            cleanup.meshes |= true;
+            break;
+        case RSResourceInfo::TYPE_HAIR:
+            cleanup.hairs |= true;
+            break;
+        default:
+            cleanup.meshes |= true;
+            break;
+    }
+}
+
+/*! \brief Move the material references of an item to the specified ones which are released later */
+static void
+retire_materials(CoreVector<unsigned int>& references, CoreVector<unsigned int>& retired)
+{
+    for (auto reference : references) retired.add(reference);
+    references.remove_all();
+}
+
+RedshiftScene::RedshiftScene()
+    : ptr(nullptr)
+    , point_cloud_count(0)
+    , compaction_ratio(0.25)
+    , compaction_max_removed_items(100000)
+    , compaction_max_removed_bytes(1024ull * 1024 * 1024)
+{
+    tombstones.bytes = 0;
+}
+
+RSGeometryInfo *
+RedshiftScene::remove_geometry(R2cItemId id)
+{
+    RSGeometryInfo *geometry = geometries.index.is_key_exists(id);
+    if (geometry != nullptr) { // make sure it is indeed in our index
+        geometries.removed.add(id);
+        geometry->dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
+    }
+    return geometry;
+}
+
+RSGeometryInfo *
+RedshiftScene::dirty_geometry(R2cItemId id, const int& dirtiness)
+{
+    RSGeometryInfo *geometry = geometries.index.is_key_exists(id);
+    if (geometry != nullptr) { // make sure it is indeed in our index
+        geometries.set_dirty(id, *geometry, dirtiness);
+    }
+    return geometry;
+}
+
+void
+RedshiftScene::remove_instancer(R2cItemId id)
+{
+    RSInstancerInfo *instancer = instancers.index.is_key_exists(id);
+    if (instancer != nullptr) { // make sure it is indeed in our index
+        instancers.removed.add(id);
+        instancer->dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
+    }
+}
+
+void
+RedshiftScene::dirty_instancer(R2cItemId id, const int& dirtiness)
+{
+    RSInstancerInfo *instancer = instancers.index.is_key_exists(id);
+    if (instancer != nullptr) { // make sure it is indeed in our index
+        instancers.set_dirty(id, *instancer, dirtiness);
+    }
+}
+
+void
+RedshiftScene::remove_light(R2cItemId id)
+{
+    if (lights.index.is_key_exists(id) != nullptr) { // make sure it is indeed in our index
+        lights.removed.add(id);
+    }
+}
+
+void
+RedshiftScene::dirty_light(R2cItemId id, const int& dirtiness)
+{
+    RSLightInfo *light = lights.index.is_key_exists(id);
+    if (light != nullptr) { // make sure it is indeed in our index
+        lights.set_dirty(id, *light, dirtiness);
+    }
+}
+
+void
+RedshiftScene::sync(RedshiftSceneSource& source)
+{
+    CleanupFlags cleanup;
+    sync_geometries(source, cleanup);
+    sync_instancers(source, cleanup);
+    compact_scene(source, cleanup);
+    sync_lights(source, cleanup);
+    // cleanup the scene in the event we removed items
+    cleanup_scene(cleanup);
+}
+
+void
+RedshiftScene::bury_resource(const R2cResourceId& resource_id)
+{
+    RSResourceInfo *stored_resource = resources.index.is_key_exists(resource_id);
+    if (stored_resource != nullptr) { // there's a resource bound to the removed item
+        stored_resource->refcount--;
+        if (stored_resource->refcount == 0) { // no one is using that resource anymore so let's bury it
+            tombstones.resources.add(*stored_resource);
+            tombstones.bytes += stored_resource->bytes;
+            resources.index.remove(resource_id);
+        }
+    }
+}
+
+void
+RedshiftScene::release_materials(RedshiftSceneSource& source)
+{
+    // materials which aren't referenced anymore are deleted
+    for (auto reference : tombstones.materials) source.release_material(reference);
+    tombstones.materials.remove_all();
+}
+
+void
+RedshiftScene::sync_geometry(RedshiftSceneSource& source, R2cItemId cgeometryid, RSGeometryInfo& rgeometry, const bool& is_new)
+{
+    if ((rgeometry.dirtiness & R2cSceneDelegate::DIRTINESS_DEFORMATION) && !(rgeometry.dirtiness & R2cSceneDelegate::DIRTINESS_GEOMETRY) && !is_new) {
+        // fast path when only the points moved. Otherwise fallback to recreating the geometry
+        if (!source.deform_geometry(*this, cgeometryid, rgeometry)) rgeometry.dirtiness |= R2cSceneDelegate::DIRTINESS_GEOMETRY;
+    }
+
+    if (rgeometry.dirtiness & R2cSceneDelegate::DIRTINESS_GEOMETRY) {
+        if (!is_new) {
+            // mark as removed since we will need to recreate it
+            geometries.removed.add(cgeometryid);
+            rgeometry.dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
+            // reinsert the removed geometry so it is added after the cleanup
+            geometries.inserted.add(cgeometryid);
+        } else {
+            // it's a new geometry whose resource has been created along with the other new ones if it didn't exist yet
+            const R2cResourceId resource_id = source.get_resource_id(cgeometryid);
+            RSResourceInfo *stored_resource = resources.index.is_key_exists(resource_id);
+            if (stored_resource == nullptr) {
+                CoreVector<R2cItemId> geometry(1);
+                geometry[0] = cgeometryid;
+                source.create_resources(*this, geometry);
+                stored_resource = resources.index.is_key_exists(resource_id);
+            }
+            RSMeshBase *mesh = stored_resource->ptr;
+            stored_resource->refcount++;
+
+            // generating the instance to the resource
+            rgeometry.ptr = RS_MeshInstance_New();
+            rgeometry.ptr->SetIsTransformationBlurred(false);
+            // we need to create the material overrides for the instance since we can freely assign
+            // materials to instances in Clarisse
+            rgeometry.materials = RS_InstanceMaterialOverrides_New();
+            rgeometry.materials->SetTemplate(mesh);
+            rgeometry.materials->SetNumMaterials(mesh->GetNumMaterials());
+            // back pointer to the clarisse resource since when we are dirty it's too late to get it back
+            rgeometry.resource = resource_id;
+
+            rgeometry.materials_index = ptr->AddInstanceMaterialOverride(rgeometry.materials);
+            rgeometry.ptr->SetTemplate(mesh, rgeometry.materials_index);
+            // since that was a new geometry we will need to set the matrix, materials and visibility flags
+            rgeometry.dirtiness = R2cSceneDelegate::DIRTINESS_KINEMATIC |
+                                  R2cSceneDelegate::DIRTINESS_SHADING_GROUP |
+                                  R2cSceneDelegate::DIRTINESS_VISIBILITY;
+        }
+    }
+
+    if (rgeometry.dirtiness & R2cSceneDelegate::DIRTINESS_KINEMATIC) {
+        rgeometry.ptr->SetMatrix(RedshiftUtils::ToRSMatrix4x4(source.get_transform(cgeometryid)));
+    }
+
+    if (rgeometry.dirtiness & R2cSceneDelegate::DIRTINESS_SHADING_GROUP) {
+        // previous materials are released later so that the ones still assigned aren't created again
+        retire_materials(rgeometry.material_references, tombstones.materials);
+        for (unsigned int i = 0; i < rgeometry.materials->GetNumMaterials(); i++) {
+            rgeometry.materials->SetMaterial(i, source.acquire_material(cgeometryid, i, rgeometry.material_references));
+        }
+    }
+
+    if (rgeometry.dirtiness & R2cSceneDelegate::DIRTINESS_VISIBILITY) {
+        rgeometry.ptr->SetCachedMeshFlags(source.get_visible(cgeometryid) ? RS_CachedMeshFlag_GetDefault() : get_hidden_flags());
+    }
+
+    // setting the dirtiness back to none since the geometry is fully synched
+    rgeometry.dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
+}
+
+void
+RedshiftScene::sync_geometries(RedshiftSceneSource& source, CleanupFlags& cleanup)
+{
+    // synching the geometries which received dirtiness. Only these ones are visited
+    // so the cost of the sync doesn't depend on the size of the scene.
+    // it's VERY IMPORTANT to do this before everything else since if any
+    // items received DIRTINESS_GEOMETRY, we need to remove it from the
+    // scene to rebuild it!!!
+    for (auto dirtied_item : geometries.dirtied) {
+        RSGeometryInfo *geometry = geometries.index.is_key_exists(dirtied_item);
+        // removed geometries are skipped since their dirtiness is reset
+        if (geometry != nullptr && geometry->dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
+            sync_geometry(source, dirtied_item, *geometry, false);
+        }
+    }
+    // our geometries are now perfectly synched
+    geometries.dirtied.remove_all();
+
+    // let's see if we have to remove geometries from the scene. Since we can't remove
+    // items from the scene using the Redshift API, removed geometries are hidden and
+    // kept as tombstones until the scene gets compacted
+    for (auto removed_item : geometries.removed) {
+        RSGeometryInfo *geometry = geometries.index.is_key_exists(removed_item);
+        // check the current geometry exists in the scene
+        if (geometry != nullptr) {
+            bury_resource(geometry->resource);
+            geometry->ptr->SetCachedMeshFlags(get_hidden_flags());
+            retire_materials(geometry->material_references, tombstones.materials);
+            tombstones.geometries.add(*geometry);
+
+            geometries.index.remove(removed_item);
+            if (geometries.index.get_count() == 0) break; // finished
+        }
+    }
+    // since we processed all pending removed geometries we have to clear our array
+    geometries.removed.remove_all();
+
+    // let's see if new geometries have been added. Interestingly it's possible
+    // that sync_geometry remove and add items if the topology changes. This
+    // is why it is very important to first sync the index, remove and finally add.
+    // The source may keep some of them aside or add ones it kept aside before.
+    source.filter_inserted_geometries(*this);
+    if (geometries.inserted.get_count() == 0) return;
+    // first convert all the new resources at once
+    source.create_resources(*this, geometries.inserted);
+
+    RSGeometryInfo geometry;
+    CoreVector<RSGeometryInfo> new_geometries(0, geometries.inserted.get_count());
+    for (auto inserted_item : geometries.inserted) {
+        // initializing the new geometry
+        geometry.ptr = nullptr;
+        geometry.material_references.remove_all();
+        geometry.dirtiness = R2cSceneDelegate::DIRTINESS_ALL;
+        // synching the new geometry
+        sync_geometry(source, inserted_item, geometry, true);
+        // adding it to our geometry index
+        geometries.index.add(inserted_item, geometry);
+        new_geometries.add(geometry);
+    }
+    // since we processed all pending inserted geometries we have to clear the array
+    geometries.inserted.remove_all();
+
+    if (!cleanup.mesh_instances) {
+        // we can just add new geometries to the scene since they are already synched!
+        for (auto new_geometry : new_geometries) {
+           ptr->AddMeshInstance(new_geometry.ptr);
+        }
+    }
+}
+
+void
+RedshiftScene::sync_instancer(RedshiftSceneSource& source, R2cItemId cinstancerid, RSInstancerInfo& rinstancer, const bool& is_new)
+{
+    if (rinstancer.dirtiness & R2cSceneDelegate::DIRTINESS_GEOMETRY) {
+        if (!is_new) { // existing instancer
+            // mark as removed since we will need to recreate it
+            instancers.removed.add(cinstancerid);
+            // reinsert the removed instancer so it is added after the cleanup
+            instancers.inserted.add(cinstancerid);
+            // mark it as clean since we will rebuild it anyway
+            rinstancer.dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
+        } else { // it's a new instancer and let's create its resources
+            source.create_instancer(*this, cinstancerid, rinstancer);
+        }
+    }
+
+    if (rinstancer.dirtiness & R2cSceneDelegate::DIRTINESS_KINEMATIC) {
+        const RSMatrix4x4 transform = RedshiftUtils::ToRSMatrix4x4(source.get_transform(cinstancerid));
+        for (auto ptc : rinstancer.ptrs) ptc->SetMatrix(transform);
+    }
+
+    if (rinstancer.dirtiness & R2cSceneDelegate::DIRTINESS_SHADING_GROUP) {
+        retire_materials(rinstancer.material_references, tombstones.materials);
+        // since the redshift instancer is mimicing Clarisse, shading groups/material association are perfect match
+        unsigned int shading_group_offset = 0;
+        for (auto instancer : rinstancer.ptrs) {
+            for (unsigned int sgindex = 0; sgindex < instancer->GetNumMaterials(); sgindex++) {
+                instancer->SetMaterial(sgindex, source.acquire_material(cinstancerid, sgindex + shading_group_offset, rinstancer.material_references));
+            }
+            shading_group_offset += instancer->GetNumMaterials();
+        }
+    }
+
+    if (rinstancer.dirtiness & R2cSceneDelegate::DIRTINESS_VISIBILITY) {
+        const bool visibility = source.get_visible(cinstancerid);
+        for (auto ptc : rinstancer.ptrs) ptc->SetCachedMeshFlags(visibility ? RS_CachedMeshFlag_GetDefault() : get_hidden_flags());
+    }
+    // setting the dirtiness back to none since the instancer is synched
+    rinstancer.dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
+}
+
+void
+RedshiftScene::sync_instancers(RedshiftSceneSource& source, CleanupFlags& cleanup)
+{
+    if (!instancers.is_dirty()) return;
+    // synching the instancers which received dirtiness
+    // it's VERY IMPORTANT to do this before everything else since if any
+    // items received DIRTINESS_GEOMETRY, we need to remove it from the
+    // scene to rebuild it!!!
+    for (auto dirtied_item : instancers.dirtied) {
+        RSInstancerInfo *instancer = instancers.index.is_key_exists(dirtied_item);
+        // removed instancers are skipped since their dirtiness is reset
+        if (instancer != nullptr && instancer->dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
+            sync_instancer(source, dirtied_item, *instancer, false);
+        }
+    }
+    // our instancers are now perfectly synched
+    instancers.dirtied.remove_all();
+
+    // let's see if we have to remove instancers from the scene. Like geometries, they
+    // are hidden and kept as tombstones until the scene gets compacted
+    for (auto removed_item : instancers.removed) {
+        RSInstancerInfo *instancer = instancers.index.is_key_exists(removed_item);
+        // check the current instancer exists in the scene
+        if (instancer != nullptr) {
+            // hiding all point clouds representing the current instancer
+            for (unsigned int i = 0; i < instancer->ptrs.get_count(); i++) {
+                instancer->ptrs[i]->SetCachedMeshFlags(get_hidden_flags());
+                tombstones.point_clouds.add(instancer->ptrs[i]);
+            }
+            point_cloud_count -= instancer->ptrs.get_count();
+            tombstones.bytes += instancer->bytes;
+            retire_materials(instancer->material_references, tombstones.materials);
+            // releasing the resources of its prototypes
+            for (unsigned int i = 0; i < instancer->resources.get_count(); i++) bury_resource(instancer->resources[i]);
+            instancers.index.remove(removed_item);
+            if (instancers.index.get_count() == 0) break; // finished
+        }
+    }
+    // since we processed all pending removed instancers we have to clear our array
+    instancers.removed.remove_all();
+
+    // let's see if new instancers have been added. Interestingly it's possible
+    // that sync_instancers remove and add items if the topology changes. This
+    // is why it is very important to first sync the index, remove and finally add.
+    RSInstancerInfo instancer;
+    CoreVector<RSInstancerInfo> new_instancers(0, instancers.inserted.get_count());
+    for (auto inserted_item : instancers.inserted) {
+        // initializing the new instancer
+        instancer.ptrs.remove_all();
+        instancer.resources.remove_all();
+        instancer.material_references.remove_all();
+        // since we create them we need to make them as fully dirty
+        instancer.dirtiness = R2cSceneDelegate::DIRTINESS_ALL;
+        // synching the new instancer
+        sync_instancer(source, inserted_item, instancer, true);
+        // adding it to our instancer index
+        instancers.index.add(inserted_item, instancer);
+        point_cloud_count += instancer.ptrs.get_count();
+        new_instancers.add(instancer);
+    }
+    // since we processed all pending inserted instancers we have to clear the array
+    instancers.inserted.remove_all();
+
+    if (!cleanup.point_clouds) {
+        // we can just add new instancers to the scene since they are already synched!
+        for (auto new_instancer : new_instancers) {
+            for (auto point_cloud : new_instancer.ptrs) {
+                ptr->AddMeshPointCloud(point_cloud);
+            }
+        }
+    }
+}
+
+void
+RedshiftScene::compact_scene(RedshiftSceneSource& source, CleanupFlags& cleanup)
+{
+    const unsigned int removed_count = tombstones.get_count();
+    if (removed_count == 0) {
+        // retired materials aren't used by any hidden item
+        release_materials(source);
+        return;
+    }
+
+    // the point clouds are counted as they are inserted and removed so that the scene isn't visited
+    const unsigned int live_count = geometries.index.get_count() + resources.index.get_count() + point_cloud_count;
+
+    // a few removed meshes can retain more memory than many removed instances
+    if (removed_count > compaction_max_removed_items || removed_count > compaction_ratio * live_count ||
+        tombstones.bytes > compaction_max_removed_bytes) {
+        // actually deleting removed items. The render scene will be rebuilt without them by cleanup_scene
+        for (auto geometry : tombstones.geometries) {
+            RS_MeshInstance_Delete(geometry.ptr);
+            RS_InstanceMaterialOverrides_Delete(geometry.materials);
+        }
+        cleanup.mesh_instances |= tombstones.geometries.get_count() > 0;
+        tombstones.geometries.remove_all();
+
+        for (auto point_cloud : tombstones.point_clouds) RS_PointCloud_Delete(point_cloud);
+        cleanup.point_clouds |= tombstones.point_clouds.get_count() > 0;
+        tombstones.point_clouds.remove_all();
+
+        for (auto resource : tombstones.resources) delete_resource(resource, cleanup);
+        tombstones.resources.remove_all();
+        tombstones.bytes = 0;
+
+        release_materials(source);
+    }
+}
+
+void
+RedshiftScene::sync_light(RedshiftSceneSource& source, R2cItemId clightid, RSLightInfo& rlight)
+{
+    if (rlight.dirtiness & R2cSceneDelegate::DIRTINESS_KINEMATIC) {
+        rlight.ptr->SetMatrix(RedshiftUtils::ToRSMatrix4x4(source.get_transform(clightid)));
+    }
+
+    if (rlight.dirtiness & R2cSceneDelegate::DIRTINESS_LIGHT) {
+        // synching light's attributes only
+        source.sync_light_attributes(clightid, rlight);
+    }
+    // setting the dirtiness back to none since the light is synched
+    rlight.dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
+}
+
+void
+RedshiftScene::sync_lights(RedshiftSceneSource& source, CleanupFlags& cleanup)
+{
+    if (!lights.is_dirty()) return;
+    cleanup.lights = lights.removed.get_count() > 0;
+    // remove lights first
+    for (auto removed_item : lights.removed) {
+        RSLightInfo *light = lights.index.is_key_exists(removed_item);
+        // check the current light exists in the scene
+        if (light != nullptr) {
+            RS_Light_Delete(light->ptr);
+            RS_ShaderNode_Release(light->shader);
+            lights.index.remove(removed_item);
+            if (lights.index.get_count() == 0) break; // finished
+        }
+    }
+    lights.removed.remove_all();
+
+    // creating new lights
+    RSLightInfo light;
+    CoreVector<RSLightInfo> new_lights(0, lights.inserted.get_count());
+    for (auto inserted_item : lights.inserted) {
+        // create corresponding light according to the scene light
+        source.create_light(inserted_item, light);
+        light.dirtiness = R2cSceneDelegate::DIRTINESS_ALL;
+        // synching the new light
+        sync_light(source, inserted_item, light);
+        // adding it to our light index
+        lights.index.add(inserted_item, light);
+        new_lights.add(light);
+    }
+    lights.inserted.remove_all();
+
+    if (!cleanup.lights) {
+        // we can just add new lights since they are already synched!
+        for (auto new_light : new_lights) {
+           ptr->AddLight(new_light.ptr);
+        }
+    }
+    // synching the lights which received dirtiness
+    for (auto dirtied_item : lights.dirtied) {
+        RSLightInfo *light = lights.index.is_key_exists(dirtied_item);
+        if (light != nullptr && light->dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
+            sync_light(source, dirtied_item, *light);
+        }
+    }
+    // our lights are now perfectly synched
+    lights.dirtied.remove_all();
+}
+
+void
+RedshiftScene::cleanup_scene(const CleanupFlags& cleanup)
+{
+    // since we can't remove geometries we must repopulate all geometries etc... :'(
+    if (cleanup.mesh_instances) {
+        ptr->ClearInstanceMaterialOverrides();
+        ptr->ClearMeshInstances();
+        // adding instances
+        for (auto geometry : geometries.index) {
+            RSGeometryInfo& geo = geometry.get_value();
+            geo.materials_index = ptr->AddInstanceMaterialOverride(geo.materials);
+            geo.ptr->SetTemplate(geo.materials->GetTemplate(), geo.materials_index);
+            ptr->AddMeshInstance(geometry.get_value().ptr);
+        }
+    }
+
+    if (cleanup.meshes) {
+        ptr->ClearMeshes();
+        // adding mesh resources
+        for (auto resource: resources.index) ptr->AddMesh(resource.get_value().ptr);
+    }
+
+    if (cleanup.point_clouds) {
+        ptr->ClearMeshPointClouds();
+        for (auto instancer: instancers.index) {
+            for (auto point_cloud : instancer.get_value().ptrs) {
+                ptr->AddMeshPointCloud(point_cloud);
+            }
+        }
+    }
+
+    if (cleanup.lights) {
+        ptr->ClearLights();
+        for (auto light : lights.index) ptr->AddLight(light.get_value().ptr);
+    }
+}
+
+void
+RedshiftScene::clear(RedshiftSceneSource& source)
+{
+    // !!! make sure to clear everything !!!
+    if (ptr == nullptr) return;
+    // clearing removed items
+    for (auto geometry : tombstones.geometries) {
+        RS_InstanceMaterialOverrides_Delete(geometry.materials);
+        RS_MeshInstance_Delete(geometry.ptr);
+    }
+    tombstones.geometries.remove_all();
+    for (auto point_cloud : tombstones.point_clouds) RS_PointCloud_Delete(point_cloud);
+    tombstones.point_clouds.remove_all();
+    for (auto resource : tombstones.resources) {
+        RS_MeshBase_Delete(resource.ptr);
+        delete resource.topology;
+    }
+    tombstones.resources.remove_all();
+    tombstones.bytes = 0;
+
+    // clearing instances
+    for (auto geometry : geometries.index) {
+        RSGeometryInfo& geo = geometry.get_value();
+        RS_InstanceMaterialOverrides_Delete(geo.materials);
+        RS_MeshInstance_Delete(geo.ptr);
+        retire_materials(geo.material_references, tombstones.materials);
+    }
+    geometries.index.remove_all();
+    geometries.removed.remove_all();
+    geometries.inserted.remove_all();
+    geometries.dirtied.remove_all();
+    ptr->ClearInstanceMaterialOverrides();
+    ptr->ClearMeshInstances();
+
+    // clearing meshes
+    for (auto resource: resources.index) {
+        RS_MeshBase_Delete(resource.get_value().ptr);
+        delete resource.get_value().topology;
+    }
+    ptr->ClearMeshes();
+    resources.index.remove_all();
+
+    // clearing point clouds
+    for (auto instancer: instancers.index) {
+        for (auto point_cloud : instancer.get_value().ptrs) {
+            RS_PointCloud_Delete(point_cloud);
+        }
+        retire_materials(instancer.get_value().material_references, tombstones.materials);
+    }
+    ptr->ClearMeshPointClouds(); // not really necessary since we called ClearMeshes()
+    instancers.index.remove_all();
+    point_cloud_count = 0;
+    instancers.removed.remove_all();
+    instancers.inserted.remove_all();
+    instancers.dirtied.remove_all();
+
+    // clearing lights
+    for (auto light : lights.index) {
+        RS_Light_Delete(light.get_value().ptr);
+        RS_ShaderNode_Release(light.get_value().shader);
+    }
+    lights.index.remove_all();
+    lights.removed.remove_all();
+    lights.inserted.remove_all();
+    lights.dirtied.remove_all();
+    ptr->ClearLights();
+
+    // materials are deleted once nothing references them anymore
+    release_materials(source);
+
+    RS_Scene_Delete(ptr);
+    ptr = nullptr;
+}
@@ -0,0 +1,248 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+#include "redshift_utils.h"
+
+#include <core_log.h>
+#include <core_set.h>
+#include <sys_thread_lock.h>
+
+#include <RS.h>
+
+#include <fstream>
+#include <thread>
+
+// Texture cache
+
+/*! \brief Redshift texture shared by all the shader parameters referencing the same file */
+struct CachedTexture {
+    RSTexture *texture;
+    unsigned int refcount; // number of shader parameters bound to the texture
+};
+
+/*! \brief Files bound to the texture parameters of a shader node */
+struct ShaderTextures {
+    CoreHashTable<unsigned int, CoreString> paths; // file path bound to each parameter index
+};
+
+/*! \brief Path keyed cache of Redshift textures so that a file referenced by many shaders is only requested once.
+ *         Files referenced by deferred shader updates are read on a background thread to be in the system cache by the time Redshift loads them. */
+struct TextureCache {
+    SysThreadLock lock;
+    CoreHashTable<CoreString, CachedTexture> textures;
+    CoreHashTable<RSShaderNode *, ShaderTextures> shaders;
+    CoreSet<CoreString> prefetched; // files queued for prefetching or read since the last flush of the shader updates
+    CoreVector<CoreString> prefetch_queue;
+    std::thread prefetcher; // reads the queued files, joined before starting a new one and when the module is unloaded
+    bool is_prefetching; // true while the prefetch thread is reading the queue
+    bool is_stopping; // true while the prefetch thread is asked to return without reading the rest of the queue
+    RedshiftUtils::TextureCacheStatistics statistics;
+    TextureCache() : is_prefetching(false), is_stopping(false) { statistics.hits = statistics.misses = statistics.bytes = 0; }
+};
+
+static TextureCache&
+get_texture_cache()
+{
+    // never destroyed since shaders may still release their textures when the module is unloaded
+    static TextureCache *cache = new TextureCache;
+    return *cache;
+}
+
+/*! \brief Stops the prefetch thread when the module is unloaded so that it doesn't outlive the code it runs */
+struct TexturePrefetchGuard {
+    ~TexturePrefetchGuard() { RedshiftUtils::stop_texture_prefetching(); }
+};
+
+static TexturePrefetchGuard texture_prefetch_guard;
+
+/*! \brief Read the queued files until the queue is empty or the prefetching is stopped. Runs on the prefetch thread of the cache. */
+static void
+prefetch_textures()
+{
+    TextureCache& cache = get_texture_cache();
+    CoreVector<char> buffer(1 << 20);
+    while (true) {
+        cache.lock.lock();
+        if (cache.prefetch_queue.get_count() == 0 || cache.is_stopping) {
+            cache.is_prefetching = false;
+            cache.lock.unlock();
+            return;
+        }
+        const CoreString path = cache.prefetch_queue[cache.prefetch_queue.get_count() - 1];
+        cache.prefetch_queue.remove_last();
+        cache.lock.unlock();
+
+        // the data is dropped, reading the file is enough to bring it in the system cache
+        unsigned long long bytes = 0;
+        std::ifstream file(path.get_data(), std::ios::binary);
+        while (file) {
+            file.read(&buffer[0], buffer.get_count());
+            bytes += static_cast<unsigned long long>(file.gcount());
+        }
+
+        cache.lock.lock();
+        cache.statistics.bytes += bytes;
+        cache.lock.unlock();
+    }
+}
+
+/*! \brief Queue the specified file for prefetching if it's neither cached nor already queued
+ *  \note Must be called with the lock of the cache held */
+static void
+queue_prefetch(TextureCache& cache, const CoreString& path)
+{
+    if (cache.is_stopping || path.is_empty() || cache.textures.is_key_exists(path) != nullptr) return;
+    unsigned int idx;
+    if (cache.prefetched.exists(path, idx)) return;
+    cache.prefetched.add(path);
+    cache.prefetch_queue.add(path);
+    if (!cache.is_prefetching) {
+        // the previous thread has emptied the queue and is returning, so joining it doesn't wait for any read
+        if (cache.prefetcher.joinable()) cache.prefetcher.join();
+        cache.is_prefetching = true;
+        cache.prefetcher = std::thread(prefetch_textures);
+    }
+}
+
+void
+RedshiftUtils::prefetch_texture(const CoreString& path)
+{
+    TextureCache& cache = get_texture_cache();
+    cache.lock.lock();
+    queue_prefetch(cache, path);
+    cache.lock.unlock();
+}
+
+/*! \brief Release a reference to a cached texture, the texture being released once no parameter is bound to it
+ *  \note Must be called with the lock of the cache held */
+static void
+release_cached_texture(TextureCache& cache, const CoreString& path)
+{
+    CachedTexture *cached = cache.textures.is_key_exists(path);
+    if (cached == nullptr) return;
+    if (--cached->refcount == 0) {
+        RS_Texture_Release(cached->texture);
+        cache.textures.remove(path);
+    }
+}
+
+/*! \brief Return the cached texture of the specified file after referencing it, loading the file if it isn't cached yet
+ *  \note Returns nullptr without caching anything if the file fails to load */
+static RSTexture *
+acquire_cached_texture(TextureCache& cache, const CoreString& path)
+{
+    cache.lock.lock();
+    CachedTexture *cached = cache.textures.is_key_exists(path);
+    if (cached != nullptr) {
+        cached->refcount++;
+        cache.statistics.hits++;
+        RSTexture *texture = cached->texture;
+        cache.lock.unlock();
+        return texture;
+    }
+    cache.statistics.misses++;
+    cache.lock.unlock();
+
+    // the file is loaded without holding the lock, which the prefetch thread takes between two files
+    RSTexture *loaded = RS_Texture_Get(path.get_data());
+    if (loaded == nullptr) return nullptr;
+    cache.lock.lock();
+    RSTexture *texture = loaded;
+    cached = cache.textures.is_key_exists(path);
+    if (cached != nullptr) { // the file has been cached by another binding meanwhile
+        cached->refcount++;
+        texture = cached->texture;
+    } else {
+        cache.textures.add(path, CachedTexture { loaded, 1 });
+        loaded = nullptr;
+        // the file is cached from now on so it won't be queued again
+        unsigned int idx;
+        if (cache.prefetched.exists(path, idx)) cache.prefetched.remove(idx);
+    }
+    cache.lock.unlock();
+    if (loaded != nullptr) RS_Texture_Release(loaded);
+    return texture;
+}
+
+RSTexture *
+RedshiftUtils::bind_texture(RSShaderNode& shader, const unsigned int& idx, const CoreString& path)
+{
+    TextureCache& cache = get_texture_cache();
+    // acquire before releasing the previous file in case it's the same one
+    RSTexture *texture = acquire_cached_texture(cache, path);
+    cache.lock.lock();
+    ShaderTextures *bound = cache.shaders.is_key_exists(&shader);
+    if (bound == nullptr) {
+        cache.shaders.add(&shader, ShaderTextures());
+        bound = cache.shaders.is_key_exists(&shader);
+    }
+    CoreString *previous = bound->paths.is_key_exists(idx);
+    if (previous != nullptr) release_cached_texture(cache, *previous);
+    if (texture == nullptr) { // the parameter isn't bound to any file, the file being loaded again if it's bound anew
+        if (previous != nullptr) bound->paths.remove(idx);
+    } else if (previous != nullptr) {
+        *previous = path;
+    } else {
+        bound->paths.add(idx, path);
+    }
+    cache.lock.unlock();
+    if (texture == nullptr) LOG_WARNING("RedshiftUtils.bind_texture: Failed to load the texture file " << path);
+    return texture;
+}
+
+void
+RedshiftUtils::release_shader_textures(RSShaderNode& shader)
+{
+    TextureCache& cache = get_texture_cache();
+    cache.lock.lock();
+    ShaderTextures *bound = cache.shaders.is_key_exists(&shader);
+    if (bound != nullptr) {
+        for (auto binding : bound->paths) release_cached_texture(cache, binding.get_value());
+        cache.shaders.remove(&shader);
+    }
+    cache.lock.unlock();
+}
+
+void
+RedshiftUtils::stop_texture_prefetching()
+{
+    TextureCache& cache = get_texture_cache();
+    cache.lock.lock();
+    cache.is_stopping = true;
+    // the files left in the queue will be prefetched again if they are referenced anew
+    for (auto path : cache.prefetch_queue) {
+        unsigned int idx;
+        if (cache.prefetched.exists(path, idx)) cache.prefetched.remove(idx);
+    }
+    cache.prefetch_queue.remove_all();
+    std::thread prefetcher = std::move(cache.prefetcher);
+    cache.lock.unlock();
+    // joined without holding the lock since the thread takes it to return
+    if (prefetcher.joinable()) prefetcher.join();
+    cache.lock.lock();
+    cache.is_stopping = false;
+    cache.lock.unlock();
+}
+
+void
+RedshiftUtils::forget_prefetched_textures()
+{
+    TextureCache& cache = get_texture_cache();
+    cache.lock.lock();
+    // only the files still queued are kept, so that the ones which were read but never bound don't pile up
+    cache.prefetched.remove_all();
+    for (auto path : cache.prefetch_queue) cache.prefetched.add(path);
+    cache.lock.unlock();
+}
+
+RedshiftUtils::TextureCacheStatistics
+RedshiftUtils::get_texture_cache_statistics()
+{
+    TextureCache& cache = get_texture_cache();
+    cache.lock.lock();
+    TextureCacheStatistics statistics = cache.statistics;
+    statistics.count = cache.textures.get_count();
+    cache.lock.unlock();
+    return statistics;
+}
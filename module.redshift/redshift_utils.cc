@@ -25,6 +25,23 @@
 
 #include <RS.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#ifdef CORE_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #define CLARISSE_SINK 0
 
@@ -32,7 +49,7 @@
 bool
 RenderingAbortChecker::ShouldAbort()
 {
-    return m_application.must_stop_evaluation();
+    return m_interrupted || (m_is_evaluation_bound && m_application.must_stop_evaluation());
 }
 
 void
@@ -42,7 +59,42 @@ RenderingProgress::DisplayProgress(const char *message, unsigned int percentage)
     m_progress = static_cast<float>(percentage) / 100.f;
 }
 
-RenderingBlockSink::RenderingBlockSink() : RSBlockSink(), m_render_buffer(nullptr)
+void
+RenderingFrameBuffer::resize(const unsigned int& width, const unsigned int& height)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (width == m_width && height == m_height) return;
+    m_width = width;
+    m_height = height;
+    m_pixels.resize(width * height * 4);
+    for (unsigned int i = 0; i < m_pixels.get_count(); i++) m_pixels[i] = 0.0f;
+}
+
+void
+RenderingFrameBuffer::fill_rgba_region(const float *rgba, const unsigned int& src_stride, const unsigned int& offset_x, const unsigned int& offset_y,
+                                       const unsigned int& width, const unsigned int& height)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (offset_x >= m_width || offset_y >= m_height) return;
+    // blocks of a previous size may still be output by the passes being aborted
+    const unsigned int w = std::min(width, m_width - offset_x);
+    const unsigned int h = std::min(height, m_height - offset_y);
+    for (unsigned int y = 0; y < h; y++) {
+        const float *src = rgba + static_cast<unsigned long long>(y) * src_stride * 4;
+        float *dst = m_pixels.get_data() + (static_cast<unsigned long long>(offset_y + y) * m_width + offset_x) * 4;
+        memcpy(dst, src, w * 4 * sizeof(float));
+    }
+}
+
+void
+RenderingFrameBuffer::copy_to(R2cRenderBuffer& render_buffer) const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (m_width == 0 || m_height == 0) return;
+    render_buffer.fill_rgba_region(m_pixels.get_data(), m_width, R2cRenderBuffer::Region(0, 0, m_width, m_height), true);
+}
+
+RenderingBlockSink::RenderingBlockSink() : RSBlockSink(), m_render_buffer(nullptr), m_frame_buffer(nullptr)
 {}
 
 RenderingBlockSink::~RenderingBlockSink()
@@ -76,19 +128,21 @@ RenderingBlockSink::~RenderingBlockSink()
 unsigned int
 RenderingBlockSink::GetWidth() const
 {
+    if (m_frame_buffer != nullptr) return m_frame_buffer->get_width();
     return m_render_buffer != nullptr ? static_cast<unsigned int>(m_render_buffer->get_width()) : 0;
 }
 
 unsigned int
 RenderingBlockSink::GetHeight() const
 {
+    if (m_frame_buffer != nullptr) return m_frame_buffer->get_height();
     return m_render_buffer != nullptr ? static_cast<unsigned int>(m_render_buffer->get_height()) : 0;
 }
 
 void
 RenderingBlockSink::OutputBlock(unsigned int layer_id, unsigned int denoisePassID, unsigned int offsetX, unsigned int offsetY, unsigned int width, unsigned int height, unsigned int stride, const char *pDataType, const char *pBitDepth, float gamma, bool clamped, const void *data)
 {
-    if (layer_id == 0 && m_render_buffer!= nullptr && data != nullptr && strcmp(pBitDepth, "FLOAT32") == 0) {
+    if (layer_id == 0 && (m_render_buffer != nullptr || m_frame_buffer != nullptr) && data != nullptr && strcmp(pBitDepth, "FLOAT32") == 0) {
         unsigned int numSourceChannels = 0;
         if (strcmp(pDataType, "RGB") == 0) {
             numSourceChannels = 3;
@@ -102,7 +156,9 @@ RenderingBlockSink::OutputBlock(unsigned int layer_id, unsigned int denoisePassI
             // unrecognized!
         }
 
-        if (numSourceChannels == 4) {
+        if (numSourceChannels == 4 && m_frame_buffer != nullptr) {
+            m_frame_buffer->fill_rgba_region(static_cast<const float *>(data), stride, offsetX, offsetY, width, height);
+        } else if (numSourceChannels == 4) {
             R2cRenderBuffer::Region region(offsetX, offsetY, width, height);
             // we have to lock because of potential conccurent calls when rendering on multiple GPUs
             m_render_buffer->fill_rgba_region(static_cast<const float *>(data), stride, region, true);
@@ -113,7 +169,8 @@ RenderingBlockSink::OutputBlock(unsigned int layer_id, unsigned int denoisePassI
 void
 RenderingBlockSink::NotifyWillRenderBlock(unsigned int offsetX, unsigned int offsetY, unsigned int width, unsigned int height)
 {
-    m_render_buffer->notify_start_render_region(R2cRenderBuffer::Region(offsetX, offsetY, width, height), true, /* thread_id = */ 0);
+    // the blocks of the passes rendered in the background aren't tied to a render buffer
+    if (m_render_buffer != nullptr) m_render_buffer->notify_start_render_region(R2cRenderBuffer::Region(offsetX, offsetY, width, height), true, /* thread_id = */ 0);
 }
 
 void
@@ -164,33 +221,39 @@ RedshiftUtils::CreateGeometry(const R2cSceneDelegate& delegate, R2cItemId geomet
     static const OfClass *GeometryPolymeshClass = delegate.get_application().get_factory().get_classes().get("GeometryPolymesh");
     static const OfClass *GeometrySphereClass = delegate.get_application().get_factory().get_classes().get("GeometrySphere");
     static const OfClass *GeometryBoxClass = delegate.get_application().get_factory().get_classes().get("GeometryBox");
-
-    static const CoreClassInfo *tmesh_type = CoreClassInfo::get_class("TessellationMesh");
+    static const OfClass *GeometryFurClass = delegate.get_application().get_factory().get_classes().get("GeometryFur");
 
     R2cItemDescriptor idesc = delegate.get_render_item(geometry);
     OfObject *item = idesc.get_item();
 
     ModuleSceneObject *module = static_cast<ModuleSceneObject *>(item->get_module());
 
-    if (item->is_kindof(*GeometryPolymeshClass)) { // test if it's a polymesh
+    // the classes may be missing from the factory in which case the geometry falls back to its bounding box
+    if (GeometryPolymeshClass != nullptr && item->is_kindof(*GeometryPolymeshClass)) { // test if it's a polymesh
         type = RSResourceInfo::TYPE_MESH;
-        R2cGeometryResource resource = delegate.get_geometry_resource(geometry);
-        const GeometryObject *geo = resource.get_geometry();
+        const GeometryObject *geo = GetPolygonalGeometry(delegate, geometry);
         if (geo != nullptr) { // safety net but shouldn't really happen
-            if (geo->is_kindof(PolyMesh::class_info())) { // it's a polymesh
-                return CreatePolymesh(*dynamic_cast<const PolyMesh *>(geo), material);
-            } else if ((geo->is_kindof(PolyMeshSmoothed::class_info())) ||
-                       (tmesh_type != nullptr && geo->is_kindof(*tmesh_type))) { // it's a polymeshsmoothed or tessellation mesh
-                return CreateGeometryPolymesh(*geo, material);
-            }
+            return CreatePolygonalMesh(*geo, material);
         } // else something wrong has happened since we should always have a resource
-    } else if (item->is_kindof(*GeometrySphereClass)) {
+    } else if (GeometrySphereClass != nullptr && item->is_kindof(*GeometrySphereClass)) {
         type = RSResourceInfo::TYPE_POINT_CLOUD;
         const float radius = static_cast<float>(item->get_attribute("radius")->get_double());
         return CreateSphere(radius, material);
-    } else if (item->is_kindof(*GeometryBoxClass)) {
+    } else if (GeometryBoxClass != nullptr && item->is_kindof(*GeometryBoxClass)) {
         type = RSResourceInfo::TYPE_MESH;
         return CreateBox(item->get_attribute("size")->get_vec3d(), material);
+    } else if (GeometryFurClass != nullptr && item->is_kindof(*GeometryFurClass)) {
+        const GeometryObject *geo = delegate.get_geometry_resource(geometry).get_geometry();
+        if (geo != nullptr) {
+            // strands have a constant width, read from the width attribute when the groom has one
+            OfAttr *width = item->attribute_exists("width");
+            if (width == nullptr) LOG_WARNING("RedshiftUtils::CreateGeometry: " << item->get_full_name() << " has no width attribute, its strands are 0.01 wide\n");
+            RSMeshBase *hair = CreateHair(*geo, width != nullptr ? static_cast<float>(width->get_double()) : 0.01f, material);
+            if (hair != nullptr) {
+                type = RSResourceInfo::TYPE_HAIR;
+                return hair;
+            }
+        }
     }
     type = RSResourceInfo::TYPE_MESH;
     // don't know the geometry type, let's create a bbox
@@ -204,286 +267,241 @@ inline void SetVertexData(void *vtx_data_struct, unsigned int attribute_byte_off
     memcpy((static_cast<char *>(vtx_data_struct)) + attribute_byte_offset, &data, sizeof(T));
 }
 
-RSMesh *
-RedshiftUtils::CreatePolymesh(const PolyMesh& polymesh, RSMaterial *material)
+// gather the normals of the points of the point cloud
+static void
+get_point_normals(const GeometryPointCloud& ptc, const unsigned int& point_count, CoreArray<GMathVec3f>& normals)
 {
-    const unsigned int attribute_count = 3;
-    const unsigned int material_count = polymesh.get_shading_group_names().get_count();
-
-    RSMesh *mesh = RS_Mesh_New(get_new_unique_name("GeometrySmoothed").get_data());
-    mesh->SetIsTransformationBlurred(false);
-    mesh->SetNumMaterials(material_count);
-
-    RSArray<RSMaterial *> materials;
-    for (unsigned int i = 0; i < material_count; i++) {
-        mesh->SetMaterial(i, material);
-        materials.Add(material);
+    normals.resize(point_count);
+    for (unsigned int i = 0; i < point_count; i++) {
+        const auto& normal = ptc.get_normal(i);
+        normals[i] = GMathVec3f(static_cast<float>(normal[0]), static_cast<float>(normal[1]), static_cast<float>(normal[2]));
     }
+}
 
-    RSVertexData* pMyVertexFormatData = RS_VertexData_New();
-    pMyVertexFormatData->SetNumAttributes(attribute_count);
+/*! \brief Gather the topology and attributes of a Clarisse polymesh */
+static void
+describe_polymesh(const PolyMesh& polymesh, PolymeshDescription& desc)
+{
+    desc.material_count = polymesh.get_shading_group_names().get_count();
 
-    const unsigned int positionStreamOriginalIndex = 0;
-    const unsigned int normalStreamOriginalIndex = 1;
-    const unsigned int uv0StreamOriginalIndex = 2;
+    const GeometryPointCloud *ptc = polymesh.get_point_cloud();
+    ptc->get_positions(desc.positions);
+    polymesh.get_polygon_vertex_count(desc.polygon_vertex_count);
+    polymesh.get_polygon_vertex_indices(desc.polygon_vertex_ids);
+    polymesh.get_polygon_shading_groups(desc.polygon_shading_groups);
+
+    // normals are defined per point
+    get_point_normals(*ptc, desc.positions.get_count(), desc.normals);
+    desc.normal_indices = desc.polygon_vertex_ids;
 
-    pMyVertexFormatData->SetAttributeDefinition(positionStreamOriginalIndex, "RS_ATTRIBUTETYPE_FLOAT3", "RS_ATTRIBUTEUSAGETYPE_POSITION", "<<position>>");
-    pMyVertexFormatData->SetAttributeDefinition(normalStreamOriginalIndex, "RS_ATTRIBUTETYPE_NORMAL", "RS_ATTRIBUTEUSAGETYPE_NORMAL", "<<normal>>");
 	// Note : For now, we only support one UV map per mesh, it can be easily extended to support multiple UV maps
-	pMyVertexFormatData->SetAttributeDefinition(uv0StreamOriginalIndex, "RS_ATTRIBUTETYPE_FLOAT2", "RS_ATTRIBUTEUSAGETYPE_TEXCOORD", "uv0");			// requires 'AddVertexAttributeMeshAssociation' on shader node that is accessing this attribute stream, otherwise it can be optimized out (see notes above)
-	//pMyVertexFormatData->SetAttributeDefinition(uv0StreamOriginalIndex, "RS_ATTRIBUTETYPE_FLOAT2", "RS_ATTRIBUTEUSAGETYPE_TEXCOORD", "uv0", false);	// does not require 'AddVertexAttributeMeshAssociation' on shader node that is accessing this attribute stream
+    desc.is_uv_defined = polymesh.get_uv_map_data(0, desc.uvs, desc.uv_indices);
+}
 
-	// Note : The first parameter is set to False, otherwise, the attribute for UVs seems to be always considered as unused and textures are not working ...
-	// If someone understand why it is not working and how to optimize it, feel free to set it to True and to update the code accordingly
-    pMyVertexFormatData->FinalizeAttributeFormatAndAllocate(false, 1, false, mesh->GetName(), materials);
+/*! \brief Gather the topology and attributes of an abstract polygonal geometry */
+static void
+describe_geometry_polymesh(const GeometryObject& geometry, PolymeshDescription& desc)
+{
+    desc.material_count = geometry.get_shading_group_names().get_count();
 
-    // Cache the re-mapped offsets into the finalized vertex data structure
-    unsigned int vtx_attr_offsets[attribute_count];
-    for (unsigned int originalAttributeIndex = 0; originalAttributeIndex < attribute_count; originalAttributeIndex++) {
-        // Check to see if the remapped attribute has been stripped by the 'RS_GenerateVertexFormatFromMeshMaterials' function. If it has, the remapped index will be 'RS_INVALIDATTRIBUTEINDEX'
-        if (pMyVertexFormatData->IsAttributeUsed(originalAttributeIndex))
-            vtx_attr_offsets[originalAttributeIndex] = pMyVertexFormatData->GetAttributeOffsetBytes(originalAttributeIndex);
-        else
-            vtx_attr_offsets[originalAttributeIndex] = 0xFFFF; // an invalid offset (see AddTrianglesToMesh for usage)
+    const GeometryPointCloud *ptc = geometry.get_point_cloud();
+    ptc->get_positions(desc.positions);
+    geometry.get_primitive_indices(desc.polygon_vertex_ids);
+
+    const unsigned int primitive_count = geometry.get_primitive_count();
+    desc.polygon_vertex_count.resize(primitive_count);
+    desc.polygon_shading_groups.resize(primitive_count);
+    for (unsigned int i = 0; i < primitive_count; i++) {
+        desc.polygon_vertex_count[i] = geometry.get_primitive_edge_count(i);
+        desc.polygon_shading_groups[i] = geometry.get_primitive_shading_group_index(i);
     }
 
-    unsigned int p_offset = vtx_attr_offsets[positionStreamOriginalIndex];
-    unsigned int n_offset= vtx_attr_offsets[normalStreamOriginalIndex];
-	unsigned int uv_offset= vtx_attr_offsets[uv0StreamOriginalIndex];
-
-    CoreArray<GMathVec3f> vertices;
-    CoreArray<unsigned int> polygon_vertex_ids;
-    CoreArray<unsigned int> polygon_vertex_count;
-    CoreArray<unsigned int> polygon_shading_groups;
-
-    const GeometryPointCloud *ptc = polymesh.get_point_cloud();
-
-    ptc->get_positions(vertices);
-    polymesh.get_polygon_vertex_count(polygon_vertex_count);
-    polymesh.get_polygon_vertex_indices(polygon_vertex_ids);
-    polymesh.get_polygon_shading_groups(polygon_shading_groups);
+    if (geometry.get_normal_map_count() > 0) { // normals are defined per polygon vertex
+        geometry.get_normal_map_data(0, desc.normals, desc.normal_indices);
+    } else { // normals are defined per point
+        get_point_normals(*ptc, desc.positions.get_count(), desc.normals);
+        desc.normal_indices = desc.polygon_vertex_ids;
+    }
 
 	// Note : For now, we only support one UV map per mesh, it can be easily extended to support multiple UV maps
-	CoreArray<GMathVec3f> uvs;
-	CoreArray<unsigned int> uv_indices;
-	bool is_uv_defined = polymesh.get_uv_map_data(0, uvs, uv_indices);
-
-    unsigned int offset = 0;
-    unsigned int *ids;
-
-    mesh->SetAttributesFormat(pMyVertexFormatData);
-    mesh->BeginPrimitives(1);
+    desc.is_uv_defined = geometry.get_uv_map_data(0, desc.uvs, desc.uv_indices);
+}
 
-	char vtx_data[4][1024]; // temporary vertex buffer data
-	unsigned int vidx = 0;
-
-    for (unsigned int i = 0; i < polymesh.get_polygon_count(); i++) {
-		const unsigned int id0 = vidx;
-		const unsigned int id1 = vidx + 1;
-		const unsigned int id2 = vidx + 2;
-		const unsigned int id3 = vidx + 3;
-        ids = &polygon_vertex_ids[offset];
-
-        if (polygon_vertex_count[i] == 3) {
-            SetVertexData(vtx_data[0], p_offset, RSVector3(vertices[ids[0]][0], vertices[ids[0]][1], -vertices[ids[0]][2]));
-            SetVertexData(vtx_data[1], p_offset, RSVector3(vertices[ids[1]][0], vertices[ids[1]][1], -vertices[ids[1]][2]));
-            SetVertexData(vtx_data[2], p_offset, RSVector3(vertices[ids[2]][0], vertices[ids[2]][1], -vertices[ids[2]][2]));
-
-            SetVertexData(vtx_data[0], n_offset, RSNormal(ptc->get_normal(ids[0])[0], ptc->get_normal(ids[0])[1], -ptc->get_normal(ids[0])[2]));
-            SetVertexData(vtx_data[1], n_offset, RSNormal(ptc->get_normal(ids[1])[0], ptc->get_normal(ids[1])[1], -ptc->get_normal(ids[1])[2]));
-            SetVertexData(vtx_data[2], n_offset, RSNormal(ptc->get_normal(ids[2])[0], ptc->get_normal(ids[2])[1], -ptc->get_normal(ids[2])[2]));
-
-			if (uv_offset != 0xFFFF && is_uv_defined) {
-				SetVertexData(vtx_data[0], uv_offset, RSVector2(uvs[uv_indices[id0]][0], uvs[uv_indices[id0]][1]));
-				SetVertexData(vtx_data[1], uv_offset, RSVector2(uvs[uv_indices[id1]][0], uvs[uv_indices[id1]][1]));
-				SetVertexData(vtx_data[2], uv_offset, RSVector2(uvs[uv_indices[id2]][0], uvs[uv_indices[id2]][1]));
-			}
-
-            mesh->AddTri(vtx_data[0], vtx_data[1], vtx_data[2],
-                          0.0f, 0.0f, 0.0f, 0.0f,0.0f,0.0f,
-                          ids[0], ids[1], ids[2], static_cast<unsigned short>(polygon_shading_groups[i]));
-
-        } else if (polygon_vertex_count[i] == 4) {
-            SetVertexData(vtx_data[0], p_offset, RSVector3(vertices[ids[0]][0], vertices[ids[0]][1], -vertices[ids[0]][2]));
-            SetVertexData(vtx_data[1], p_offset, RSVector3(vertices[ids[1]][0], vertices[ids[1]][1], -vertices[ids[1]][2]));
-            SetVertexData(vtx_data[2], p_offset, RSVector3(vertices[ids[2]][0], vertices[ids[2]][1], -vertices[ids[2]][2]));
-            SetVertexData(vtx_data[3], p_offset, RSVector3(vertices[ids[3]][0], vertices[ids[3]][1], -vertices[ids[3]][2]));
-
-            SetVertexData(vtx_data[0], n_offset, RSNormal(ptc->get_normal(ids[0])[0], ptc->get_normal(ids[0])[1], -ptc->get_normal(ids[0])[2]));
-            SetVertexData(vtx_data[1], n_offset, RSNormal(ptc->get_normal(ids[1])[0], ptc->get_normal(ids[1])[1], -ptc->get_normal(ids[1])[2]));
-            SetVertexData(vtx_data[2], n_offset, RSNormal(ptc->get_normal(ids[2])[0], ptc->get_normal(ids[2])[1], -ptc->get_normal(ids[2])[2]));
-            SetVertexData(vtx_data[3], n_offset, RSNormal(ptc->get_normal(ids[3])[0], ptc->get_normal(ids[3])[1], -ptc->get_normal(ids[3])[2]));
-
-			if (uv_offset != 0xFFFF && is_uv_defined) {
-				SetVertexData(vtx_data[0], uv_offset, RSVector2(uvs[uv_indices[id0]][0], uvs[uv_indices[id0]][1]));
-				SetVertexData(vtx_data[1], uv_offset, RSVector2(uvs[uv_indices[id1]][0], uvs[uv_indices[id1]][1]));
-				SetVertexData(vtx_data[2], uv_offset, RSVector2(uvs[uv_indices[id2]][0], uvs[uv_indices[id2]][1]));
-				SetVertexData(vtx_data[3], uv_offset, RSVector2(uvs[uv_indices[id3]][0], uvs[uv_indices[id3]][1]));
-			}
-
-            mesh->AddQuad(vtx_data[0], vtx_data[1], vtx_data[2], vtx_data[3],
-                          0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,0.0f,0.0f,
-                          ids[0], ids[1], ids[2], ids[3], static_cast<unsigned short>(polygon_shading_groups[i]));
-        }
-		vidx += polygon_vertex_count[i];
-        offset += polygon_vertex_count[i];
+/*! \brief Gather again the positions and normals of the points of a polygonal geometry whose topology is unchanged
+ *  \return false if the number of points or of normals doesn't match the description anymore */
+static bool
+describe_polygonal_points(const GeometryObject& geometry, PolymeshDescription& desc)
+{
+    const unsigned int point_count = desc.positions.get_count();
+    const unsigned int normal_count = desc.normals.get_count();
+    const GeometryPointCloud *ptc = geometry.get_point_cloud();
+    ptc->get_positions(desc.positions);
+    if (desc.positions.get_count() != point_count) return false;
+
+    if (!geometry.is_kindof(PolyMesh::class_info()) && geometry.get_normal_map_count() > 0) {
+        // the indices of the normal map are part of the topology and are unchanged
+        CoreArray<unsigned int> normal_indices;
+        geometry.get_normal_map_data(0, desc.normals, normal_indices);
+    } else {
+        get_point_normals(*ptc, point_count, desc.normals);
     }
-    mesh->CompactDataAndPrepareForRendering();
-    RS_VertexData_Delete(pMyVertexFormatData);
-    return mesh;
+    return desc.normals.get_count() == normal_count;
+}
+
+RSMesh *
+RedshiftUtils::CreatePolymesh(const PolyMesh& polymesh, RSMaterial *material)
+{
+    PolymeshDescription desc;
+    describe_polymesh(polymesh, desc);
+    return CreatePolygonalMesh(desc, material);
 }
 
 RSMesh *
 RedshiftUtils::CreateGeometryPolymesh(const GeometryObject& geometry, RSMaterial *material)
 {
-    const unsigned int attribute_count = 3;
-    const unsigned int material_count = geometry.get_shading_group_names().get_count();
+    PolymeshDescription desc;
+    describe_geometry_polymesh(geometry, desc);
+    return CreatePolygonalMesh(desc, material);
+}
 
+const GeometryObject *
+RedshiftUtils::GetPolygonalGeometry(const R2cSceneDelegate& delegate, R2cItemId geometry)
+{
+    static const OfClass *GeometryPolymeshClass = delegate.get_application().get_factory().get_classes().get("GeometryPolymesh");
+    static const CoreClassInfo *tmesh_type = CoreClassInfo::get_class("TessellationMesh");
 
-    RSMesh *mesh = RS_Mesh_New(get_new_unique_name("GeometrySmoothed").get_data());
-    mesh->SetIsTransformationBlurred(false);
-    mesh->SetNumMaterials(material_count);
+    OfObject *item = delegate.get_render_item(geometry).get_item();
+    if (item == nullptr || GeometryPolymeshClass == nullptr || !item->is_kindof(*GeometryPolymeshClass)) return nullptr;
 
-    RSArray<RSMaterial *> materials;
-    for (unsigned int i = 0; i < material_count; i++) {
-        mesh->SetMaterial(i, material);
-        materials.Add(material);
+    const GeometryObject *geo = delegate.get_geometry_resource(geometry).get_geometry();
+    if (geo != nullptr && (geo->is_kindof(PolyMesh::class_info()) || geo->is_kindof(PolyMeshSmoothed::class_info()) ||
+                           (tmesh_type != nullptr && geo->is_kindof(*tmesh_type)))) {
+        return geo;
     }
+    return nullptr;
+}
 
-    RSVertexData* pMyVertexFormatData = RS_VertexData_New();
-    pMyVertexFormatData->SetNumAttributes(attribute_count);
-
-    const unsigned int positionStreamOriginalIndex = 0;
-    const unsigned int normalStreamOriginalIndex = 1;
-    const unsigned int uv0StreamOriginalIndex = 2;
-
-    pMyVertexFormatData->SetAttributeDefinition(positionStreamOriginalIndex, "RS_ATTRIBUTETYPE_FLOAT3", "RS_ATTRIBUTEUSAGETYPE_POSITION", "<<position>>");
-    pMyVertexFormatData->SetAttributeDefinition(normalStreamOriginalIndex, "RS_ATTRIBUTETYPE_NORMAL", "RS_ATTRIBUTEUSAGETYPE_NORMAL", "<<normal>>");
-	// Note : For now, we only support one UV map per mesh, it can be easily extended to support multiple UV maps
-    pMyVertexFormatData->SetAttributeDefinition(uv0StreamOriginalIndex, "RS_ATTRIBUTETYPE_FLOAT2", "RS_ATTRIBUTEUSAGETYPE_TEXCOORD", "uv0");			// requires 'AddVertexAttributeMeshAssociation' on shader node that is accessing this attribute stream, otherwise it can be optimized out (see notes above)
-	//pMyVertexFormatData->SetAttributeDefinition(uv0StreamOriginalIndex, "RS_ATTRIBUTETYPE_FLOAT2", "RS_ATTRIBUTEUSAGETYPE_TEXCOORD", "uv0", false);	// does not require 'AddVertexAttributeMeshAssociation' on shader node that is accessing this attribute stream
-
-	// Note : The first parameter is set to False, otherwise, the attribute for UVs seems to be always considered as unused and textures are not working ...
-	// If someone understand why it is not working and how to optimize it, feel free to set it to True and to update the code accordingly
-    pMyVertexFormatData->FinalizeAttributeFormatAndAllocate(false, 1, false, mesh->GetName(), materials);
-
-    // Cache the re-mapped offsets into the finalized vertex data structure
-    unsigned int vtx_attr_offsets[attribute_count];
-    for (unsigned int originalAttributeIndex = 0; originalAttributeIndex < attribute_count; originalAttributeIndex++) {
-        // Check to see if the remapped attribute has been stripped by the 'RS_GenerateVertexFormatFromMeshMaterials' function. If it has, the remapped index will be 'RS_INVALIDATTRIBUTEINDEX'
-        if (pMyVertexFormatData->IsAttributeUsed(originalAttributeIndex))
-            vtx_attr_offsets[originalAttributeIndex] = pMyVertexFormatData->GetAttributeOffsetBytes(originalAttributeIndex);
-        else
-            vtx_attr_offsets[originalAttributeIndex] = 0xFFFF; // an invalid offset (see AddTrianglesToMesh for usage)
+void
+RedshiftUtils::DescribePolygonalMesh(const GeometryObject& geometry, PolymeshDescription& description)
+{
+    if (geometry.is_kindof(PolyMesh::class_info())) { // it's a polymesh
+        describe_polymesh(*dynamic_cast<const PolyMesh *>(&geometry), description);
+    } else { // it's a polymeshsmoothed or tessellation mesh
+        describe_geometry_polymesh(geometry, description);
     }
+}
 
-    unsigned int p_offset = vtx_attr_offsets[positionStreamOriginalIndex];
-    unsigned int n_offset= vtx_attr_offsets[normalStreamOriginalIndex];
-	unsigned int uv_offset= vtx_attr_offsets[uv0StreamOriginalIndex];
-
-    mesh->SetAttributesFormat(pMyVertexFormatData);
-    mesh->BeginPrimitives(1);
+RSMesh *
+RedshiftUtils::CreatePolygonalMesh(const GeometryObject& geometry, RSMaterial *material)
+{
+    if (geometry.is_kindof(PolyMesh::class_info())) { // it's a polymesh
+        return CreatePolymesh(*dynamic_cast<const PolyMesh *>(&geometry), material);
+    } else { // it's a polymeshsmoothed or tessellation mesh
+        return CreateGeometryPolymesh(geometry, material);
+    }
+}
 
-    CoreArray<unsigned int> primitive_vertex_ids;
-    const GeometryPointCloud *ptc = geometry.get_point_cloud();
-    CoreArray<GMathVec3f> vertices;
-    ptc->get_positions(vertices);
+unsigned long long
+RedshiftUtils::EstimateGeometrySize(const R2cSceneDelegate& delegate, R2cItemId geometry)
+{
+    const GeometryObject *geo = GetPolygonalGeometry(delegate, geometry);
+    if (geo == nullptr) return 0;
 
-    CoreArray<GMathVec3f> normals;
-    CoreArray<unsigned int> normal_index;
+    // counting the vertices of the polygons would walk all of them so they are assumed to be quads, which is the usual case
+    const unsigned int primitive_count = geo->get_primitive_count();
+    return EstimatePolygonalMeshSize(4ull * primitive_count, primitive_count);
+}
 
-	// Note : For now, we only support one UV map per mesh, it can be easily extended to support multiple UV maps
-	CoreArray<GMathVec3f> uvs;
-	CoreArray<unsigned int> uv_indices;
-    bool is_uv_defined = geometry.get_uv_map_data(0, uvs, uv_indices);
+unsigned long long
+RedshiftUtils::EstimatePolygonalMeshSize(const unsigned long long& vertex_count, const unsigned int& polygon_count)
+{
+    // polygons are triangulated and each triangle vertex stores its position, normal and uv
+    return (vertex_count > 2 * polygon_count ? 3 * (vertex_count - 2 * polygon_count) : 0) * (sizeof(GMathVec3f) * 2 + sizeof(GMathVec2f));
+}
 
-    unsigned int offset = 0;
-    unsigned int *ids;
+bool
+RedshiftUtils::DeformGeometry(const R2cSceneDelegate& delegate, R2cItemId geometry, RSResourceInfo& resource, RSMaterial *material)
+{
+    static const CoreClassInfo *tmesh_type = CoreClassInfo::get_class("TessellationMesh");
 
-    if (geometry.get_normal_map_count() > 0) {
-        geometry.get_normal_map_data(0, normals, normal_index);
+    const GeometryObject *geo = delegate.get_geometry_resource(geometry).get_geometry();
+    RSMesh *mesh = static_cast<RSMesh *>(resource.ptr);
+    if (geo == nullptr || mesh == nullptr) return false;
+
+    if (resource.topology != nullptr) {
+        // the mesh has already been deformed so only its points are gathered again
+        if (!describe_polygonal_points(*geo, resource.topology->description)) return false;
+    } else {
+        // the topology is only kept for the meshes which are deformed since it holds a copy of the mesh
+        PolymeshTopology *topology = new PolymeshTopology;
+        if (geo->is_kindof(PolyMesh::class_info())) {
+            describe_polymesh(*dynamic_cast<const PolyMesh *>(geo), topology->description);
+        } else if ((geo->is_kindof(PolyMeshSmoothed::class_info())) ||
+                   (tmesh_type != nullptr && geo->is_kindof(*tmesh_type))) {
+            describe_geometry_polymesh(*geo, topology->description);
+        }
+        // the mesh must have been created from a polygonal geometry with the same shading groups
+        if (topology->description.polygon_vertex_count.get_count() == 0 || topology->description.material_count != mesh->GetNumMaterials()) {
+            delete topology;
+            return false;
+        }
+        resource.topology = topology;
     }
 
-    geometry.get_primitive_indices(primitive_vertex_ids);
-
-    char vtx_data[4][1024]; // temporary vertex buffer data
-    unsigned int vidx = 0;
-
-    for (unsigned int i = 0; i < geometry.get_primitive_count(); i++) {
-        const unsigned int primitive_vertex_count = geometry.get_primitive_edge_count(i);
-        // FIXME: potential problems with shading group since Redshift also support short
-        const unsigned short shading_group_id = static_cast<unsigned short>(geometry.get_primitive_shading_group_index(i));
-        const unsigned int id0 = vidx;
-        const unsigned int id1 = vidx + 1;
-        const unsigned int id2 = vidx + 2;
-        const unsigned int id3 = vidx + 3;
-        ids = &primitive_vertex_ids[offset];
-
-        if (primitive_vertex_count == 3) {
-            SetVertexData(vtx_data[0], p_offset, RSVector3(vertices[ids[0]][0], vertices[ids[0]][1], -vertices[ids[0]][2]));
-            SetVertexData(vtx_data[1], p_offset, RSVector3(vertices[ids[1]][0], vertices[ids[1]][1], -vertices[ids[1]][2]));
-            SetVertexData(vtx_data[2], p_offset, RSVector3(vertices[ids[2]][0], vertices[ids[2]][1], -vertices[ids[2]][2]));
-
-            if (normals.get_count() > 0) { // don't like the if in the for loop
-                SetVertexData(vtx_data[0], n_offset, RSNormal(normals[normal_index[id0]][0], normals[normal_index[id0]][1], -normals[normal_index[id0]][2]));
-                SetVertexData(vtx_data[1], n_offset, RSNormal(normals[normal_index[id1]][0], normals[normal_index[id1]][1], -normals[normal_index[id1]][2]));
-                SetVertexData(vtx_data[2], n_offset, RSNormal(normals[normal_index[id2]][0], normals[normal_index[id2]][1], -normals[normal_index[id2]][2]));
-            } else {
-                SetVertexData(vtx_data[0], n_offset, RSNormal(ptc->get_normal(ids[0])[0], ptc->get_normal(ids[0])[1], -ptc->get_normal(ids[0])[2]));
-                SetVertexData(vtx_data[1], n_offset, RSNormal(ptc->get_normal(ids[1])[0], ptc->get_normal(ids[1])[1], -ptc->get_normal(ids[1])[2]));
-                SetVertexData(vtx_data[2], n_offset, RSNormal(ptc->get_normal(ids[2])[0], ptc->get_normal(ids[2])[1], -ptc->get_normal(ids[2])[2]));
-            }
+    // the mesh, its instances and their material overrides are kept, only the vertex data is written again
+    // from the kept triangulation so that the polygons aren't triangulated again
+    FillPolygonalMesh(mesh, resource.topology->description, material, &resource.topology->triangles);
+    return true;
+}
 
-			if (uv_offset != 0xFFFF && is_uv_defined) {
-				SetVertexData(vtx_data[0], uv_offset, RSVector2(uvs[uv_indices[id0]][0], uvs[uv_indices[id0]][1]));
-				SetVertexData(vtx_data[1], uv_offset, RSVector2(uvs[uv_indices[id1]][0], uvs[uv_indices[id1]][1]));
-				SetVertexData(vtx_data[2], uv_offset, RSVector2(uvs[uv_indices[id2]][0], uvs[uv_indices[id2]][1]));
-			}
-
-            mesh->AddTri(vtx_data[0], vtx_data[1], vtx_data[2],
-                          0.0f, 0.0f, 0.0f, 0.0f,0.0f,0.0f,
-                          ids[0], ids[1], ids[2], shading_group_id);
-
-        } else if (primitive_vertex_count == 4) {
-            SetVertexData(vtx_data[0], p_offset, RSVector3(vertices[ids[0]][0], vertices[ids[0]][1], -vertices[ids[0]][2]));
-            SetVertexData(vtx_data[1], p_offset, RSVector3(vertices[ids[1]][0], vertices[ids[1]][1], -vertices[ids[1]][2]));
-            SetVertexData(vtx_data[2], p_offset, RSVector3(vertices[ids[2]][0], vertices[ids[2]][1], -vertices[ids[2]][2]));
-            SetVertexData(vtx_data[3], p_offset, RSVector3(vertices[ids[3]][0], vertices[ids[3]][1], -vertices[ids[3]][2]));
-
-            if (normals.get_count() > 0) {
-                SetVertexData(vtx_data[0], n_offset, RSNormal(normals[normal_index[id0]][0], normals[normal_index[id0]][1], -normals[normal_index[id0]][2]));
-                SetVertexData(vtx_data[1], n_offset, RSNormal(normals[normal_index[id1]][0], normals[normal_index[id1]][1], -normals[normal_index[id1]][2]));
-                SetVertexData(vtx_data[2], n_offset, RSNormal(normals[normal_index[id2]][0], normals[normal_index[id2]][1], -normals[normal_index[id2]][2]));
-                SetVertexData(vtx_data[3], n_offset, RSNormal(normals[normal_index[id3]][0], normals[normal_index[id3]][1], -normals[normal_index[id3]][2]));
-            } else {
-                SetVertexData(vtx_data[0], n_offset, RSNormal(ptc->get_normal(ids[0])[0], ptc->get_normal(ids[0])[1], -ptc->get_normal(ids[0])[2]));
-                SetVertexData(vtx_data[1], n_offset, RSNormal(ptc->get_normal(ids[1])[0], ptc->get_normal(ids[1])[1], -ptc->get_normal(ids[1])[2]));
-                SetVertexData(vtx_data[2], n_offset, RSNormal(ptc->get_normal(ids[2])[0], ptc->get_normal(ids[2])[1], -ptc->get_normal(ids[2])[2]));
-                SetVertexData(vtx_data[3], n_offset, RSNormal(ptc->get_normal(ids[3])[0], ptc->get_normal(ids[3])[1], -ptc->get_normal(ids[3])[2]));
-            }
 
-			if (uv_offset != 0xFFFF && is_uv_defined) {
-				SetVertexData(vtx_data[0], uv_offset, RSVector2(uvs[uv_indices[id0]][0], uvs[uv_indices[id0]][1]));
-				SetVertexData(vtx_data[1], uv_offset, RSVector2(uvs[uv_indices[id1]][0], uvs[uv_indices[id1]][1]));
-				SetVertexData(vtx_data[2], uv_offset, RSVector2(uvs[uv_indices[id2]][0], uvs[uv_indices[id2]][1]));
-				SetVertexData(vtx_data[3], uv_offset, RSVector2(uvs[uv_indices[id3]][0], uvs[uv_indices[id3]][1]));
-			}
 
-            mesh->AddQuad(vtx_data[0], vtx_data[1], vtx_data[2], vtx_data[3],
-                          0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,0.0f,0.0f,
-                          ids[0], ids[1], ids[2], ids[3], shading_group_id);
+bool
+RedshiftUtils::IsHairGeometry(const R2cSceneDelegate& delegate, R2cItemId geometry)
+{
+    static const OfClass *GeometryFurClass = delegate.get_application().get_factory().get_classes().get("GeometryFur");
+    OfObject *item = delegate.get_render_item(geometry).get_item();
+    return item != nullptr && GeometryFurClass != nullptr && item->is_kindof(*GeometryFurClass);
+}
 
-        }
-        vidx += primitive_vertex_count;
-        offset += primitive_vertex_count;
+/*! \class GeometryHairSource
+    \brief Source reading the curves of a Clarisse geometry in place, the positions being those of its point cloud. */
+class GeometryHairSource : public HairSource {
+public:
+    GeometryHairSource(const GeometryObject& geometry, const GeometryPointCloud& ptc) : m_geometry(geometry)
+    {
+        const CoreBasicArray<GMathVec3f>& points = ptc.get_positions();
+        positions = points.get_data();
+        point_count = points.get_count();
+        // the primitive indices are only exposed as a copy which is then the only array gathered from the groom
+        geometry.get_primitive_indices(m_indices);
+        curve_vertex_ids = m_indices.get_data();
+        index_count = m_indices.get_count();
+        curve_count = geometry.get_primitive_count();
     }
 
-    mesh->CompactDataAndPrepareForRendering();
-    RS_VertexData_Delete(pMyVertexFormatData);
-    return mesh;
-}
+    unsigned int get_curve_edge_count(const unsigned int& curve) const override { return m_geometry.get_primitive_edge_count(curve); }
 
+private:
+    const GeometryObject& m_geometry;
+    CoreArray<unsigned int> m_indices;
+};
 
+RSMeshBase *
+RedshiftUtils::CreateHair(const GeometryObject& geometry, const float& width, RSMaterial *material)
+{
+    const GeometryPointCloud *ptc = geometry.get_point_cloud();
+    if (ptc == nullptr) return nullptr;
+    GeometryHairSource source(geometry, *ptc);
+    source.radius = width * 0.5f;
+
+    if (!ResolveHairLayout(source)) {
+        LOG_WARNING("RedshiftUtils::CreateHair: the " << source.index_count << " indices of the " << source.curve_count
+                    << " curves don't match their edge counts, the groom is replaced by its bounding box\n");
+        return nullptr;
+    }
+    return CreateHair(source, material);
+}
 
 RSPointCloud *
 RedshiftUtils::CreateSphere(const float& radius, RSMaterial *material)
@@ -522,6 +540,44 @@ RedshiftUtils::CreateSphere(const float& radius, RSMaterial *material)
     return ptc;
 }
 
+bool
+RedshiftUtils::GetPrimitive(const R2cSceneDelegate& delegate, R2cItemId geometry, CoreString& key, GMathVec3d& scale)
+{
+    static const OfClass *GeometrySphereClass = delegate.get_application().get_factory().get_classes().get("GeometrySphere");
+    static const OfClass *GeometryBoxClass = delegate.get_application().get_factory().get_classes().get("GeometryBox");
+
+    OfObject *item = delegate.get_render_item(geometry).get_item();
+    if (item == nullptr) return false;
+
+    // the parameters of spheres and boxes are all folded in the instance scale so their class is enough to identify them.
+    // The classes may be missing from the factory in which case the geometries are converted like any other
+    if (GeometrySphereClass != nullptr && item->is_kindof(*GeometrySphereClass)) {
+        const OfAttr *radius = item->get_attribute("radius");
+        if (radius == nullptr) return false;
+        scale = GMathVec3d(radius->get_double(), radius->get_double(), radius->get_double());
+        key = "GeometrySphere";
+        return true;
+    } else if (GeometryBoxClass != nullptr && item->is_kindof(*GeometryBoxClass)) {
+        const OfAttr *size = item->get_attribute("size");
+        if (size == nullptr) return false;
+        scale = size->get_vec3d();
+        key = "GeometryBox";
+        return true;
+    }
+    return false;
+}
+
+RSMeshBase *
+RedshiftUtils::CreatePrimitive(const CoreString& key, RSMaterial *material, RSResourceInfo::Type& type)
+{
+    if (key == "GeometrySphere") {
+        type = RSResourceInfo::TYPE_POINT_CLOUD;
+        return CreateSphere(1.0f, material);
+    }
+    type = RSResourceInfo::TYPE_MESH;
+    return CreateBox(GMathVec3d(1.0, 1.0, 1.0), material);
+}
+
 RSMesh *
 RedshiftUtils::CreateBox(const GMathVec3d& size, RSMaterial *material)
 {
@@ -896,6 +952,7 @@ RedshiftUtils::CreateInstancer(RSInstancerInfo& instancer, RSResourceIndex& reso
             RSResourceInfo new_resource;
             new_resource.ptr = RedshiftUtils::CreateGeometry(delegate, instancer_info->get_prototypes()[resource.get_value()], RedshiftUtils::get_default_material(), new_resource.type);
             new_resource.refcount = 1;
+            new_resource.bytes = RedshiftUtils::EstimateGeometrySize(delegate, instancer_info->get_prototypes()[resource.get_value()]);
             // adding the new resource
             resources.add(resource.get_key(), new_resource);
             // we need to add the new mesh
@@ -923,56 +980,11 @@ RedshiftUtils::CreateInstancer(RSInstancerInfo& instancer, RSResourceIndex& reso
                           R2cSceneDelegate::DIRTINESS_SHADING_GROUP |
                           R2cSceneDelegate::DIRTINESS_VISIBILITY;
 
-    const CoreArray<unsigned int>& indices = instancer_info->get_indices();
-    const CoreArray<GMathMatrix4x4d>& matrices = instancer_info->get_matrices();
-    // creating the actual points
-    for (unsigned int i = 0; i < instancer.ptrs.get_count(); i++) instancer.ptrs[i]->BeginPrimitives(1);
+    FillPointClouds(instancer.ptrs, instancer_info->get_matrices(), instancer_info->get_indices());
+    instancer.bytes = static_cast<unsigned long long>(instancer_info->get_indices().get_count()) * sizeof(RSMatrix4x4);
 
-    for (unsigned int i = 0; i < indices.get_count(); i++) {
-        // getting the corresponding point cloud
-        RSPointCloud *ptc = instancer.ptrs[indices[i]];
-        // and adding the instance
-        ptc->AddInstance(RedshiftUtils::ToRSMatrix4x4(matrices[i]));
-    }
     // release instancer description since we don't need it anymore
     delegate.destroy_instancer_description(instancer_info);
-    // finalizing point cloud data
-    for (unsigned int i = 0; i < instancer.ptrs.get_count(); i++) instancer.ptrs[i]->CompactDataAndPrepareForRendering();
-}
-
-static
-const GMathMatrix4x4d& get_scale_matrix()
-{
-    bool init = false;
-    static GMathMatrix4x4d mx;
-    if (!init) {
-        mx.set_identity();
-        mx.make_scaling(1.0,1.0,-1.0);
-    }
-    return mx;
-}
-
-RSMatrix4x4
-RedshiftUtils::ToRSMatrix4x4(const GMathMatrix4x4d& m)
-{
-    GMathMatrix4x4d mx(m);
-    mx.multiply_left(get_scale_matrix());
-    mx.multiply_right(get_scale_matrix());
-    return RSMatrix4x4(static_cast<float>(mx[0][0]), static_cast<float>(mx[1][0]), static_cast<float>(mx[2][0]), static_cast<float>(mx[3][0]),
-                       static_cast<float>(mx[0][1]), static_cast<float>(mx[1][1]), static_cast<float>(mx[2][1]), static_cast<float>(mx[3][1]),
-                       static_cast<float>(mx[0][2]), static_cast<float>(mx[1][2]), static_cast<float>(mx[2][2]), static_cast<float>(mx[3][2]),
-                       static_cast<float>(mx[0][3]), static_cast<float>(mx[1][3]), static_cast<float>(mx[2][3]), static_cast<float>(mx[3][3]));
-}
-
-
-CoreString
-RedshiftUtils::get_new_unique_name(const CoreString& prefix)
-{
-    static unsigned long long id = 0;
-    CoreString result = "FromClarisse::";
-    result += prefix;
-    result += (++id);
-    return result;
 }
 
 bool&
@@ -988,6 +1000,23 @@ RedshiftUtils::is_initialized()
     return RS_is_initialized();
 }
 
+/*! \brief State of the Redshift engine which is only started once it is really needed since
+ *         bringing up the renderer and its devices is slow and useless when rendering with another engine */
+struct RSEngineState {
+    bool is_started;
+    bool has_failed; // true if the engine couldn't be started so that we don't try again
+    bool has_default_materials; // true once the default materials have been created
+    // like the rest of the Redshift API, the state is only accessed by the thread syncing the scenes
+    RSEngineState() : is_started(false), has_failed(false), has_default_materials(false) {}
+};
+
+static RSEngineState&
+get_engine_state()
+{
+    static RSEngineState engine;
+    return engine;
+}
+
 void
 create_default_material_module(OfApp& app)
 {
@@ -1121,68 +1150,126 @@ get_attribute_definition(const EGUIShaderParamType& rs_type,
     return true;
 }
 
-void
-register_attribute(OfClass& cls, const RSShaderInputParamInfo *input, const CoreString& category)
-{
+/*! \class ShaderAttributeInfo
+    \brief Description of a Clarisse attribute generated from a Redshift shader input parameter.
+           This is what is stored in the shader manifest so that classes can be registered without
+           walking the Redshift shader package. */
+class ShaderAttributeInfo {
+public:
+    CoreString name;
+    CoreString category;
     OfAttr::Type type;
     OfAttr::Container container;
     OfAttr::VisualHint hint;
     unsigned int size;
+    bool texturable;
+    bool logarithmic_slider;
+    bool has_range;
+    bool has_ui_range;
+    double range[2];
+    double ui_range[2];
+    CoreVector<double> default_values;
+};
+
+/*! \class ShaderOutputInfo
+    \brief Description of a Clarisse output generated from a Redshift shader output parameter. */
+class ShaderOutputInfo {
+public:
+    CoreString name;
+    OfAttr::Type type;
+    OfAttr::VisualHint hint;
+    unsigned int size;
+};
+
+/*! \class ShaderClassInfo
+    \brief Description of a Clarisse class generated from a Redshift shader. */
+class ShaderClassInfo {
+public:
+    CoreString name;
+    CoreString base_class;
+    CoreVector<ShaderAttributeInfo> attributes;
+    CoreVector<ShaderOutputInfo> outputs;
+};
 
-    if (get_attribute_definition(input->GetGUIType(), type, container, hint, size)) {
-
-        OfAttr *attr = cls.attribute_exists(input->GetInternalName());
-        if (attr == nullptr) {
-            attr = cls.add_attribute(input->GetInternalName(), type, container, hint, category);
-            attr->set_value_count(size);
-            // todo set attribute description
-            // setting default value
-            if (attr->is_numeric_type()) {
-                if (attr->get_type() == OfAttr::TYPE_DOUBLE) {
-                    float value, vmin, vmax;
-                    for (unsigned int i = 0; i < attr->get_value_count(); i++) {
-                        input->GetDefaultValue(static_cast<int>(i), value);
-                        attr->set_double(static_cast<double>(value), i);
-                    }
-                    if (input->GetHardMinMaxValue(vmin, vmax)) {
-                       attr->set_numeric_range(static_cast<double>(vmin), static_cast<double>(vmax));
-                       attr->enable_range(true);
-                    }
-                    if (input->GetSoftMinMaxValue(vmin, vmax)) {
-                        attr->set_numeric_ui_range(static_cast<double>(vmin), static_cast<double>(vmax));
-                        attr->enable_ui_range(true);
-                    }
-                } else {
-                    int value, vmin, vmax;
-                    for (unsigned int i = 0; i < attr->get_value_count(); i++) {
-                        input->GetDefaultValue(static_cast<int>(i), value);
-                        attr->set_long(static_cast<long>(value), i);
-                    }
-                    if (input->GetHardMinMaxValue(vmin, vmax)) {
-                       attr->set_numeric_range(static_cast<double>(vmin), static_cast<double>(vmax));
-                       attr->enable_range(true);
-                    }
-                    if (input->GetSoftMinMaxValue(vmin, vmax)) {
-                        attr->set_numeric_ui_range(static_cast<double>(vmin), static_cast<double>(vmax));
-                        attr->enable_ui_range(true);
-                    }
+bool
+describe_attribute(const RSShaderInputParamInfo *input, const CoreString& category, ShaderAttributeInfo& info)
+{
+    if (!get_attribute_definition(input->GetGUIType(), info.type, info.container, info.hint, info.size)) return false; // unsupported
+
+    info.name = input->GetInternalName();
+    info.category = category;
+    info.texturable = input->IsTexturable();
+    info.logarithmic_slider = input->IsLogarithmicSlider();
+    info.default_values.remove_all();
+    if (info.type == OfAttr::TYPE_DOUBLE) {
+        float value, vmin, vmax;
+        for (unsigned int i = 0; i < info.size; i++) {
+            input->GetDefaultValue(static_cast<int>(i), value);
+            info.default_values.add(static_cast<double>(value));
+        }
+        info.has_range = input->GetHardMinMaxValue(vmin, vmax);
+        info.range[0] = static_cast<double>(vmin); info.range[1] = static_cast<double>(vmax);
+        info.has_ui_range = input->GetSoftMinMaxValue(vmin, vmax);
+        info.ui_range[0] = static_cast<double>(vmin); info.ui_range[1] = static_cast<double>(vmax);
+    } else if (info.type == OfAttr::TYPE_LONG || info.type == OfAttr::TYPE_BOOL) {
+        int value, vmin, vmax;
+        for (unsigned int i = 0; i < info.size; i++) {
+            input->GetDefaultValue(static_cast<int>(i), value);
+            info.default_values.add(static_cast<double>(value));
+        }
+        info.has_range = input->GetHardMinMaxValue(vmin, vmax);
+        info.range[0] = static_cast<double>(vmin); info.range[1] = static_cast<double>(vmax);
+        info.has_ui_range = input->GetSoftMinMaxValue(vmin, vmax);
+        info.ui_range[0] = static_cast<double>(vmin); info.ui_range[1] = static_cast<double>(vmax);
+    } else {
+        info.has_range = info.has_ui_range = false;
+        info.range[0] = info.range[1] = info.ui_range[0] = info.ui_range[1] = 0.0;
+    }
+    return true;
+}
+
+void
+register_attribute(OfClass& cls, const ShaderAttributeInfo& info)
+{
+    OfAttr *attr = cls.attribute_exists(info.name);
+    if (attr == nullptr) {
+        attr = cls.add_attribute(info.name, info.type, info.container, info.hint, info.category);
+        attr->set_value_count(info.size);
+        // todo set attribute description
+        // setting default value
+        if (attr->is_numeric_type()) {
+            if (attr->get_type() == OfAttr::TYPE_DOUBLE) {
+                for (unsigned int i = 0; i < attr->get_value_count() && i < info.default_values.get_count(); i++) {
+                    attr->set_double(info.default_values[i], i);
                 }
-                attr->set_animatable(true);
-                attr->set_texturable(input->IsTexturable());
-
-                // The texture filters must be specified so it is only possible to connect
-                // redshift textures in texturable attributes of redshift objects in Clarisse
-                if (input->IsTexturable()) {
-                    CoreArray<CoreString> texture_filters = { "TextureRedshift" };
-                    attr->set_texture_filters(texture_filters);
+            } else {
+                for (unsigned int i = 0; i < attr->get_value_count() && i < info.default_values.get_count(); i++) {
+                    attr->set_long(static_cast<long>(info.default_values[i]), i);
                 }
-
-                attr->set_slider(input->IsLogarithmicSlider());
             }
-        } else {
-            LOG_WARNING("Failed to add " << cls.get_name() << "::" << input->GetInternalName() << " since it already exists!\n");
+            if (info.has_range) {
+               attr->set_numeric_range(info.range[0], info.range[1]);
+               attr->enable_range(true);
+            }
+            if (info.has_ui_range) {
+                attr->set_numeric_ui_range(info.ui_range[0], info.ui_range[1]);
+                attr->enable_ui_range(true);
+            }
+            attr->set_animatable(true);
+            attr->set_texturable(info.texturable);
+
+            // The texture filters must be specified so it is only possible to connect
+            // redshift textures in texturable attributes of redshift objects in Clarisse
+            if (info.texturable) {
+                CoreArray<CoreString> texture_filters = { "TextureRedshift" };
+                attr->set_texture_filters(texture_filters);
+            }
+
+            attr->set_slider(info.logarithmic_slider);
         }
-    } // else unsupported
+    } else {
+        LOG_WARNING("Failed to add " << cls.get_name() << "::" << info.name << " since it already exists!\n");
+    }
 }
 
 CoreString
@@ -1197,12 +1284,13 @@ make_category(const CoreString& tab, const CoreVector<CoreString>& subtabs)
 }
 
 void
-register_attributes(OfClass& cls, const RSShaderGUIInfo& shader)
+describe_attributes(const RSShaderGUIInfo& shader, ShaderClassInfo& cls)
 {
     CoreString category;
     int paramidx = 0;
     CoreString tab;
     CoreVector<CoreString> subtabs;
+    ShaderAttributeInfo info;
 
     for (int i = 0; i < shader.GetNumGUILayoutProperties(); i++) {
         const RSGUILayoutProperty *property = shader.GetGUILayoutProperty(i);
@@ -1216,105 +1304,347 @@ register_attributes(OfClass& cls, const RSShaderGUIInfo& shader)
             CoreString category = make_category(tab, subtabs);
             for (int j = 0; j < property->GetNumParamBlockEntries(); j++) {
                 const RSShaderInputParamInfo *input = shader.GetInputParameterInfo(paramidx++);
-                register_attribute(cls, input, category);
+                if (describe_attribute(input, category, info)) {
+                    cls.attributes.add(info);
+                }
             }
         }
     }
 }
 
 void
-register_output(OfClass& cls, const RSShaderOutputParamInfo *output)
+describe_outputs(const RSShaderGUIInfo& shader, ShaderClassInfo& cls)
 {
-	OfAttr::Type type;
+	ShaderOutputInfo info;
 	OfAttr::Container container;
-	OfAttr::VisualHint hint;
-	unsigned int size;
-
-	if (get_attribute_definition(output->GetGUIType(), type, container, hint, size)) {
-		const OfOutput* plug = cls.output_exists(output->GetInternalName());
-		if (plug == nullptr) {
-			cls.add_output(output->GetInternalName(), type, size, hint);
-		} else {
-			LOG_WARNING("Failed to add " << cls.get_name() << "::" << output->GetInternalName() << " since it already exists!\n");
+	for (int i = 0; i < shader.GetNumOutputParameters(); i++) {
+		if (const RSShaderOutputParamInfo *output = shader.GetOutputParameterInfo(i)) {
+			if (get_attribute_definition(output->GetGUIType(), info.type, container, info.hint, info.size)) {
+				info.name = output->GetInternalName();
+				cls.outputs.add(info);
+			} // else unsupported
 		}
-	} // else unsupported
+	}
 }
 
 void
-register_outputs(OfClass& cls, const RSShaderGUIInfo& shader)
+register_output(OfClass& cls, const ShaderOutputInfo& info)
 {
-	for (int i = 0; i < shader.GetNumOutputParameters(); i++) {
-		if (const RSShaderOutputParamInfo *output = shader.GetOutputParameterInfo(i)) {
-			register_output(cls, output);
-		}
+	const OfOutput* plug = cls.output_exists(info.name);
+	if (plug == nullptr) {
+		cls.add_output(info.name, info.type, info.size, info.hint);
+	} else {
+		LOG_WARNING("Failed to add " << cls.get_name() << "::" << info.name << " since it already exists!\n");
 	}
 }
 
 bool
-register_shader(OfApp& application, OfClass& redshift_class, const CoreString& new_class, const RSShaderGUIInfo& shader)
+register_shader(OfApp& application, const ShaderClassInfo& info)
 {
-    OfClass *cls = application.get_factory().get_classes().add(new_class, redshift_class.get_name());
-    cls->set_callbacks(redshift_class.get_callbacks());
-    register_attributes(*cls, shader);
-	register_outputs(*cls, shader);
+    OfClass *redshift_class = application.get_factory().get_classes().get(info.base_class);
+    if (redshift_class == nullptr) return false;
+
+    OfClass *cls = application.get_factory().get_classes().add(info.name, redshift_class->get_name());
+    cls->set_callbacks(redshift_class->get_callbacks());
+    for (const ShaderAttributeInfo& attribute : info.attributes) register_attribute(*cls, attribute);
+	for (const ShaderOutputInfo& output : info.outputs) register_output(*cls, output);
     return true;
 }
 
-void register_shaders(OfApp& application)
+// describe all Redshift shaders exposed to Clarisse by walking the Redshift shader package
+void
+describe_shaders(CoreVector<ShaderClassInfo>& classes)
 {
-    static OfClass *redshift_material = application.get_factory().get_classes().get("MaterialRedshift");
-    static OfClass *redshift_texture = application.get_factory().get_classes().get("TextureRedshift");
-    //static OfClass *redshift_light = application.get_factory().get_classes().get("LightRedshift");
-
     CoreSet<CoreString> deprecated_materials;
     // populating deprecated materials to avoid exposing them
     deprecated_materials.add("Architectural");
     deprecated_materials.add("MatteShadow");
 
-    static CoreSet<CoreString> deprecated_lights;
-    CoreString cls_name;
-
+    ShaderClassInfo cls;
     RSShaderPackageGUIInfo *shader_info = RS_ShaderPackageInfo_New("houdini");
     for (int i = 0; i < shader_info->GetNumShaders(); i++) {
         const RSShaderGUIInfo *shader = shader_info->GetShaderInfo(i);
         if (shader != nullptr) {
             switch (shader->GetType()) {
                 case RS_GUISHADERTYPE_MATERIAL:
-                    if (redshift_material != nullptr && !deprecated_materials.exists(shader->GetName())) {
-                        cls_name = ModuleMaterialRedshift::mangle_class(shader->GetName());
-                        register_shader(application, *redshift_material, cls_name, *shader);
+                    if (!deprecated_materials.exists(shader->GetName())) {
+                        cls.name = ModuleMaterialRedshift::mangle_class(shader->GetName());
+                        cls.base_class = "MaterialRedshift";
+                    } else {
+                        continue;
                     }
                     break;
-//                case RS_GUISHADERTYPE_LIGHT:
-//                    for (int j =0 ; j < shader->GetNumInputParameters(); j++) {
-//                        if (shader->GetInputParameterInfo(j)->IsVisibleInGUI()) {
-//                            LOG_INFO(shader->GetName() << "::" << shader->GetInputParameterInfo(j)->GetInternalName() << " " << shader->GetInputParameterInfo(j)->GetPrettyName() << '\n');
-//                        }
-//                    }
-//                    if (redshift_light != nullptr) {
-//                        cls_name = ModuleLightRedshift::mangle_class(shader->GetName());
-//                        register_shader(application, *redshift_light, cls_name, *shader, deprecated_lights);
-//                    }
-//                    break;
 				case RS_GUISHADERTYPE_TEXTURE:
 				case RS_GUISHADERTYPE_UTILITY:
-                    if (redshift_texture != nullptr) {
-                        cls_name = ModuleTextureRedshift::mangle_class(shader->GetName());
-                        register_shader(application, *redshift_texture, cls_name, *shader);
-                    }
+                    cls.name = ModuleTextureRedshift::mangle_class(shader->GetName());
+                    cls.base_class = "TextureRedshift";
                     break;
+                // lights are not exposed yet
                 default:
-                    break;
+                    continue;
             }
+            cls.attributes.remove_all();
+            cls.outputs.remove_all();
+            describe_attributes(*shader, cls);
+            describe_outputs(*shader, cls);
+            classes.add(cls);
         }
     }
     RS_ShaderPackageInfo_Delete(shader_info);
 }
 
+// The shader manifest is a tab separated text file stored in the Redshift cache folder. It is tied
+// to its own format version, to the Redshift version, to the Clarisse build and to the binary of the module,
+// identified by its size and modification time, since it stores OfAttr enums as numbers, and is regenerated
+// whenever one of them differs.
+// It ends with a trailer holding the number of classes so that a truncated manifest is detected.
+static const char *s_shader_manifest_name = "clarisse_shader_manifest.txt";
+static const unsigned int s_shader_manifest_version = 3;
+
+// return the path of the shader manifest in the specified cache folder
+static CoreString
+get_shader_manifest_path(const CoreString& cache_folder)
+{
+    CoreString path = cache_folder;
+    path += "/";
+    path += s_shader_manifest_name;
+    return path;
+}
+
+// return the version of the Redshift library as major.minor.build
+static CoreString
+get_redshift_version()
+{
+    int rs_major, rs_minor, rs_build;
+    RS_Renderer_GetVersion(rs_major, rs_minor, rs_build);
+    CoreString version;
+    version += rs_major; version += "."; version += rs_minor; version += "."; version += rs_build;
+    return version;
+}
+
+// return the path of the binary of this module or an empty string if it can't be found
+static CoreString
+get_module_path()
+{
+#ifdef CORE_WINDOWS
+    HMODULE module = nullptr;
+    char path[MAX_PATH];
+    if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                            reinterpret_cast<LPCSTR>(&get_module_path), &module)) return "";
+    const DWORD length = GetModuleFileNameA(module, path, MAX_PATH);
+    return length != 0 && length < MAX_PATH ? CoreString(path) : CoreString("");
+#else
+    Dl_info info;
+    return dladdr(reinterpret_cast<void *>(&get_module_path), &info) != 0 && info.dli_fname != nullptr ? CoreString(info.dli_fname) : CoreString("");
+#endif
+}
+
+// return the size and the modification time of the binary of this module as "size:mtime", or an empty string if it can't be found.
+// Unlike a hash of its content, it doesn't cost a read of the whole binary on each launch
+static CoreString
+get_module_stamp()
+{
+    const CoreString path = get_module_path();
+    if (path.is_empty()) return "";
+#ifdef CORE_WINDOWS
+    struct _stat64 status;
+    if (_stat64(path.get_data(), &status) != 0) return "";
+#else
+    struct stat status;
+    if (stat(path.get_data(), &status) != 0) return "";
+#endif
+    CoreString stamp;
+    stamp += std::to_string(static_cast<unsigned long long>(status.st_size)).c_str();
+    stamp += ":";
+    stamp += std::to_string(static_cast<long long>(status.st_mtime)).c_str();
+    return stamp;
+}
+
+// return the key of the manifest written after its format version: the Redshift version, the Clarisse build
+// and the stamp of the module separated by tabs, or an empty string if the module can't be identified
+static CoreString
+get_shader_manifest_key()
+{
+    const CoreString module_stamp = get_module_stamp();
+    if (module_stamp.is_empty()) return "";
+    CoreString key = get_redshift_version();
+    key += "\t";
+    key += std::to_string(static_cast<unsigned long long>(ISOTROPIX_VERSION_NUMBER)).c_str();
+    key += "\t";
+    key += module_stamp;
+    return key;
+}
+
+// split a line of the manifest in its tab separated fields
+static void
+split_manifest_line(const std::string& line, CoreVector<std::string>& fields)
+{
+    fields.remove_all();
+    size_t start = 0;
+    size_t end;
+    while ((end = line.find('\t', start)) != std::string::npos) {
+        fields.add(line.substr(start, end - start));
+        start = end + 1;
+    }
+    fields.add(line.substr(start));
+}
+
+// read the classes described by the manifest. Return false if it's missing, outdated, invalid or truncated
+static bool
+read_shader_manifest(const CoreString& path, const CoreString& key, CoreVector<ShaderClassInfo>& classes)
+{
+    std::ifstream file(path.get_data());
+    if (!file.is_open()) return false;
+
+    std::string line;
+    CoreVector<std::string> fields;
+    if (!std::getline(file, line)) return false;
+    const std::string header = "redshift_shader_manifest\t" + std::to_string(s_shader_manifest_version) + "\t" + key.get_data();
+    if (line != header) {
+        return false; // outdated
+    }
+
+    ShaderAttributeInfo attribute;
+    ShaderOutputInfo output;
+    bool is_complete = false;
+    while (!is_complete && std::getline(file, line)) {
+        split_manifest_line(line, fields);
+        if (fields[0] == "end" && fields.get_count() == 2) {
+            // the trailer must match the classes read so far and be the last line
+            is_complete = strtoul(fields[1].c_str(), nullptr, 10) == classes.get_count() && !std::getline(file, line);
+            if (!is_complete) break;
+        } else if (fields[0] == "class" && fields.get_count() == 3) {
+            classes.add(ShaderClassInfo());
+            classes[classes.get_count() - 1].name = fields[1].c_str();
+            classes[classes.get_count() - 1].base_class = fields[2].c_str();
+        } else if (fields[0] == "attribute" && fields.get_count() >= 15 && classes.get_count() > 0) {
+            attribute.name = fields[1].c_str();
+            attribute.category = fields[2].c_str();
+            attribute.type = static_cast<OfAttr::Type>(atoi(fields[3].c_str()));
+            attribute.container = static_cast<OfAttr::Container>(atoi(fields[4].c_str()));
+            attribute.hint = static_cast<OfAttr::VisualHint>(atoi(fields[5].c_str()));
+            attribute.size = static_cast<unsigned int>(strtoul(fields[6].c_str(), nullptr, 10));
+            attribute.texturable = fields[7] == "1";
+            attribute.logarithmic_slider = fields[8] == "1";
+            attribute.has_range = fields[9] == "1";
+            attribute.range[0] = atof(fields[10].c_str());
+            attribute.range[1] = atof(fields[11].c_str());
+            attribute.has_ui_range = fields[12] == "1";
+            attribute.ui_range[0] = atof(fields[13].c_str());
+            attribute.ui_range[1] = atof(fields[14].c_str());
+            attribute.default_values.remove_all();
+            for (unsigned int i = 15; i < fields.get_count(); i++) attribute.default_values.add(atof(fields[i].c_str()));
+            classes[classes.get_count() - 1].attributes.add(attribute);
+        } else if (fields[0] == "output" && fields.get_count() == 5 && classes.get_count() > 0) {
+            output.name = fields[1].c_str();
+            output.type = static_cast<OfAttr::Type>(atoi(fields[2].c_str()));
+            output.hint = static_cast<OfAttr::VisualHint>(atoi(fields[3].c_str()));
+            output.size = static_cast<unsigned int>(strtoul(fields[4].c_str(), nullptr, 10));
+            classes[classes.get_count() - 1].outputs.add(output);
+        } else {
+            break;
+        }
+    }
+    if (!is_complete) {
+        LOG_WARNING("Invalid Redshift shader manifest " << path << ", it will be regenerated.\n");
+        return false;
+    }
+    return true;
+}
+
+// write the manifest to a temporary file which then replaces it so that concurrent
+// launches and interrupted writes never leave a partial manifest behind
+static void
+write_shader_manifest(const CoreString& path, const CoreString& key, const CoreVector<ShaderClassInfo>& classes)
+{
+    CoreString temporary_path = path;
+    temporary_path += ".";
+    temporary_path += std::to_string(std::chrono::high_resolution_clock::now().time_since_epoch().count()).c_str();
+    temporary_path += ".tmp";
+    std::ofstream file(temporary_path.get_data());
+    if (!file.is_open()) {
+        LOG_WARNING("Failed to write the Redshift shader manifest " << path << "\n");
+        return;
+    }
+    file.precision(17);
+    file << "redshift_shader_manifest\t" << s_shader_manifest_version << '\t' << key.get_data() << '\n';
+    for (const ShaderClassInfo& cls : classes) {
+        file << "class\t" << cls.name.get_data() << '\t' << cls.base_class.get_data() << '\n';
+        for (const ShaderAttributeInfo& attribute : cls.attributes) {
+            file << "attribute\t" << attribute.name.get_data() << '\t' << attribute.category.get_data() << '\t'
+                 << static_cast<int>(attribute.type) << '\t' << static_cast<int>(attribute.container) << '\t'
+                 << static_cast<int>(attribute.hint) << '\t' << attribute.size << '\t'
+                 << attribute.texturable << '\t' << attribute.logarithmic_slider << '\t'
+                 << attribute.has_range << '\t' << attribute.range[0] << '\t' << attribute.range[1] << '\t'
+                 << attribute.has_ui_range << '\t' << attribute.ui_range[0] << '\t' << attribute.ui_range[1];
+            for (unsigned int i = 0; i < attribute.default_values.get_count(); i++) file << '\t' << attribute.default_values[i];
+            file << '\n';
+        }
+        for (const ShaderOutputInfo& output : cls.outputs) {
+            file << "output\t" << output.name.get_data() << '\t' << static_cast<int>(output.type) << '\t'
+                 << static_cast<int>(output.hint) << '\t' << output.size << '\n';
+        }
+    }
+    file << "end\t" << classes.get_count() << '\n';
+    file.close();
+
+    // rename doesn't replace an existing file on Windows
+    const bool is_written = !file.fail() && (std::rename(temporary_path.get_data(), path.get_data()) == 0 ||
+                      (std::remove(path.get_data()) == 0 && std::rename(temporary_path.get_data(), path.get_data()) == 0));
+    if (!is_written) {
+        std::remove(temporary_path.get_data());
+        LOG_WARNING("Failed to write the Redshift shader manifest " << path << "\n");
+    }
+}
+
+/*! \brief Return the Redshift cache folder defined by REDSHIFT_CACHEPATH or the Redshift preferences */
+static CoreString
+get_cache_folder()
+{
+    RSString cacheFolder_query;
+    CoreString var = sys_get_env("REDSHIFT_CACHEPATH");
+    if (var.is_empty() == false) {
+        cacheFolder_query = var.get_data();
+        RSLogMessage(Debug, "Querying cache path from REDSHIFT_CACHEPATH: %s", static_cast<const char *>(cacheFolder_query));
+    } else {
+        RS_Renderer_GetPreferenceValue("CacheFolder", cacheFolder_query, RS_Renderer_GetDefaultCacheFolder());
+        RSLogMessage(Debug, "Querying cache path from preferences.xml: %s", static_cast<const char *>(cacheFolder_query));
+    }
+    return static_cast<const char *>(cacheFolder_query);
+}
+
+void register_shaders(OfApp& application, const CoreString& cache_folder)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    // Walking the Redshift shader package is slow so the description of the generated
+    // classes is cached in a manifest which is read instead on later launches. Without a key identifying
+    // the module the manifest can't be trusted, so the package is walked on every launch.
+    const CoreString manifest_path = get_shader_manifest_path(cache_folder);
+    const CoreString manifest_key = get_shader_manifest_key();
+    if (manifest_key.is_empty()) {
+        LOG_WARNING("Failed to identify the binary of the Redshift module, the shader manifest is not used.\n");
+    }
+    CoreVector<ShaderClassInfo> classes;
+    const bool is_warm = !manifest_key.is_empty() && read_shader_manifest(manifest_path, manifest_key, classes);
+    if (!is_warm) {
+        classes.remove_all();
+        describe_shaders(classes);
+        if (!manifest_key.is_empty()) write_shader_manifest(manifest_path, manifest_key, classes);
+    }
+
+    for (const ShaderClassInfo& cls : classes) register_shader(application, cls);
+
+    const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LOG_INFO("Registered " << classes.get_count() << " Redshift shaders in " << elapsed << " ms ("
+             << (is_warm ? "warm start from " : "cold start, generated ") << manifest_path << ")\n");
+}
+
 bool
 RedshiftUtils::initialize(OfApp& application)
 {
     if (!is_initialized()) {
+        const auto start = std::chrono::steady_clock::now();
         int rs_major, rs_minor, rs_build;
         RS_Renderer_GetVersion(rs_major, rs_minor, rs_build);
         LOG_INFO("Registered Redshift module (version " << rs_major << '.' << rs_minor << '.' << rs_build << ")\n");
@@ -1333,54 +1663,82 @@ RedshiftUtils::initialize(OfApp& application)
         RS_Renderer_SetLicensePath(licensePath);
         RS_Renderer_SetProceduralPath(proceduralsPath);
 
-        unsigned int textureCacheBudgetMB = static_cast<unsigned int>(RS_Renderer_GetDefaultTextureCacheBudgetGB() * 1024);
-        CoreString var = sys_get_env("REDSHIFT_TEXTURECACHEBUDGET");
-        if (var.is_empty() == false) {
-            int textureCacheBudgetGB_query = static_cast<int>(var);
-            RSLogMessage(Debug, "Querying texture cache buget from REDSHIFT_TEXTURECACHEBUDGET: %d GB", textureCacheBudgetGB_query);
-            textureCacheBudgetMB = static_cast<unsigned int>(textureCacheBudgetGB_query * 1024);
-        } else {
-            int textureCacheBudgetGB_query;
-            RS_Renderer_GetPreferenceValue("TextureCacheBudgetGB", textureCacheBudgetGB_query, RS_Renderer_GetDefaultTextureCacheBudgetGB());
-            textureCacheBudgetMB = static_cast<unsigned int>(textureCacheBudgetGB_query * 1024);
-            RSLogMessage(Debug, "Querying texture cache buget from preferences.xml: %d GB", textureCacheBudgetGB_query);
-        }
-
-        RSString cacheFolder_query;
-        var = sys_get_env("REDSHIFT_CACHEPATH");
-        if (var.is_empty() == false) {
-            cacheFolder_query = var.get_data();
-            RSLogMessage(Debug, "Querying cache path from REDSHIFT_CACHEPATH: %s", static_cast<const char *>(cacheFolder_query));
-        } else {
-            RS_Renderer_GetPreferenceValue("CacheFolder", cacheFolder_query, RS_Renderer_GetDefaultCacheFolder());
-            RSLogMessage(Debug, "Querying cache path from preferences.xml: %s", static_cast<const char *>(cacheFolder_query));
-        }
-
-        RS_Renderer_SetCachePath(static_cast<const char *>(cacheFolder_query), textureCacheBudgetMB);
-
-        // initialize the redshift renderer
-        RSArray<int> selectedCudaDeviceOrdinals;
-        if (RS_Renderer_GetSelectedCudaDeviceOrdinalsFromPreferences(selectedCudaDeviceOrdinals) == false) {
-            LOG_ERROR("Redshift - Couldn't get selected Cuda Device Ordinals.\n");
-            return false;
-        }
-        RS_Renderer_Create(static_cast<unsigned int>(selectedCudaDeviceOrdinals.Length()), static_cast<int *>(&selectedCudaDeviceOrdinals[0]));
-
-        // register Redshift shaders to Clarisse
-        register_shaders(application);
-
-		// create the material that will be evaluated when the default material is assigned
-		create_default_material_module(application);
-		// create the material that will be evaluated when a non-supported material is assigned
-		create_error_material_module(application);
+        // register Redshift shaders to Clarisse. This must be done early on so that projects can be loaded
+        // while the rest of the engine (texture cache, devices...) is only started by start_engine()
+        register_shaders(application, get_cache_folder());
+        // the conversions share the threads of the application
+        set_thread_manager(&application.get_thread_manager());
 
         RS_is_initialized() = true;
+        const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        LOG_INFO("Initialized Redshift module in " << elapsed << " ms\n");
         return true;
     }
     LOG_ERROR("Redshift was already initialized!\n");
     return false;
 }
 
+/*! \brief Set the Redshift cache path and texture cache budget and create the renderer on the selected devices */
+static bool
+create_engine()
+{
+    unsigned int textureCacheBudgetMB = static_cast<unsigned int>(RS_Renderer_GetDefaultTextureCacheBudgetGB() * 1024);
+    CoreString var = sys_get_env("REDSHIFT_TEXTURECACHEBUDGET");
+    if (var.is_empty() == false) {
+        int textureCacheBudgetGB_query = static_cast<int>(var);
+        RSLogMessage(Debug, "Querying texture cache buget from REDSHIFT_TEXTURECACHEBUDGET: %d GB", textureCacheBudgetGB_query);
+        textureCacheBudgetMB = static_cast<unsigned int>(textureCacheBudgetGB_query * 1024);
+    } else {
+        int textureCacheBudgetGB_query;
+        RS_Renderer_GetPreferenceValue("TextureCacheBudgetGB", textureCacheBudgetGB_query, RS_Renderer_GetDefaultTextureCacheBudgetGB());
+        textureCacheBudgetMB = static_cast<unsigned int>(textureCacheBudgetGB_query * 1024);
+        RSLogMessage(Debug, "Querying texture cache buget from preferences.xml: %d GB", textureCacheBudgetGB_query);
+    }
+
+    RS_Renderer_SetCachePath(get_cache_folder().get_data(), textureCacheBudgetMB);
+
+    // initialize the redshift renderer
+    RSArray<int> selectedCudaDeviceOrdinals;
+    if (RS_Renderer_GetSelectedCudaDeviceOrdinalsFromPreferences(selectedCudaDeviceOrdinals) == false) {
+        LOG_ERROR("Redshift - Couldn't get selected Cuda Device Ordinals.\n");
+        return false;
+    }
+    RS_Renderer_Create(static_cast<unsigned int>(selectedCudaDeviceOrdinals.Length()), static_cast<int *>(&selectedCudaDeviceOrdinals[0]));
+    return true;
+}
+
+bool
+RedshiftUtils::start_engine(const char *reason)
+{
+    if (!is_initialized()) return false;
+
+    RSEngineState& engine = get_engine_state();
+    if (!engine.is_started && !engine.has_failed) {
+        const auto start = std::chrono::steady_clock::now();
+        engine.is_started = create_engine();
+        engine.has_failed = !engine.is_started;
+        if (engine.is_started) {
+            const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            LOG_INFO("Started Redshift engine in " << elapsed << " ms (" << reason << ")\n");
+        }
+    }
+    return engine.is_started;
+}
+
+void
+RedshiftUtils::create_default_materials(OfApp& application)
+{
+    RSEngineState& engine = get_engine_state();
+    if (!is_initialized() || engine.has_default_materials) return;
+    // set first since the default materials are Redshift materials which create them again
+    engine.has_default_materials = true;
+
+    // create the material that will be evaluated when the default material is assigned
+    create_default_material_module(application);
+    // create the material that will be evaluated when a non-supported material is assigned
+    create_error_material_module(application);
+}
+
 static
 RSMaterial *create_default_material()
 {
@@ -1493,20 +1851,129 @@ get_string(const OfAttr& attr) { return attr.get_string().get_data(); }
 inline bool
 get_bool(const OfAttr& attr) { return attr.get_bool(); }
 
-inline RSShaderNode *
-get_texture(const OfAttr& attr)
+// Texture shaders and materials connected to shader parameters
+
+/*! \brief Reference held by a shader parameter on the texture shader or the material connected to it */
+struct ShaderInput {
+    unsigned int reference_id; // reference id of the texture or of the material
+    bool is_material;
+    ShaderInput() : reference_id(0), is_material(false) {}
+    ShaderInput(const unsigned int& id, const bool& material) : reference_id(id), is_material(material) {}
+};
+
+/*! \brief Inputs connected to the parameters of a shader node by parameter index */
+struct ShaderInputs {
+    CoreHashTable<unsigned int, ShaderInput> parameters;
+};
+
+/*! \brief References held by the shader parameters on the inputs connected to them. Like the items owning the
+ *         shaders, they are only modified by the thread evaluating the layer, which syncs the render scene */
+static CoreHashTable<RSShaderNode *, ShaderInputs>&
+get_shader_inputs()
 {
-    ModuleTextureRedshift *texture = static_cast<ModuleTextureRedshift *>(attr.get_texture()->get_module());
-    return texture->get_shader();
+    static CoreHashTable<RSShaderNode *, ShaderInputs> inputs;
+    return inputs;
+}
+
+/*! \brief Release the reference held by a shader parameter on its input
+ *  \note The input may be deleted along with its own inputs */
+static void
+release_input(const ShaderInput& input)
+{
+    if (input.is_material) {
+        ModuleMaterialRedshift::release_material(input.reference_id);
+    } else {
+        ModuleTextureRedshift::release_shader(input.reference_id);
+    }
+}
+
+/*! \brief Record the input connected to a parameter of a shader, releasing the input previously connected to the parameter
+ *  \note The new input must be acquired before in case it's the same one */
+static void
+set_input(RSShaderNode& shader, const unsigned int& idx, const ShaderInput& input)
+{
+    CoreHashTable<RSShaderNode *, ShaderInputs>& inputs = get_shader_inputs();
+    ShaderInputs *connected = inputs.is_key_exists(&shader);
+    if (connected == nullptr) {
+        inputs.add(&shader, ShaderInputs());
+        connected = inputs.is_key_exists(&shader);
+    }
+    ShaderInput previous;
+    ShaderInput *current = connected->parameters.is_key_exists(idx);
+    if (current != nullptr) {
+        previous = *current;
+        *current = input;
+    } else {
+        connected->parameters.add(idx, input);
+    }
+    if (previous.reference_id != 0) release_input(previous);
+}
+
+/*! \brief Return the shader of the specified texture for a parameter of a shader, releasing the input previously connected to the parameter */
+static RSShaderNode *
+connect_texture(RSShaderNode& shader, const unsigned int& idx, ModuleTextureRedshift& texture)
+{
+    RSShaderNode *texture_shader = texture.acquire_shader();
+    if (texture_shader == nullptr) return nullptr;
+    set_input(shader, idx, ShaderInput(texture.get_reference_id(), false));
+    return texture_shader;
+}
+
+/*! \brief Return the surface shader of the specified material for a parameter of a shader, releasing the input previously
+ *         connected to the parameter. The material is referenced as long as the parameter is connected to it */
+static RSShaderNode *
+connect_material(RSShaderNode& shader, const unsigned int& idx, ModuleMaterialRedshift& material)
+{
+    RSMaterial *connected = material.acquire_material();
+    RSShaderNode *surface_shader = connected != nullptr ? connected->GetSurfaceShaderNodeGraph() : nullptr;
+    if (surface_shader == nullptr) {
+        if (connected != nullptr) ModuleMaterialRedshift::release_material(material.get_reference_id());
+        return nullptr;
+    }
+    set_input(shader, idx, ShaderInput(material.get_reference_id(), true));
+    return surface_shader;
+}
+
+/*! \brief Release the input connected to a parameter of a shader, if any, once the parameter is set to something else */
+static void
+disconnect_input(RSShaderNode& shader, const unsigned int& idx)
+{
+    ShaderInputs *connected = get_shader_inputs().is_key_exists(&shader);
+    if (connected == nullptr) return;
+    ShaderInput *current = connected->parameters.is_key_exists(idx);
+    if (current != nullptr) {
+        const ShaderInput previous = *current;
+        connected->parameters.remove(idx);
+        release_input(previous);
+    }
 }
 
 void
-RedshiftUtils::on_attribute_change(RSShaderNode& shader, const OfAttr& attr, int& dirtiness, const int& dirtiness_flags)
+RedshiftUtils::release_shader_inputs(RSShaderNode& shader)
 {
-    const char *name = attr.get_name().get_data();
-    unsigned int idx = shader.GetParameterIndex(name);
-    shader.BeginUpdate();
+    CoreVector<ShaderInput> released;
+    CoreHashTable<RSShaderNode *, ShaderInputs>& inputs = get_shader_inputs();
+    ShaderInputs *connected = inputs.is_key_exists(&shader);
+    if (connected != nullptr) {
+        for (auto input : connected->parameters) released.add(input.get_value());
+        inputs.remove(&shader);
+    }
+    // released once the shader is forgotten since the inputs may be deleted along with their own inputs
+    for (auto input : released) release_input(input);
+}
 
+inline RSShaderNode *
+get_texture(RSShaderNode& shader, const unsigned int& idx, const OfAttr& attr)
+{
+    ModuleTextureRedshift *texture = static_cast<ModuleTextureRedshift *>(attr.get_texture()->get_module());
+    return connect_texture(shader, idx, *texture);
+}
+
+/*! \brief Set the Redshift shader parameter at the specified index to the value of the Clarisse attribute.
+ *  \note Must be called between RSShaderNode::BeginUpdate() and RSShaderNode::EndUpdate() */
+static void
+set_shader_parameter(RSShaderNode& shader, const unsigned int& idx, const OfAttr& attr)
+{
 	unsigned int plug_idx;
 	if (OfObject* object_bound = attr.get_output_binding(plug_idx, false)) {
 		// If an OfOutput is connected to this attribute, we only have to use Redshift to get its value (if it is supported)
@@ -1515,11 +1982,13 @@ RedshiftUtils::on_attribute_change(RSShaderNode& shader, const OfAttr& attr, int
 		RSShaderNode *shader_bound = nullptr;
 		if (object_bound->get_module()->is_kindof(ModuleTextureRedshift::class_info())) {
 			ModuleTextureRedshift *texture = static_cast<ModuleTextureRedshift *>(object_bound->get_module());
-			shader_bound = texture->get_shader();
+			shader_bound = connect_texture(shader, idx, *texture);
 		} else if (object_bound->get_module()->is_kindof(ModuleMaterialRedshift::class_info())) {
 			ModuleMaterialRedshift *material = static_cast<ModuleMaterialRedshift *>(object_bound->get_module());
-			shader_bound = material->get_material()->GetSurfaceShaderNodeGraph();
-		} 
+			shader_bound = connect_material(shader, idx, *material);
+		} else {
+			disconnect_input(shader, idx);
+		}
 		if (shader_bound != nullptr) {
 			shader.SetParameterNode(idx, shader_bound, output->get_name().get_data());
 		} else {
@@ -1529,17 +1998,18 @@ RedshiftUtils::on_attribute_change(RSShaderNode& shader, const OfAttr& attr, int
 	} else {
 		// If no OfOutput is connected to the current attribute, we have to translate Clarisse data into Redshift data
 		// and update the current input parameter (corresponding to the current attribute)
+		if (!attr.is_textured()) disconnect_input(shader, idx);
 		switch (attr.get_visual_hint()) {
 			case OfAttr::VISUAL_HINT_RGB:
 				if (attr.is_textured()) {
-					shader.SetParameterNode(idx, get_texture(attr));
+					shader.SetParameterNode(idx, get_texture(shader, idx, attr));
 				} else {
 					shader.SetParameterData(idx, get_color3(attr));
 				}
 				break;
 			case OfAttr::VISUAL_HINT_RGBA:
 				if (attr.is_textured()) {
-					shader.SetParameterNode(idx, get_texture(attr));
+					shader.SetParameterNode(idx, get_texture(shader, idx, attr));
 				} else {
 					shader.SetParameterData(idx, get_color4(attr));
 				}
@@ -1574,13 +2044,12 @@ RedshiftUtils::on_attribute_change(RSShaderNode& shader, const OfAttr& attr, int
 						break;
 					case OfAttr::TYPE_STRING:
 						if (shader.IsParameterATexture(idx)) { // the attribute is a file path of a texture
-							RSTexture *texture = RS_Texture_Get(get_string(attr));
+							// Textures are shared by all the parameters referencing the same file. The cache releases its reference
+							// once no parameter is bound to the file anymore while 'shader' holds its own until it is deleted.
+							RSTexture *texture = RedshiftUtils::bind_texture(shader, idx, attr.get_string());
 							// Note : For now, we only support one UV map per mesh, it can be easily extended to support multiple UV maps
 							shader.AddVertexAttributeMeshAssociation( "tspace_id", "uv0" );
 							shader.SetParameterData(idx, texture);
-							// Textures are reference counted, so releasing it here after applying it to 'shader' will ensure it does not leak.
-							// It will then be automatically deleted when 'shader' is deleted.
-							RS_Texture_Release(texture);
 						} else { // the attribute is a simple string
 							shader.SetParameterData(idx, get_string(attr));
 						}
@@ -1591,6 +2060,190 @@ RedshiftUtils::on_attribute_change(RSShaderNode& shader, const OfAttr& attr, int
 			default: break;
 		}
 	}
+}
+
+// index returned by RSShaderNode::GetParameterIndex() for names which aren't parameters of the shader
+static const unsigned int s_invalid_parameter_index = static_cast<unsigned int>(-1);
 
+/*! \brief Return the lock guarding the parameter indices of all the shader classes.
+ *  \note Indices are filled on first use by the thread changing attributes as well as by the one syncing the render scene */
+static SysThreadLock&
+get_parameter_indices_lock()
+{
+    static SysThreadLock lock;
+    return lock;
+}
+
+/*! \brief Return the Redshift parameter index of the specified attribute, resolving it only once per shader class */
+static unsigned int
+get_parameter_index(RSShaderNode& shader, RSShaderParameterIndex& parameters, const OfAttr& attr)
+{
+    SysThreadLock& lock = get_parameter_indices_lock();
+    lock.lock();
+    unsigned int *idx = parameters.is_key_exists(attr.get_name());
+    if (idx == nullptr) {
+        parameters.add(attr.get_name(), shader.GetParameterIndex(attr.get_name().get_data()));
+        idx = parameters.is_key_exists(attr.get_name());
+    }
+    const unsigned int result = *idx;
+    lock.unlock();
+    return result;
+}
+
+void
+RedshiftUtils::sync_shader(RSShaderNode& shader, RSShaderParameterIndex& parameters, OfObject& object)
+{
+    shader.BeginUpdate();
+    for (unsigned int i = 0; i < object.get_attribute_count(); i++) {
+        const OfAttr& attr = *object.get_attribute(i);
+        const unsigned int idx = get_parameter_index(shader, parameters, attr);
+        // attributes inherited from the Clarisse base classes aren't shader parameters
+        if (idx != s_invalid_parameter_index) set_shader_parameter(shader, idx, attr);
+    }
     shader.EndUpdate();
 }
+
+RSShaderParameterIndex&
+RedshiftUtils::get_shader_parameter_index(const CoreString& shader_class)
+{
+    // indices are shared by all shader nodes of the same class and live as long as the registered classes
+    static CoreHashTable<CoreString, RSShaderParameterIndex *> parameter_indices;
+    SysThreadLock& lock = get_parameter_indices_lock();
+    lock.lock();
+    RSShaderParameterIndex **parameters = parameter_indices.is_key_exists(shader_class);
+    if (parameters == nullptr) {
+        parameter_indices.add(shader_class, new RSShaderParameterIndex);
+        parameters = parameter_indices.is_key_exists(shader_class);
+    }
+    RSShaderParameterIndex& result = **parameters;
+    lock.unlock();
+    return result;
+}
+
+// Deferred shader updates
+
+/*! \brief Attribute changes of a shader node waiting to be applied */
+struct PendingShaderUpdate {
+    RSShaderParameterIndex *parameters; // parameter indices of the shader class
+    CoreSet<const OfAttr *> attributes; // changed attributes, each one is only applied once
+    PendingShaderUpdate() : parameters(nullptr) {}
+};
+
+/*! \brief Shader nodes with pending attribute changes which are applied in a single update per node at the next sync */
+struct PendingShaderUpdates {
+    SysThreadLock lock;
+    CoreHashTable<RSShaderNode *, PendingShaderUpdate> shaders;
+    bool enabled;
+    PendingShaderUpdates() : enabled(true) {}
+};
+
+static PendingShaderUpdates&
+get_pending_shader_updates()
+{
+    static PendingShaderUpdates updates;
+    return updates;
+}
+
+/*! \brief Start reading the file of a texture parameter before it is bound */
+static void
+prefetch_attribute_texture(RSShaderNode& shader, RSShaderParameterIndex& parameters, const OfAttr& attr)
+{
+    if (attr.get_type() == OfAttr::TYPE_STRING) {
+        const unsigned int idx = get_parameter_index(shader, parameters, attr);
+        if (idx != s_invalid_parameter_index && shader.IsParameterATexture(idx)) {
+            RedshiftUtils::prefetch_texture(attr.get_string());
+        }
+    }
+}
+
+void
+RedshiftUtils::prefetch_shader_textures(RSShaderNode& shader, RSShaderParameterIndex& parameters, OfObject& object)
+{
+    for (unsigned int i = 0; i < object.get_attribute_count(); i++) {
+        prefetch_attribute_texture(shader, parameters, *object.get_attribute(i));
+    }
+}
+
+void
+RedshiftUtils::on_attribute_change(RSShaderNode& shader, RSShaderParameterIndex& parameters, const OfAttr& attr, int& dirtiness, const int& dirtiness_flags)
+{
+    PendingShaderUpdates& updates = get_pending_shader_updates();
+    updates.lock.lock();
+    if (updates.enabled) {
+        // only record the attribute, its value is read when the update is flushed
+        PendingShaderUpdate *update = updates.shaders.is_key_exists(&shader);
+        if (update == nullptr) {
+            updates.shaders.add(&shader, PendingShaderUpdate());
+            update = updates.shaders.is_key_exists(&shader);
+            update->parameters = &parameters;
+        }
+        update->attributes.add(&attr);
+        updates.lock.unlock();
+        // start reading new texture files while the update is pending
+        prefetch_attribute_texture(shader, parameters, attr);
+        return;
+    }
+    updates.lock.unlock();
+
+    shader.BeginUpdate();
+    set_shader_parameter(shader, get_parameter_index(shader, parameters, attr), attr);
+    shader.EndUpdate();
+}
+
+void
+RedshiftUtils::set_deferred_shader_updates(const bool& enabled)
+{
+    PendingShaderUpdates& updates = get_pending_shader_updates();
+    updates.lock.lock();
+    updates.enabled = enabled;
+    updates.lock.unlock();
+    // apply what was recorded so far so that nothing is lost when leaving the deferred mode
+    if (!enabled) flush_shader_updates();
+}
+
+bool
+RedshiftUtils::is_deferred_shader_updates()
+{
+    return get_pending_shader_updates().enabled;
+}
+
+void
+RedshiftUtils::flush_shader_updates()
+{
+    PendingShaderUpdates& updates = get_pending_shader_updates();
+    CoreVector<RSShaderNode *> shaders;
+    updates.lock.lock();
+    for (auto pending : updates.shaders) shaders.add(pending.get_key());
+    updates.lock.unlock();
+    // each update is applied without holding the lock since connecting a parameter may release the shaders previously
+    // connected to it, whose pending updates are then discarded
+    for (auto shader : shaders) {
+        updates.lock.lock();
+        PendingShaderUpdate *pending = updates.shaders.is_key_exists(shader);
+        if (pending == nullptr) { // discarded along with its shader
+            updates.lock.unlock();
+            continue;
+        }
+        const PendingShaderUpdate update = *pending;
+        updates.shaders.remove(shader);
+        updates.lock.unlock();
+        shader->BeginUpdate();
+        for (unsigned int i = 0; i < update.attributes.get_count(); i++) {
+            const OfAttr& attr = *update.attributes[i];
+            set_shader_parameter(*shader, get_parameter_index(*shader, *update.parameters, attr), attr);
+        }
+        shader->EndUpdate();
+    }
+    forget_prefetched_textures();
+}
+
+void
+RedshiftUtils::discard_shader_updates(RSShaderNode& shader)
+{
+    PendingShaderUpdates& updates = get_pending_shader_updates();
+    updates.lock.lock();
+    if (updates.shaders.is_key_exists(&shader) != nullptr) {
+        updates.shaders.remove(&shader);
+    }
+    updates.lock.unlock();
+}
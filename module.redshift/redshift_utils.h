@@ -5,7 +5,9 @@
 #ifndef REDSHIFT_UTILS_H
 #define REDSHIFT_UTILS_H
 
+#include <core_array.h>
 #include <core_hash_table.h>
+#include <core_vector.h>
 #include <gmath_bbox3.h>
 #include <gmath_matrix4x4.h>
 #include <gmath_vec3.h>
@@ -13,8 +15,17 @@
 
 #include <RS.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
 class OfAttr;
+class OfObject;
 class ModuleMaterial;
+class SysThreadManager;
+class R2cRenderBuffer;
 
 
 /*! \class RSLightInfo
@@ -24,11 +35,13 @@ public:
     RSLight *ptr; // pointer to the actual redshift item
     RSShaderNode *shader; // only used for clarisse native lights
     int dirtiness; // dirtiness state of the item
-    RSLightInfo() : ptr(nullptr), dirtiness(R2cSceneDelegate::DIRTINESS_ALL) {}
+    RSLightInfo() : ptr(nullptr), shader(nullptr), dirtiness(R2cSceneDelegate::DIRTINESS_ALL) {}
 };
 
 typedef CoreHashTable<R2cItemId, RSLightInfo> RSLightIndex;
 
+class PolymeshTopology;
+
 /*! \class RSResourceInfo
     \brief internal class holding the actual geometric resource data */
 class RSResourceInfo {
@@ -43,7 +56,10 @@ public:
     RSMeshBase *ptr; //!< pointer to the actual redshift item
     Type type; //!< defines the type of the redshift mesh
     unsigned int refcount; //!< internal refcount used to keep track of the number of requesters
-    RSResourceInfo() : ptr(nullptr), refcount(0) {}
+    bool is_proxy; //!< true if the mesh is a bounding box standing for the resource until its actual mesh is converted
+    unsigned long long bytes; //!< estimated size in bytes of the vertex data of the mesh
+    PolymeshTopology *topology; //!< topology of the mesh kept once it has been deformed, owned by the resource
+    RSResourceInfo() : ptr(nullptr), refcount(0), is_proxy(false), bytes(0), topology(nullptr) {}
 };
 
 typedef CoreHashTable<R2cResourceId, RSResourceInfo> RSResourceIndex;
@@ -54,9 +70,11 @@ class RSGeometryInfo {
 public:
     RSMeshInstance *ptr; //!< pointer to the actual redshift item
     RSInstanceMaterialOverrides *materials; //!< material override definition since everything is considered as an instance
+    unsigned int materials_index; //!< index of the material overrides in the render scene
     R2cResourceId resource; //!< id to the actual Clarisse geometry resource
+    CoreVector<unsigned int> material_references; //!< reference ids of the Redshift materials assigned to the shading groups
     int dirtiness; //!< dirtiness state of the item
-    RSGeometryInfo() : ptr(nullptr), materials(nullptr), resource(nullptr), dirtiness(R2cSceneDelegate::DIRTINESS_ALL) {}
+    RSGeometryInfo() : ptr(nullptr), materials(nullptr), materials_index(0), resource(nullptr), dirtiness(R2cSceneDelegate::DIRTINESS_ALL) {}
 };
 
 typedef CoreHashTable<R2cItemId, RSGeometryInfo> RSGeometryIndex;
@@ -67,12 +85,253 @@ class RSInstancerInfo {
 public:
     CoreArray<RSPointCloud *> ptrs; //!< list of pointers to the redshift point cloud (one per prototype)
     CoreArray<R2cResourceId> resources; //!< list of unique resources for used by all prototypes the number of resources can be smaller that the number of prototypes if there's deduplication
+    CoreVector<unsigned int> material_references; //!< reference ids of the Redshift materials assigned to the shading groups
     int dirtiness; //!< dirtiness state of the item
-    RSInstancerInfo() : dirtiness(R2cSceneDelegate::DIRTINESS_ALL) {}
+    unsigned long long bytes; //!< size in bytes of the instance matrices held by the point clouds
+    RSInstancerInfo() : dirtiness(R2cSceneDelegate::DIRTINESS_ALL), bytes(0) {}
 };
 
 typedef CoreHashTable<R2cItemId, RSInstancerInfo> RSInstancerIndex;
 
+/*! \class PolymeshDescription
+    \brief Topology and attributes gathered in bulk from a Clarisse polygonal geometry before its conversion. */
+class PolymeshDescription {
+public:
+    CoreArray<GMathVec3f> positions; //!< position of each point
+    CoreArray<GMathVec3f> normals; //!< normals referenced by normal_indices
+    CoreArray<unsigned int> normal_indices; //!< index in normals of each polygon vertex
+    CoreArray<GMathVec3f> uvs; //!< uvs referenced by uv_indices
+    CoreArray<unsigned int> uv_indices; //!< index in uvs of each polygon vertex
+    bool is_uv_defined;
+    CoreArray<unsigned int> polygon_vertex_count; //!< number of vertices of each polygon
+    CoreArray<unsigned int> polygon_vertex_ids; //!< point index of each polygon vertex
+    CoreArray<unsigned int> polygon_shading_groups; //!< shading group index of each polygon
+    unsigned int material_count;
+    PolymeshDescription() : is_uv_defined(false), material_count(0) {}
+};
+
+/*! \class PolymeshTopology
+    \brief Description and triangulation of a deformed polygonal mesh kept so that its next deformations
+            only gather the positions and normals of its points instead of its whole topology. */
+class PolymeshTopology {
+public:
+    PolymeshDescription description; //!< description whose positions and normals are refreshed by each deformation
+    CoreVector<unsigned int> triangles; //!< triangles of the polygons with more than four vertices, in the order of the polygons
+};
+
+/*! \class HairDescription
+    \brief Curves of a groom gathered in bulk, mostly used to convert grooms which aren't Clarisse geometries. */
+class HairDescription {
+public:
+    CoreArray<GMathVec3f> positions; //!< position of each point
+    CoreArray<unsigned int> curve_vertex_count; //!< number of vertices of each curve
+    CoreArray<unsigned int> curve_vertex_ids; //!< point index of each curve vertex
+    float radius; //!< radius of all the strands
+    HairDescription() : radius(0.0f) {}
+};
+
+/*! \class HairSource
+    \brief Curves of a groom read in place by the conversion so that the groom isn't copied as a whole before it's
+            converted. The positions and the curve vertex ids are borrowed and must outlive the conversion. */
+class HairSource {
+public:
+    HairSource() : positions(nullptr), point_count(0), curve_vertex_ids(nullptr), index_count(0), curve_count(0), edge_offset(0), radius(0.0f) {}
+    virtual ~HairSource() {}
+    /*! \brief Return the edge count of a curve as listed by the groom, see RedshiftUtils::ResolveHairLayout() */
+    virtual unsigned int get_curve_edge_count(const unsigned int& curve) const = 0;
+    /*! \brief Return the number of vertices of a curve once its layout is resolved */
+    inline unsigned int get_curve_vertex_count(const unsigned int& curve) const { return get_curve_edge_count(curve) + edge_offset; }
+
+    const GMathVec3f *positions; //!< position of each point
+    unsigned int point_count; //!< number of points
+    const unsigned int *curve_vertex_ids; //!< point index of each curve vertex
+    unsigned int index_count; //!< number of curve vertices
+    unsigned int curve_count; //!< number of curves
+    unsigned int edge_offset; //!< 1 when the edge counts are segment counts, set by RedshiftUtils::ResolveHairLayout()
+    float radius; //!< radius of all the strands
+};
+
+/*! \class PolygonTriangulator
+    \brief Triangulate polygons as a fan when they are convex and by ear clipping otherwise. Buffers are kept
+           from one polygon to the next so that triangulating the polygons of a mesh doesn't allocate. */
+class PolygonTriangulator {
+public:
+    /*! \brief Triangulate a polygon projected on the plane the most aligned with it
+     *  \param points vertices of the polygon
+     *  \param count number of vertices of the polygon
+     *  \return triplets of polygon vertex indices, valid until the next call. A polygon of n vertices always
+     *          gives n - 2 triangles, degenerated polygons being completed by a fan once no ear is left. */
+    const CoreVector<unsigned int>& triangulate(const GMathVec3f *points, const unsigned int& count);
+
+private:
+    CoreVector<unsigned int> m_triangles;
+    CoreVector<unsigned int> m_prev; //!< previous vertex of each vertex not clipped yet
+    CoreVector<unsigned int> m_next; //!< next vertex of each vertex not clipped yet
+    CoreVector<bool> m_is_reflex; //!< true if the corner of the vertex is currently reflex
+    CoreVector<unsigned int> m_reflex; //!< vertices which were reflex before clipping started
+};
+
+/*! \class RSShaderParameterIndex
+    \brief map the name of the attributes of a Redshift shader class to their Redshift parameter index */
+class RSShaderParameterIndex : public CoreHashTable<CoreString, unsigned int> {};
+
+/*! \class RedshiftTaskExecutor
+    \brief Runs the tasks of the parallel parts of the conversions. By default they are run by the thread manager of the
+            application set with RedshiftUtils::set_thread_manager(), another executor can be supplied with RedshiftUtils::set_task_executor(). */
+class RedshiftTaskExecutor {
+public:
+    virtual ~RedshiftTaskExecutor() {}
+    /*! \brief Return the number of tasks which are run concurrently, used to size the batches of tasks */
+    virtual unsigned int get_concurrency() const = 0;
+    /*! \brief Call task for each index from 0 to count - 1, possibly concurrently, and return once all the tasks are done */
+    virtual void run(const unsigned int& count, const std::function<void(const unsigned int&)>& task) = 0;
+};
+
+class RedshiftScene;
+
+/*! \class RedshiftSceneSource
+    \brief Items read by RedshiftScene when it synchronizes the render scene. The render delegate implements it over its
+            scene delegate, which lets the synchronization be driven by synthetic scenes without Clarisse. */
+class RedshiftSceneSource {
+public:
+    virtual ~RedshiftSceneSource() {}
+    /*! \brief Return the id of the resource of a geometry, geometries with the same id sharing their resource */
+    virtual R2cResourceId get_resource_id(R2cItemId geometry) = 0;
+    /*! \brief Create the resources of the specified geometries which aren't in the resource index of the scene yet
+     *  \note New resources are added to the index with a refcount of 0 and to the render scene in the order of the geometries */
+    virtual void create_resources(RedshiftScene& scene, const CoreVector<R2cItemId>& geometries) = 0;
+    /*! \brief Update in place the resource of a geometry whose points moved without changing its topology
+     *  \return false if the geometry must be created again */
+    virtual bool deform_geometry(RedshiftScene& scene, R2cItemId geometry, RSGeometryInfo& rgeometry) { return false; }
+    /*! \brief Filter the inserted geometries of the scene before their resources are created */
+    virtual void filter_inserted_geometries(RedshiftScene& scene) {}
+    /*! \brief Return the matrix of an item, geometries sharing a canonical primitive having their parameters folded into it */
+    virtual GMathMatrix4x4d get_transform(R2cItemId item) = 0;
+    /*! \brief Return true if an item is visible */
+    virtual bool get_visible(R2cItemId item) = 0;
+    /*! \brief Return the Redshift material of a shading group of an item, referencing it so that it is created if needed
+     *  \param references output reference ids of the materials of the item */
+    virtual RSMaterial *acquire_material(R2cItemId item, const unsigned int& shading_group, CoreVector<unsigned int>& references) = 0;
+    /*! \brief Release a reference returned by acquire_material(). Materials which aren't referenced anymore are deleted */
+    virtual void release_material(const unsigned int& reference) = 0;
+    /*! \brief Create the point clouds of an instancer, referencing the resources of its prototypes in the resource index of the scene */
+    virtual void create_instancer(RedshiftScene& scene, R2cItemId instancer, RSInstancerInfo& rinstancer) = 0;
+    /*! \brief Create a light */
+    virtual void create_light(R2cItemId light, RSLightInfo& rlight) = 0;
+    /*! \brief Set the attributes of a light other than its matrix */
+    virtual void sync_light_attributes(R2cItemId light, RSLightInfo& rlight) = 0;
+};
+
+/*! \class RedshiftScene
+    \brief Redshift render scene along with the index of its items. Modifications are recorded as they are received and
+            applied by the next sync which only visits the modified items. Since Redshift can't remove items from its scene,
+            removed items are hidden and kept as tombstones until the scene is compacted. */
+class RedshiftScene {
+public:
+
+    struct CleanupFlags { //!< Defines cleanup info used to cleanup the scene after a sync
+        CleanupFlags() : hairs(false), point_clouds(false), meshes(false), mesh_instances(false), lights(false) {}
+        bool hairs; //!< true if curve/mesh geometry have been removed from the scene
+        bool point_clouds; //!< true if point clouds geometry have been removed from the scene
+        bool meshes; //!< true if meshes have been removed from the scene
+        bool mesh_instances; //!< true if mesh instances have been removed from the scene
+        bool lights; //!< true if lights have been removed from the scene
+    };
+
+    /*! \brief Index of the render items of a type along with the modifications recorded since the last sync */
+    template<class INFO>
+    struct ClarisseToRedshiftObjectsMapping {
+        CoreHashTable<R2cItemId, INFO> index; //!< index of all render items (geometries, instancers or lights)
+        CoreVector<R2cItemId> inserted; //!< items inserted since the last sync
+        CoreVector<R2cItemId> removed; //!< items removed since the last sync
+        CoreVector<R2cItemId> dirtied; //!< items which received dirtiness since the last sync, each one being queued once when it gets dirty
+        bool is_dirty() { return inserted.get_count() != 0 || removed.get_count() != 0 || dirtied.get_count() != 0; } //!< return true is index is dirty
+
+        /*! \brief Add dirtiness to an item and queue it for the next sync if it wasn't dirty yet
+         *  \note The dirtiness of the item is the flag preventing it to be queued several times */
+        void set_dirty(R2cItemId id, INFO& info, const int& dirtiness)
+        {
+            if (info.dirtiness == R2cSceneDelegate::DIRTINESS_NONE) dirtied.add(id);
+            info.dirtiness |= dirtiness;
+        }
+    };
+
+    RedshiftScene();
+
+    /*! \brief Record the insertion of a geometry */
+    inline void insert_geometry(R2cItemId id) { geometries.inserted.add(id); }
+    /*! \brief Record the removal of a geometry and return it or nullptr if it isn't in the index */
+    RSGeometryInfo *remove_geometry(R2cItemId id);
+    /*! \brief Add dirtiness to a geometry and return it or nullptr if it isn't in the index */
+    RSGeometryInfo *dirty_geometry(R2cItemId id, const int& dirtiness);
+    /*! \brief Record the insertion of an instancer */
+    inline void insert_instancer(R2cItemId id) { instancers.inserted.add(id); }
+    /*! \brief Record the removal of an instancer */
+    void remove_instancer(R2cItemId id);
+    /*! \brief Add dirtiness to an instancer */
+    void dirty_instancer(R2cItemId id, const int& dirtiness);
+    /*! \brief Record the insertion of a light */
+    inline void insert_light(R2cItemId id) { lights.inserted.add(id); }
+    /*! \brief Record the removal of a light */
+    void remove_light(R2cItemId id);
+    /*! \brief Add dirtiness to a light */
+    void dirty_light(R2cItemId id, const int& dirtiness);
+
+    /*! \brief Synchronize the render scene with the recorded modifications, running all the stages below in order */
+    void sync(RedshiftSceneSource& source);
+    /*! \brief Synchronize the dirtied, removed and inserted geometries
+     *  \param cleanup output cleanup flags to do post cleanup with the render scene */
+    void sync_geometries(RedshiftSceneSource& source, CleanupFlags& cleanup);
+    /*! \brief Synchronize the dirtied, removed and inserted instancers
+     *  \param cleanup output cleanup flags to do post cleanup with the render scene */
+    void sync_instancers(RedshiftSceneSource& source, CleanupFlags& cleanup);
+    /*! \brief Delete removed items once they exceed the compaction thresholds
+     *  \param cleanup output cleanup flags to rebuild the render scene without the deleted items */
+    void compact_scene(RedshiftSceneSource& source, CleanupFlags& cleanup);
+    /*! \brief Synchronize the removed, inserted and dirtied lights
+     *  \param cleanup output cleanup flags to do post cleanup with the render scene */
+    void sync_lights(RedshiftSceneSource& source, CleanupFlags& cleanup);
+    /*! \brief Cleanup the render scene according to the specified flags
+     *  \note This post cleanup is there to rebuild the render scene since redshift can only
+     *        add new items not remove them. We are then obliged to remove the corresponding
+     *        item collections (mesh, lights...) if an item has been removed from the scene. */
+    void cleanup_scene(const CleanupFlags& cleanup);
+    /*! \brief Delete all the items along with the render scene */
+    void clear(RedshiftSceneSource& source);
+
+    RSScene *ptr; //!< actual Redshift render scene, created by the owner of the scene before its first sync
+
+    struct {
+        RSResourceIndex index; //!< the index of all current resources where we store deduplicated data
+    } resources;
+
+    ClarisseToRedshiftObjectsMapping<RSGeometryInfo> geometries; //!< render geometries which are mesh instances pointing to a geometry resource
+    ClarisseToRedshiftObjectsMapping<RSInstancerInfo> instancers; //!< render instancers
+    ClarisseToRedshiftObjectsMapping<RSLightInfo> lights; //!< render lights
+
+    struct {
+        CoreVector<RSGeometryInfo> geometries; //!< hidden mesh instances of removed geometries
+        CoreVector<RSPointCloud *> point_clouds; //!< hidden point clouds of removed instancers
+        CoreVector<RSResourceInfo> resources; //!< resources which aren't instanciated anymore
+        CoreVector<unsigned int> materials; //!< references to the materials which were assigned to removed or reassigned items
+        unsigned long long bytes; //!< estimated size of the vertex data and instance matrices held by the tombstones
+        unsigned int get_count() const { return geometries.get_count() + point_clouds.get_count() + resources.get_count(); }
+    } tombstones;
+
+    unsigned int point_cloud_count; //!< number of point clouds of the live instancers, counted as live items by the compaction
+    double compaction_ratio; //!< ratio of tombstones over live items above which the scene is compacted
+    unsigned int compaction_max_removed_items; //!< number of tombstones above which the scene is compacted
+    unsigned long long compaction_max_removed_bytes; //!< size held by the tombstones above which the scene is compacted
+
+private:
+
+    void sync_geometry(RedshiftSceneSource& source, R2cItemId cgeometryid, RSGeometryInfo& rgeometry, const bool& is_new);
+    void sync_instancer(RedshiftSceneSource& source, R2cItemId cinstancerid, RSInstancerInfo& rinstancer, const bool& is_new);
+    void sync_light(RedshiftSceneSource& source, R2cItemId clightid, RSLightInfo& rlight);
+    void bury_resource(const R2cResourceId& resource_id);
+    void release_materials(RedshiftSceneSource& source);
+};
+
 class R2cRenderBuffer;
 
 /*! \class RenderingAbortChecker
@@ -80,12 +339,95 @@ class R2cRenderBuffer;
 class RenderingAbortChecker : public RSAbortChecker {
 public:
 
-    RenderingAbortChecker(OfApp& app) : RSAbortChecker(), m_application(app) {}
+    RenderingAbortChecker(OfApp& app) : RSAbortChecker(), m_application(app), m_interrupted(false), m_is_evaluation_bound(true) {}
     bool ShouldAbort() override;
 
+    /*! \brief Abort the render in progress since the scene has been modified */
+    inline void interrupt() { m_interrupted = true; }
+    /*! \brief Return true if the scene has been modified since the interruption was last cleared */
+    inline bool is_interrupted() const { return m_interrupted; }
+    /*! \brief Reset the interruption and return true if the render has been interrupted */
+    inline bool clear_interruption() { return m_interrupted.exchange(false); }
+    /*! \brief Set whether stopping the evaluation of Clarisse aborts the render, which isn't the case of passes rendered
+     *         in the background since they outlive the evaluation which started them */
+    inline void set_evaluation_bound(const bool& is_bound) { m_is_evaluation_bound = is_bound; }
+
 private:
 
     OfApp& m_application;
+    std::atomic<bool> m_interrupted; // set by the render delegate when the scene is modified during the render
+    std::atomic<bool> m_is_evaluation_bound;
+};
+
+/*! \class InteractiveRender
+    \brief Renders the progressive passes of the render scene on a background thread. The render scene is only read and
+            modified by the calling thread: the passes in progress are aborted and waited for before it's synchronized with
+            the modifications of the scene, then new passes are started in the background and the calling thread returns. */
+class InteractiveRender {
+public:
+
+    InteractiveRender() : m_thread(nullptr), m_is_requested(false), m_is_rendering(false), m_is_stopped(false) {}
+    ~InteractiveRender() { stop(); }
+
+    /*! \brief Synchronize the scene on the calling thread and start rendering its passes on the background thread without waiting for them
+     *  \param sync synchronize the render scene with the modifications recorded so far and return false if there is nothing to render,
+     *              called by the calling thread with the lock held once the passes in progress are aborted
+     *  \param render_passes render the passes of the scene, called by the background thread
+     *  \param abort_passes abort the passes in progress */
+    void restart(const std::function<bool()>& sync, const std::function<void()>& render_passes, const std::function<void()>& abort_passes);
+    /*! \brief Wait for the passes in progress to be done
+     *  \param timeout maximum time to wait in milliseconds
+     *  \return true if no passes are in progress anymore */
+    bool wait_for_passes(const unsigned int& timeout);
+    /*! \brief Return true while passes are rendered in the background */
+    bool is_rendering() const;
+    /*! \brief Abort the passes in progress and stop the background thread
+     *  \param abort_passes abort the passes in progress */
+    void stop(const std::function<void()>& abort_passes = nullptr);
+
+    /*! \brief Return the lock held while the modifications of the scene are recorded or synchronized */
+    inline std::recursive_mutex& get_lock() { return m_lock; }
+
+private:
+
+    void run();
+
+    std::recursive_mutex m_lock; // guards the modifications of the scene recorded until the next sync, and the start and stop of the thread
+    mutable std::mutex m_state_lock; // guards the requested passes
+    std::condition_variable m_requested;
+    std::condition_variable m_done;
+    std::thread *m_thread; // background thread rendering the passes, modified with both locks held
+    std::function<void()> m_render_passes;
+    bool m_is_requested; // true until the background thread starts the requested passes
+    bool m_is_rendering; // true while the background thread renders passes
+    std::atomic<bool> m_is_stopped;
+};
+
+/*! \class RenderingFrameBuffer
+    \brief RGBA image the passes rendered in the background are written to, since they outlive the render buffer of the
+            evaluation which started them. Each evaluation then copies the latest image to its own render buffer. */
+class RenderingFrameBuffer {
+public:
+
+    RenderingFrameBuffer() : m_width(0), m_height(0) {}
+
+    /*! \brief Resize the image, which is cleared if its size changes */
+    void resize(const unsigned int& width, const unsigned int& height);
+    /*! \brief Copy a block of RGBA pixels of the specified stride, in pixels, to the image */
+    void fill_rgba_region(const float *rgba, const unsigned int& src_stride, const unsigned int& offset_x, const unsigned int& offset_y,
+                          const unsigned int& width, const unsigned int& height);
+    /*! \brief Copy the whole image to a render buffer of the same size */
+    void copy_to(R2cRenderBuffer& render_buffer) const;
+
+    inline unsigned int get_width() const { return m_width; }
+    inline unsigned int get_height() const { return m_height; }
+
+private:
+
+    mutable std::mutex m_lock; // blocks are written concurrently when rendering on multiple GPUs
+    CoreVector<float> m_pixels;
+    unsigned int m_width;
+    unsigned int m_height;
 };
 
 /*! Redshift progress reporter. */
@@ -130,10 +472,13 @@ public:
 
     inline R2cRenderBuffer *GetRenderBuffer() const { return m_render_buffer; }
     inline void SetRenderBuffer(R2cRenderBuffer *render_buffer) { m_render_buffer = render_buffer; }
+    /*! \brief Set the image blocks are written to instead of the render buffer, used by passes rendered in the background */
+    inline void SetFrameBuffer(RenderingFrameBuffer *frame_buffer) { m_frame_buffer = frame_buffer; }
 
 private:
 
     R2cRenderBuffer *m_render_buffer;
+    RenderingFrameBuffer *m_frame_buffer;
 };
 
 // log redirection class
@@ -153,6 +498,13 @@ namespace RedshiftUtils {
     bool initialize(OfApp& application);
     /*! \brief return true if Redshift is initialized. */
     bool is_initialized();
+    /*! \brief Start the Redshift engine (texture cache and renderer devices) if it isn't already. This is deferred
+     *         from initialize() to the first render or the first Redshift object creation since it is slow.
+     *  \param reason what triggered the start, only used to log start-up timings
+     *  \return false if the engine couldn't be started */
+    bool start_engine(const char *reason);
+    /*! \brief Create the default Redshift materials if they don't exist yet. */
+    void create_default_materials(OfApp& application);
     /*! \brief Generates a unique name for Redshift shaders. */
     CoreString get_new_unique_name(const CoreString& prefix = "");
 
@@ -171,8 +523,57 @@ namespace RedshiftUtils {
     inline RSNormal ToRSNormal(const GMathVec3d& v) { return RSNormal(static_cast<float>(v[0]), static_cast<float>(v[1]), static_cast<float>(v[2])); }
     inline RSNormal ToRSNormal(const GMathVec3f& v) { return RSNormal(v[0], v[1], v[2]); }
 
-    /*! \brief Helper to use in the module callback on_attribute_change() to control dirtiness between a Clarisse object and the corresponding Redshift shader */
-    void on_attribute_change(RSShaderNode& shader, const OfAttr& attr, int& dirtiness, const int& dirtiness_flags);
+    /*! \brief Return the cache of parameter indices of the specified Redshift shader class */
+    RSShaderParameterIndex& get_shader_parameter_index(const CoreString& shader_class);
+    /*! \brief Helper to use in the module callback on_attribute_change() to control dirtiness between a Clarisse object and the corresponding Redshift shader
+     *  \param parameters parameter indices of the class of the shader returned by get_shader_parameter_index()
+     *  \note When shader updates are deferred, the change is only recorded and applied by flush_shader_updates() */
+    void on_attribute_change(RSShaderNode& shader, RSShaderParameterIndex& parameters, const OfAttr& attr, int& dirtiness, const int& dirtiness_flags);
+    /*! \brief Set all the parameters of a new shader to the values of the attributes of its Clarisse object
+     *  \param parameters parameter indices of the class of the shader returned by get_shader_parameter_index()
+     *  \note Used by materials and textures whose shader is only created once it is referenced */
+    void sync_shader(RSShaderNode& shader, RSShaderParameterIndex& parameters, OfObject& object);
+    /*! \brief Enable or disable deferred shader updates (enabled by default). Pending updates are applied when disabling it.
+     *  \note Deferring updates coalesces the many attribute changes emitted while loading a project into one update per shader
+     *         and prefetches the new textures until the next sync. It's independent of the render mode and should be left
+     *         enabled during interactive renders, whose passes would otherwise see shaders updated while they are rendered. */
+    void set_deferred_shader_updates(const bool& enabled);
+    /*! \brief Return true if shader updates are deferred. */
+    bool is_deferred_shader_updates();
+    /*! \brief Apply all pending attribute changes, each shader being updated in a single batch. Called before syncing the render scene. */
+    void flush_shader_updates();
+    /*! \brief Drop the pending attribute changes of a shader which is about to be released. */
+    void discard_shader_updates(RSShaderNode& shader);
+    /*! \brief Release the cached textures bound to the parameters of a shader which is about to be released. */
+    void release_shader_textures(RSShaderNode& shader);
+    /*! \brief Release the texture shaders and the materials connected to the parameters of a shader which is about to be released.
+     *  \note A texture shader or a material is deleted once nothing references it anymore */
+    void release_shader_inputs(RSShaderNode& shader);
+    /*! \brief Return the texture of the specified file for a parameter of a shader, releasing the file previously bound to the parameter
+     *  \note The texture is owned by the cache, the shader holding its own reference once the texture is set */
+    RSTexture *bind_texture(RSShaderNode& shader, const unsigned int& idx, const CoreString& path);
+    /*! \brief Read a file which isn't cached yet on a background thread so that it is in the system cache by the time it is bound.
+     *  \note Used when the binding of the file is deferred, bind_texture() loading the file right away */
+    void prefetch_texture(const CoreString& path);
+    /*! \brief Forget the prefetched files which haven't been bound, so that they are read again if they get referenced later.
+     *  \note Called once the deferred shader updates are flushed, the files they referenced being bound by then */
+    void forget_prefetched_textures();
+    /*! \brief Queue the files of the texture parameters of a shader about to be synced so that they are read while its inputs are created.
+     *  \param parameters parameter indices of the class of the shader returned by get_shader_parameter_index() */
+    void prefetch_shader_textures(RSShaderNode& shader, RSShaderParameterIndex& parameters, OfObject& object);
+    /*! \brief Drop the files waiting to be prefetched and join the prefetch thread. Called when the module is unloaded.
+     *  \note Files queued afterwards are prefetched by a new thread */
+    void stop_texture_prefetching();
+
+    /*! \brief Counters of the cache of Redshift textures shared by all the shaders */
+    struct TextureCacheStatistics {
+        unsigned long long hits; //!< texture requests served by the cache
+        unsigned long long misses; //!< texture requests which created a Redshift texture
+        unsigned long long bytes; //!< bytes read by the background prefetching of new files
+        unsigned int count; //!< number of textures currently in the cache
+    };
+    /*! \brief Return the counters of the texture cache */
+    TextureCacheStatistics get_texture_cache_statistics();
 
     //
     /*! \brief Return the default material which is set to look like the default Clarisse one. */
@@ -187,14 +588,92 @@ namespace RedshiftUtils {
     RSMeshBase *CreateGeometry(const R2cSceneDelegate& delegate, R2cItemId geometry, RSMaterial * material, RSResourceInfo::Type& type);
     /*! \brief Create a Redshift instancer from an input Clarisse instancer */
     void CreateInstancer(RSInstancerInfo& instancer, RSResourceIndex& resource_index, const R2cSceneDelegate& delegate, RSScene *scene, R2cItemId cinstancer);
+    /*! \brief Fill the instances of the point clouds of an instancer
+     *  \param ptcs point clouds of the instancer, one per prototype
+     *  \param matrices matrix of each instance
+     *  \param indices index in ptcs of the point cloud of each instance
+     *  \note Matrices are converted in parallel by chunks of bounded size while the point clouds are only
+     *        filled by the calling thread since the Redshift SDK doesn't document them as thread safe */
+    void FillPointClouds(const CoreArray<RSPointCloud *>& ptcs, const CoreArray<GMathMatrix4x4d>& matrices, const CoreArray<unsigned int>& indices);
     /*! \brief Create a Redshift mesh from a Clarisse Polymesh  */
     RSMesh *CreatePolymesh(const PolyMesh& polymesh, RSMaterial *material);
     /*! \brief Create a Redshift mesh from an abstract geometry defined by a GeometryPolymesh class  */
     RSMesh *CreateGeometryPolymesh(const GeometryObject& polymesh, RSMaterial *material);
+    /*! \brief Return the polygonal geometry CreateGeometry() would convert to a Redshift mesh or nullptr if the geometry isn't polygonal
+     *  \note The returned geometry only depends on the resource so that it can be converted outside of the sync using CreatePolygonalMesh() */
+    const GeometryObject *GetPolygonalGeometry(const R2cSceneDelegate& delegate, R2cItemId geometry);
+    /*! \brief Create a Redshift mesh from a polygonal geometry returned by GetPolygonalGeometry() */
+    RSMesh *CreatePolygonalMesh(const GeometryObject& geometry, RSMaterial *material);
+    /*! \brief Gather the topology and attributes of a polygonal geometry returned by GetPolygonalGeometry()
+     *  \note Only the Clarisse geometry is read so that it can be called from any thread, the Redshift
+     *        mesh being then created from the description by the thread owning the render scene */
+    void DescribePolygonalMesh(const GeometryObject& geometry, PolymeshDescription& description);
+    /*! \brief Create a Redshift mesh from a description gathered by DescribePolygonalMesh() */
+    RSMesh *CreatePolygonalMesh(const PolymeshDescription& description, RSMaterial *material);
+    /*! \brief Set the thread manager of the application which runs the tasks of the conversions by default. Called by initialize()
+     *  \note Without thread manager, the default executor runs the tasks serially on the calling thread */
+    void set_thread_manager(SysThreadManager *thread_manager);
+    /*! \brief Set the executor running the tasks of the conversions, or restore the default one over the thread manager if nullptr
+     *  \note The executor isn't owned and must outlive the conversions */
+    void set_task_executor(RedshiftTaskExecutor *executor);
+    /*! \brief Return the executor running the tasks of the conversions */
+    RedshiftTaskExecutor& get_task_executor();
+    /*! \brief Create several Redshift meshes whose descriptions are gathered in parallel
+     *  \param count number of meshes
+     *  \param describe fill the description of the mesh of the specified index, called concurrently by several threads
+     *  \param meshes output meshes in the order of their index
+     *  \note The meshes are created in the order of their index by the calling thread, only their descriptions
+     *        being gathered by other threads, so that the Redshift API is never called concurrently and the
+     *        meshes are always created in the same order */
+    void CreatePolygonalMeshes(const unsigned int& count, const std::function<void(const unsigned int&, PolymeshDescription&)>& describe,
+                               RSMaterial *material, CoreArray<RSMesh *>& meshes);
+    /*! \brief Fill the vertex data and primitives of a Redshift mesh from a polygonal description
+     *  \param triangles if not null, triangulation of the polygons with more than four vertices which is filled
+     *         if it's empty and reused otherwise so that a deformed mesh keeps the same triangles
+     *  \note When called on an existing mesh its previous primitives are replaced */
+    void FillPolygonalMesh(RSMesh *mesh, const PolymeshDescription& description, RSMaterial *material, CoreVector<unsigned int> *triangles = nullptr);
+    /*! \brief Return an estimate of the size in bytes of the vertex data of the Redshift mesh created by CreateGeometry()
+     *         from the number of primitives of the geometry, which are assumed to be quads
+     *  \note Only polygonal geometries are accounted for, other geometries are considered negligible */
+    unsigned long long EstimateGeometrySize(const R2cSceneDelegate& delegate, R2cItemId geometry);
+    /*! \brief Return an estimate of the size in bytes of the vertex data of a Redshift mesh triangulated from the specified polygons */
+    unsigned long long EstimatePolygonalMeshSize(const unsigned long long& vertex_count, const unsigned int& polygon_count);
+    /*! \brief Update in place the points and normals of a Redshift mesh created from a Clarisse polygonal geometry whose topology is unchanged
+     *  \return false if the mesh can't be updated in place and must be created again
+     *  \note The topology of the mesh is kept by the resource after its first deformation so that the next
+     *        ones only gather the positions and normals of its points and keep its triangles */
+    bool DeformGeometry(const R2cSceneDelegate& delegate, R2cItemId geometry, RSResourceInfo& resource, RSMaterial *material);
+    /*! \brief Return true if the geometry is a groom which CreateGeometry() converts to a Redshift hair object */
+    bool IsHairGeometry(const R2cSceneDelegate& delegate, R2cItemId geometry);
+    /*! \brief Create a Redshift hair object from the curves of a Clarisse geometry or return nullptr if its curves can't be resolved
+     *  \param geometry geometry whose primitives are the curves of the groom
+     *  \param width width of the strands
+     *  \note The curves are read in place from the geometry and its point cloud, chunk by chunk */
+    RSMeshBase *CreateHair(const GeometryObject& geometry, const float& width, RSMaterial *material);
+    /*! \brief Resolve the number of vertices of each curve of a description whose curve_vertex_count holds the edge counts
+     *         of the primitives of the groom. Depending on the geometry, the edge count of an open curve is either its
+     *         number of vertices, like polygons list them, or its number of segments. The layout is deduced from the
+     *         number of primitive indices, which must match one of them.
+     *  \return false if the indices match neither layout or reference missing points */
+    bool ResolveHairLayout(HairDescription& description);
+    /*! \brief Resolve the layout of the curves of a source like ResolveHairLayout(HairDescription&) does, setting its edge offset
+     *  \return false if the indices match neither layout or reference missing points */
+    bool ResolveHairLayout(HairSource& source);
+    /*! \brief Create a Redshift hair object from a description whose layout is resolved */
+    RSMeshHair *CreateHair(const HairDescription& description, RSMaterial *material);
+    /*! \brief Create a Redshift hair object from a source whose layout is resolved
+     *  \note Curves are converted in parallel by chunks of bounded size which are streamed to the hair object */
+    RSMeshHair *CreateHair(const HairSource& source, RSMaterial *material);
     /*! \brief Create a Redshift sphere instancer representing a single Clarisse implit sphere. This method shouldn't be used  */
     RSPointCloud *CreateSphere(const float& radius, RSMaterial *material);
     /*! \brief Create a Redshift box mesh used to represent a Clarisse implicit box  */
     RSMesh *CreateBox(const GMathVec3d& size, RSMaterial *material);
+    /*! \brief Return true if the geometry is a parametric primitive which can be shared between geometries
+     *  \param key output key identifying the canonical primitive, geometries with the same key share the same Redshift resource
+     *  \param scale output scale to apply to the canonical primitive in the instance matrix to match the parameters of the geometry */
+    bool GetPrimitive(const R2cSceneDelegate& delegate, R2cItemId geometry, CoreString& key, GMathVec3d& scale);
+    /*! \brief Create the canonical primitive of the specified key returned by GetPrimitive(), a sphere of radius 1 or a box of size 1 */
+    RSMeshBase *CreatePrimitive(const CoreString& key, RSMaterial *material, RSResourceInfo::Type& type);
     /*! \brief Create a Redshift box mesh used to represent a Clarisse bounding box (useful for debugging)  */
     RSMesh *CreateBbox(const GMathBbox3d& bbox, RSMaterial *material);
     /*! \brief Create a Redshift light from a Clarisse light. This is really a barebone implementation  */
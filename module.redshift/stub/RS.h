@@ -0,0 +1,396 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+#ifndef RS_STUB_RS_H
+#define RS_STUB_RS_H
+
+// Stub of the subset of the Redshift API used by the translation code of module.redshift. It stands for
+// the SDK header so that the conversions can be built and measured on machines without Redshift nor GPU.
+// Objects keep the data they receive so that memory measurements stay meaningful, and each call and
+// allocation is recorded (see rs_stub.h). Signatures follow their use in module.redshift.
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//! Fixed size types
+class RSVector2 {
+public:
+    RSVector2() : x(0.0f), y(0.0f) {}
+    RSVector2(float x, float y) : x(x), y(y) {}
+    float x, y;
+};
+
+class RSVector3 {
+public:
+    RSVector3() : x(0.0f), y(0.0f), z(0.0f) {}
+    RSVector3(float x, float y, float z) : x(x), y(y), z(z) {}
+    float x, y, z;
+};
+
+class RSVector4 {
+public:
+    RSVector4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+    RSVector4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    float x, y, z, w;
+};
+
+class RSNormal {
+public:
+    RSNormal() : x(0.0f), y(0.0f), z(0.0f) {}
+    RSNormal(float x, float y, float z) : x(x), y(y), z(z) {}
+    float x, y, z;
+};
+
+class RSColor {
+public:
+    RSColor() : r(0.0f), g(0.0f), b(0.0f), a(1.0f) {}
+    RSColor(float r, float g, float b, float a = 1.0f) : r(r), g(g), b(b), a(a) {}
+    float r, g, b, a;
+};
+
+class RSMatrix4x4 {
+public:
+    RSMatrix4x4();
+    RSMatrix4x4(float m00, float m01, float m02, float m03,
+                float m10, float m11, float m12, float m13,
+                float m20, float m21, float m22, float m23,
+                float m30, float m31, float m32, float m33);
+    RSMatrix4x4& SetIdentity();
+    float m[4][4];
+};
+
+class RSString {
+public:
+    RSString() {}
+    RSString(const char *str) : m_str(str != nullptr ? str : "") {}
+    const char *c_str() const { return m_str.c_str(); }
+    operator const char *() const { return m_str.c_str(); }
+private:
+    std::string m_str;
+};
+
+template <class T>
+class RSArray {
+public:
+    void Add(const T& item) { m_items.push_back(item); }
+    unsigned int Length() const { return static_cast<unsigned int>(m_items.size()); }
+    T& operator[](const unsigned int& index) { return m_items[index]; }
+    const T& operator[](const unsigned int& index) const { return m_items[index]; }
+private:
+    std::vector<T> m_items;
+};
+
+#define RS_INVALIDATTRIBUTEINDEX 0xFFFFFFFF
+
+//! Visibility flags of the geometries, one bit per MESHFLAG_* name
+typedef unsigned int RSCachedMeshFlags;
+
+//! Callbacks implemented by the integration
+enum RSLogLevel {
+    RSLOGLEVEL_NONE,
+    RSLOGLEVEL_ERROR,
+    RSLOGLEVEL_WARNING,
+    RSLOGLEVEL_INFO,
+    RSLOGLEVEL_DEBUG
+};
+
+class RSAbortChecker {
+public:
+    virtual ~RSAbortChecker() {}
+    virtual bool ShouldAbort() = 0;
+};
+
+class RSProgressReporter {
+public:
+    virtual ~RSProgressReporter() {}
+    virtual void DisplayProgress(const char *message, unsigned int percentage) = 0;
+};
+
+class RSBlockSink {
+public:
+    virtual ~RSBlockSink() {}
+    virtual bool IsDisplaySink() const { return false; }
+    virtual const char *GetClassIdentifier() const = 0;
+    virtual void OutputBlock(unsigned int layerID, unsigned int denoisePassID, unsigned int offsetX, unsigned int offsetY, unsigned int width, unsigned int height, unsigned int stride, const char *pDataType, const char *pBitDepth, float gamma, bool clamped, const void *data) = 0;
+    virtual void NotifyWillRenderBlock(unsigned int offsetX, unsigned int offsetY, unsigned int width, unsigned int height) {}
+    virtual void PreRender() {}
+    virtual void PostRender() {}
+    virtual unsigned int GetWidth() const = 0;
+    virtual unsigned int GetHeight() const = 0;
+};
+
+class RSLogSink {
+public:
+    virtual ~RSLogSink() {}
+    virtual void Log(RSLogLevel level, const char *msg, size_t nCharsMSG) = 0;
+};
+
+//! Shading
+class RSShaderNode {
+public:
+    RSShaderNode(const char *name, const char *type) : m_name(name), m_type(type) {}
+    const char *GetName() const { return m_name; }
+    const char *GetTypeName() const { return m_type; }
+private:
+    RSString m_name;
+    RSString m_type;
+};
+
+class RSMaterial {
+public:
+    explicit RSMaterial(const char *name) : m_name(name), m_surface(nullptr) {}
+    void SetResourceName(const char *name) { m_name = name; }
+    const char *GetResourceName() const { return m_name; }
+    void SetSurfaceShaderNodeGraph(RSShaderNode *shader) { m_surface = shader; }
+    RSShaderNode *GetSurfaceShaderNodeGraph() const { return m_surface; }
+private:
+    RSString m_name;
+    RSShaderNode *m_surface;
+};
+
+class RSTexture {
+public:
+    RSTexture(const char *path, const unsigned long long& size) : m_path(path), m_size(size) {}
+    const char *GetPath() const { return m_path; }
+    unsigned long long GetSize() const { return m_size; }
+private:
+    RSString m_path;
+    unsigned long long m_size; // bytes of the file loaded by the texture
+};
+
+//! Lights
+class RSLight {
+public:
+    explicit RSLight(const char *name) : m_name(name), m_area_scaling(1.0f, 1.0f, 1.0f) {}
+    const char *GetName() const { return m_name; }
+    void SetMatrix(const RSMatrix4x4& matrix) { m_matrix = matrix; }
+    const RSMatrix4x4& GetMatrix() const { return m_matrix; }
+    void SetAreaScaling(const RSVector3& scaling) { m_area_scaling = scaling; }
+    const RSVector3& GetAreaScaling() const { return m_area_scaling; }
+private:
+    RSString m_name;
+    RSMatrix4x4 m_matrix;
+    RSVector3 m_area_scaling;
+};
+
+//! Vertex format of meshes
+class RSVertexData {
+public:
+    void SetNumAttributes(unsigned int count);
+    void SetAttributeDefinition(unsigned int index, const char *type, const char *usage, const char *name);
+    void FinalizeAttributeFormatAndAllocate(bool stripUnused, unsigned int numMotionSteps, bool hasTangents, const char *meshName, const RSArray<RSMaterial *>& materials);
+    bool IsAttributeUsed(unsigned int index) const;
+    unsigned int GetAttributeOffsetBytes(unsigned int index) const;
+    unsigned int GetVertexSizeBytes() const { return m_vertex_size; }
+private:
+    std::vector<unsigned int> m_sizes;
+    std::vector<unsigned int> m_offsets;
+    unsigned int m_vertex_size = 0;
+};
+
+//! Geometries
+class RSMeshBase {
+public:
+    explicit RSMeshBase(const char *name) : m_name(name), m_is_transformation_blurred(true) {}
+    virtual ~RSMeshBase();
+
+    const char *GetName() const { return m_name; }
+    void SetIsTransformationBlurred(bool blurred) { m_is_transformation_blurred = blurred; }
+    void SetNumMaterials(unsigned int count) { m_materials.resize(count, nullptr); }
+    unsigned int GetNumMaterials() const { return static_cast<unsigned int>(m_materials.size()); }
+    void SetMaterial(unsigned int index, RSMaterial *material) { m_materials[index] = material; }
+    RSMaterial *GetMaterial(unsigned int index) const { return m_materials[index]; }
+    void SetCachedMeshFlags(const RSCachedMeshFlags& flags) { m_flags = flags; }
+    RSCachedMeshFlags GetCachedMeshFlags() const { return m_flags; }
+    void BeginPrimitives(unsigned int count);
+    void CompactDataAndPrepareForRendering();
+
+    //! Bytes of the primitive data held by the object
+    unsigned long long GetDataSizeBytes() const { return m_data_size; }
+
+protected:
+
+    //! Account for data added to or removed from the object
+    void Allocate(const long long& bytes);
+    //! Drop all the primitives
+    virtual void ClearPrimitives() = 0;
+
+private:
+
+    RSString m_name;
+    std::vector<RSMaterial *> m_materials;
+    bool m_is_transformation_blurred;
+    RSCachedMeshFlags m_flags = ~0u;
+    unsigned long long m_data_size = 0;
+};
+
+class RSMesh : public RSMeshBase {
+public:
+    explicit RSMesh(const char *name) : RSMeshBase(name) {}
+
+    void SetAttributesFormat(RSVertexData *format);
+    void AddTri(const void *v0, const void *v1, const void *v2,
+                float s0, float s1, float s2, float t0, float t1, float t2,
+                unsigned int i0, unsigned int i1, unsigned int i2, unsigned short materialID);
+    void AddQuad(const void *v0, const void *v1, const void *v2, const void *v3,
+                 float s0, float s1, float s2, float s3, float t0, float t1, float t2, float t3,
+                 unsigned int i0, unsigned int i1, unsigned int i2, unsigned int i3, unsigned short materialID);
+
+    unsigned int GetNumTriangles() const { return m_triangle_count; }
+    unsigned int GetNumQuads() const { return m_quad_count; }
+    const std::vector<unsigned int>& GetIndices() const { return m_indices; }
+    const std::vector<char>& GetVertexData() const { return m_vertices; }
+    unsigned int GetVertexSizeBytes() const { return m_vertex_size; }
+
+protected:
+
+    void ClearPrimitives() override;
+
+private:
+
+    void AddVertex(const void *vertex, const unsigned int& index);
+
+    unsigned int m_vertex_size = 0;
+    unsigned int m_triangle_count = 0;
+    unsigned int m_quad_count = 0;
+    std::vector<char> m_vertices;
+    std::vector<unsigned int> m_indices;
+    std::vector<unsigned short> m_material_ids;
+};
+
+class RSMeshHair : public RSMeshBase {
+public:
+    explicit RSMeshHair(const char *name) : RSMeshBase(name) {}
+
+    void AddStrand(const RSVector4 *points, unsigned int count, unsigned int materialID);
+
+    unsigned int GetNumStrands() const { return static_cast<unsigned int>(m_strand_offsets.size()); }
+    const std::vector<RSVector4>& GetPoints() const { return m_points; }
+
+protected:
+
+    void ClearPrimitives() override;
+
+private:
+
+    std::vector<RSVector4> m_points;
+    std::vector<unsigned int> m_strand_offsets;
+};
+
+class RSPointCloud : public RSMeshBase {
+public:
+    RSPointCloud() : RSMeshBase("PointCloud"), m_template(nullptr) {}
+
+    void SetPrimitiveType(const char *type) { m_primitive_type = type; }
+    void SetInstanceTemplate(RSMeshBase *mesh) { m_template = mesh; }
+    RSMeshBase *GetInstanceTemplate() const { return m_template; }
+    void AddInstance(const RSMatrix4x4& matrix);
+    void SetMatrix(const RSMatrix4x4& matrix) { m_matrix = matrix; }
+
+    unsigned int GetNumInstances() const { return static_cast<unsigned int>(m_instances.size()); }
+    const RSMatrix4x4& GetInstance(const unsigned int& index) const { return m_instances[index]; }
+
+protected:
+
+    void ClearPrimitives() override;
+
+private:
+
+    RSString m_primitive_type;
+    RSMeshBase *m_template;
+    RSMatrix4x4 m_matrix;
+    std::vector<RSMatrix4x4> m_instances;
+};
+
+class RSInstanceMaterialOverrides {
+public:
+    RSInstanceMaterialOverrides() : m_template(nullptr) {}
+    void SetTemplate(RSMeshBase *mesh) { m_template = mesh; }
+    RSMeshBase *GetTemplate() const { return m_template; }
+    void SetNumMaterials(unsigned int count) { m_materials.resize(count, nullptr); }
+    unsigned int GetNumMaterials() const { return static_cast<unsigned int>(m_materials.size()); }
+    void SetMaterial(unsigned int index, RSMaterial *material) { m_materials[index] = material; }
+    RSMaterial *GetMaterial(unsigned int index) const { return m_materials[index]; }
+private:
+    RSMeshBase *m_template;
+    std::vector<RSMaterial *> m_materials;
+};
+
+class RSMeshInstance {
+public:
+    RSMeshInstance() : m_template(nullptr), m_overrides(0), m_is_transformation_blurred(true) {}
+    void SetIsTransformationBlurred(bool blurred) { m_is_transformation_blurred = blurred; }
+    void SetTemplate(RSMeshBase *mesh, unsigned int overrides) { m_template = mesh; m_overrides = overrides; }
+    RSMeshBase *GetTemplate() const { return m_template; }
+    void SetMatrix(const RSMatrix4x4& matrix) { m_matrix = matrix; }
+    const RSMatrix4x4& GetMatrix() const { return m_matrix; }
+    void SetCachedMeshFlags(const RSCachedMeshFlags& flags) { m_flags = flags; }
+    RSCachedMeshFlags GetCachedMeshFlags() const { return m_flags; }
+private:
+    RSMeshBase *m_template;
+    unsigned int m_overrides; // index of the material overrides in the scene
+    bool m_is_transformation_blurred;
+    RSCachedMeshFlags m_flags = ~0u;
+    RSMatrix4x4 m_matrix;
+};
+
+//! Render scene
+class RSScene {
+public:
+    void AddMesh(RSMeshBase *mesh);
+    void AddMeshInstance(RSMeshInstance *instance);
+    void AddMeshPointCloud(RSPointCloud *point_cloud);
+    unsigned int AddInstanceMaterialOverride(RSInstanceMaterialOverrides *overrides);
+    void AddLight(RSLight *light);
+    void ClearMeshes() { m_meshes.clear(); }
+    void ClearMeshInstances() { m_instances.clear(); }
+    void ClearMeshPointClouds() { m_point_clouds.clear(); }
+    void ClearInstanceMaterialOverrides() { m_overrides.clear(); }
+    void ClearLights() { m_lights.clear(); }
+
+    unsigned int GetNumMeshes() const { return static_cast<unsigned int>(m_meshes.size()); }
+    unsigned int GetNumMeshInstances() const { return static_cast<unsigned int>(m_instances.size()); }
+    unsigned int GetNumMeshPointClouds() const { return static_cast<unsigned int>(m_point_clouds.size()); }
+    unsigned int GetNumLights() const { return static_cast<unsigned int>(m_lights.size()); }
+private:
+    std::vector<RSMeshBase *> m_meshes;
+    std::vector<RSMeshInstance *> m_instances;
+    std::vector<RSPointCloud *> m_point_clouds;
+    std::vector<RSInstanceMaterialOverrides *> m_overrides;
+    std::vector<RSLight *> m_lights;
+};
+
+class RSCamera {};
+
+//! Object creation and release
+RSScene *RS_Scene_New();
+void RS_Scene_Delete(RSScene *scene);
+RSMesh *RS_Mesh_New(const char *name);
+RSMeshHair *RS_MeshHair_New(const char *name);
+void RS_MeshBase_Delete(RSMeshBase *mesh);
+RSPointCloud *RS_PointCloud_New();
+void RS_PointCloud_Delete(RSPointCloud *point_cloud);
+RSMeshInstance *RS_MeshInstance_New();
+void RS_MeshInstance_Delete(RSMeshInstance *instance);
+RSInstanceMaterialOverrides *RS_InstanceMaterialOverrides_New();
+void RS_InstanceMaterialOverrides_Delete(RSInstanceMaterialOverrides *overrides);
+RSLight *RS_Light_New(const char *name, const char *shader_name);
+void RS_Light_Delete(RSLight *light);
+RSCachedMeshFlags RS_CachedMeshFlag_GetDefault();
+void RS_CachedMeshFlag_Set(RSCachedMeshFlags& flags, const char *name, bool enabled);
+RSVertexData *RS_VertexData_New();
+void RS_VertexData_Delete(RSVertexData *data);
+RSMaterial *RS_Material_Get(const char *name);
+void RS_Material_Release(RSMaterial *material);
+RSShaderNode *RS_ShaderNode_Get(const char *name, const char *type);
+void RS_ShaderNode_Release(RSShaderNode *shader);
+//! Load the texture of a file, each call returning a new texture to release with RS_Texture_Release()
+RSTexture *RS_Texture_Get(const char *path);
+void RS_Texture_Release(RSTexture *texture);
+
+//! Rendering, simulated by passes of fixed duration reporting their progress (see RSStub::set_render_passes())
+void RS_Renderer_Render(RSCamera *camera, RSScene *scene, bool progressive, RSAbortChecker *abort_checker, RSProgressReporter *progress);
+
+#endif
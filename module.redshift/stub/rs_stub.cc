@@ -0,0 +1,468 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+#include "RS.h"
+#include "rs_stub.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+// Counters
+
+static const char *s_call_names[RSStub::CALL_COUNT] = {
+    "RS_Scene_New",
+    "RS_Mesh_New",
+    "RS_MeshHair_New",
+    "RS_PointCloud_New",
+    "RS_MeshInstance_New",
+    "RS_InstanceMaterialOverrides_New",
+    "RS_Light_New",
+    "RS_VertexData_New",
+    "RS_Material_Get",
+    "RS_ShaderNode_Get",
+    "RS_Texture_Get",
+    "Delete/Release",
+    "BeginPrimitives",
+    "AddTri",
+    "AddQuad",
+    "AddStrand",
+    "AddInstance",
+    "CompactDataAndPrepareForRendering",
+    "RSScene::Add*",
+    "RS_Renderer_Render",
+    "Render pass"
+};
+
+struct StubCounters {
+    std::atomic<unsigned long long> calls[RSStub::CALL_COUNT];
+    std::atomic<long long> objects;
+    std::atomic<unsigned long long> allocations;
+    std::atomic<long long> bytes;
+    std::atomic<long long> peak_bytes;
+    std::atomic<unsigned long long> foreign_calls;
+    std::thread::id api_thread; // thread expected to call the API, set by reset()
+    StubCounters() : objects(0), allocations(0), bytes(0), peak_bytes(0), foreign_calls(0), api_thread(std::this_thread::get_id()) { for (auto& call : calls) call = 0; }
+};
+
+static StubCounters&
+get_counters()
+{
+    static StubCounters counters;
+    return counters;
+}
+
+const char *
+RSStub::get_call_name(const Call& call)
+{
+    return s_call_names[call];
+}
+
+void
+RSStub::record_call(const Call& call)
+{
+    StubCounters& counters = get_counters();
+    counters.calls[call].fetch_add(1, std::memory_order_relaxed);
+    if (std::this_thread::get_id() != counters.api_thread) counters.foreign_calls.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+RSStub::record_objects(const long long& count)
+{
+    get_counters().objects.fetch_add(count, std::memory_order_relaxed);
+}
+
+void
+RSStub::record_bytes(const long long& bytes)
+{
+    StubCounters& counters = get_counters();
+    if (bytes > 0) counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    const long long current = counters.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    long long peak = counters.peak_bytes.load(std::memory_order_relaxed);
+    while (current > peak && !counters.peak_bytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {}
+}
+
+RSStub::Statistics
+RSStub::get_statistics()
+{
+    const StubCounters& counters = get_counters();
+    Statistics statistics;
+    for (unsigned int i = 0; i < CALL_COUNT; i++) statistics.calls[i] = counters.calls[i];
+    statistics.objects = static_cast<unsigned long long>(counters.objects);
+    statistics.allocations = counters.allocations;
+    statistics.bytes = static_cast<unsigned long long>(counters.bytes);
+    statistics.peak_bytes = static_cast<unsigned long long>(counters.peak_bytes);
+    statistics.foreign_calls = counters.foreign_calls;
+    return statistics;
+}
+
+void
+RSStub::reset()
+{
+    StubCounters& counters = get_counters();
+    for (auto& call : counters.calls) call = 0;
+    counters.allocations = 0;
+    counters.peak_bytes = counters.bytes.load();
+    counters.foreign_calls = 0;
+    counters.api_thread = std::this_thread::get_id();
+}
+
+void
+RSStub::print_statistics(FILE *file)
+{
+    const Statistics statistics = get_statistics();
+    for (unsigned int i = 0; i < CALL_COUNT; i++) {
+        if (statistics.calls[i] != 0) fprintf(file, "    %-36s %llu\n", s_call_names[i], statistics.calls[i]);
+    }
+    fprintf(file, "    %-36s %llu\n", "live objects", statistics.objects);
+    fprintf(file, "    %-36s %llu\n", "allocations", statistics.allocations);
+    fprintf(file, "    %-36s %.1f MB\n", "live data", static_cast<double>(statistics.bytes) / (1024.0 * 1024.0));
+    fprintf(file, "    %-36s %.1f MB\n", "peak data", static_cast<double>(statistics.peak_bytes) / (1024.0 * 1024.0));
+    if (statistics.foreign_calls != 0) fprintf(file, "    %-36s %llu\n", "calls from other threads", statistics.foreign_calls);
+}
+
+// Types
+
+RSMatrix4x4::RSMatrix4x4()
+{
+    SetIdentity();
+}
+
+RSMatrix4x4::RSMatrix4x4(float m00, float m01, float m02, float m03,
+                         float m10, float m11, float m12, float m13,
+                         float m20, float m21, float m22, float m23,
+                         float m30, float m31, float m32, float m33)
+{
+    m[0][0] = m00; m[0][1] = m01; m[0][2] = m02; m[0][3] = m03;
+    m[1][0] = m10; m[1][1] = m11; m[1][2] = m12; m[1][3] = m13;
+    m[2][0] = m20; m[2][1] = m21; m[2][2] = m22; m[2][3] = m23;
+    m[3][0] = m30; m[3][1] = m31; m[3][2] = m32; m[3][3] = m33;
+}
+
+RSMatrix4x4&
+RSMatrix4x4::SetIdentity()
+{
+    for (unsigned int i = 0; i < 4; i++) {
+        for (unsigned int j = 0; j < 4; j++) m[i][j] = i == j ? 1.0f : 0.0f;
+    }
+    return *this;
+}
+
+// Vertex format
+
+// size in bytes of a vertex attribute type
+static unsigned int
+get_attribute_size(const char *type)
+{
+    if (strcmp(type, "RS_ATTRIBUTETYPE_FLOAT2") == 0) return 2 * sizeof(float);
+    if (strcmp(type, "RS_ATTRIBUTETYPE_FLOAT4") == 0) return 4 * sizeof(float);
+    if (strcmp(type, "RS_ATTRIBUTETYPE_FLOAT") == 0) return sizeof(float);
+    return 3 * sizeof(float); // RS_ATTRIBUTETYPE_FLOAT3, RS_ATTRIBUTETYPE_NORMAL
+}
+
+void
+RSVertexData::SetNumAttributes(unsigned int count)
+{
+    m_sizes.assign(count, 0);
+    m_offsets.assign(count, RS_INVALIDATTRIBUTEINDEX);
+    m_vertex_size = 0;
+}
+
+void
+RSVertexData::SetAttributeDefinition(unsigned int index, const char *type, const char *usage, const char *name)
+{
+    m_sizes[index] = get_attribute_size(type);
+}
+
+void
+RSVertexData::FinalizeAttributeFormatAndAllocate(bool stripUnused, unsigned int numMotionSteps, bool hasTangents, const char *meshName, const RSArray<RSMaterial *>& materials)
+{
+    // attributes are packed in their declaration order, none of them being stripped
+    m_vertex_size = 0;
+    for (unsigned int i = 0; i < m_sizes.size(); i++) {
+        m_offsets[i] = m_vertex_size;
+        m_vertex_size += m_sizes[i];
+    }
+}
+
+bool
+RSVertexData::IsAttributeUsed(unsigned int index) const
+{
+    return m_offsets[index] != RS_INVALIDATTRIBUTEINDEX;
+}
+
+unsigned int
+RSVertexData::GetAttributeOffsetBytes(unsigned int index) const
+{
+    return m_offsets[index];
+}
+
+// Geometries
+
+RSMeshBase::~RSMeshBase()
+{
+    RSStub::record_bytes(-static_cast<long long>(m_data_size));
+}
+
+void
+RSMeshBase::BeginPrimitives(unsigned int count)
+{
+    RSStub::record_call(RSStub::CALL_BEGIN_PRIMITIVES);
+    ClearPrimitives();
+    Allocate(-static_cast<long long>(m_data_size));
+}
+
+void
+RSMeshBase::CompactDataAndPrepareForRendering()
+{
+    RSStub::record_call(RSStub::CALL_COMPACT_DATA);
+}
+
+void
+RSMeshBase::Allocate(const long long& bytes)
+{
+    m_data_size += bytes;
+    RSStub::record_bytes(bytes);
+}
+
+void
+RSMesh::SetAttributesFormat(RSVertexData *format)
+{
+    // the format may be deleted right after so only its vertex size is kept
+    m_vertex_size = format->GetVertexSizeBytes();
+}
+
+void
+RSMesh::AddVertex(const void *vertex, const unsigned int& index)
+{
+    const char *data = static_cast<const char *>(vertex);
+    m_vertices.insert(m_vertices.end(), data, data + m_vertex_size);
+    m_indices.push_back(index);
+}
+
+void
+RSMesh::AddTri(const void *v0, const void *v1, const void *v2,
+               float s0, float s1, float s2, float t0, float t1, float t2,
+               unsigned int i0, unsigned int i1, unsigned int i2, unsigned short materialID)
+{
+    RSStub::record_call(RSStub::CALL_ADD_TRI);
+    AddVertex(v0, i0);
+    AddVertex(v1, i1);
+    AddVertex(v2, i2);
+    m_material_ids.push_back(materialID);
+    m_triangle_count++;
+    Allocate(3 * (m_vertex_size + sizeof(unsigned int)) + sizeof(unsigned short));
+}
+
+void
+RSMesh::AddQuad(const void *v0, const void *v1, const void *v2, const void *v3,
+                float s0, float s1, float s2, float s3, float t0, float t1, float t2, float t3,
+                unsigned int i0, unsigned int i1, unsigned int i2, unsigned int i3, unsigned short materialID)
+{
+    RSStub::record_call(RSStub::CALL_ADD_QUAD);
+    AddVertex(v0, i0);
+    AddVertex(v1, i1);
+    AddVertex(v2, i2);
+    AddVertex(v3, i3);
+    m_material_ids.push_back(materialID);
+    m_quad_count++;
+    Allocate(4 * (m_vertex_size + sizeof(unsigned int)) + sizeof(unsigned short));
+}
+
+void
+RSMesh::ClearPrimitives()
+{
+    std::vector<char>().swap(m_vertices);
+    std::vector<unsigned int>().swap(m_indices);
+    std::vector<unsigned short>().swap(m_material_ids);
+    m_triangle_count = 0;
+    m_quad_count = 0;
+}
+
+void
+RSMeshHair::AddStrand(const RSVector4 *points, unsigned int count, unsigned int materialID)
+{
+    RSStub::record_call(RSStub::CALL_ADD_STRAND);
+    m_strand_offsets.push_back(static_cast<unsigned int>(m_points.size()));
+    m_points.insert(m_points.end(), points, points + count);
+    Allocate(count * sizeof(RSVector4) + sizeof(unsigned int));
+}
+
+void
+RSMeshHair::ClearPrimitives()
+{
+    std::vector<RSVector4>().swap(m_points);
+    std::vector<unsigned int>().swap(m_strand_offsets);
+}
+
+void
+RSPointCloud::AddInstance(const RSMatrix4x4& matrix)
+{
+    RSStub::record_call(RSStub::CALL_ADD_INSTANCE);
+    m_instances.push_back(matrix);
+    Allocate(sizeof(RSMatrix4x4));
+}
+
+void
+RSPointCloud::ClearPrimitives()
+{
+    std::vector<RSMatrix4x4>().swap(m_instances);
+}
+
+// Scene
+
+void
+RSScene::AddMesh(RSMeshBase *mesh)
+{
+    RSStub::record_call(RSStub::CALL_SCENE_ADD);
+    m_meshes.push_back(mesh);
+}
+
+void
+RSScene::AddMeshInstance(RSMeshInstance *instance)
+{
+    RSStub::record_call(RSStub::CALL_SCENE_ADD);
+    m_instances.push_back(instance);
+}
+
+void
+RSScene::AddMeshPointCloud(RSPointCloud *point_cloud)
+{
+    RSStub::record_call(RSStub::CALL_SCENE_ADD);
+    m_point_clouds.push_back(point_cloud);
+}
+
+unsigned int
+RSScene::AddInstanceMaterialOverride(RSInstanceMaterialOverrides *overrides)
+{
+    RSStub::record_call(RSStub::CALL_SCENE_ADD);
+    m_overrides.push_back(overrides);
+    return static_cast<unsigned int>(m_overrides.size() - 1);
+}
+
+void
+RSScene::AddLight(RSLight *light)
+{
+    RSStub::record_call(RSStub::CALL_SCENE_ADD);
+    m_lights.push_back(light);
+}
+
+// Object creation and release
+
+template <class T>
+static inline T *
+new_object(T *object, const RSStub::Call& call)
+{
+    RSStub::record_call(call);
+    RSStub::record_objects(1);
+    return object;
+}
+
+template <class T>
+static inline void
+delete_object(T *object)
+{
+    if (object == nullptr) return;
+    RSStub::record_call(RSStub::CALL_DELETE);
+    RSStub::record_objects(-1);
+    delete object;
+}
+
+RSScene *RS_Scene_New() { return new_object(new RSScene, RSStub::CALL_SCENE_NEW); }
+void RS_Scene_Delete(RSScene *scene) { delete_object(scene); }
+RSMesh *RS_Mesh_New(const char *name) { return new_object(new RSMesh(name), RSStub::CALL_MESH_NEW); }
+RSMeshHair *RS_MeshHair_New(const char *name) { return new_object(new RSMeshHair(name), RSStub::CALL_MESH_HAIR_NEW); }
+void RS_MeshBase_Delete(RSMeshBase *mesh) { delete_object(mesh); }
+RSPointCloud *RS_PointCloud_New() { return new_object(new RSPointCloud, RSStub::CALL_POINT_CLOUD_NEW); }
+void RS_PointCloud_Delete(RSPointCloud *point_cloud) { delete_object(point_cloud); }
+RSMeshInstance *RS_MeshInstance_New() { return new_object(new RSMeshInstance, RSStub::CALL_MESH_INSTANCE_NEW); }
+void RS_MeshInstance_Delete(RSMeshInstance *instance) { delete_object(instance); }
+RSInstanceMaterialOverrides *RS_InstanceMaterialOverrides_New() { return new_object(new RSInstanceMaterialOverrides, RSStub::CALL_MATERIAL_OVERRIDES_NEW); }
+void RS_InstanceMaterialOverrides_Delete(RSInstanceMaterialOverrides *overrides) { delete_object(overrides); }
+RSLight *RS_Light_New(const char *name, const char *shader_name) { return new_object(new RSLight(name), RSStub::CALL_LIGHT_NEW); }
+void RS_Light_Delete(RSLight *light) { delete_object(light); }
+RSVertexData *RS_VertexData_New() { return new_object(new RSVertexData, RSStub::CALL_VERTEX_DATA_NEW); }
+void RS_VertexData_Delete(RSVertexData *data) { delete_object(data); }
+RSMaterial *RS_Material_Get(const char *name) { return new_object(new RSMaterial(name), RSStub::CALL_MATERIAL_GET); }
+void RS_Material_Release(RSMaterial *material) { delete_object(material); }
+RSShaderNode *RS_ShaderNode_Get(const char *name, const char *type) { return new_object(new RSShaderNode(name, type), RSStub::CALL_SHADER_NODE_GET); }
+void RS_ShaderNode_Release(RSShaderNode *shader) { delete_object(shader); }
+
+// Visibility flags
+
+// names of the flags in the order of their bit
+static const char *s_mesh_flag_names[] = {
+    "MESHFLAG_PRIMARYRAYVISIBLE",
+    "MESHFLAG_AOCASTER",
+    "MESHFLAG_SHADOWCASTER",
+    "MESHFLAG_REFLECTIONVISIBLE",
+    "MESHFLAG_REFRACTIONVISIBLE",
+    "MESHFLAG_GIVISIBLE",
+    "MESHFLAG_CAUSTICVISIBLE",
+    "MESHFLAG_FGVISIBLE"
+};
+
+RSCachedMeshFlags
+RS_CachedMeshFlag_GetDefault()
+{
+    return ~0u;
+}
+
+void
+RS_CachedMeshFlag_Set(RSCachedMeshFlags& flags, const char *name, bool enabled)
+{
+    for (unsigned int i = 0; i < sizeof(s_mesh_flag_names) / sizeof(s_mesh_flag_names[0]); i++) {
+        if (strcmp(name, s_mesh_flag_names[i]) == 0) flags = enabled ? flags | (1u << i) : flags & ~(1u << i);
+    }
+}
+
+RSTexture *
+RS_Texture_Get(const char *path)
+{
+    // the size of the file stands for the memory of the loaded texture, missing files failing to load
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        RSStub::record_call(RSStub::CALL_TEXTURE_GET);
+        return nullptr;
+    }
+    const long long size = static_cast<long long>(file.tellg());
+    RSStub::record_bytes(size);
+    return new_object(new RSTexture(path, static_cast<unsigned long long>(size)), RSStub::CALL_TEXTURE_GET);
+}
+
+void
+RS_Texture_Release(RSTexture *texture)
+{
+    if (texture != nullptr) RSStub::record_bytes(-static_cast<long long>(texture->GetSize()));
+    delete_object(texture);
+}
+
+// Rendering
+
+// number of passes of a render and duration of each pass in milliseconds
+static std::atomic<unsigned int> s_render_pass_count(4);
+static std::atomic<unsigned int> s_render_pass_duration(1);
+
+void
+RSStub::set_render_passes(const unsigned int& count, const unsigned int& duration)
+{
+    s_render_pass_count = count;
+    s_render_pass_duration = duration;
+}
+
+void
+RS_Renderer_Render(RSCamera *camera, RSScene *scene, bool progressive, RSAbortChecker *abort_checker, RSProgressReporter *progress)
+{
+    RSStub::record_call(RSStub::CALL_RENDER);
+    // a non progressive render is a single pass
+    const unsigned int pass_count = progressive ? s_render_pass_count.load() : 1;
+    for (unsigned int pass = 0; pass < pass_count; pass++) {
+        if (abort_checker != nullptr && abort_checker->ShouldAbort()) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(s_render_pass_duration));
+        RSStub::record_call(RSStub::CALL_RENDER_PASS);
+        if (progress != nullptr) progress->DisplayProgress("Rendering", (pass + 1) * 100 / pass_count);
+    }
+}
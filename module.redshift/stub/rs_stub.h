@@ -0,0 +1,70 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+#ifndef RS_STUB_H
+#define RS_STUB_H
+
+#include <cstdio>
+
+/*! \namespace RSStub
+    \brief Calls and allocations recorded by the stub of the Redshift API. Counters are atomic so that
+           they can be updated from any thread, the objects themselves not being thread safe. */
+namespace RSStub {
+
+    //! Recorded calls
+    enum Call {
+        CALL_SCENE_NEW,
+        CALL_MESH_NEW,
+        CALL_MESH_HAIR_NEW,
+        CALL_POINT_CLOUD_NEW,
+        CALL_MESH_INSTANCE_NEW,
+        CALL_MATERIAL_OVERRIDES_NEW,
+        CALL_LIGHT_NEW,
+        CALL_VERTEX_DATA_NEW,
+        CALL_MATERIAL_GET,
+        CALL_SHADER_NODE_GET,
+        CALL_TEXTURE_GET,
+        CALL_DELETE, //!< any deletion or release of an object
+        CALL_BEGIN_PRIMITIVES,
+        CALL_ADD_TRI,
+        CALL_ADD_QUAD,
+        CALL_ADD_STRAND,
+        CALL_ADD_INSTANCE,
+        CALL_COMPACT_DATA,
+        CALL_SCENE_ADD, //!< any item added to the scene
+        CALL_RENDER,
+        CALL_RENDER_PASS, //!< any pass rendered until its end
+        CALL_COUNT
+    };
+
+    /*! \brief Snapshot of the counters of the stub */
+    struct Statistics {
+        unsigned long long calls[CALL_COUNT]; //!< number of calls of each kind
+        unsigned long long objects; //!< number of live objects
+        unsigned long long allocations; //!< number of allocations of primitive data
+        unsigned long long bytes; //!< bytes of primitive data held by the live objects
+        unsigned long long peak_bytes; //!< maximum of bytes since the last reset
+        unsigned long long foreign_calls; //!< number of calls made by another thread than the one which last reset the counters
+    };
+
+    /*! \brief Return the name of a call */
+    const char *get_call_name(const Call& call);
+    /*! \brief Record a call */
+    void record_call(const Call& call);
+    /*! \brief Record the creation (positive count) or the deletion (negative count) of objects */
+    void record_objects(const long long& count);
+    /*! \brief Record primitive data added (positive bytes) to or removed (negative bytes) from an object */
+    void record_bytes(const long long& bytes);
+    /*! \brief Return the current counters */
+    Statistics get_statistics();
+    /*! \brief Reset the call counters and the peak of bytes, the live objects and bytes being kept.
+     *         The calling thread becomes the one expected to call the API. */
+    void reset();
+    /*! \brief Set the number of passes rendered by RS_Renderer_Render() and their duration in milliseconds */
+    void set_render_passes(const unsigned int& count, const unsigned int& duration);
+    /*! \brief Print the counters which aren't null */
+    void print_statistics(FILE *file);
+};
+
+#endif
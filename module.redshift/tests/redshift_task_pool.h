@@ -0,0 +1,118 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+#ifndef REDSHIFT_TASK_POOL_H
+#define REDSHIFT_TASK_POOL_H
+
+#include <redshift_utils.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*! \class RedshiftTaskPool
+    \brief Executor of the tasks of the conversions used by the tests and the benchmarks, which run without the thread
+            manager of Clarisse. Its worker threads are started once and wait for batches of tasks, the calling thread
+            running tasks of its batch too. A batch run while another one is running, or from a task, is run serially
+            by the calling thread. */
+class RedshiftTaskPool : public RedshiftTaskExecutor {
+public:
+    RedshiftTaskPool() : m_batch(nullptr), m_generation(0), m_is_stopped(false)
+    {
+        const unsigned int concurrency = std::max(std::thread::hardware_concurrency(), 1u);
+        for (unsigned int i = 1; i < concurrency; i++) m_workers.add(new std::thread(&RedshiftTaskPool::work, this));
+    }
+
+    ~RedshiftTaskPool() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_is_stopped = true;
+        }
+        m_wake_up.notify_all();
+        for (auto worker : m_workers) {
+            worker->join();
+            delete worker;
+        }
+    }
+
+    unsigned int get_concurrency() const override { return m_workers.get_count() + 1; }
+
+    void run(const unsigned int& count, const std::function<void(const unsigned int&)>& task) override
+    {
+        if (count <= 1 || m_workers.get_count() == 0 || is_worker() || !m_run_mutex.try_lock()) {
+            for (unsigned int i = 0; i < count; i++) task(i);
+            return;
+        }
+        Batch batch(task, count);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_batch = &batch;
+            m_generation++;
+        }
+        m_wake_up.notify_all();
+        batch.execute();
+        {
+            // the batch lives on this stack so it's unpublished once no worker is running its tasks anymore
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_finished.wait(lock, [&batch]() { return batch.active == 0; });
+            m_batch = nullptr;
+        }
+        m_run_mutex.unlock();
+    }
+
+private:
+    /*! \brief Tasks of a run, picked by index by the threads until they are all taken */
+    struct Batch {
+        Batch(const std::function<void(const unsigned int&)>& t, const unsigned int& c) : task(t), count(c), next(0), active(0) {}
+        void execute()
+        {
+            for (unsigned int i = next++; i < count; i = next++) task(i);
+        }
+
+        const std::function<void(const unsigned int&)>& task;
+        const unsigned int count;
+        std::atomic<unsigned int> next; //!< index of the next task to run
+        unsigned int active; //!< number of workers running tasks of the batch, guarded by m_mutex
+    };
+
+    /*! \brief Return true on the worker threads of the pools */
+    static bool& is_worker()
+    {
+        static thread_local bool is_worker = false;
+        return is_worker;
+    }
+
+    void work()
+    {
+        is_worker() = true;
+        unsigned long long generation = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_wake_up.wait(lock, [this, &generation]() { return m_is_stopped || (m_batch != nullptr && m_generation != generation); });
+            if (m_is_stopped) return;
+            generation = m_generation;
+            Batch *batch = m_batch;
+            batch->active++;
+            lock.unlock();
+            batch->execute();
+            lock.lock();
+            if (--batch->active == 0) m_finished.notify_all();
+        }
+    }
+
+    CoreVector<std::thread *> m_workers;
+    std::mutex m_run_mutex; //!< held during a run since the workers serve one batch at a time
+    std::mutex m_mutex;
+    std::condition_variable m_wake_up;
+    std::condition_variable m_finished;
+    Batch *m_batch; //!< batch currently run, guarded by m_mutex
+    unsigned long long m_generation; //!< incremented for each batch so that a worker joins each batch once
+    bool m_is_stopped;
+};
+
+#endif
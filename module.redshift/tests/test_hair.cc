@@ -0,0 +1,129 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Checks the resolution of the curve layout of grooms by RedshiftUtils::ResolveHairLayout() and their
+// conversion by RedshiftUtils::CreateHair() against the stub of the Redshift API.
+
+#include <RS.h>
+#include <rs_stub.h>
+#include <redshift_utils.h>
+
+#include <r2c_test_utils.h>
+
+// describe a groom of curves of the specified number of vertices, each vertex having its own point
+static void
+make_groom(HairDescription& desc, const CoreVector<unsigned int>& vertex_counts)
+{
+    desc.positions.remove_all();
+    desc.curve_vertex_count.resize(vertex_counts.get_count());
+    desc.curve_vertex_ids.remove_all();
+    for (unsigned int i = 0; i < vertex_counts.get_count(); i++) {
+        desc.curve_vertex_count[i] = vertex_counts[i];
+        for (unsigned int j = 0; j < vertex_counts[i]; j++) {
+            desc.curve_vertex_ids.add(desc.positions.get_count());
+            desc.positions.add(GMathVec3f(static_cast<float>(i), static_cast<float>(j), 1.0f));
+        }
+    }
+    desc.radius = 0.25f;
+}
+
+static void
+test_layout()
+{
+    CoreVector<unsigned int> vertex_counts;
+    vertex_counts.add(4);
+    vertex_counts.add(2);
+    vertex_counts.add(7);
+
+    // edge counts listing the vertices like polygons do
+    HairDescription vertices;
+    make_groom(vertices, vertex_counts);
+    CHECK(RedshiftUtils::ResolveHairLayout(vertices));
+    for (unsigned int i = 0; i < vertex_counts.get_count(); i++) CHECK(vertices.curve_vertex_count[i] == vertex_counts[i]);
+
+    // edge counts being the segments of the curves
+    HairDescription segments;
+    make_groom(segments, vertex_counts);
+    for (unsigned int i = 0; i < vertex_counts.get_count(); i++) segments.curve_vertex_count[i]--;
+    CHECK(RedshiftUtils::ResolveHairLayout(segments));
+    for (unsigned int i = 0; i < vertex_counts.get_count(); i++) CHECK(segments.curve_vertex_count[i] == vertex_counts[i]);
+
+    // indices matching neither layout
+    HairDescription mismatch;
+    make_groom(mismatch, vertex_counts);
+    mismatch.curve_vertex_count[1] += 2;
+    CHECK(!RedshiftUtils::ResolveHairLayout(mismatch));
+
+    // indices referencing missing points
+    HairDescription missing;
+    make_groom(missing, vertex_counts);
+    missing.curve_vertex_ids[3] = missing.positions.get_count();
+    CHECK(!RedshiftUtils::ResolveHairLayout(missing));
+}
+
+// check that each curve of more than one vertex gives a strand of its converted vertices
+static void
+check_hair(const CoreVector<unsigned int>& vertex_counts)
+{
+    HairDescription desc;
+    make_groom(desc, vertex_counts);
+    unsigned int strand_count = 0;
+    unsigned int point_count = 0;
+    for (auto count : vertex_counts) {
+        if (count > 1) {
+            strand_count++;
+            point_count += count;
+        }
+    }
+
+    RSStub::reset();
+    RSMaterial *material = RS_Material_Get("test");
+    RSMeshHair *hair = RedshiftUtils::CreateHair(desc, material);
+    CHECK(hair->GetNumStrands() == strand_count);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_ADD_STRAND] == strand_count);
+    CHECK(hair->GetMaterial(0) == material);
+
+    const std::vector<RSVector4>& points = hair->GetPoints();
+    CHECK(points.size() == point_count);
+    bool is_matching = points.size() == point_count;
+    unsigned int point = 0;
+    for (unsigned int i = 0; i < vertex_counts.get_count() && is_matching; i++) {
+        if (vertex_counts[i] < 2) continue;
+        for (unsigned int j = 0; j < vertex_counts[i]; j++, point++) {
+            const RSVector4& p = points[point];
+            is_matching = is_matching && p.x == static_cast<float>(i) && p.y == static_cast<float>(j) && p.z == -1.0f && p.w == desc.radius;
+        }
+    }
+    CHECK(is_matching);
+
+    RS_MeshBase_Delete(hair);
+    RS_Material_Release(material);
+}
+
+static void
+test_hair()
+{
+    // curves without segments are skipped
+    CoreVector<unsigned int> vertex_counts;
+    vertex_counts.add(3);
+    vertex_counts.add(1);
+    vertex_counts.add(0);
+    vertex_counts.add(5);
+    check_hair(vertex_counts);
+
+    // curves spanning many chunks, including curves larger than a chunk
+    vertex_counts.remove_all();
+    for (unsigned int i = 0; i < 50000; i++) vertex_counts.add(2 + i % 13);
+    vertex_counts.add(100000);
+    vertex_counts.add(3);
+    check_hair(vertex_counts);
+}
+
+int
+main(int argc, char **argv)
+{
+    test_layout();
+    test_hair();
+    return test_result();
+}
@@ -0,0 +1,76 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Checks the filling of the point clouds of instancers by RedshiftUtils::FillPointClouds() against the stub
+// of the Redshift API.
+
+#include <RS.h>
+#include <rs_stub.h>
+#include <redshift_utils.h>
+
+#include <cstring>
+
+#include <r2c_test_utils.h>
+
+// check that each point cloud holds its instances in their original order with their converted matrix
+static void
+check_point_clouds(const CoreArray<RSPointCloud *>& ptcs, const CoreArray<GMathMatrix4x4d>& matrices, const CoreArray<unsigned int>& indices)
+{
+    CoreArray<unsigned int> counts(ptcs.get_count());
+    for (unsigned int i = 0; i < counts.get_count(); i++) counts[i] = 0;
+    bool is_matching = true;
+    for (unsigned int i = 0; i < indices.get_count() && is_matching; i++) {
+        const unsigned int ptc = indices[i];
+        const RSMatrix4x4 expected = RedshiftUtils::ToRSMatrix4x4(matrices[i]);
+        is_matching = counts[ptc] < ptcs[ptc]->GetNumInstances() && memcmp(&ptcs[ptc]->GetInstance(counts[ptc]), &expected, sizeof(RSMatrix4x4)) == 0;
+        counts[ptc]++;
+    }
+    CHECK(is_matching);
+    for (unsigned int i = 0; i < ptcs.get_count(); i++) CHECK(ptcs[i]->GetNumInstances() == counts[i]);
+}
+
+// fill point clouds with the specified number of instances spread over them, the last one being left empty
+static void
+test_fill(const unsigned int& ptc_count, const unsigned int& instance_count)
+{
+    CoreArray<RSPointCloud *> ptcs(ptc_count);
+    for (unsigned int i = 0; i < ptc_count; i++) ptcs[i] = RS_PointCloud_New();
+
+    CoreArray<GMathMatrix4x4d> matrices(instance_count);
+    CoreArray<unsigned int> indices(instance_count);
+    const GMathMatrix4x4d identity(true);
+    for (unsigned int i = 0; i < instance_count; i++) {
+        GMathMatrix4x4d& matrix = matrices[i];
+        matrix = identity;
+        matrix[0][0] = 1.0 + i % 7;
+        matrix[1][2] = 0.5;
+        matrix[3][0] = static_cast<double>(i);
+        matrix[3][2] = -static_cast<double>(i % 1000);
+        indices[i] = ptc_count > 1 ? (i * 7919u) % (ptc_count - 1) : 0;
+    }
+
+    RSStub::reset();
+    RedshiftUtils::FillPointClouds(ptcs, matrices, indices);
+    const RSStub::Statistics statistics = RSStub::get_statistics();
+    CHECK(statistics.calls[RSStub::CALL_BEGIN_PRIMITIVES] == ptc_count);
+    CHECK(statistics.calls[RSStub::CALL_COMPACT_DATA] == ptc_count);
+    CHECK(statistics.calls[RSStub::CALL_ADD_INSTANCE] == instance_count);
+    check_point_clouds(ptcs, matrices, indices);
+
+    // filling again replaces the previous instances
+    RedshiftUtils::FillPointClouds(ptcs, matrices, indices);
+    check_point_clouds(ptcs, matrices, indices);
+
+    for (auto ptc : ptcs) RS_PointCloud_Delete(ptc);
+}
+
+int
+main(int argc, char **argv)
+{
+    test_fill(1, 0);
+    test_fill(4, 1000);
+    // more instances than converted at once
+    test_fill(9, 2500000);
+    return test_result();
+}
@@ -0,0 +1,188 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Checks the control flow of InteractiveRender against the stub of the Redshift API simulating progressive passes:
+// the scene is synchronized by the calling thread which returns without waiting for the passes rendered on a background
+// thread, modifications recorded during the passes abort them, a new render aborts the passes in progress before
+// synchronizing the scene, and stopping the background thread aborts the passes in progress.
+
+#include <RS.h>
+#include <rs_stub.h>
+#include <redshift_utils.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <r2c_test_utils.h>
+
+// number of passes of each render, long enough for the scene to be modified during the passes
+static const unsigned int s_pass_count = 20;
+// duration of a pass in milliseconds
+static const unsigned int s_pass_duration = 5;
+// maximum time in milliseconds to wait for the passes
+static const unsigned int s_timeout = 10000;
+
+/*! \brief Abort checker interrupted by the modifications of the scene or by a new render */
+class TestAbortChecker : public RSAbortChecker {
+public:
+    TestAbortChecker() : is_interrupted(false) {}
+    bool ShouldAbort() override { return is_interrupted; }
+
+    std::atomic<bool> is_interrupted;
+};
+
+/*! \brief Progress reporter counting the passes rendered since the last sync */
+class TestProgress : public RSProgressReporter {
+public:
+    TestProgress() : passes(0), percentage(0) {}
+    void DisplayProgress(const char *message, unsigned int value) override
+    {
+        passes++;
+        percentage = value;
+    }
+
+    std::atomic<unsigned int> passes;
+    std::atomic<unsigned int> percentage;
+};
+
+/*! \brief Scene whose modifications are recorded until the render synchronizes them */
+struct TestScene {
+    TestScene() : scene(RS_Scene_New()), modification_count(0), synchronized_count(0), sync_count(0),
+                  is_rendering(false), is_rendering_during_sync(false) {}
+    ~TestScene() { RS_Scene_Delete(scene); }
+
+    RSScene *scene;
+    RSCamera camera;
+    TestAbortChecker abort_checker;
+    TestProgress progress;
+    unsigned int modification_count; // modifications recorded, guarded by the lock of the render
+    unsigned int synchronized_count; // modifications synchronized with the render scene
+    unsigned int sync_count;
+    std::atomic<bool> is_rendering;
+    bool is_rendering_during_sync; // true if the scene was synchronized while passes were rendered
+    std::thread::id sync_thread;
+    std::thread::id render_thread;
+};
+
+// record a modification of the scene like the render delegate does
+static void
+modify(InteractiveRender& ipr, TestScene& scene)
+{
+    std::lock_guard<std::recursive_mutex> lock(ipr.get_lock());
+    scene.modification_count++;
+    scene.abort_checker.is_interrupted = true;
+}
+
+// render the scene the way the render delegate does in interactive mode
+static void
+render(InteractiveRender& ipr, TestScene& scene)
+{
+    ipr.restart([&scene]() {
+        scene.is_rendering_during_sync = scene.is_rendering_during_sync || scene.is_rendering;
+        scene.abort_checker.is_interrupted = false;
+        scene.synchronized_count = scene.modification_count;
+        scene.progress.passes = 0;
+        scene.progress.percentage = 0;
+        scene.sync_thread = std::this_thread::get_id();
+        scene.sync_count++;
+        return true;
+    }, [&scene]() {
+        scene.is_rendering = true;
+        scene.render_thread = std::this_thread::get_id();
+        RS_Renderer_Render(&scene.camera, scene.scene, true, &scene.abort_checker, &scene.progress);
+        scene.is_rendering = false;
+    }, [&scene]() {
+        scene.abort_checker.is_interrupted = true;
+    });
+}
+
+// wait until a pass is rendered after the last sync, return false on timeout
+static bool
+wait_for_pass(const TestScene& scene)
+{
+    const auto start = std::chrono::steady_clock::now();
+    while (scene.progress.passes == 0) {
+        if (std::chrono::steady_clock::now() - start > std::chrono::milliseconds(s_timeout)) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+int
+main(int argc, char **argv)
+{
+    RSStub::reset();
+    RSStub::set_render_passes(s_pass_count, s_pass_duration);
+    InteractiveRender ipr;
+    TestScene scene;
+
+    // the scene is synchronized by the calling thread which returns while the passes are rendered in the background
+    render(ipr, scene);
+    CHECK(ipr.is_rendering());
+    CHECK(scene.sync_count == 1);
+    CHECK(scene.sync_thread == std::this_thread::get_id());
+    CHECK(ipr.wait_for_passes(s_timeout));
+    CHECK(!ipr.is_rendering());
+    CHECK(scene.render_thread != std::this_thread::get_id());
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_RENDER] == 1);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_RENDER_PASS] == s_pass_count);
+    CHECK(scene.progress.percentage == 100);
+    const std::thread::id render_thread = scene.render_thread;
+
+    // a modification during the passes aborts them and the background thread doesn't restart them by itself
+    RSStub::reset();
+    scene.sync_count = 0;
+    render(ipr, scene);
+    CHECK(wait_for_pass(scene));
+    modify(ipr, scene);
+    CHECK(ipr.wait_for_passes(s_timeout));
+    CHECK(scene.sync_count == 1);
+    CHECK(scene.progress.percentage < 100);
+    CHECK(scene.synchronized_count + 1 == scene.modification_count);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_RENDER] == 1);
+
+    // the next render synchronizes the modification and renders all the passes on the same background thread
+    render(ipr, scene);
+    CHECK(scene.sync_count == 2);
+    CHECK(scene.synchronized_count == scene.modification_count);
+    CHECK(ipr.wait_for_passes(s_timeout));
+    CHECK(scene.progress.percentage == 100);
+    CHECK(scene.render_thread == render_thread);
+
+    // a render requested while passes are in progress aborts them before synchronizing the scene
+    RSStub::reset();
+    scene.sync_count = 0;
+    render(ipr, scene);
+    CHECK(wait_for_pass(scene));
+    render(ipr, scene);
+    CHECK(scene.sync_count == 2);
+    CHECK(!scene.is_rendering_during_sync);
+    CHECK(ipr.wait_for_passes(s_timeout));
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_RENDER] == 2);
+    CHECK(scene.progress.percentage == 100);
+
+    // nothing is rendered when the sync has nothing to render
+    ipr.restart([]() { return false; }, [&scene]() { scene.sync_count++; }, []() {});
+    CHECK(!ipr.is_rendering());
+    CHECK(scene.sync_count == 2);
+
+    // stopping the background thread aborts the passes in progress
+    scene.sync_count = 0;
+    render(ipr, scene);
+    CHECK(wait_for_pass(scene));
+    ipr.stop([&scene]() { scene.abort_checker.is_interrupted = true; });
+    CHECK(!ipr.is_rendering());
+    CHECK(scene.progress.percentage < 100);
+
+    // a stopped render starts a new background thread for the next render
+    scene.sync_count = 0;
+    render(ipr, scene);
+    CHECK(scene.sync_count == 1);
+    CHECK(ipr.wait_for_passes(s_timeout));
+    CHECK(scene.render_thread != std::this_thread::get_id());
+    CHECK(scene.progress.percentage == 100);
+
+    return test_result();
+}
@@ -0,0 +1,137 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Checks that RedshiftUtils::CreatePolygonalMeshes() only calls the stub of the Redshift API from the calling
+// thread and creates the meshes in the order of their index whatever the order their descriptions are gathered in,
+// with the default executor of the tasks, which runs them serially without the thread manager of Clarisse, with the
+// pool of worker threads of the benchmarks and with an executor supplied by RedshiftUtils::set_task_executor().
+
+#include <RS.h>
+#include <rs_stub.h>
+#include <redshift_task_pool.h>
+#include <redshift_utils.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include <r2c_test_utils.h>
+
+// number of meshes converted at once, more than the threads of a wave so that several waves are needed
+static const unsigned int s_mesh_count = 37;
+
+// describe a grid of resolution x resolution quads
+static void
+make_grid(PolymeshDescription& desc, const unsigned int& resolution)
+{
+    const unsigned int row = resolution + 1;
+    desc.positions.resize(row * row);
+    for (unsigned int j = 0; j < row; j++) {
+        for (unsigned int i = 0; i < row; i++) desc.positions[j * row + i] = GMathVec3f(static_cast<float>(i), 0.0f, static_cast<float>(j));
+    }
+    desc.normals.resize(1);
+    desc.normals[0] = GMathVec3f(0.0f, 1.0f, 0.0f);
+    const unsigned int polygon_count = resolution * resolution;
+    desc.polygon_vertex_count.resize(polygon_count);
+    desc.polygon_shading_groups.resize(polygon_count);
+    desc.polygon_vertex_ids.resize(polygon_count * 4);
+    desc.normal_indices.resize(polygon_count * 4);
+    for (unsigned int j = 0; j < resolution; j++) {
+        for (unsigned int i = 0; i < resolution; i++) {
+            const unsigned int polygon = j * resolution + i;
+            desc.polygon_vertex_count[polygon] = 4;
+            desc.polygon_shading_groups[polygon] = 0;
+            unsigned int *ids = &desc.polygon_vertex_ids[polygon * 4];
+            ids[0] = j * row + i;
+            ids[1] = (j + 1) * row + i;
+            ids[2] = (j + 1) * row + i + 1;
+            ids[3] = j * row + i + 1;
+            for (unsigned int k = 0; k < 4; k++) desc.normal_indices[polygon * 4 + k] = 0;
+        }
+    }
+    desc.is_uv_defined = false;
+    desc.material_count = 1;
+}
+
+// return the number ending the unique name of a mesh
+static unsigned long long
+get_name_id(const RSMeshBase *mesh)
+{
+    const char *name = mesh->GetName();
+    const char *digits = name + strlen(name);
+    while (digits != name && digits[-1] >= '0' && digits[-1] <= '9') digits--;
+    return strtoull(digits, nullptr, 10);
+}
+
+/*! \brief Executor starting a thread per task so that the tasks run concurrently whatever the number of cores */
+class TestExecutor : public RedshiftTaskExecutor {
+public:
+    TestExecutor() : run_count(0) {}
+    unsigned int get_concurrency() const override { return 4; }
+    void run(const unsigned int& count, const std::function<void(const unsigned int&)>& task) override
+    {
+        run_count++;
+        CoreVector<std::thread *> threads;
+        for (unsigned int i = 0; i < count; i++) threads.add(new std::thread(std::cref(task), i));
+        for (auto thread : threads) {
+            thread->join();
+            delete thread;
+        }
+    }
+
+    std::atomic<unsigned int> run_count;
+};
+
+// create the meshes with the current executor and check their order
+static void
+test_meshes(RSMaterial *material)
+{
+    RSStub::reset();
+    // the first meshes of each wave take the longest to describe so that they are described last
+    CoreArray<RSMesh *> meshes;
+    RedshiftUtils::CreatePolygonalMeshes(s_mesh_count, [](const unsigned int& index, PolymeshDescription& description) {
+        std::this_thread::sleep_for(std::chrono::milliseconds((s_mesh_count - index) % 8));
+        make_grid(description, index + 1);
+    }, material, meshes);
+
+    CHECK(meshes.get_count() == s_mesh_count);
+    for (unsigned int i = 0; i < meshes.get_count(); i++) {
+        CHECK(meshes[i] != nullptr && meshes[i]->GetNumQuads() == (i + 1) * (i + 1));
+        // meshes are named in the order they are created
+        if (i > 0) CHECK(get_name_id(meshes[i]) > get_name_id(meshes[i - 1]));
+    }
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_MESH_NEW] == s_mesh_count);
+    CHECK(RSStub::get_statistics().foreign_calls == 0);
+    for (unsigned int i = 0; i < meshes.get_count(); i++) RS_MeshBase_Delete(meshes[i]);
+}
+
+int
+main(int argc, char **argv)
+{
+    RSMaterial *material = RS_Material_Get("test");
+    test_meshes(material);
+
+    RedshiftTaskPool pool;
+    RedshiftUtils::set_task_executor(&pool);
+    test_meshes(material);
+
+    // the meshes are described by waves of the concurrency of the supplied executor
+    TestExecutor executor;
+    RedshiftUtils::set_task_executor(&executor);
+    CHECK(&RedshiftUtils::get_task_executor() == &executor);
+    test_meshes(material);
+    CHECK(executor.run_count == (s_mesh_count + 3) / 4);
+    RedshiftUtils::set_task_executor(nullptr);
+    CHECK(&RedshiftUtils::get_task_executor() != &executor);
+
+    // nothing to create
+    CoreArray<RSMesh *> none;
+    RedshiftUtils::CreatePolygonalMeshes(0, [](const unsigned int& index, PolymeshDescription& description) { CHECK(false); }, material, none);
+    CHECK(none.get_count() == 0);
+
+    RS_Material_Release(material);
+    return test_result();
+}
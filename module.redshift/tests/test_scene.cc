@@ -0,0 +1,281 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Checks the synchronization of the render scene by RedshiftScene against the stub of the Redshift API: the sharing
+// of resources between geometries, the items visited by a sync, the tombstones of removed items and the compaction
+// which rebuilds the render scene without them.
+
+#include <RS.h>
+#include <rs_stub.h>
+#include <redshift_utils.h>
+
+#include <r2c_test_utils.h>
+
+// number of shading groups of every mesh
+static const unsigned int s_shading_group_count = 2;
+
+/*! \brief Scene whose geometries share their resource by pairs, whose instancers use the resources of the first
+           geometries as prototypes and which counts the references to its materials */
+class TestSceneSource : public RedshiftSceneSource {
+public:
+
+    TestSceneSource() : acquired(0), released(0), created_resources(0), deformed(0), is_deformable(true)
+    {
+        materials[0] = RS_Material_Get("test_0");
+        materials[1] = RS_Material_Get("test_1");
+    }
+
+    ~TestSceneSource() override { for (auto material : materials) RS_Material_Release(material); }
+
+    R2cResourceId get_resource_id(R2cItemId geometry) override
+    {
+        return reinterpret_cast<R2cResourceId>(static_cast<size_t>(geometry / 2 + 1));
+    }
+
+    void create_resources(RedshiftScene& scene, const CoreVector<R2cItemId>& geometries) override
+    {
+        for (auto geometry : geometries) {
+            const R2cResourceId id = get_resource_id(geometry);
+            if (scene.resources.index.is_key_exists(id) != nullptr) continue;
+            RSResourceInfo resource;
+            resource.ptr = RS_Mesh_New("test_mesh");
+            resource.ptr->SetNumMaterials(s_shading_group_count);
+            resource.type = RSResourceInfo::TYPE_MESH;
+            resource.bytes = 1024;
+            scene.resources.index.add(id, resource);
+            scene.ptr->AddMesh(resource.ptr);
+            created_resources++;
+        }
+    }
+
+    bool deform_geometry(RedshiftScene& scene, R2cItemId geometry, RSGeometryInfo& rgeometry) override
+    {
+        deformed++;
+        return is_deformable;
+    }
+
+    GMathMatrix4x4d get_transform(R2cItemId item) override
+    {
+        GMathMatrix4x4d transform(true);
+        transform[3][0] = static_cast<double>(item);
+        return transform;
+    }
+
+    bool get_visible(R2cItemId item) override { return item % 5 != 4; }
+
+    RSMaterial *acquire_material(R2cItemId item, const unsigned int& shading_group, CoreVector<unsigned int>& references) override
+    {
+        references.add(shading_group);
+        acquired++;
+        return materials[shading_group];
+    }
+
+    void release_material(const unsigned int& reference) override { released++; }
+
+    void create_instancer(RedshiftScene& scene, R2cItemId instancer, RSInstancerInfo& rinstancer) override
+    {
+        // a single prototype being the resource of the first geometry
+        rinstancer.resources.resize(1);
+        rinstancer.ptrs.resize(1);
+        rinstancer.resources[0] = get_resource_id(0);
+        RSResourceInfo *resource = scene.resources.index.is_key_exists(rinstancer.resources[0]);
+        resource->refcount++;
+        rinstancer.ptrs[0] = RS_PointCloud_New();
+        rinstancer.ptrs[0]->SetInstanceTemplate(resource->ptr);
+        rinstancer.ptrs[0]->SetNumMaterials(resource->ptr->GetNumMaterials());
+        rinstancer.bytes = 64;
+    }
+
+    void create_light(R2cItemId light, RSLightInfo& rlight) override
+    {
+        rlight.shader = RS_ShaderNode_Get("test_light", "Light");
+        rlight.ptr = RS_Light_New("test_light", "test_light_shader");
+    }
+
+    void sync_light_attributes(R2cItemId light, RSLightInfo& rlight) override { rlight.ptr->SetAreaScaling(RSVector3(2.0f, 2.0f, 2.0f)); }
+
+    RSMaterial *materials[s_shading_group_count];
+    unsigned int acquired; // number of material references acquired
+    unsigned int released; // number of material references released
+    unsigned int created_resources;
+    unsigned int deformed; // number of calls to deform_geometry()
+    bool is_deformable; // value returned by deform_geometry()
+};
+
+// return the number of references of the resource of a geometry
+static unsigned int
+get_refcount(RedshiftScene& scene, TestSceneSource& source, R2cItemId geometry)
+{
+    const RSResourceInfo *resource = scene.resources.index.is_key_exists(source.get_resource_id(geometry));
+    return resource != nullptr ? resource->refcount : 0;
+}
+
+// insert geometries sharing their resources and check the render scene
+static void
+test_insert(RedshiftScene& scene, TestSceneSource& source)
+{
+    for (unsigned int i = 0; i < 10; i++) scene.insert_geometry(i);
+    scene.sync(source);
+
+    CHECK(scene.geometries.index.get_count() == 10);
+    CHECK(scene.resources.index.get_count() == 5);
+    CHECK(source.created_resources == 5);
+    for (unsigned int i = 0; i < 10; i += 2) CHECK(get_refcount(scene, source, i) == 2);
+    CHECK(scene.ptr->GetNumMeshes() == 5);
+    CHECK(scene.ptr->GetNumMeshInstances() == 10);
+    CHECK(source.acquired == 10 * s_shading_group_count);
+    CHECK(scene.geometries.inserted.get_count() == 0);
+
+    // hidden geometries are kept in the scene with the flags hiding them
+    const RSGeometryInfo *visible = scene.geometries.index.is_key_exists(3);
+    const RSGeometryInfo *hidden = scene.geometries.index.is_key_exists(4);
+    CHECK(visible->ptr->GetCachedMeshFlags() == RS_CachedMeshFlag_GetDefault());
+    CHECK(hidden->ptr->GetCachedMeshFlags() != RS_CachedMeshFlag_GetDefault());
+    CHECK(visible->materials->GetMaterial(1) == source.materials[1]);
+}
+
+// dirty geometries and check that only them are visited by the sync
+static void
+test_dirty(RedshiftScene& scene, TestSceneSource& source)
+{
+    const unsigned int acquired = source.acquired;
+    // dirtying a geometry several times queues it once
+    scene.dirty_geometry(1, R2cSceneDelegate::DIRTINESS_SHADING_GROUP);
+    scene.dirty_geometry(1, R2cSceneDelegate::DIRTINESS_SHADING_GROUP);
+    CHECK(scene.geometries.dirtied.get_count() == 1);
+    CHECK(scene.dirty_geometry(100, R2cSceneDelegate::DIRTINESS_KINEMATIC) == nullptr);
+    scene.sync(source);
+    CHECK(source.acquired == acquired + s_shading_group_count);
+    // the previous references are released once the reassigned materials are acquired
+    CHECK(source.released == s_shading_group_count);
+    CHECK(scene.geometries.dirtied.get_count() == 0);
+
+    // deformations are applied in place while the geometry keeps its resource
+    scene.dirty_geometry(2, R2cSceneDelegate::DIRTINESS_DEFORMATION);
+    scene.sync(source);
+    CHECK(source.deformed == 1);
+    CHECK(scene.geometries.index.get_count() == 10);
+    CHECK(scene.tombstones.get_count() == 0);
+
+    // geometries which can't be deformed are created again, the previous mesh instance being buried
+    RSMeshInstance *previous = scene.geometries.index.is_key_exists(2)->ptr;
+    source.is_deformable = false;
+    scene.dirty_geometry(2, R2cSceneDelegate::DIRTINESS_DEFORMATION);
+    scene.sync(source);
+    source.is_deformable = true;
+    CHECK(source.deformed == 2);
+    CHECK(scene.geometries.index.get_count() == 10);
+    CHECK(scene.geometries.index.is_key_exists(2)->ptr != previous);
+    CHECK(scene.tombstones.geometries.get_count() == 1);
+    CHECK(scene.tombstones.resources.get_count() == 0);
+    CHECK(get_refcount(scene, source, 2) == 2);
+    CHECK(scene.ptr->GetNumMeshInstances() == 11);
+}
+
+// remove geometries, the removed items being hidden until the scene is compacted
+static void
+test_remove(RedshiftScene& scene, TestSceneSource& source)
+{
+    RSMeshInstance *removed = scene.geometries.index.is_key_exists(8)->ptr;
+    CHECK(scene.remove_geometry(8) != nullptr);
+    CHECK(scene.remove_geometry(100) == nullptr);
+    // a removed geometry isn't synchronized even if it is dirtied after its removal
+    scene.dirty_geometry(8, R2cSceneDelegate::DIRTINESS_KINEMATIC);
+    scene.remove_geometry(9);
+    scene.sync(source);
+
+    CHECK(scene.geometries.index.get_count() == 8);
+    CHECK(scene.resources.index.get_count() == 4);
+    CHECK(scene.tombstones.geometries.get_count() == 3);
+    CHECK(scene.tombstones.resources.get_count() == 1);
+    CHECK(scene.tombstones.bytes == 1024);
+    CHECK(removed->GetCachedMeshFlags() != RS_CachedMeshFlag_GetDefault());
+    CHECK(scene.ptr->GetNumMeshInstances() == 11);
+}
+
+// insert instancers and lights, then remove them
+static void
+test_instancers_and_lights(RedshiftScene& scene, TestSceneSource& source)
+{
+    scene.insert_instancer(1000);
+    scene.insert_light(2000);
+    scene.insert_light(2001);
+    scene.sync(source);
+    CHECK(scene.instancers.index.get_count() == 1);
+    CHECK(get_refcount(scene, source, 0) == 3);
+    CHECK(scene.ptr->GetNumMeshPointClouds() == 1);
+    CHECK(scene.point_cloud_count == 1);
+    CHECK(scene.lights.index.get_count() == 2);
+    CHECK(scene.ptr->GetNumLights() == 2);
+    const RSLightInfo *light = scene.lights.index.is_key_exists(2000);
+    CHECK(light->ptr->GetAreaScaling().x == 2.0f);
+    CHECK(light->ptr->GetMatrix().m[0][3] == 2000.0f);
+
+    scene.remove_instancer(1000);
+    scene.remove_light(2001);
+    scene.sync(source);
+    CHECK(scene.instancers.index.get_count() == 0);
+    CHECK(scene.tombstones.point_clouds.get_count() == 1);
+    CHECK(scene.point_cloud_count == 0);
+    CHECK(get_refcount(scene, source, 0) == 2);
+    // lights are deleted right away, the lights of the render scene being rebuilt
+    CHECK(scene.lights.index.get_count() == 1);
+    CHECK(scene.ptr->GetNumLights() == 1);
+}
+
+// compact the scene, the render scene being rebuilt with the live items only
+static void
+test_compact(RedshiftScene& scene, TestSceneSource& source)
+{
+    const RSStub::Statistics before = RSStub::get_statistics();
+    scene.compaction_max_removed_items = 0;
+    scene.sync(source);
+    const RSStub::Statistics after = RSStub::get_statistics();
+    scene.compaction_max_removed_items = 100000;
+
+    CHECK(scene.tombstones.get_count() == 0);
+    CHECK(scene.tombstones.bytes == 0);
+    // 3 mesh instances with their overrides, 1 point cloud and 1 mesh
+    CHECK(before.objects - after.objects == 3 * 2 + 1 + 1);
+    CHECK(scene.ptr->GetNumMeshInstances() == 8);
+    CHECK(scene.ptr->GetNumMeshes() == 4);
+    CHECK(scene.ptr->GetNumMeshPointClouds() == 0);
+    CHECK(scene.ptr->GetNumLights() == 1);
+    // the materials of the removed items are released along with them
+    CHECK(source.acquired - source.released == 8 * s_shading_group_count);
+
+    // the scene is only compacted once the tombstones exceed the thresholds
+    scene.remove_geometry(0);
+    scene.sync(source);
+    CHECK(scene.tombstones.geometries.get_count() == 1);
+}
+
+int
+main(int argc, char **argv)
+{
+    const unsigned long long objects = RSStub::get_statistics().objects;
+    {
+        TestSceneSource source;
+        RedshiftScene scene;
+        scene.ptr = RS_Scene_New();
+        // the scene is small so the tombstones would exceed the default ratio right away
+        scene.compaction_ratio = 1.0;
+
+        test_insert(scene, source);
+        test_dirty(scene, source);
+        test_remove(scene, source);
+        test_instancers_and_lights(scene, source);
+        test_compact(scene, source);
+
+        // clearing the scene deletes every item and releases all the materials
+        scene.clear(source);
+        CHECK(scene.ptr == nullptr);
+        CHECK(scene.geometries.index.get_count() == 0);
+        CHECK(scene.resources.index.get_count() == 0);
+        CHECK(scene.tombstones.get_count() == 0);
+        CHECK(source.acquired == source.released);
+    }
+    CHECK(RSStub::get_statistics().objects == objects);
+    return test_result();
+}
@@ -0,0 +1,168 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Checks the texture cache of RedshiftUtils against the stub of the Redshift API with local files.
+
+#include <RS.h>
+#include <rs_stub.h>
+#include <redshift_utils.h>
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include <r2c_test_utils.h>
+
+// write a file of the specified size in the working directory and return its path
+static CoreString
+write_file(const char *name, const unsigned int& size)
+{
+    std::ofstream file(name, std::ios::binary | std::ios::trunc);
+    for (unsigned int i = 0; i < size; i++) file.put(static_cast<char>(i));
+    return CoreString(name);
+}
+
+// wait until the background prefetching read the specified number of bytes, or a few seconds
+static bool
+wait_prefetched_bytes(const unsigned long long& bytes)
+{
+    for (unsigned int i = 0; i < 500; i++) {
+        if (RedshiftUtils::get_texture_cache_statistics().bytes >= bytes) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+static void
+test_sharing()
+{
+    const CoreString a = write_file("texture_cache_a.tex", 1000);
+    const CoreString b = write_file("texture_cache_b.tex", 2000);
+    RSShaderNode *shader1 = RS_ShaderNode_Get("shader1", "TextureSampler");
+    RSShaderNode *shader2 = RS_ShaderNode_Get("shader2", "TextureSampler");
+    RSStub::reset();
+
+    // the same file bound by two shaders is only loaded once
+    RSTexture *texture1 = RedshiftUtils::bind_texture(*shader1, 0, a);
+    RSTexture *texture2 = RedshiftUtils::bind_texture(*shader2, 0, a);
+    CHECK(texture1 != nullptr && texture1 == texture2);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_TEXTURE_GET] == 1);
+    RedshiftUtils::TextureCacheStatistics statistics = RedshiftUtils::get_texture_cache_statistics();
+    CHECK(statistics.misses == 1 && statistics.hits == 1 && statistics.count == 1);
+
+    // binding another file to a parameter keeps the previous one while another shader references it
+    RedshiftUtils::bind_texture(*shader1, 0, b);
+    statistics = RedshiftUtils::get_texture_cache_statistics();
+    CHECK(statistics.misses == 2 && statistics.count == 2);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_DELETE] == 0);
+
+    // binding the same file again to the same parameter neither loads nor releases it
+    RedshiftUtils::bind_texture(*shader1, 0, b);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_TEXTURE_GET] == 2);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_DELETE] == 0);
+
+    // releasing the last shader referencing a file releases its texture
+    RedshiftUtils::release_shader_textures(*shader2);
+    CHECK(RedshiftUtils::get_texture_cache_statistics().count == 1);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_DELETE] == 1);
+    RedshiftUtils::release_shader_textures(*shader1);
+    CHECK(RedshiftUtils::get_texture_cache_statistics().count == 0);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_DELETE] == 2);
+
+    // a released file is loaded again when it is bound anew
+    RedshiftUtils::bind_texture(*shader1, 1, a);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_TEXTURE_GET] == 3);
+    RedshiftUtils::release_shader_textures(*shader1);
+    CHECK(RSStub::get_statistics().bytes == 0);
+
+    RS_ShaderNode_Release(shader1);
+    RS_ShaderNode_Release(shader2);
+}
+
+static void
+test_failed_load()
+{
+    const CoreString a = write_file("texture_cache_a.tex", 1000);
+    RSShaderNode *shader = RS_ShaderNode_Get("shader4", "TextureSampler");
+    RSStub::reset();
+
+    // a file failing to load isn't cached and unbinds the file previously bound to the parameter
+    RedshiftUtils::bind_texture(*shader, 0, a);
+    CHECK(RedshiftUtils::bind_texture(*shader, 0, "texture_cache_missing.tex") == nullptr);
+    CHECK(RedshiftUtils::get_texture_cache_statistics().count == 0);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_DELETE] == 1);
+    // it is loaded again when bound anew
+    CHECK(RedshiftUtils::bind_texture(*shader, 1, "texture_cache_missing.tex") == nullptr);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_TEXTURE_GET] == 3);
+
+    RedshiftUtils::release_shader_textures(*shader);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_DELETE] == 1);
+    RS_ShaderNode_Release(shader);
+}
+
+static void
+test_prefetch()
+{
+    const CoreString c = write_file("texture_cache_c.tex", 3000);
+    const CoreString d = write_file("texture_cache_d.tex", 5000);
+    const CoreString e = write_file("texture_cache_e.tex", 7000);
+    RSShaderNode *shader = RS_ShaderNode_Get("shader3", "TextureSampler");
+    const unsigned long long bytes = RedshiftUtils::get_texture_cache_statistics().bytes;
+
+    // binding a file loads it right away without prefetching it
+    RedshiftUtils::bind_texture(*shader, 0, e);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(RedshiftUtils::get_texture_cache_statistics().bytes == bytes);
+
+    // new files are read in the background, each one once
+    RedshiftUtils::prefetch_texture(c);
+    RedshiftUtils::prefetch_texture(c);
+    CHECK(wait_prefetched_bytes(bytes + 3000));
+    // cached files aren't prefetched
+    RedshiftUtils::prefetch_texture(e);
+    RedshiftUtils::prefetch_texture(d);
+    CHECK(wait_prefetched_bytes(bytes + 8000));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(RedshiftUtils::get_texture_cache_statistics().bytes == bytes + 8000);
+
+    // prefetched files are then loaded once bound
+    RedshiftUtils::bind_texture(*shader, 1, c);
+    CHECK(RedshiftUtils::get_texture_cache_statistics().count == 2);
+
+    // files which were read but never bound are read again once forgotten
+    RedshiftUtils::prefetch_texture(d);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(RedshiftUtils::get_texture_cache_statistics().bytes == bytes + 8000);
+    RedshiftUtils::forget_prefetched_textures();
+    RedshiftUtils::prefetch_texture(d);
+    CHECK(wait_prefetched_bytes(bytes + 13000));
+
+    RedshiftUtils::release_shader_textures(*shader);
+    RS_ShaderNode_Release(shader);
+}
+
+static void
+test_stop_prefetching()
+{
+    const CoreString f = write_file("texture_cache_f.tex", 11000);
+    const unsigned long long bytes = RedshiftUtils::get_texture_cache_statistics().bytes;
+
+    // stopping joins the prefetch thread, the next files starting a new one
+    RedshiftUtils::stop_texture_prefetching();
+    RedshiftUtils::prefetch_texture(f);
+    CHECK(wait_prefetched_bytes(bytes + 11000));
+    RedshiftUtils::stop_texture_prefetching();
+    RedshiftUtils::stop_texture_prefetching();
+    CHECK(RedshiftUtils::get_texture_cache_statistics().bytes == bytes + 11000);
+}
+
+int
+main(int argc, char **argv)
+{
+    test_sharing();
+    test_failed_load();
+    test_prefetch();
+    test_stop_prefetching();
+    return test_result();
+}
@@ -0,0 +1,348 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Checks the triangulation of polygons by PolygonTriangulator and the conversion of the polygons of a mesh
+// by RedshiftUtils::FillPolygonalMesh() against the stub of the Redshift API, including the refill of a
+// deformed mesh from its kept triangulation.
+
+#include <RS.h>
+#include <rs_stub.h>
+#include <redshift_utils.h>
+
+#include <cmath>
+
+#include <r2c_test_utils.h>
+
+static const double s_pi = 3.14159265358979323846;
+
+// twice the signed area of the triangle abc in the XZ plane
+static double
+get_area(const GMathVec3f& a, const GMathVec3f& b, const GMathVec3f& c)
+{
+    return (static_cast<double>(b[2]) - a[2]) * (static_cast<double>(c[0]) - a[0]) -
+           (static_cast<double>(b[0]) - a[0]) * (static_cast<double>(c[2]) - a[2]);
+}
+
+// twice the signed area of a polygon in the XZ plane
+static double
+get_polygon_area(const CoreVector<GMathVec3f>& points)
+{
+    double area = 0.0;
+    for (unsigned int i = 1; i + 1 < points.get_count(); i++) area += get_area(points[0], points[i], points[i + 1]);
+    return area;
+}
+
+// add a point of the XZ plane to a polygon
+static void
+add_point(CoreVector<GMathVec3f>& points, const double& x, const double& z)
+{
+    points.add(GMathVec3f(static_cast<float>(x), 0.0f, static_cast<float>(z)));
+}
+
+// star of 16 vertices whose every other vertex is reflex, starting on a reflex vertex
+static void
+make_star(CoreVector<GMathVec3f>& points)
+{
+    for (unsigned int i = 0; i < 16; i++) {
+        const double radius = i % 2 == 0 ? 0.4 : 1.0;
+        add_point(points, radius * cos(i * s_pi / 8.0), radius * sin(i * s_pi / 8.0));
+    }
+}
+
+// check the triangulation of a simple polygon: n - 2 triangles with the orientation of the polygon
+// covering its area. Flat triangles are only expected when the polygon has collinear vertices.
+static void
+check_triangulation(const CoreVector<GMathVec3f>& points, const bool& allow_flat = false)
+{
+    PolygonTriangulator triangulator;
+    const CoreVector<unsigned int>& triangles = triangulator.triangulate(points.get_data(), points.get_count());
+    CHECK(triangles.get_count() == 3 * (points.get_count() - 2));
+
+    const double area = get_polygon_area(points);
+    double sum = 0.0;
+    bool is_oriented = true;
+    for (unsigned int t = 0; t < triangles.get_count(); t += 3) {
+        const double triangle_area = get_area(points[triangles[t]], points[triangles[t + 1]], points[triangles[t + 2]]);
+        is_oriented = is_oriented && (allow_flat ? triangle_area * area >= 0.0 : triangle_area * area > 0.0);
+        sum += triangle_area;
+    }
+    CHECK(is_oriented);
+    CHECK(fabs(sum - area) <= 1e-6 * fabs(area));
+}
+
+// check that a polygon gives n - 2 triangles of valid and distinct polygon vertex indices whatever its shape
+static void
+check_degenerated_triangulation(const CoreVector<GMathVec3f>& points)
+{
+    PolygonTriangulator triangulator;
+    const CoreVector<unsigned int>& triangles = triangulator.triangulate(points.get_data(), points.get_count());
+    CHECK(triangles.get_count() == 3 * (points.get_count() - 2));
+    bool is_valid = true;
+    for (unsigned int t = 0; t < triangles.get_count(); t += 3) {
+        is_valid = is_valid && triangles[t] < points.get_count() && triangles[t + 1] < points.get_count() && triangles[t + 2] < points.get_count();
+        is_valid = is_valid && triangles[t] != triangles[t + 1] && triangles[t + 1] != triangles[t + 2] && triangles[t + 2] != triangles[t];
+    }
+    CHECK(is_valid);
+}
+
+static void
+test_convex()
+{
+    CoreVector<GMathVec3f> points;
+    for (unsigned int i = 0; i < 6; i++) add_point(points, cos(i * s_pi / 3.0), sin(i * s_pi / 3.0));
+    check_triangulation(points);
+
+    // same polygon the other way around and in another plane
+    CoreVector<GMathVec3f> reversed;
+    for (unsigned int i = points.get_count(); i > 0; i--) reversed.add(points[i - 1]);
+    check_triangulation(reversed);
+    CoreVector<GMathVec3f> vertical;
+    for (const GMathVec3f& p : points) vertical.add(GMathVec3f(p[0], p[2], 0.0f));
+    PolygonTriangulator triangulator;
+    CHECK(triangulator.triangulate(vertical.get_data(), vertical.get_count()).get_count() == 12);
+}
+
+static void
+test_concave()
+{
+    // L shape
+    CoreVector<GMathVec3f> l_shape;
+    add_point(l_shape, 0, 0);
+    add_point(l_shape, 2, 0);
+    add_point(l_shape, 2, 1);
+    add_point(l_shape, 1, 1);
+    add_point(l_shape, 1, 2);
+    add_point(l_shape, 0, 2);
+    check_triangulation(l_shape);
+
+    // star
+    CoreVector<GMathVec3f> star;
+    make_star(star);
+    check_triangulation(star);
+
+    // comb with a reflex vertex between each tooth, clockwise
+    CoreVector<GMathVec3f> comb;
+    add_point(comb, 0, 0);
+    for (unsigned int i = 0; i < 8; i++) {
+        add_point(comb, i, 3);
+        add_point(comb, i + 0.5, 3);
+        add_point(comb, i + 0.5, 1);
+        add_point(comb, i + 1, 1);
+    }
+    add_point(comb, 8, 0);
+    check_triangulation(comb);
+}
+
+static void
+test_degenerated()
+{
+    PolygonTriangulator triangulator;
+    CoreVector<GMathVec3f> points;
+    for (unsigned int i = 0; i < 3; i++) {
+        CHECK(triangulator.triangulate(points.get_data(), points.get_count()).get_count() == 0);
+        add_point(points, i, i * i);
+    }
+    CHECK(triangulator.triangulate(points.get_data(), points.get_count()).get_count() == 3);
+
+    // collinear vertices
+    CoreVector<GMathVec3f> line;
+    for (unsigned int i = 0; i < 8; i++) add_point(line, i, 2 * i);
+    check_degenerated_triangulation(line);
+
+    // coincident vertices
+    CoreVector<GMathVec3f> coincident(6);
+    for (GMathVec3f& p : coincident) p = GMathVec3f(1.0f, 2.0f, 3.0f);
+    check_degenerated_triangulation(coincident);
+
+    // concave polygon with duplicated and collinear vertices
+    CoreVector<GMathVec3f> l_shape;
+    add_point(l_shape, 0, 0);
+    add_point(l_shape, 1, 0);
+    add_point(l_shape, 2, 0);
+    add_point(l_shape, 2, 1);
+    add_point(l_shape, 2, 1);
+    add_point(l_shape, 1, 1);
+    add_point(l_shape, 1, 2);
+    add_point(l_shape, 0, 2);
+    add_point(l_shape, 0, 1);
+    check_triangulation(l_shape, true);
+
+    // self intersecting polygon
+    CoreVector<GMathVec3f> bowtie;
+    add_point(bowtie, 0, 0);
+    add_point(bowtie, 1, 1);
+    add_point(bowtie, 1, 0);
+    add_point(bowtie, 0, 1);
+    add_point(bowtie, 0.5, 2);
+    check_degenerated_triangulation(bowtie);
+}
+
+// rectangle whose bottom edge is split in the specified number of collinear edges, with a notch in its top edge if concave
+static void
+make_large_polygon(CoreVector<GMathVec3f>& points, const unsigned int& edge_count, const bool& is_concave)
+{
+    points.remove_all();
+    for (unsigned int i = 0; i <= edge_count; i++) add_point(points, i, 0);
+    add_point(points, edge_count, 100);
+    if (is_concave) add_point(points, edge_count / 2, 50);
+    add_point(points, 0, 100);
+}
+
+static void
+test_large()
+{
+    CoreVector<GMathVec3f> points;
+    make_large_polygon(points, 100000, false);
+    check_triangulation(points, true);
+    make_large_polygon(points, 100000, true);
+    check_triangulation(points, true);
+}
+
+// check that the polygons of a mesh are converted to triangles and quads covering their area
+static void
+check_mesh(const PolymeshDescription& desc, const unsigned int& triangle_count, const unsigned int& quad_count, const double& area)
+{
+    RSMaterial *material = RS_Material_Get("test");
+    RSMesh *mesh = RedshiftUtils::CreatePolygonalMesh(desc, material);
+    CHECK(mesh->GetNumTriangles() == triangle_count);
+    CHECK(mesh->GetNumQuads() == quad_count);
+
+    const std::vector<unsigned int>& indices = mesh->GetIndices();
+    CHECK(indices.size() == 3 * triangle_count + 4 * quad_count);
+    double sum = 0.0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        sum += get_area(desc.positions[indices[i]], desc.positions[indices[i + 1]], desc.positions[indices[i + 2]]);
+    }
+    CHECK(quad_count != 0 || fabs(sum - area) <= 1e-6 * fabs(area));
+
+    RS_MeshBase_Delete(mesh);
+    RS_Material_Release(material);
+}
+
+// fill the description of a mesh made of the specified polygon
+static void
+make_mesh(PolymeshDescription& desc, const CoreVector<GMathVec3f>& points, const unsigned int& polygon_count)
+{
+    desc.positions.resize(points.get_count());
+    for (unsigned int i = 0; i < points.get_count(); i++) desc.positions[i] = points[i];
+    desc.normals.resize(1);
+    desc.normals[0] = GMathVec3f(0.0f, 1.0f, 0.0f);
+    desc.polygon_vertex_count.resize(polygon_count);
+    desc.polygon_shading_groups.resize(polygon_count);
+    desc.polygon_vertex_ids.resize(polygon_count * points.get_count());
+    desc.normal_indices.resize(polygon_count * points.get_count());
+    for (unsigned int i = 0; i < polygon_count; i++) {
+        desc.polygon_vertex_count[i] = points.get_count();
+        desc.polygon_shading_groups[i] = 0;
+        for (unsigned int j = 0; j < points.get_count(); j++) {
+            desc.polygon_vertex_ids[i * points.get_count() + j] = j;
+            desc.normal_indices[i * points.get_count() + j] = 0;
+        }
+    }
+    desc.material_count = 1;
+}
+
+static void
+test_mesh()
+{
+    // triangles and quads are added as they are
+    CoreVector<GMathVec3f> triangle;
+    add_point(triangle, 0, 0);
+    add_point(triangle, 1, 0);
+    add_point(triangle, 0, 1);
+    PolymeshDescription triangles;
+    make_mesh(triangles, triangle, 10);
+    check_mesh(triangles, 10, 0, get_polygon_area(triangle) * 10);
+
+    CoreVector<GMathVec3f> quad(triangle);
+    add_point(quad, 1, 1);
+    PolymeshDescription quads;
+    make_mesh(quads, quad, 10);
+    check_mesh(quads, 0, 10, 0.0);
+
+    // polygons spanning several chunks of polygon vertices
+    CoreVector<GMathVec3f> star;
+    make_star(star);
+    PolymeshDescription stars;
+    make_mesh(stars, star, 10000);
+    check_mesh(stars, 140000, 0, get_polygon_area(star) * 10000);
+
+    // polygons larger than a chunk
+    CoreVector<GMathVec3f> large;
+    make_large_polygon(large, 100000, true);
+    PolymeshDescription larges;
+    make_mesh(larges, large, 3);
+    check_mesh(larges, 3 * (large.get_count() - 2), 0, get_polygon_area(large) * 3);
+}
+
+// sum of the areas of the triangles of a mesh
+static double
+get_mesh_area(const RSMesh *mesh, const PolymeshDescription& desc)
+{
+    const std::vector<unsigned int>& indices = mesh->GetIndices();
+    double sum = 0.0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        sum += get_area(desc.positions[indices[i]], desc.positions[indices[i + 1]], desc.positions[indices[i + 2]]);
+    }
+    return sum;
+}
+
+static void
+test_deformation()
+{
+    CoreVector<GMathVec3f> star;
+    make_star(star);
+    PolymeshDescription desc;
+    make_mesh(desc, star, 100);
+    RSMaterial *material = RS_Material_Get("test");
+
+    // the triangulation is stored by the first fill and gives the same triangles as a fill without it
+    RSMesh *reference = RedshiftUtils::CreatePolygonalMesh(desc, material);
+    RSMesh *mesh = RedshiftUtils::CreatePolygonalMesh(desc, material);
+    CoreVector<unsigned int> triangles;
+    RedshiftUtils::FillPolygonalMesh(mesh, desc, material, &triangles);
+    CHECK(triangles.get_count() == 100 * 3 * (star.get_count() - 2));
+    CHECK(mesh->GetIndices() == reference->GetIndices());
+
+    // stretching the points keeps the triangles, which are read back from the triangulation
+    for (unsigned int i = 0; i < desc.positions.get_count(); i++) desc.positions[i][0] *= 2.0f;
+    const CoreVector<unsigned int> kept_triangles(triangles);
+    RSStub::reset();
+    RedshiftUtils::FillPolygonalMesh(mesh, desc, material, &triangles);
+    CHECK(RSStub::get_statistics().calls[RSStub::CALL_ADD_TRI] == 100 * (star.get_count() - 2));
+    CHECK(mesh->GetIndices() == reference->GetIndices());
+    CHECK(triangles.get_count() == kept_triangles.get_count());
+    CHECK(fabs(get_mesh_area(mesh, desc) - get_polygon_area(star) * 200) <= 1e-6 * fabs(get_polygon_area(star) * 200));
+
+    // a specified triangulation is used as it is, even when it differs from the one of the triangulator
+    CoreVector<unsigned int> fan;
+    for (unsigned int p = 0; p < 100; p++) {
+        for (unsigned int i = 1; i + 1 < star.get_count(); i++) {
+            fan.add(0);
+            fan.add(i);
+            fan.add(i + 1);
+        }
+    }
+    RedshiftUtils::FillPolygonalMesh(mesh, desc, material, &fan);
+    CHECK(mesh->GetIndices().size() == fan.get_count());
+    bool is_fan = true;
+    for (unsigned int i = 0; i < fan.get_count(); i++) is_fan = is_fan && mesh->GetIndices()[i] == fan[i];
+    CHECK(is_fan);
+
+    RS_MeshBase_Delete(reference);
+    RS_MeshBase_Delete(mesh);
+    RS_Material_Release(material);
+}
+
+int
+main(int argc, char **argv)
+{
+    test_convex();
+    test_concave();
+    test_degenerated();
+    test_large();
+    test_mesh();
+    test_deformation();
+    return test_result();
+}
@@ -0,0 +1,110 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Measures the shading of the hits of 64x64 buckets by ExternalHitBuffer, which groups the hits by material,
+// for each type of material (diffuse and reflection, with a constant or a textured color) and 1 to 1024
+// materials in the scene, in hits per second. The cost per hit should not depend on the number of materials,
+// textured materials being evaluated one hit at a time. Usage:
+//     spherix_bench_shading [max_material_count]
+
+#include <cmath>
+
+#include <spherix_external_shader.h>
+
+#include <r2c_bench_utils.h>
+
+// number of pixels of a bucket
+static const unsigned int s_bucket_pixel_count = 64 * 64;
+// number of buckets shaded by each run
+static const unsigned int s_bucket_count = 256;
+
+// types of the benchmarked materials
+enum MaterialType {
+    MATERIAL_DIFFUSE,
+    MATERIAL_REFLECTION,
+    MATERIAL_TEXTURED_DIFFUSE,
+    MATERIAL_TEXTURED_REFLECTION,
+    MATERIAL_TYPE_COUNT
+};
+
+static const char *s_material_type_names[MATERIAL_TYPE_COUNT] = {
+    "diffuse",
+    "reflection",
+    "textured diffuse",
+    "textured reflection"
+};
+
+// create a material of the specified type, textured ones reading their color from the texture
+static ExternalMaterialShader *
+create_material(const MaterialType& type, SpherixTextureColor& texture)
+{
+    ExternalMaterialShader *material;
+    if (type == MATERIAL_DIFFUSE || type == MATERIAL_TEXTURED_DIFFUSE) {
+        material = new SpherixMaterialDiffuse;
+    } else {
+        material = new SpherixMaterialReflection;
+    }
+    if (type == MATERIAL_TEXTURED_DIFFUSE || type == MATERIAL_TEXTURED_REFLECTION) {
+        material->parameters[0]->texture = &texture;
+    }
+    return material;
+}
+
+// shade buckets whose hits are spread over the specified number of materials of the specified type
+static void
+run(const MaterialType& type, const unsigned int& material_count)
+{
+    SpherixTextureColor texture;
+    double *texture_color = static_cast<ParameterColor *>(texture.parameters[0])->value;
+    texture_color[0] = 0.25; texture_color[1] = 0.5; texture_color[2] = 0.75;
+
+    CoreVector<ExternalMaterialShader *> materials;
+    for (unsigned int i = 0; i < material_count; i++) {
+        materials.add(create_material(type, texture));
+    }
+
+    // pseudo random material of each pixel so that consecutive hits rarely share their material
+    CoreVector<unsigned int> pixel_materials(s_bucket_pixel_count);
+    unsigned int seed = 1;
+    for (unsigned int i = 0; i < s_bucket_pixel_count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        pixel_materials[i] = (seed >> 8) % material_count;
+    }
+
+    CoreVector<float> buffer(s_bucket_pixel_count * 4);
+    const GMathVec3f light_contribution(1.0f, 1.0f, 1.0f);
+    const double ray_direction[3] = { 0.0, 0.0, -1.0 };
+    ExternalHitBuffer hits;
+
+    BenchTimer timer;
+    for (unsigned int bucket = 0; bucket < s_bucket_count; bucket++) {
+        hits.clear();
+        for (unsigned int pixel = 0; pixel < s_bucket_pixel_count; pixel++) {
+            // normals sweep the hemisphere so that the reflection both masks and keeps hits
+            const double angle = pixel * 0.001;
+            const double normal[3] = { sin(angle), 0.0, cos(angle) };
+            hits.add(pixel, pixel_materials[pixel], ray_direction, normal);
+        }
+        hits.shade(materials.get_data(), materials.get_count(), light_contribution, buffer.get_data());
+    }
+    const double elapsed = timer.get_elapsed();
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s %u", s_material_type_names[type], material_count);
+    print_result(name, static_cast<unsigned long long>(s_bucket_pixel_count) * s_bucket_count, elapsed);
+
+    for (ExternalMaterialShader *material : materials) delete material;
+}
+
+int
+main(int argc, char **argv)
+{
+    const unsigned long long max_count = get_max_count(argc, argv, 1024);
+    printf("%u hits per bucket\n", s_bucket_pixel_count);
+    for (unsigned int type = 0; type < MATERIAL_TYPE_COUNT; type++) {
+        printf("%s\n", s_material_type_names[type]);
+        for (unsigned long long count = 1; count <= max_count; count *= 4) run(static_cast<MaterialType>(type), static_cast<unsigned int>(count));
+    }
+    return 0;
+}
@@ -0,0 +1,611 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+#pragma once
+
+#include <cmath>
+#include <string>
+
+// Clarisse includes
+#include <core_array.h>
+#include <core_hash_table.h>
+#include <core_string.h>
+#include <core_vector.h>
+#include <gmath_vec3.h>
+
+// In this file we are simulating the shaders of an external Renderer with their own structures and types.
+// They only depend on the Clarisse core types so that they can be tested outside of Clarisse (see tests/test_shaders.cc)
+
+class ExternalTextureShader;
+
+/*! \struct ExternalShadingContext
+    \brief Shading inputs of a single evaluation. It is owned by the calling render thread
+    so that shaders never have to store intermediate results in shared members. */
+struct ExternalShadingContext {
+    ExternalShadingContext(const double *shading_ray_direction, const double *shading_normal) :
+        ray_direction(shading_ray_direction),
+        normal(shading_normal)
+    {}
+
+    const double *ray_direction;
+    const double *normal;
+};
+
+/*! \struct ExternalShadingBatch
+    \brief Structure of arrays describing several hits sharing the same material so that they
+    can be shaded in a single call. Each component is stored in its own array of count entries. */
+struct ExternalShadingBatch {
+    unsigned int count;
+    const double *ray_direction[3]; // x, y and z components of the ray directions
+    const double *normal[3]; // x, y and z components of the normals
+    float *color[3]; // output red, green and blue components
+};
+
+// An enum representing the external renderer type, this is important because it will be used to match out type when creating the object's attributes
+enum ExternalRendererType {
+    EXTR_TYPE_DOUBLE = 0,
+    EXTR_TYPE_COLOR,
+    EXTR_TYPE_BOOL,
+};
+
+
+/*! \class Parameter
+    \brief internal class used to create an interface between the external renderer and the Clarisse attributes
+    There is a lot of attributes that defines how the Parameter will be represent in a Clarisse Object GUI
+*/
+class Parameter {
+public :
+    Parameter(const std::string& attr_group_name, const std::string& attr_name, ExternalRendererType attr_type, double *storage) :
+        value(storage),
+        name(attr_name),
+        group_name(attr_group_name),
+        enable_numeric_range(false), min_numeric_range(0.0), max_numeric_range(0.0),
+        enable_numeric_ui_range(false), min_numeric_ui_range(0.0), max_numeric_ui_range(0.0),
+        is_texturable(false),
+        type(attr_type),
+        texture(nullptr)
+    {}
+
+    virtual ~Parameter() {}
+
+    // Pointer to the value of the parameter which is stored in the contiguous value block of its shader
+    double *value;
+
+    // GUI attributes : Attributes used to populate a GUI Clarisse object
+    // (note : you could add a lot more attributes, like a documentation, an expression etc...
+
+    // Attribute name is the name displayed for the attribute
+    std::string name;
+
+    // Group name is the category in which the attribute will be
+    std::string group_name;
+
+    // Those attributes are used to defined if our attribute will have a numeric range,
+    // it means that the value will be clamped between [min_numeric_range, max_numeric_range]
+    bool enable_numeric_range;
+    double min_numeric_range;
+    double max_numeric_range;
+
+    // Those attributes are used to defined if our attribute will have a numeric ui range,
+    // it means that the slider will have values between [min_numeric_ui_range, max_numeric_ui_range]
+    bool enable_numeric_ui_range;
+    double min_numeric_ui_range;
+    double max_numeric_ui_range;
+
+    // Tell if the Clarisse object is texturable
+    bool is_texturable;
+
+    // External Renderer attributes
+    ExternalRendererType type;
+
+    // A pointer on a external texture shader in case of the attribute is texturable
+    ExternalTextureShader *texture;
+};
+
+/********************* EXTERNAL SHADER *******************/
+
+// Map the name of each parameter of a shader class to its slot in ExternalShader::parameters
+typedef CoreHashTable<CoreString, unsigned int> ExternalParameterIndex;
+
+// Slot of the parameter index of a shader class which hasn't been registered
+static const unsigned int s_unregistered_parameter_class = 0xffffffff;
+
+/*! \class ExternalShader
+    \brief internal class used to create a shader that will create an interface between Clarisse shaders and the external ones.
+    It is in this class that the shader will define how they are evaluated.
+*/
+class ExternalShader {
+public :
+    ExternalShader() : allocated_value_count(0), parameter_class(s_unregistered_parameter_class) {}
+    virtual ~ExternalShader()
+    {
+        for (Parameter *param : parameters) {
+            delete param;
+        }
+    }
+    ExternalShader(std::string ext_base_name, std::string name, unsigned int parameter_count, unsigned int value_count) :
+        ext_class_base_name(ext_base_name), class_name(name), allocated_value_count(0), parameter_class(s_unregistered_parameter_class)
+    {
+        parameters.resize(parameter_count);
+        parameter_values.resize(value_count);
+    }
+
+    // The parameters point to the values of their shader, so a copy would share them with the original
+    ExternalShader(const ExternalShader&) = delete;
+    ExternalShader& operator=(const ExternalShader&) = delete;
+
+    // Return the next value_count values of the value block. Must be called by the shader constructor to bind its parameters.
+    double *allocate_values(const unsigned int& value_count)
+    {
+        CORE_ASSERT(allocated_value_count + value_count <= parameter_values.get_count());
+        double *values = &parameter_values[allocated_value_count];
+        allocated_value_count += value_count;
+        return values;
+    }
+
+    // Return the parameter matching the specified attribute name or nullptr if the shader doesn't define it
+    Parameter *get_parameter(const CoreString& attr_name)
+    {
+        if (parameter_class == s_unregistered_parameter_class) {
+            const unsigned int *slot = get_parameter_classes().is_key_exists(CoreString(class_name.data()));
+            if (slot == nullptr) return nullptr;
+            parameter_class = *slot;
+        }
+        const unsigned int *slot = get_parameter_indices()[parameter_class].is_key_exists(attr_name);
+        return slot != nullptr ? parameters[*slot] : nullptr;
+    }
+
+    // Build the parameter index of the class of the shader. Called once per class by SpherixRegisterShaders::register_shaders
+    static void register_parameters(const ExternalShader& shader)
+    {
+        const CoreString name(shader.class_name.data());
+        if (get_parameter_classes().is_key_exists(name) != nullptr) return;
+
+        ExternalParameterIndex parameter_index;
+        for (unsigned int i = 0; i < shader.parameters.get_count(); i++) {
+            parameter_index.add(CoreString(shader.parameters[i]->name.data()), i);
+        }
+        get_parameter_classes().add(name, get_parameter_indices().get_count());
+        get_parameter_indices().add(parameter_index);
+    }
+
+    // Parameter indices of all shader classes, shaders only keep the slot of their class since the array may grow
+    static CoreVector<ExternalParameterIndex>& get_parameter_indices()
+    {
+        static CoreVector<ExternalParameterIndex> indices;
+        return indices;
+    }
+
+    // Slot in get_parameter_indices() of each shader class
+    static CoreHashTable<CoreString, unsigned int>& get_parameter_classes()
+    {
+        static CoreHashTable<CoreString, unsigned int> classes;
+        return classes;
+    }
+
+    // Clarisse important attributes that store the module names
+    // It is important to store only XXX instead of ModuleXXX for compability reasons
+
+    // ext_class_base_name is the class name of the new External Clarisse module from which the external shader will inherit (ModuleMaterialSpherix, ModuleLightSpherix, ModuleTextureSpherix)
+    std::string ext_class_base_name;
+
+    // class_name is the actual class name of the new External Clarisse module (SpherixMaterialDiffuse, SpherixMaterialReflection, SpherixTextureColor)
+    std::string class_name;
+
+    // A list of parameters used to compute the shader
+    CoreArray<Parameter *> parameters;
+
+    // The values of all the parameters stored contiguously
+    CoreArray<double> parameter_values;
+    unsigned int allocated_value_count;
+
+private:
+    // Slot of the parameter index of the shader class resolved on first use
+    unsigned int parameter_class;
+};
+
+/******************************* Material, Light, Texture shader *********************************/
+
+/**
+ * Here we defined some class that will be used to represent an external shader.
+ * In this example we create 3 external shaders to represent the Materials, Lights and Textures.
+ * The actual Materials, Lights and Texture will inherit from those.
+ */
+
+class ExternalMaterialShader : public ExternalShader {
+public :
+    ExternalMaterialShader() : ExternalShader() {}
+    ExternalMaterialShader(std::string name, unsigned int parameter_count, unsigned int value_count) : ExternalShader("MaterialSpherix", name, parameter_count, value_count) {}
+
+    virtual GMathVec3f evaluate(const double *ray_direction, const double *normal) const {return GMathVec3f(0.0f);}
+
+    // Shade all the hits of the batch. By default each hit is evaluated one by one,
+    // materials should override it to resolve their parameters once per batch
+    virtual void evaluate_batch(const ExternalShadingBatch& batch) const
+    {
+        for (unsigned int i = 0; i < batch.count; i++) {
+            const double ray_direction[3] = { batch.ray_direction[0][i], batch.ray_direction[1][i], batch.ray_direction[2][i] };
+            const double normal[3] = { batch.normal[0][i], batch.normal[1][i], batch.normal[2][i] };
+            const GMathVec3f color = evaluate(ray_direction, normal);
+            batch.color[0][i] = color[0];
+            batch.color[1][i] = color[1];
+            batch.color[2][i] = color[2];
+        }
+    }
+};
+
+class ExternalLightShader : public ExternalShader {
+public :
+    ExternalLightShader() : ExternalShader() {}
+    ExternalLightShader(std::string name, unsigned int parameter_count, unsigned int value_count) : ExternalShader("LightSpherix", name, parameter_count, value_count) {}
+
+    virtual GMathVec3f evaluate() const { return GMathVec3f(0.0f); }
+};
+
+class ExternalTextureShader : public ExternalShader {
+public :
+    ExternalTextureShader() : ExternalShader() {}
+    ExternalTextureShader(std::string name, unsigned int parameter_count, unsigned int value_count) : ExternalShader("TextureSpherix", name, parameter_count, value_count) {}
+
+    // The result is returned by value so that the same texture can be evaluated concurrently by several render threads
+    virtual GMathVec3d evaluate(const ExternalShadingContext& context) const { return GMathVec3d(0.0); }
+};
+
+/************************************* Parameter *******************************/
+
+/**
+  * Here we define several Parameters to make an interface between the Clarisse attributes and the External Renderer attributes
+  * Note : The default value is the value used to initialize the Clarisse attribute
+ */
+
+class ParameterDouble : public Parameter
+{
+public :
+    ParameterDouble(const std::string& attr_group_name, const std::string& name, double attr_default_value, double *storage) : Parameter(attr_group_name, name, ExternalRendererType::EXTR_TYPE_DOUBLE, storage)
+    {
+        value[0] = default_value = attr_default_value;
+    }
+
+    const double get_value() const { return value[0]; }
+    const double get_default_value() const { return default_value; }
+    const double evaluate_double() const { return value[0]; }
+
+    double default_value;
+};
+
+class ParameterColor : public Parameter
+{
+public :
+    ParameterColor(const std::string& attr_group_name, const std::string& name, double *attr_default_value, double *storage) : Parameter(attr_group_name, name, ExternalRendererType::EXTR_TYPE_COLOR, storage)
+    {
+        value[0] = default_value[0] = attr_default_value[0];
+        value[1] = default_value[1] = attr_default_value[1];
+        value[2] = default_value[2] = attr_default_value[2];
+    }
+
+    const double *get_value() const { return value; }
+    const double *get_default_value() const { return default_value; }
+
+    // Return true if the parameter isn't textured so its value is the same for every evaluation
+    bool is_constant() const { return texture == nullptr; }
+
+    // The evaluate will return the value if the attribute is not textures else it will return the value return per the shader texture
+    GMathVec3d evaluate(const ExternalShadingContext& context) const
+    {
+        return (texture == nullptr) ? GMathVec3d(value[0], value[1], value[2]) : texture->evaluate(context);
+    }
+
+    double default_value[3];
+};
+
+class ParameterBool : public Parameter
+{
+public :
+    ParameterBool(const std::string& attr_group_name, const std::string& name, bool attr_default_value, double *storage) : Parameter(attr_group_name, name, ExternalRendererType::EXTR_TYPE_BOOL, storage)
+    {
+        default_value = attr_default_value;
+        value[0] = attr_default_value ? 1.0 : 0.0;
+    }
+
+    bool get_bool() const { return value[0] != 0.0; }
+    bool get_default_value() const { return default_value; }
+
+    bool default_value;
+};
+
+/********************* MATERIALS ***********************/
+
+/**
+ * Here we defined some materials with different parameters and evaluate functions.
+ * The Shaders (Material, Light and Texture) are very similar so we will only detail the first one
+ * Important : To use the shaders you need to create the class corresponding to a Clarisse Module and register this class (see : register_shaders in spherix_register_shaders.h)
+ */
+
+// This materiall will have 2 attributes one color and one boolean, according to the boolean it will return a different color
+class SpherixMaterialDiffuse : public ExternalMaterialShader {
+public :
+    SpherixMaterialDiffuse() : ExternalMaterialShader("SpherixMaterialDiffuse", 2, 4)
+    {
+        // Init the parameters
+        // Those paremeters will be created when registering our shaders (see : register_shaders in spherix_register_shaders.h)
+        // Also thanks to the function on attribute change and how the module are organized,
+        // they will always be updated when the parameter value changed (see : on_attribute_change of the spherix_module_material.h for instance)
+
+        // Color
+        double default_value[3] = {1,0,0};
+        parameters[0] = new ParameterColor("Shading", "color", default_value, allocate_values(3));
+        parameters[0]->is_texturable = true;
+
+        // Boolean
+        parameters[1] = new ParameterBool("spherix_category", "spherix_boolean", false, allocate_values(1));
+    }
+
+    // Here we are evaluating the shader with the stored parameters that are automatically updated when they changed
+    // Note : We are passing a ray_direction and a normal but we could add more arguments or remove them like in the SpherixLightDistant
+    GMathVec3f evaluate(const double *ray_direction, const double *normal) const
+    {
+        // Get the parameters
+        ParameterColor *attr_color = static_cast<ParameterColor *>(parameters[0]);
+        ParameterBool  *attr_spherix_bool = static_cast<ParameterBool *>(parameters[1]);
+
+        // Get the value parameters
+        const GMathVec3d color = attr_color->evaluate(ExternalShadingContext(ray_direction, normal));
+        const bool spherix_bool = attr_spherix_bool->get_bool();
+
+        GMathVec3f final_color;
+        // Compute the final value with a simple shading
+        if (spherix_bool) {
+            final_color = GMathVec3f(color[0] * ray_direction[0], color[1] * ray_direction[1], color[2] * ray_direction[2]);
+        } else {
+            final_color = GMathVec3f(color[0], color[1], color[2]);
+        }
+
+        double dot = ray_direction[0] * normal[0] + ray_direction[1] * normal[1] + ray_direction[2] * normal[2];
+        return fabs(dot) * final_color;
+    }
+
+    // Same as evaluate for a batch of hits. Parameters are resolved once and the loops
+    // only work on arrays so that the compiler can vectorize them
+    virtual void evaluate_batch(const ExternalShadingBatch& batch) const final
+    {
+        const ParameterColor *attr_color = static_cast<const ParameterColor *>(parameters[0]);
+        const ParameterBool  *attr_spherix_bool = static_cast<const ParameterBool *>(parameters[1]);
+
+        if (!attr_color->is_constant()) {
+            // the color is textured and must be evaluated for each hit
+            ExternalMaterialShader::evaluate_batch(batch);
+            return;
+        }
+
+        const double *dx = batch.ray_direction[0];
+        const double *dy = batch.ray_direction[1];
+        const double *dz = batch.ray_direction[2];
+        const double *nx = batch.normal[0];
+        const double *ny = batch.normal[1];
+        const double *nz = batch.normal[2];
+        const double *color = attr_color->get_value();
+        const double r = color[0], g = color[1], b = color[2];
+
+        if (attr_spherix_bool->get_bool()) {
+            for (unsigned int i = 0; i < batch.count; i++) {
+                const double dot = fabs(dx[i] * nx[i] + dy[i] * ny[i] + dz[i] * nz[i]);
+                batch.color[0][i] = static_cast<float>(r * dx[i] * dot);
+                batch.color[1][i] = static_cast<float>(g * dy[i] * dot);
+                batch.color[2][i] = static_cast<float>(b * dz[i] * dot);
+            }
+        } else {
+            for (unsigned int i = 0; i < batch.count; i++) {
+                const double dot = fabs(dx[i] * nx[i] + dy[i] * ny[i] + dz[i] * nz[i]);
+                batch.color[0][i] = static_cast<float>(r * dot);
+                batch.color[1][i] = static_cast<float>(g * dot);
+                batch.color[2][i] = static_cast<float>(b * dot);
+            }
+        }
+    }
+};
+
+class SpherixMaterialReflection : public ExternalMaterialShader {
+public :
+    SpherixMaterialReflection() : ExternalMaterialShader("SpherixMaterialReflection", 1, 3)
+    {
+        // Color
+        double default_value[3] = {1,1,1};
+        parameters[0] = new ParameterColor("Shading", "color", default_value, allocate_values(3));
+        parameters[0]->is_texturable = true;
+    }
+
+    virtual GMathVec3f evaluate(const double *ray_direction, const double *normal) const final
+    {
+        // Get the parameters
+        ParameterColor *attr_color = static_cast<ParameterColor *>(parameters[0]);
+
+        // Get the value parameters
+        const GMathVec3d color = attr_color->evaluate(ExternalShadingContext(ray_direction, normal));
+
+        // Compute the final value
+        const double dot = ray_direction[0] * normal[0] + ray_direction[1] * normal[1] + ray_direction[2] * normal[2];
+        if (dot < -0.8) {
+            return GMathVec3f(color[0], color[1], color[2]);
+        } else {
+            return GMathVec3f(0.0f);
+        }
+    }
+
+    virtual void evaluate_batch(const ExternalShadingBatch& batch) const final
+    {
+        const ParameterColor *attr_color = static_cast<const ParameterColor *>(parameters[0]);
+
+        if (!attr_color->is_constant()) {
+            // the color is textured and must be evaluated for each hit
+            ExternalMaterialShader::evaluate_batch(batch);
+            return;
+        }
+
+        const double *color = attr_color->get_value();
+        const float r = static_cast<float>(color[0]), g = static_cast<float>(color[1]), b = static_cast<float>(color[2]);
+        for (unsigned int i = 0; i < batch.count; i++) {
+            const double dot = batch.ray_direction[0][i] * batch.normal[0][i] + batch.ray_direction[1][i] * batch.normal[1][i] + batch.ray_direction[2][i] * batch.normal[2][i];
+            const float mask = dot < -0.8 ? 1.0f : 0.0f;
+            batch.color[0][i] = r * mask;
+            batch.color[1][i] = g * mask;
+            batch.color[2][i] = b * mask;
+        }
+    }
+};
+
+/********************* LIGHTS *************************/
+class SpherixLightDistant : public ExternalLightShader {
+public :
+    SpherixLightDistant() : ExternalLightShader("SpherixLightDistant", 2, 4)
+    {
+        // Color
+        double default_value[3] = {1,1,1};
+        parameters[0] = new ParameterColor("Shading", "color", default_value, allocate_values(3));
+        parameters[0]->is_texturable = true;
+
+        // Intensity
+        parameters[1] = new ParameterDouble("Shading", "intensity", 1, allocate_values(1));
+
+        parameters[1]->enable_numeric_range = true;
+        parameters[1]->min_numeric_range = 0.0;
+        parameters[1]->max_numeric_range = 10000.0;
+
+        parameters[1]->enable_numeric_ui_range = true;
+        parameters[1]->min_numeric_ui_range = 0.0;
+        parameters[1]->max_numeric_ui_range = 10.0;
+    }
+
+    virtual GMathVec3f evaluate() const final
+    {
+        // Get the parameters
+        ParameterColor  *attr_color        = static_cast<ParameterColor *>(parameters[0]);
+        ParameterDouble *attr_spherix_double = static_cast<ParameterDouble *>(parameters[1]);
+
+        // Get the value parameters
+        const double *color = attr_color->get_value();
+        const double intensity = attr_spherix_double->get_value();
+
+        return GMathVec3f(color[0], color[1], color[2]) * intensity;
+    }
+};
+
+/********************* TEXTURES ***********************/
+
+class SpherixTextureColor : public ExternalTextureShader {
+public :
+    SpherixTextureColor() : ExternalTextureShader("SpherixTextureColor", 1, 3)
+    {
+        // Color
+        double default_value[3] = {1,1,1};
+        parameters[0] = new ParameterColor("Shading", "color", default_value, allocate_values(3));
+    }
+
+    virtual GMathVec3d evaluate(const ExternalShadingContext& context) const final
+    {
+        // Get the parameters
+        const ParameterColor *attr_color = static_cast<const ParameterColor *>(parameters[0]);
+
+        // Get the value parameters
+        const double *color = attr_color->get_value();
+        return GMathVec3d(color[0], color[1], color[2]);
+    }
+};
+
+/********************* HIT SHADING ***********************/
+
+/*! \class ExternalHitBuffer
+    \brief Hits of a bucket waiting to be shaded. Hits are grouped by material with a single counting sort
+    on their material index and each group is shaded with one ExternalMaterialShader::evaluate_batch call.
+    The arrays are kept from one bucket to the next so that a render thread stops allocating once they are large enough. */
+class ExternalHitBuffer {
+public :
+    ExternalHitBuffer() : hit_count(0) {}
+
+    // Remove the recorded hits without releasing the arrays
+    void clear() { hit_count = 0; }
+
+    // Return the number of recorded hits
+    unsigned int get_count() const { return hit_count; }
+
+    // Record a hit of the specified pixel on a material, given by its index in the materials passed to shade()
+    void add(const unsigned int& pixel, const unsigned int& material, const double *ray_direction, const double *normal)
+    {
+        if (hit_count == hit_pixels.get_count()) {
+            const unsigned int capacity = hit_count == 0 ? 1024 : hit_count * 2;
+            hit_data.resize(capacity * 6);
+            hit_pixels.resize(capacity);
+            hit_materials.resize(capacity);
+        }
+        double *data = &hit_data[hit_count * 6];
+        data[0] = ray_direction[0]; data[1] = ray_direction[1]; data[2] = ray_direction[2];
+        data[3] = normal[0]; data[4] = normal[1]; data[5] = normal[2];
+        hit_pixels[hit_count] = pixel;
+        hit_materials[hit_count] = material;
+        hit_count++;
+    }
+
+    // Shade the recorded hits by batches of hits sharing the same material and write their RGBA color
+    // scaled by the light contribution at 4 * pixel in buffer
+    void shade(ExternalMaterialShader * const *materials, const unsigned int& material_count, const GMathVec3f& light_contribution, float *buffer)
+    {
+        if (hit_count == 0) return;
+
+        // count the hits of each material to get the first slot of each batch in the sorted arrays
+        if (batch_offsets.get_count() < material_count + 1) batch_offsets.resize(material_count + 1);
+        for (unsigned int i = 0; i <= material_count; i++) batch_offsets[i] = 0;
+        for (unsigned int i = 0; i < hit_count; i++) batch_offsets[hit_materials[i] + 1]++;
+        for (unsigned int i = 0; i < material_count; i++) batch_offsets[i + 1] += batch_offsets[i];
+
+        // scatter the hits to their slot, each component being stored in its own array of stride hit_count
+        if (batch_data.get_count() < hit_count * 6) {
+            batch_data.resize(hit_pixels.get_count() * 6);
+            batch_colors.resize(hit_pixels.get_count() * 3);
+            batch_pixels.resize(hit_pixels.get_count());
+        }
+        for (unsigned int i = 0; i < hit_count; i++) {
+            const unsigned int slot = batch_offsets[hit_materials[i]]++;
+            for (unsigned int k = 0; k < 6; k++) {
+                batch_data[k * hit_count + slot] = hit_data[i * 6 + k];
+            }
+            batch_pixels[slot] = hit_pixels[i];
+        }
+
+        // the scatter moved each offset to the end of its batch which is the start of the next one
+        unsigned int first = 0;
+        for (unsigned int m = 0; m < material_count; m++) {
+            const unsigned int last = batch_offsets[m];
+            if (last == first) continue;
+
+            ExternalShadingBatch batch;
+            batch.count = last - first;
+            for (unsigned int k = 0; k < 3; k++) {
+                batch.ray_direction[k] = &batch_data[k * hit_count + first];
+                batch.normal[k] = &batch_data[(k + 3) * hit_count + first];
+                batch.color[k] = &batch_colors[k * hit_count + first];
+            }
+            materials[m]->evaluate_batch(batch);
+
+            for (unsigned int i = 0; i < batch.count; i++) {
+                const unsigned int pixel_index = batch_pixels[first + i] * 4;
+                buffer[pixel_index + 0] = batch.color[0][i] * light_contribution[0];
+                buffer[pixel_index + 1] = batch.color[1][i] * light_contribution[1];
+                buffer[pixel_index + 2] = batch.color[2][i] * light_contribution[2];
+                buffer[pixel_index + 3] = 1.0f;
+            }
+            first = last;
+        }
+    }
+
+private :
+    // recorded hits, the ray direction and normal of each hit being stored contiguously in hit_data
+    unsigned int hit_count;
+    CoreArray<double> hit_data;
+    CoreArray<unsigned int> hit_pixels;
+    CoreArray<unsigned int> hit_materials;
+
+    // hits sorted by material in structure of arrays
+    CoreArray<unsigned int> batch_offsets;
+    CoreArray<double> batch_data;
+    CoreArray<float> batch_colors;
+    CoreArray<unsigned int> batch_pixels;
+};
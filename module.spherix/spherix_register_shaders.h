@@ -52,6 +52,8 @@ public :
                 // Create the corresponding Clarisse attributes
                 create_attribute_from_definition(param, class_shader);
             }
+            // Remember the slot of the parameters so attribute changes can find them directly
+            ExternalShader::register_parameters(*shader);
 
             delete shader;
         }
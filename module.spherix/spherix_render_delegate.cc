@@ -27,19 +27,84 @@ public:
         SpherixResourceIndex index; // the index of all current resources where we store deduplicated data
     } resources;
 
-    template<class INDEX>
+    template<class INFO>
     struct ClarisseToSpherixObjectsMapping {
-        INDEX index; // index of all render object (can be geometries, lights or instancers) which are instances pointing to a object resource
+        SpherixItemSlotIndex index; // index of all render object (can be geometries, lights or instancers) mapping their id to their slot in items
+        CoreVector<INFO> items; // contiguous storage of the render objects which is directly handed to the renderer
+        CoreVector<R2cItemId> ids; // id of the render object stored in the same slot of items
         CoreVector<R2cItemId> inserted; // is filled by SpherixRenderDelegate::insert_xxx when a object is inserted to the scene
         CoreVector<R2cItemId> removed; // is filled by SpherixRenderDelegate::remove_xxx when a object is removed from the scene
 
-        bool dirty; // flag set when we receive dirtiness so that we don't need to iterate the whole index to know that it is dirty
-        bool is_dirty() { return inserted.get_count() != 0 || removed.get_count() != 0 || dirty; } // return true is index is dirty
+        CoreVector<R2cItemId> dirtied; // objects which received dirtiness since the last sync, each one being queued once when it gets dirty
+        bool is_dirty() { return inserted.get_count() != 0 || removed.get_count() != 0 || dirtied.get_count() != 0; } // return true is index is dirty
+
+        // add dirtiness to a render object and queue it for the next sync if it wasn't dirty yet
+        void set_dirty(R2cItemId id, INFO& info, const int& dirtiness)
+        {
+            if (info.dirtiness == R2cSceneDelegate::DIRTINESS_NONE) dirtied.add(id);
+            info.dirtiness |= dirtiness;
+        }
+
+        // return the render object associated to the specified id or nullptr if it doesn't exist
+        INFO *get(R2cItemId id)
+        {
+            const unsigned int *slot = index.is_key_exists(id);
+            return slot != nullptr ? &items[*slot] : nullptr;
+        }
+
+        // append a new render object at the end of the contiguous storage
+        void add(R2cItemId id, const INFO& info)
+        {
+            index.add(id, items.get_count());
+            items.add(info);
+            ids.add(id);
+        }
+
+        // remove the render object by moving the last one in its slot so the storage stays contiguous
+        void remove(R2cItemId id)
+        {
+            const unsigned int *found = index.is_key_exists(id);
+            if (found != nullptr) {
+                const unsigned int slot = *found;
+                const unsigned int last = items.get_count() - 1;
+                if (slot != last) {
+                    items[slot] = items[last];
+                    ids[slot] = ids[last];
+                    *index.is_key_exists(ids[slot]) = slot;
+                }
+                items.remove_last();
+                ids.remove_last();
+                index.remove(id);
+            }
+        }
+
+        void remove_all()
+        {
+            index.remove_all();
+            items.remove_all();
+            ids.remove_all();
+        }
     };
 
-    ClarisseToSpherixObjectsMapping<SpherixGeometryIndex> geometries;
-    ClarisseToSpherixObjectsMapping<SpherixLightIndex> lights;
-    ClarisseToSpherixObjectsMapping<SpherixInstancerIndex> instancers;
+    ClarisseToSpherixObjectsMapping<SpherixGeometryInfo> geometries;
+    ClarisseToSpherixObjectsMapping<SpherixLightInfo> lights;
+    ClarisseToSpherixObjectsMapping<SpherixInstancerInfo> instancers;
+
+    // world space spheres of geometries and instancers, the entry of an item being updated when it changes
+    SpherixSphereTable spheres;
+
+    // bake the sphere of an item in the table from its resource, its transform and its material
+    void sync_sphere(R2cResourceId resource, const GMathMatrix4x4d& transform, const MaterialData& material, unsigned int& sphere)
+    {
+        const SpherixResourceInfo *resource_info = resources.index.is_key_exists(resource);
+        if (resource_info == nullptr) {
+            spheres.remove(sphere);
+        } else if (resource_info->points) {
+            spheres.set(sphere, transform, *resource_info->points, material);
+        } else {
+            spheres.set(sphere, transform, resource_info->sphere, material);
+        }
+    }
 };
 
 IMPLEMENT_CLASS(SpherixRenderDelegate, R2cRenderDelegate);
@@ -51,7 +116,7 @@ const CoreVector<CoreString> SpherixRenderDelegate::s_unsupported_lights     = {
 const CoreVector<CoreString> SpherixRenderDelegate::s_supported_materials    = { "MaterialSpherix"};
 const CoreVector<CoreString> SpherixRenderDelegate::s_unsupported_materials  = {};
 const CoreVector<CoreString> SpherixRenderDelegate::s_supported_geometries   = { "SceneObject" };
-const CoreVector<CoreString> SpherixRenderDelegate::s_unsupported_geometries = { "GeometryBundle", "GeometryPointArray" };
+const CoreVector<CoreString> SpherixRenderDelegate::s_unsupported_geometries = { "GeometryBundle" };
 
 SpherixRenderDelegate::SpherixRenderDelegate(OfApp *app) : R2cRenderDelegate()
 {
@@ -80,7 +145,7 @@ SpherixRenderDelegate::insert_light(R2cItemDescriptor item)
 void
 SpherixRenderDelegate::remove_light(R2cItemDescriptor item)
 {
-    SpherixLightInfo *light = m->lights.index.is_key_exists(item.get_id());
+    SpherixLightInfo *light = m->lights.get(item.get_id());
     if (light != nullptr) { // make sure it is indeed in our index
         m->lights.removed.add(item.get_id());
     }
@@ -89,10 +154,9 @@ SpherixRenderDelegate::remove_light(R2cItemDescriptor item)
 void
 SpherixRenderDelegate::dirty_light(R2cItemDescriptor item, const int& dirtiness)
 {
-    SpherixLightInfo *light = m->lights.index.is_key_exists(item.get_id());
+    SpherixLightInfo *light = m->lights.get(item.get_id());
     if (light != nullptr) { // make sure it is indeed in our index
-        m->lights.dirty = true;
-        light->dirtiness |= dirtiness;
+        m->lights.set_dirty(item.get_id(), *light, dirtiness);
     }
 }
 
@@ -105,7 +169,7 @@ SpherixRenderDelegate::insert_instancer(R2cItemDescriptor item)
 void
 SpherixRenderDelegate::remove_instancer(R2cItemDescriptor item)
 {
-    SpherixInstancerInfo *instancer = m->instancers.index.is_key_exists(item.get_id());
+    SpherixInstancerInfo *instancer = m->instancers.get(item.get_id());
     if (instancer != nullptr) { // make sure it is indeed in our index
         m->instancers.removed.add(item.get_id());
         instancer->dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
@@ -115,10 +179,9 @@ SpherixRenderDelegate::remove_instancer(R2cItemDescriptor item)
 void
 SpherixRenderDelegate::dirty_instancer(R2cItemDescriptor item, const int& dirtiness)
 {
-    SpherixInstancerInfo *instancer = m->instancers.index.is_key_exists(item.get_id());
+    SpherixInstancerInfo *instancer = m->instancers.get(item.get_id());
     if (instancer != nullptr) { // make sure it is indeed in our index
-        m->instancers.dirty = true;
-        instancer->dirtiness |= dirtiness;
+        m->instancers.set_dirty(item.get_id(), *instancer, dirtiness);
     }
 }
 
@@ -131,7 +194,7 @@ SpherixRenderDelegate::insert_geometry(R2cItemDescriptor item)
 void
 SpherixRenderDelegate::remove_geometry(R2cItemDescriptor item)
 {
-    SpherixGeometryInfo *geometry = m->geometries.index.is_key_exists(item.get_id());
+    SpherixGeometryInfo *geometry = m->geometries.get(item.get_id());
     if (geometry != nullptr) { // make sure it is indeed in our index
         m->geometries.removed.add(item.get_id());
         geometry->dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
@@ -141,10 +204,9 @@ SpherixRenderDelegate::remove_geometry(R2cItemDescriptor item)
 void
 SpherixRenderDelegate::dirty_geometry(R2cItemDescriptor item, const int& dirtiness)
 {
-    SpherixGeometryInfo *geometry = m->geometries.index.is_key_exists(item.get_id());
+    SpherixGeometryInfo *geometry = m->geometries.get(item.get_id());
     if (geometry != nullptr) { // make sure it is indeed in our index
-        m->geometries.dirty = true;
-        geometry->dirtiness |= dirtiness;
+        m->geometries.set_dirty(item.get_id(), *geometry, dirtiness);
     }
 }
 
@@ -161,6 +223,8 @@ SpherixRenderDelegate::sync()
     sync_geometries();
     sync_instancers();
     sync_lights();
+    // the spheres of the synchronized items have been updated in place, only the padding is left to restore
+    m->spheres.finalize();
 }
 
 void
@@ -168,25 +232,28 @@ SpherixRenderDelegate::clear()
 {
     // !!! make sure to clear everything !!!
     // clearing instances
-    m->geometries.index.remove_all();
+    m->geometries.remove_all();
     m->geometries.removed.remove_all();
     m->geometries.inserted.remove_all();
-    m->geometries.dirty = R2cSceneDelegate::DIRTINESS_ALL;
+    m->geometries.dirtied.remove_all();
 
     // clearing meshes
     m->resources.index.remove_all();
 
     // clearing instancers
-    m->instancers.index.remove_all();
+    m->instancers.remove_all();
     m->instancers.removed.remove_all();
     m->instancers.inserted.remove_all();
-    m->instancers.dirty = R2cSceneDelegate::DIRTINESS_ALL;
+    m->instancers.dirtied.remove_all();
+
+    // clearing baked spheres
+    m->spheres.clear();
 
     // clearing lights
-    m->lights.index.remove_all();
+    m->lights.remove_all();
     m->lights.removed.remove_all();
     m->lights.inserted.remove_all();
-    m->lights.dirty = R2cSceneDelegate::DIRTINESS_ALL;
+    m->lights.dirtied.remove_all();
 }
 
 void
@@ -209,7 +276,8 @@ sync_shading_groups(const R2cSceneDelegate& delegate, R2cItemId cgeometryid, Sph
 void
 SpherixRenderDelegate::_sync_geometry(R2cItemId cgeometryid, SpherixGeometryInfo& rgeometry, const bool& is_new)
 {
-    if (rgeometry.dirtiness & R2cSceneDelegate::DIRTINESS_GEOMETRY) {
+    // deformations are handled like any other geometry modification
+    if (rgeometry.dirtiness & (R2cSceneDelegate::DIRTINESS_GEOMETRY | R2cSceneDelegate::DIRTINESS_DEFORMATION)) {
         if (!is_new) {
             // mark as removed since we will need to recreate it
             m->geometries.removed.add(cgeometryid);
@@ -232,6 +300,14 @@ SpherixRenderDelegate::_sync_geometry(R2cItemId cgeometryid, SpherixGeometryInfo
                 ModuleSceneObject *module = static_cast<ModuleSceneObject *>(idesc.get_item()->get_module());
                 new_resource.sphere = module->get_bbox();
 
+                // Point arrays are rendered as a sphere per particle
+                if (SpherixPointCloud::is_point_array(cresource)) {
+                    std::shared_ptr<SpherixPointCloud> points = std::make_shared<SpherixPointCloud>();
+                    if (points->build(*m->app, cresource, module->get_bbox())) {
+                        new_resource.points = points;
+                    }
+                }
+
                 new_resource.refcount = 1;
                 // adding the new resource
                 m->resources.index.add(cresource.get_id(), new_resource);
@@ -255,6 +331,11 @@ SpherixRenderDelegate::_sync_geometry(R2cItemId cgeometryid, SpherixGeometryInfo
     if (rgeometry.dirtiness & R2cSceneDelegate::DIRTINESS_VISIBILITY) {
         rgeometry.visibility = get_scene_delegate()->get_visible(cgeometryid);
     }
+    // Bake the transform of the geometry in its sphere so that nothing
+    // has to be computed per object and per ray when rendering
+    if (rgeometry.dirtiness & (R2cSceneDelegate::DIRTINESS_KINEMATIC | R2cSceneDelegate::DIRTINESS_SHADING_GROUP)) {
+        m->sync_sphere(rgeometry.resource, rgeometry.transform, rgeometry.material, rgeometry.sphere);
+    }
 
     // setting the dirtiness back to none since the geometry is fully synched
     rgeometry.dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
@@ -264,18 +345,21 @@ void
 SpherixRenderDelegate::sync_geometries()
 {
     if (m->geometries.is_dirty()) {
-        // iterating through geometries to see if we need to sync any of them
+        // synching the geometries which received dirtiness. Only these ones are visited
+        // so the cost of the sync doesn't depend on the size of the scene.
         // it's VERY IMPORTANT to do this before everything else since if any
         // items received DIRTINESS_GEOMETRY, we need to remove it from the
         // scene to rebuild it!!!
-        for (auto geometry : m->geometries.index) {
-            if (geometry.get_value().dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
-                sync_geometry(geometry.get_key(), geometry.get_value());
+        for (auto dirtied_item : m->geometries.dirtied) {
+            SpherixGeometryInfo *geometry = m->geometries.get(dirtied_item);
+            // removed objects are skipped since their dirtiness is reset
+            if (geometry != nullptr && geometry->dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
+                sync_geometry(dirtied_item, *geometry);
             }
         }
         // let's see if we have to remove geometries from the scene
         for (auto removed_item : m->geometries.removed) {
-            SpherixGeometryInfo *geometry = m->geometries.index.is_key_exists(removed_item);
+            SpherixGeometryInfo *geometry = m->geometries.get(removed_item);
             // check the current geometry exists in the scene
             if (geometry != nullptr) {
                 // doing proper cleanup. Let's cleanup the resource
@@ -287,7 +371,9 @@ SpherixRenderDelegate::sync_geometries()
                         m->resources.index.remove(geometry->resource);
                     }
                 }
-                m->geometries.index.remove(removed_item);
+                // the slot of its sphere is reused by the next new item
+                m->spheres.remove(geometry->sphere);
+                m->geometries.remove(removed_item);
                 if (m->geometries.index.get_count() == 0) break; // finished
             }
         }
@@ -299,21 +385,20 @@ SpherixRenderDelegate::sync_geometries()
         // is why it is very important to first sync the index, remove and finally add.
         // let's see if we have to create new geometries
         SpherixGeometryInfo geometry;
-        CoreVector<SpherixGeometryInfo> new_geometries(0, m->geometries.inserted.get_count());
         for (auto inserted_item : m->geometries.inserted) {
             // initializing the new geometry
             geometry.dirtiness = R2cSceneDelegate::DIRTINESS_ALL;
+            geometry.sphere = SpherixSphereTable::s_invalid_handle;
             // synching the new geometry
             sync_new_geometry(inserted_item, geometry);
             // adding it to our geometry index
-            m->geometries.index.add(inserted_item, geometry);
-            new_geometries.add(geometry);
+            m->geometries.add(inserted_item, geometry);
         }
         // since we processed all pending inserted geometries we have to clear the array
         m->geometries.inserted.remove_all();
     }
     // our geometries are now perfectly synched
-    m->geometries.dirty = false;
+    m->geometries.dirtied.remove_all();
 }
 
 /*! \brief shading group synchronization helper */
@@ -375,6 +460,9 @@ SpherixRenderDelegate::_sync_instancer(R2cItemId cinstancerid, SpherixInstancerI
     if (rinstancer.dirtiness & R2cSceneDelegate::DIRTINESS_VISIBILITY) {
         rinstancer.visibility = get_scene_delegate()->get_visible(cinstancerid);
     }
+    if (rinstancer.dirtiness & (R2cSceneDelegate::DIRTINESS_KINEMATIC | R2cSceneDelegate::DIRTINESS_SHADING_GROUP)) {
+        m->sync_sphere(rinstancer.resource, rinstancer.transform, rinstancer.material, rinstancer.sphere);
+    }
     // setting the dirtiness back to none since the instancer is synched
     rinstancer.dirtiness = R2cSceneDelegate::DIRTINESS_NONE;
 }
@@ -383,19 +471,21 @@ void
 SpherixRenderDelegate::sync_instancers()
 {
     if (m->instancers.is_dirty()) {
-        // iterating through instancers to see if we need to sync any of them
+        // synching the instancers which received dirtiness
         // it's VERY IMPORTANT to do this before everything else since if any
         // items received DIRTINESS_GEOMETRY, we need to remove it from the
         // scene to rebuild it!!!
-        for (auto instancer : m->instancers.index) {
-            if (instancer.get_value().dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
-                sync_instancer(instancer.get_key(), instancer.get_value());
+        for (auto dirtied_item : m->instancers.dirtied) {
+            SpherixInstancerInfo *instancer = m->instancers.get(dirtied_item);
+            // removed objects are skipped since their dirtiness is reset
+            if (instancer != nullptr && instancer->dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
+                sync_instancer(dirtied_item, *instancer);
             }
         }
 
         // let's see if we have to remove instancers from the scene
         for (auto removed_item : m->instancers.removed) {
-            SpherixInstancerInfo *instancer = m->instancers.index.is_key_exists(removed_item);
+            SpherixInstancerInfo *instancer = m->instancers.get(removed_item);
             // check the current instancer exists in the scene
             if (instancer != nullptr) {
                 // now doing proper cleanup. Let's cleanup resources
@@ -407,7 +497,8 @@ SpherixRenderDelegate::sync_instancers()
                         m->resources.index.remove(instancer->resource);
                     }
                 }
-                m->instancers.index.remove(removed_item);
+                m->spheres.remove(instancer->sphere);
+                m->instancers.remove(removed_item);
                 if (m->instancers.index.get_count() == 0) break; // finished
             }
         }
@@ -419,21 +510,20 @@ SpherixRenderDelegate::sync_instancers()
         // is why it is very important to first sync the index, remove and finally add.
         // let's see if we have to create new geometries
         SpherixInstancerInfo instancer;
-        CoreVector<SpherixInstancerInfo> new_instancers(0, m->instancers.inserted.get_count());
         for (auto inserted_item : m->instancers.inserted) {
             // since we create them we need to make them as fully dirty
             instancer.dirtiness = R2cSceneDelegate::DIRTINESS_ALL;
+            instancer.sphere = SpherixSphereTable::s_invalid_handle;
             // synching the new instancer
             sync_new_instancer(inserted_item, instancer);
             // adding it to our instancer index
-            m->instancers.index.add(inserted_item, instancer);
-            new_instancers.add(instancer);
+            m->instancers.add(inserted_item, instancer);
         }
         // since we processed all pending inserted instancers we have to clear the array
         m->instancers.inserted.remove_all();
     }
     // our instancers are now perfectly synched
-    m->instancers.dirty = false;
+    m->instancers.dirtied.remove_all();
 }
 
 /*! \brief light synchronization helper */
@@ -450,10 +540,10 @@ SpherixRenderDelegate::sync_lights()
     if (m->lights.is_dirty()) {
         // remove lights first
         for (auto removed_item : m->lights.removed) {
-            SpherixLightInfo *light = m->lights.index.is_key_exists(removed_item);
+            SpherixLightInfo *light = m->lights.get(removed_item);
             // check the current light exists in the scene
             if (light != nullptr) {
-                m->lights.index.remove(removed_item);
+                m->lights.remove(removed_item);
                 if (m->lights.index.get_count() == 0) break; // finished
             }
         }
@@ -461,7 +551,6 @@ SpherixRenderDelegate::sync_lights()
 
         // creating new lights
         SpherixLightInfo light;
-        CoreVector<SpherixLightInfo> new_lights(0, m->lights.inserted.get_count());
         for (auto inserted_item : m->lights.inserted) {
             // create corresponding light according to the Clarisse light
             SpherixUtils::create_light(*get_scene_delegate(), inserted_item, light);
@@ -470,20 +559,21 @@ SpherixRenderDelegate::sync_lights()
             // synching the new light
             sync_light(*get_scene_delegate(), inserted_item, light);
             // adding it to our light index
-            m->lights.index.add(inserted_item, light);
-            new_lights.add(light);
+            m->lights.add(inserted_item, light);
         }
         m->lights.inserted.remove_all();
 
-        // iterating through lights to see if we need to sync any of them
-        for (auto light : m->lights.index) {
-            if (light.get_value().dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
-                sync_light(*get_scene_delegate(), light.get_key(), light.get_value());
+        // synching the lights which received dirtiness
+        for (auto dirtied_item : m->lights.dirtied) {
+            SpherixLightInfo *light = m->lights.get(dirtied_item);
+            // removed objects are skipped since their dirtiness is reset
+            if (light != nullptr && light->dirtiness != R2cSceneDelegate::DIRTINESS_NONE) {
+                sync_light(*get_scene_delegate(), dirtied_item, *light);
             }
         }
     }
     // our lights are now perfectly synched
-    m->lights.dirty = false;
+    m->lights.dirtied.remove_all();
 }
 
 void
@@ -521,6 +611,7 @@ SpherixRenderDelegate::render(R2cRenderBuffer *render_buffer, const float& sampl
     m->progress.set_float(0.0f);
 
     // Extract the image dimensions and synchronize our internal scene representation
+    R2cRenderBuffer::Region render_region = render_buffer->get_render_region();
     const unsigned int width = render_buffer->get_width();
     const unsigned int height = render_buffer->get_height();
     sync_camera(width, height);
@@ -535,10 +626,9 @@ SpherixRenderDelegate::render(R2cRenderBuffer *render_buffer, const float& sampl
     ExternalRenderer::render(m->app,
                              m->camera,
                              width, height,
-                             m->geometries.index.get_values(),
-                             m->instancers.index.get_values(),
-                             m->resources.index,
-                             m->lights.index.get_values(),
+                             render_region,
+                             m->spheres,
+                             m->lights.items,
                              background_color,
                              m->progress,
                              render_buffer);
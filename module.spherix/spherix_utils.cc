@@ -8,9 +8,30 @@
 #include "./spherix_utils.h"
 
 // Clarisse includes
+#include <geometry_point_cloud.h>
 #include <module_camera.h>
+#include <of_app.h>
 #include <ray_generator_camera.h>
 #include <sampling_image.h>
+#include <sys_thread_task_manager.h>
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPHERIX_SSE2
+#include <emmintrin.h>
+// the AVX2 kernel is compiled whatever the target of the build and only used if the CPU supports it
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SPHERIX_AVX2
+#define SPHERIX_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define SPHERIX_AVX2
+#define SPHERIX_AVX2_TARGET
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
 
 void SpherixCamera::init_ray_generator(const R2cSceneDelegate& delegate, const unsigned int width, const unsigned int height)
 {
@@ -63,33 +84,27 @@ void SpherixUtils::create_light(const R2cSceneDelegate &render_delegate, R2cItem
 
 void SpherixAttributChange::on_attribute_change(const OfAttr &attr, ExternalShader *shader)
 {
-    std::string parameter_name = attr.get_name().get_data();
-
-    // Browse all the shader attributes and update the correct one
-    for (Parameter *param : shader->parameters) {
-        if (param->name == parameter_name) {
-            // Update the value
-            if (param->type == EXTR_TYPE_DOUBLE) {
-                ParameterDouble *param_color = static_cast<ParameterDouble *>(param);
-                param_color->value = attr.get_double();
-            } else if (param->type == EXTR_TYPE_COLOR) {
-                ParameterColor *param_color = static_cast<ParameterColor *>(param);
-                GMathVec3d value = attr.get_vec3d();
-                param_color->value[0] = value[0];
-                param_color->value[1] = value[1];
-                param_color->value[2] = value[2];
-            } else if(param->type == EXTR_TYPE_BOOL) {
-                ParameterBool *param_bool = static_cast<ParameterBool *>(param);
-                param_bool->value = attr.get_bool();
-            } else {
-                CORE_ASSERT(false);
-            }
+    // Find the shader parameter bound to the attribute using the index built when registering the shaders
+    Parameter *param = shader->get_parameter(attr.get_name());
+    if (param == nullptr) {
+        return;
+    }
 
-            param->texture = (attr.is_textured()) ? static_cast<ModuleTextureSpherix *>(attr.get_texture()->get_module())->get_texture() : nullptr;
-            break;
-        }
+    // Update the value
+    if (param->type == EXTR_TYPE_DOUBLE) {
+        param->value[0] = attr.get_double();
+    } else if (param->type == EXTR_TYPE_COLOR) {
+        GMathVec3d value = attr.get_vec3d();
+        param->value[0] = value[0];
+        param->value[1] = value[1];
+        param->value[2] = value[2];
+    } else if(param->type == EXTR_TYPE_BOOL) {
+        param->value[0] = attr.get_bool() ? 1.0 : 0.0;
+    } else {
+        CORE_ASSERT(false);
     }
 
+    param->texture = (attr.is_textured()) ? static_cast<ModuleTextureSpherix *>(attr.get_texture()->get_module())->get_texture() : nullptr;
 }
 
 bool SpherixSphere::intersect(const GMathRay &local_ray, double &t, GMathVec3d &normal) const {
@@ -130,3 +145,670 @@ bool SpherixSphere::intersect(const GMathRay &local_ray, double &t, GMathVec3d &
 }
 
 GMathVec3d SpherixSphere::get_center() const { return m_center; }
+
+void SpherixSphereTable::clear()
+{
+    m_entries.remove_all();
+    m_free_handles.remove_all();
+    m_center_x.remove_all();
+    m_center_y.remove_all();
+    m_center_z.remove_all();
+    m_radius.remove_all();
+    m_square_radius.remove_all();
+    m_materials.remove_all();
+    m_handles.remove_all();
+    m_transformed.remove_all();
+    m_point_clouds.remove_all();
+    m_material_shaders.remove_all();
+    m_material_refcounts.remove_all();
+    m_free_materials.remove_all();
+    m_material_indices.remove_all();
+    m_count = 0;
+}
+
+MaterialData SpherixSphereTable::register_material(const MaterialData& material)
+{
+    MaterialData registered = material;
+    if (material.material == nullptr) return registered;
+
+    const unsigned int *index = m_material_indices.is_key_exists(material.material);
+    if (index != nullptr) {
+        registered.index = *index;
+    } else if (m_free_materials.get_count() != 0) {
+        registered.index = m_free_materials[m_free_materials.get_count() - 1];
+        m_free_materials.remove_last();
+        m_material_indices.add(material.material, registered.index);
+        m_material_shaders[registered.index] = material.material;
+    } else {
+        registered.index = m_material_shaders.get_count();
+        m_material_indices.add(material.material, registered.index);
+        m_material_shaders.add(material.material);
+        m_material_refcounts.add(0);
+    }
+    m_material_refcounts[registered.index]++;
+    return registered;
+}
+
+void SpherixSphereTable::unregister_material(const MaterialData& material)
+{
+    if (material.material == nullptr) return;
+
+    // the slot of a material no longer used is reused by the next new material
+    if (--m_material_refcounts[material.index] == 0) {
+        m_material_indices.remove(material.material);
+        m_material_shaders[material.index] = nullptr;
+        m_free_materials.add(material.index);
+    }
+}
+
+unsigned int SpherixSphereTable::allocate_handle()
+{
+    if (m_free_handles.get_count() != 0) {
+        const unsigned int handle = m_free_handles[m_free_handles.get_count() - 1];
+        m_free_handles.remove_last();
+        return handle;
+    }
+    m_entries.add(Entry());
+    return m_entries.get_count() - 1;
+}
+
+void SpherixSphereTable::remove_padding()
+{
+    while (m_center_x.get_count() > m_count) {
+        m_center_x.remove_last();
+        m_center_y.remove_last();
+        m_center_z.remove_last();
+        m_radius.remove_last();
+        m_square_radius.remove_last();
+    }
+}
+
+void SpherixSphereTable::remove_entry(const unsigned int& handle)
+{
+    // the last entry of the same kind is moved in the slot of the removed one so the storage stays contiguous
+    const Entry& entry = m_entries[handle];
+    const unsigned int slot = entry.index;
+    if (entry.kind == ENTRY_WORLD) {
+        remove_padding();
+        unregister_material(m_materials[slot]);
+        const unsigned int last = m_count - 1;
+        if (slot != last) {
+            m_center_x[slot] = m_center_x[last];
+            m_center_y[slot] = m_center_y[last];
+            m_center_z[slot] = m_center_z[last];
+            m_radius[slot] = m_radius[last];
+            m_square_radius[slot] = m_square_radius[last];
+            m_materials[slot] = m_materials[last];
+            m_handles[slot] = m_handles[last];
+            m_entries[m_handles[slot]].index = slot;
+        }
+        m_center_x.remove_last();
+        m_center_y.remove_last();
+        m_center_z.remove_last();
+        m_radius.remove_last();
+        m_square_radius.remove_last();
+        m_materials.remove_last();
+        m_handles.remove_last();
+        m_count--;
+    } else if (entry.kind == ENTRY_TRANSFORMED) {
+        unregister_material(m_transformed[slot].material);
+        const unsigned int last = m_transformed.get_count() - 1;
+        if (slot != last) {
+            m_transformed[slot] = m_transformed[last];
+            m_entries[m_transformed[slot].handle].index = slot;
+        }
+        m_transformed.remove_last();
+    } else {
+        unregister_material(m_point_clouds[slot].material);
+        const unsigned int last = m_point_clouds.get_count() - 1;
+        if (slot != last) {
+            m_point_clouds[slot] = m_point_clouds[last];
+            m_entries[m_point_clouds[slot].handle].index = slot;
+        }
+        m_point_clouds.remove_last();
+    }
+}
+
+void SpherixSphereTable::remove(unsigned int& handle)
+{
+    if (handle == s_invalid_handle) return;
+    remove_entry(handle);
+    m_free_handles.add(handle);
+    handle = s_invalid_handle;
+}
+
+void SpherixSphereTable::set(unsigned int& handle, const GMathMatrix4x4d& transform, const SpherixSphere& sphere, const MaterialData& material)
+{
+    // the new material is registered before the old one is released so that a material kept by the item keeps its slot
+    const MaterialData registered = register_material(material);
+    if (handle == s_invalid_handle) {
+        handle = allocate_handle();
+    } else {
+        remove_entry(handle);
+    }
+
+    // the sphere can be baked in world space only if the transform is a rotation with a uniform scale
+    const GMathVec3d axis_x(transform[0][0], transform[0][1], transform[0][2]);
+    const GMathVec3d axis_y(transform[1][0], transform[1][1], transform[1][2]);
+    const GMathVec3d axis_z(transform[2][0], transform[2][1], transform[2][2]);
+    const double scale = axis_x.get_length();
+    const double epsilon = 1e-6 * gmath_max(scale * scale, 1.0);
+
+    Entry& entry = m_entries[handle];
+    if (fabs(axis_y.dot(axis_y) - scale * scale) < epsilon && fabs(axis_z.dot(axis_z) - scale * scale) < epsilon &&
+        fabs(axis_x.dot(axis_y)) < epsilon && fabs(axis_x.dot(axis_z)) < epsilon && fabs(axis_y.dot(axis_z)) < epsilon) {
+        const GMathVec3d center = sphere.get_center();
+        const double radius = sphere.get_radius() * scale;
+        remove_padding();
+        entry.kind = ENTRY_WORLD;
+        entry.index = m_count;
+        m_center_x.add(static_cast<float>(center[0] * transform[0][0] + center[1] * transform[1][0] + center[2] * transform[2][0] + transform[3][0]));
+        m_center_y.add(static_cast<float>(center[0] * transform[0][1] + center[1] * transform[1][1] + center[2] * transform[2][1] + transform[3][1]));
+        m_center_z.add(static_cast<float>(center[0] * transform[0][2] + center[1] * transform[1][2] + center[2] * transform[2][2] + transform[3][2]));
+        m_radius.add(static_cast<float>(radius));
+        m_square_radius.add(static_cast<float>(radius * radius));
+        m_materials.add(registered);
+        m_handles.add(handle);
+        m_count++;
+    } else {
+        TransformedSphere transformed;
+        GMathMatrix4x4d sphere_transform = transform;
+        sphere_transform.translate_right(sphere.get_center());
+        GMathMatrix4x4d::get_inverse(sphere_transform, transformed.inverse_transform);
+        transformed.sphere = sphere;
+        transformed.material = registered;
+        transformed.handle = handle;
+        entry.kind = ENTRY_TRANSFORMED;
+        entry.index = m_transformed.get_count();
+        m_transformed.add(transformed);
+    }
+}
+
+void SpherixSphereTable::set(unsigned int& handle, const GMathMatrix4x4d& transform, const SpherixPointCloud& points, const MaterialData& material)
+{
+    const MaterialData registered = register_material(material);
+    if (handle == s_invalid_handle) {
+        handle = allocate_handle();
+    } else {
+        remove_entry(handle);
+    }
+
+    TransformedPointCloud transformed;
+    GMathMatrix4x4d::get_inverse(transform, transformed.inverse_transform);
+    transformed.points = &points;
+    transformed.material = registered;
+    transformed.handle = handle;
+    Entry& entry = m_entries[handle];
+    entry.kind = ENTRY_POINT_CLOUD;
+    entry.index = m_point_clouds.get_count();
+    m_point_clouds.add(transformed);
+}
+
+void SpherixSphereTable::finalize()
+{
+    // padding spheres have a negative square radius so they are rarely reported as hit, lanes past
+    // the last sphere are anyway ignored by intersect() since rounding can still make them hit
+    while (m_center_x.get_count() % s_block_size != 0) {
+        m_center_x.add(0.0f);
+        m_center_y.add(0.0f);
+        m_center_z.add(0.0f);
+        m_radius.add(1.0f);
+        m_square_radius.add(-1.0f);
+    }
+}
+
+// world space spheres of the table read by the intersection kernels
+struct SpherixTableSpheres {
+    const float *center_x;
+    const float *center_y;
+    const float *center_z;
+    const float *square_radius;
+    unsigned int count; // number of spheres
+    unsigned int padded_count; // number of spheres including the padding of the last block
+};
+
+// world space ray converted to single precision for the intersection kernels
+struct SpherixTableRay {
+    float ox, oy, oz;
+    float dx, dy, dz;
+    float a; // square length of the direction
+};
+
+// kernel intersecting all the spheres of the table and updating the closest hit
+typedef void (*SpherixTableKernel)(const SpherixTableSpheres& spheres, const SpherixTableRay& ray, float& closest_t, int& closest_index);
+
+// a hit was found in the block starting at the specified sphere, resolve which lane is the closest skipping the padding lanes
+static inline void
+resolve_block_hits(const SpherixTableSpheres& spheres, const unsigned int& first, const int& mask, const float *block_t, float& closest_t, int& closest_index)
+{
+    const unsigned int block_size = SpherixSphereTable::s_block_size;
+    const unsigned int lane_count = spheres.count - first < block_size ? spheres.count - first : block_size;
+    for (unsigned int lane = 0; lane < lane_count; lane++) {
+        if ((mask & (1 << lane)) && block_t[lane] < closest_t) {
+            closest_t = block_t[lane];
+            closest_index = static_cast<int>(first + lane);
+        }
+    }
+}
+
+// For each sphere we solve a*t^2 + 2*b*t + c = 0 and keep the smallest root
+#if !defined(SPHERIX_SSE2)
+static void
+intersect_spheres_scalar(const SpherixTableSpheres& spheres, const SpherixTableRay& ray, float& closest_t, int& closest_index)
+{
+    float block_t[SpherixSphereTable::s_block_size];
+    for (unsigned int i = 0; i < spheres.padded_count; i += SpherixSphereTable::s_block_size) {
+        int mask = 0;
+        for (unsigned int k = 0; k < SpherixSphereTable::s_block_size; k++) {
+            const float ocx = ray.ox - spheres.center_x[i + k];
+            const float ocy = ray.oy - spheres.center_y[i + k];
+            const float ocz = ray.oz - spheres.center_z[i + k];
+            const float b = ray.dx * ocx + ray.dy * ocy + ray.dz * ocz;
+            const float c = ocx * ocx + ocy * ocy + ocz * ocz - spheres.square_radius[i + k];
+            const float discrim = b * b - ray.a * c;
+            if (discrim >= 0.0f) {
+                block_t[k] = (-b - sqrtf(discrim)) / ray.a;
+                if (block_t[k] < closest_t) mask |= 1 << k;
+            }
+        }
+        if (mask != 0) resolve_block_hits(spheres, i, mask, block_t, closest_t, closest_index);
+    }
+}
+#endif
+
+#if defined(SPHERIX_SSE2)
+static void
+intersect_spheres_sse2(const SpherixTableSpheres& spheres, const SpherixTableRay& ray, float& closest_t, int& closest_index)
+{
+    float block_t[SpherixSphereTable::s_block_size];
+    for (unsigned int i = 0; i < spheres.padded_count; i += SpherixSphereTable::s_block_size) {
+        int mask = 0;
+        for (unsigned int k = 0; k < SpherixSphereTable::s_block_size; k += 4) {
+            const __m128 ocx = _mm_sub_ps(_mm_set1_ps(ray.ox), _mm_loadu_ps(&spheres.center_x[i + k]));
+            const __m128 ocy = _mm_sub_ps(_mm_set1_ps(ray.oy), _mm_loadu_ps(&spheres.center_y[i + k]));
+            const __m128 ocz = _mm_sub_ps(_mm_set1_ps(ray.oz), _mm_loadu_ps(&spheres.center_z[i + k]));
+            const __m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(ray.dx), ocx), _mm_mul_ps(_mm_set1_ps(ray.dy), ocy)), _mm_mul_ps(_mm_set1_ps(ray.dz), ocz));
+            const __m128 c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, ocx), _mm_mul_ps(ocy, ocy)), _mm_mul_ps(ocz, ocz)), _mm_loadu_ps(&spheres.square_radius[i + k]));
+            const __m128 discrim = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(_mm_set1_ps(ray.a), c));
+            const __m128 t = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), b), _mm_sqrt_ps(_mm_max_ps(discrim, _mm_setzero_ps()))), _mm_set1_ps(ray.a));
+            const __m128 hit = _mm_and_ps(_mm_cmpge_ps(discrim, _mm_setzero_ps()), _mm_cmplt_ps(t, _mm_set1_ps(closest_t)));
+            const int sub_mask = _mm_movemask_ps(hit);
+            if (sub_mask != 0) {
+                _mm_storeu_ps(&block_t[k], t);
+                mask |= sub_mask << k;
+            }
+        }
+        if (mask != 0) resolve_block_hits(spheres, i, mask, block_t, closest_t, closest_index);
+    }
+}
+#endif
+
+#if defined(SPHERIX_AVX2)
+SPHERIX_AVX2_TARGET static void
+intersect_spheres_avx2(const SpherixTableSpheres& spheres, const SpherixTableRay& ray, float& closest_t, int& closest_index)
+{
+    float block_t[SpherixSphereTable::s_block_size];
+    for (unsigned int i = 0; i < spheres.padded_count; i += SpherixSphereTable::s_block_size) {
+        const __m256 ocx = _mm256_sub_ps(_mm256_set1_ps(ray.ox), _mm256_loadu_ps(&spheres.center_x[i]));
+        const __m256 ocy = _mm256_sub_ps(_mm256_set1_ps(ray.oy), _mm256_loadu_ps(&spheres.center_y[i]));
+        const __m256 ocz = _mm256_sub_ps(_mm256_set1_ps(ray.oz), _mm256_loadu_ps(&spheres.center_z[i]));
+        const __m256 b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(ray.dx), ocx), _mm256_mul_ps(_mm256_set1_ps(ray.dy), ocy)), _mm256_mul_ps(_mm256_set1_ps(ray.dz), ocz));
+        const __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocx, ocx), _mm256_mul_ps(ocy, ocy)), _mm256_mul_ps(ocz, ocz)), _mm256_loadu_ps(&spheres.square_radius[i]));
+        const __m256 discrim = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(_mm256_set1_ps(ray.a), c));
+        const __m256 t = _mm256_div_ps(_mm256_sub_ps(_mm256_sub_ps(_mm256_setzero_ps(), b), _mm256_sqrt_ps(_mm256_max_ps(discrim, _mm256_setzero_ps()))), _mm256_set1_ps(ray.a));
+        const __m256 hit = _mm256_and_ps(_mm256_cmp_ps(discrim, _mm256_setzero_ps(), _CMP_GE_OQ), _mm256_cmp_ps(t, _mm256_set1_ps(closest_t), _CMP_LT_OQ));
+        const int mask = _mm256_movemask_ps(hit);
+        if (mask != 0) {
+            _mm256_storeu_ps(block_t, t);
+            resolve_block_hits(spheres, i, mask, block_t, closest_t, closest_index);
+        }
+    }
+}
+
+// return true if both the CPU and the OS support AVX2
+static bool
+is_avx2_supported()
+{
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    // the OS must save the AVX registers (OSXSAVE and XCR0 bits of the SSE and AVX states)
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#endif
+}
+#endif
+
+// return the widest intersection kernel supported by the CPU running the renderer
+static SpherixTableKernel
+get_table_kernel()
+{
+#if defined(SPHERIX_AVX2)
+    if (is_avx2_supported()) return intersect_spheres_avx2;
+#endif
+#if defined(SPHERIX_SSE2)
+    return intersect_spheres_sse2;
+#else
+    return intersect_spheres_scalar;
+#endif
+}
+
+bool SpherixSphereTable::intersect(const GMathRay& ray, double& closest_hit_t, GMathVec3d& closest_hit_normal, MaterialData& closest_hit_material) const
+{
+    // the kernel is selected once for all
+    static const SpherixTableKernel kernel = get_table_kernel();
+
+    const GMathVec3d& origin = ray.get_origin();
+    const GMathVec3d& direction = ray.get_direction();
+    SpherixTableRay table_ray;
+    table_ray.ox = static_cast<float>(origin[0]);
+    table_ray.oy = static_cast<float>(origin[1]);
+    table_ray.oz = static_cast<float>(origin[2]);
+    table_ray.dx = static_cast<float>(direction[0]);
+    table_ray.dy = static_cast<float>(direction[1]);
+    table_ray.dz = static_cast<float>(direction[2]);
+    table_ray.a = table_ray.dx * table_ray.dx + table_ray.dy * table_ray.dy + table_ray.dz * table_ray.dz;
+
+    SpherixTableSpheres spheres;
+    spheres.center_x = m_center_x.get_data();
+    spheres.center_y = m_center_y.get_data();
+    spheres.center_z = m_center_z.get_data();
+    spheres.square_radius = m_square_radius.get_data();
+    spheres.count = m_count;
+    spheres.padded_count = m_center_x.get_count();
+
+    float closest_t = static_cast<float>(closest_hit_t);
+    int closest_index = -1;
+    if (spheres.padded_count != 0) kernel(spheres, table_ray, closest_t, closest_index);
+
+    bool found = false;
+    if (closest_index >= 0) {
+        const double t = static_cast<double>(closest_t);
+        const GMathVec3d center(m_center_x[closest_index], m_center_y[closest_index], m_center_z[closest_index]);
+        closest_hit_t = t;
+        closest_hit_normal = (ray.compute_position(t) - center) / static_cast<double>(m_radius[closest_index]);
+        closest_hit_material = m_materials[closest_index];
+        found = true;
+    }
+
+    // spheres with non uniform transform are intersected in their own space
+    for (const TransformedSphere& transformed : m_transformed) {
+        GMathRay transformed_ray;
+        transformed_ray.transform(ray, transformed.inverse_transform);
+        double t;
+        GMathVec3d normal;
+        if (transformed.sphere.intersect(transformed_ray, t, normal) && t < closest_hit_t) {
+            GMathMatrix4x4d inverse_transpose_transform;
+            GMathMatrix4x4d::transpose(transformed.inverse_transform, inverse_transpose_transform);
+            GMathMatrix4x4d::multiply(closest_hit_normal, normal, inverse_transpose_transform);
+            closest_hit_t = t;
+            closest_hit_material = transformed.material;
+            found = true;
+        }
+    }
+
+    // particles are intersected in their own space through their hierarchy
+    for (const TransformedPointCloud& transformed : m_point_clouds) {
+        GMathRay transformed_ray;
+        transformed_ray.transform(ray, transformed.inverse_transform);
+        double t;
+        GMathVec3d normal;
+        if (transformed.points->intersect(transformed_ray, t, normal) && t < closest_hit_t) {
+            GMathMatrix4x4d inverse_transpose_transform;
+            GMathMatrix4x4d::transpose(transformed.inverse_transform, inverse_transpose_transform);
+            GMathMatrix4x4d::multiply(closest_hit_normal, normal, inverse_transpose_transform);
+            closest_hit_t = t;
+            closest_hit_material = transformed.material;
+            found = true;
+        }
+    }
+    return found;
+}
+
+/*********************************** POINT CLOUD ***********************************/
+
+// maximum number of particles per leaf
+static const unsigned int s_point_cloud_leaf_size = 4;
+// depth at which the hierarchy is split in subtrees built in parallel (2^depth subtrees)
+static const unsigned int s_point_cloud_parallel_depth = 5;
+// below this number of particles the hierarchy is built serially
+static const unsigned int s_point_cloud_parallel_min_count = 65536;
+// maximum depth of the hierarchy which is traversed with a fixed size stack. Since nodes are split
+// at the median the depth is at most log2 of the number of particles which is far below this limit
+static const unsigned int s_point_cloud_max_depth = 63;
+
+// Subtree of the hierarchy to build. The node is already allocated in the final hierarchy
+struct SpherixPointCloudRange {
+    unsigned int node;
+    unsigned int begin;
+    unsigned int end;
+};
+
+static void
+build_point_cloud_node(const float *points, unsigned int *indices, CoreVector<SpherixPointCloud::Node>& nodes,
+                       const unsigned int& node_index, const unsigned int& begin, const unsigned int& end,
+                       const unsigned int& depth, const unsigned int& max_depth, CoreVector<SpherixPointCloudRange> *pending,
+                       unsigned int& tree_depth)
+{
+    SpherixPointCloud::Node node;
+    const float infinity = static_cast<float>(gmath_infinity);
+    float cmin[3], cmax[3];
+    for (unsigned int k = 0; k < 3; k++) {
+        node.min[k] = cmin[k] = infinity;
+        node.max[k] = cmax[k] = -infinity;
+    }
+    // compute the bounds of the spheres and of their centers
+    for (unsigned int i = begin; i < end; i++) {
+        const float *point = &points[indices[i] * 4];
+        for (unsigned int k = 0; k < 3; k++) {
+            node.min[k] = gmath_min(node.min[k], point[k] - point[3]);
+            node.max[k] = gmath_max(node.max[k], point[k] + point[3]);
+            cmin[k] = gmath_min(cmin[k], point[k]);
+            cmax[k] = gmath_max(cmax[k], point[k]);
+        }
+    }
+
+    if (end - begin <= s_point_cloud_leaf_size) {
+        node.first = begin;
+        node.count = end - begin;
+        nodes[node_index] = node;
+        tree_depth = gmath_max(tree_depth, depth);
+        return;
+    }
+
+    // split at the median of the largest axis
+    unsigned int axis = 0;
+    if (cmax[1] - cmin[1] > cmax[axis] - cmin[axis]) axis = 1;
+    if (cmax[2] - cmin[2] > cmax[axis] - cmin[axis]) axis = 2;
+    const unsigned int middle = (begin + end) / 2;
+    std::nth_element(indices + begin, indices + middle, indices + end,
+                     [points, axis](const unsigned int& a, const unsigned int& b) { return points[a * 4 + axis] < points[b * 4 + axis]; });
+
+    node.first = nodes.get_count();
+    node.count = 0;
+    nodes[node_index] = node;
+    nodes.add(node);
+    nodes.add(node);
+
+    if (pending != nullptr && depth + 1 >= max_depth) {
+        // children will be built later on by parallel tasks
+        SpherixPointCloudRange range;
+        range.node = node.first; range.begin = begin; range.end = middle;
+        pending->add(range);
+        range.node = node.first + 1; range.begin = middle; range.end = end;
+        pending->add(range);
+    } else {
+        build_point_cloud_node(points, indices, nodes, node.first, begin, middle, depth + 1, max_depth, pending, tree_depth);
+        build_point_cloud_node(points, indices, nodes, node.first + 1, middle, end, depth + 1, max_depth, pending, tree_depth);
+    }
+}
+
+// Multithread task to build a subtree of the hierarchy in its own array of nodes
+class SpherixPointCloudBuildTask : public SysThreadTask {
+public :
+    virtual void execution_entry(const unsigned int& id)
+    {
+        nodes.add(SpherixPointCloud::Node());
+        depth = 0;
+        build_point_cloud_node(points, indices, nodes, 0, range.begin, range.end, 0, 0, nullptr, depth);
+    }
+
+    const float *points;
+    unsigned int *indices;
+    SpherixPointCloudRange range;
+    CoreVector<SpherixPointCloud::Node> nodes; // nodes of the subtree, the root being the first one
+    unsigned int depth; // depth of the subtree
+};
+
+bool SpherixPointCloud::is_point_array(const R2cGeometryResource& resource)
+{
+    const GeometryObject *geometry = resource.get_geometry();
+    return geometry != nullptr && geometry->is_kindof(GeometryPointCloud::class_info());
+}
+
+bool SpherixPointCloud::build(OfApp& application, const R2cGeometryResource& resource, const GMathBbox3d& bbox)
+{
+    m_points.remove_all();
+    m_nodes.remove_all();
+    m_depth = 0;
+    if (!is_point_array(resource)) {
+        return false;
+    }
+
+    CoreArray<GMathVec3f> positions;
+    static_cast<const GeometryPointCloud *>(resource.get_geometry())->get_positions(positions);
+    const unsigned int point_count = positions.get_count();
+    if (point_count == 0) {
+        return false;
+    }
+
+    // Particles get a uniform radius deduced from the particle density since point arrays don't expose any radius.
+    // Particles of very dense or very sparse regions thus overlap or leave gaps
+    const float radius = static_cast<float>((bbox.get_max() - bbox.get_min()).get_length() / (4.0 * gmath_max(1.0, cbrt(static_cast<double>(point_count)))));
+
+    CoreVector<float> points(point_count * 4);
+    CoreVector<unsigned int> indices(point_count);
+    for (unsigned int i = 0; i < point_count; i++) {
+        points[i * 4 + 0] = positions[i][0];
+        points[i * 4 + 1] = positions[i][1];
+        points[i * 4 + 2] = positions[i][2];
+        points[i * 4 + 3] = radius;
+        indices[i] = i;
+    }
+
+    // build the top of the hierarchy serially and the remaining subtrees in parallel
+    CoreVector<SpherixPointCloudRange> pending;
+    m_nodes.add(Node());
+    if (point_count < s_point_cloud_parallel_min_count) {
+        build_point_cloud_node(&points[0], &indices[0], m_nodes, 0, 0, point_count, 0, 0, nullptr, m_depth);
+    } else {
+        build_point_cloud_node(&points[0], &indices[0], m_nodes, 0, 0, point_count, 0, s_point_cloud_parallel_depth, &pending, m_depth);
+
+        SysThreadTaskManager task_manager(&application.get_thread_manager());
+        CoreVector<SpherixPointCloudBuildTask> tasks(pending.get_count());
+        for (unsigned int i = 0; i < pending.get_count(); i++) {
+            tasks[i].points = &points[0];
+            tasks[i].indices = &indices[0];
+            tasks[i].range = pending[i];
+            task_manager.add_task(tasks[i], false);
+        }
+        task_manager.wait_until_completed();
+
+        // append the subtrees to the hierarchy, their root replacing the pending node
+        for (unsigned int i = 0; i < pending.get_count(); i++) {
+            // subtrees are rooted at the depth the parallel build starts from
+            m_depth = gmath_max(m_depth, s_point_cloud_parallel_depth + tasks[i].depth);
+            const CoreVector<Node>& nodes = tasks[i].nodes;
+            const unsigned int base = m_nodes.get_count() - 1; // local index 0 is the pending node
+            for (unsigned int j = 0; j < nodes.get_count(); j++) {
+                Node node = nodes[j];
+                if (node.count == 0) node.first += base;
+                if (j == 0) {
+                    m_nodes[pending[i].node] = node;
+                } else {
+                    m_nodes.add(node);
+                }
+            }
+        }
+    }
+
+    // the traversal stack holds at most the pending sibling of each level plus the two children of the visited node
+    CORE_ASSERT(m_depth <= s_point_cloud_max_depth);
+
+    // store the particles in the order of the leaves of the hierarchy
+    m_points.resize(point_count * 4);
+    for (unsigned int i = 0; i < point_count; i++) {
+        for (unsigned int k = 0; k < 4; k++) {
+            m_points[i * 4 + k] = points[indices[i] * 4 + k];
+        }
+    }
+    return true;
+}
+
+bool SpherixPointCloud::intersect(const GMathRay& local_ray, double& t, GMathVec3d& normal) const
+{
+    if (m_nodes.get_count() == 0) return false;
+
+    const GMathVec3d& origin = local_ray.get_origin();
+    const GMathVec3d& direction = local_ray.get_direction();
+    const double a = direction.dot(direction);
+    const double inv_direction[3] = { 1.0 / direction[0], 1.0 / direction[1], 1.0 / direction[2] };
+
+    double closest_t = gmath_infinity;
+    unsigned int closest_point = 0;
+    bool found = false;
+
+    unsigned int stack[s_point_cloud_max_depth + 1];
+    unsigned int stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size != 0) {
+        const Node& node = m_nodes[stack[--stack_size]];
+
+        // slab test against the bounds of the node
+        double tmin = 0.0;
+        double tmax = closest_t;
+        for (unsigned int k = 0; k < 3; k++) {
+            double t0 = (node.min[k] - origin[k]) * inv_direction[k];
+            double t1 = (node.max[k] - origin[k]) * inv_direction[k];
+            if (t0 > t1) std::swap(t0, t1);
+            tmin = gmath_max(tmin, t0);
+            tmax = gmath_min(tmax, t1);
+        }
+        if (tmin > tmax) continue;
+
+        if (node.count != 0) {
+            for (unsigned int i = node.first; i < node.first + node.count; i++) {
+                const float *point = &m_points[i * 4];
+                const GMathVec3d oc(origin[0] - point[0], origin[1] - point[1], origin[2] - point[2]);
+                const double b = direction.dot(oc);
+                const double c = oc.dot(oc) - static_cast<double>(point[3]) * point[3];
+                const double discrim = b * b - a * c;
+                if (discrim >= 0.0) {
+                    const double hit_t = (-b - sqrt(discrim)) / a;
+                    if (hit_t > 0.0 && hit_t < closest_t) {
+                        closest_t = hit_t;
+                        closest_point = i;
+                        found = true;
+                    }
+                }
+            }
+        } else {
+            stack[stack_size++] = node.first;
+            stack[stack_size++] = node.first + 1;
+        }
+    }
+
+    if (found) {
+        const float *point = &m_points[closest_point * 4];
+        t = closest_t;
+        normal = local_ray.compute_position(t) - GMathVec3d(point[0], point[1], point[2]);
+        normal.normalize();
+    }
+    return found;
+}
@@ -5,10 +5,13 @@
 
 // Clarisse includes
 #include <core_hash_table.h>
+#include <core_vector.h>
 #include <gmath_matrix4x4.h>
 #include <gmath_vec3.h>
 #include <gmath_bbox3.h>
 
+#include <memory>
+
 // R2C includes
 #include <r2c_scene_delegate.h>
 
@@ -17,6 +20,8 @@
 #include "./spherix_module_light.h"
 
 // Forward declaration
+class GeometryObject;
+class OfApp;
 class RayGeneratorCamera;
 class ExternalShader;
 class ExternalLightShader;
@@ -42,6 +47,7 @@ public:
     void compute_normal(const GMathVec3d& pos, GMathVec3d& normal) const;
     bool intersect(const GMathRay& local_ray, double& t, GMathVec3d& normal) const;
     GMathVec3d get_center() const;
+    inline const double& get_radius() const { return m_radius; }
 
 private:
     double m_radius;
@@ -50,6 +56,43 @@ private:
 };
 
 
+/*! \class SpherixPointCloud
+    \brief Particles of a point array stored as a compact array of spheres in object space.
+           They are traced through a bounding volume hierarchy which is built in parallel
+           so that point arrays of several millions of particles can be rendered. */
+class SpherixPointCloud {
+public:
+    SpherixPointCloud() : m_depth(0) {}
+
+    /*! \brief Return true if the specified resource is a point array whose particles must be built */
+    static bool is_point_array(const R2cGeometryResource& resource);
+    /*! \brief Read the positions of the particles of the specified resource and build their hierarchy
+     *  \param application application used to access the thread manager
+     *  \param resource point array resource
+     *  \param bbox bounding box of the geometry used to deduce the radius of the particles
+     *  \return false if the geometry doesn't define any particle
+     *  \note All the particles share the same radius deduced from their density */
+    bool build(OfApp& application, const R2cGeometryResource& resource, const GMathBbox3d& bbox);
+    /*! \brief Intersect the particles with a ray defined in object space */
+    bool intersect(const GMathRay& local_ray, double& t, GMathVec3d& normal) const;
+    /*! \brief Return the number of particles */
+    inline unsigned int get_point_count() const { return m_points.get_count() / 4; }
+
+    // Node of the hierarchy. Children of inner nodes are stored next to each other
+    struct Node {
+        float min[3];
+        float max[3];
+        unsigned int first; //!< index of the first child for inner nodes or of the first particle for leaves
+        unsigned int count; //!< number of particles of a leaf, 0 for inner nodes
+    };
+
+private:
+    CoreVector<float> m_points; // x, y, z and radius of each particle
+    CoreVector<Node> m_nodes;
+    unsigned int m_depth; // depth of the deepest leaf of the hierarchy
+};
+
+
 /*********************************** CAMERA ***********************************/
 
 class SpherixCamera {
@@ -78,15 +121,14 @@ public:
     int dirtiness; // dirtiness state of the item
 };
 
-typedef CoreHashTable<R2cItemId, SpherixLightInfo> SpherixLightIndex;
-
 
 /*********************************** MATERIAL ***********************************/
 
 struct MaterialData {
-    MaterialData(): material(nullptr) {}
-    MaterialData(ModuleMaterialSpherix* module): material((module == nullptr) ? nullptr : module->get_material()) {}
+    MaterialData(): material(nullptr), index(0) {}
+    MaterialData(ModuleMaterialSpherix* module): material((module == nullptr) ? nullptr : module->get_material()), index(0) {}
     ExternalMaterialShader *material;
+    unsigned int index; //!< index of the material in SpherixSphereTable::get_materials(), set when a sphere is added to the table
 };
 
 /*! \class SpherixResourceInfo
@@ -95,6 +137,7 @@ class SpherixResourceInfo {
 public:
     unsigned int refcount; //!< internal refcount used to keep track of the number of requesters
     SpherixSphere sphere;
+    std::shared_ptr<SpherixPointCloud> points; //!< particles of the resource when it is a point array, shared by the copies of the info
     SpherixResourceInfo() : refcount(0) {}
 };
 
@@ -112,11 +155,10 @@ public:
     R2cResourceId resource; //!< id to the actual Clarisse geometry resource
     MaterialData material;
     int dirtiness; //!< dirtiness state of the item
-    SpherixGeometryInfo() : resource(nullptr), dirtiness(R2cSceneDelegate::DIRTINESS_ALL) {}
+    unsigned int sphere; //!< handle of the baked sphere of the item in SpherixSphereTable
+    SpherixGeometryInfo() : resource(nullptr), dirtiness(R2cSceneDelegate::DIRTINESS_ALL), sphere(0xFFFFFFFF) {}
 };
 
-typedef CoreHashTable<R2cItemId, SpherixGeometryInfo> SpherixGeometryIndex;
-
 /*! \class SpherixInstancerInfo
     \brief internal class holding instancer data which is basically a list of Spherix point clouds instancing a geometry */
 class SpherixInstancerInfo {
@@ -126,10 +168,125 @@ public:
     R2cResourceId resource; //!< id to the actual Clarisse geometry resource
     MaterialData material;
     int dirtiness; //!< dirtiness state of the item
-    SpherixInstancerInfo() : resource(nullptr), dirtiness(R2cSceneDelegate::DIRTINESS_ALL) {}
+    unsigned int sphere; //!< handle of the baked sphere of the item in SpherixSphereTable
+    SpherixInstancerInfo() : resource(nullptr), dirtiness(R2cSceneDelegate::DIRTINESS_ALL), sphere(0xFFFFFFFF) {}
 };
 
-typedef CoreHashTable<R2cItemId, SpherixInstancerInfo> SpherixInstancerIndex;
+// map a render item to its slot in the contiguous storage of the render delegate
+typedef CoreHashTable<R2cItemId, unsigned int> SpherixItemSlotIndex;
+
+
+/*********************************** SPHERE TABLE ***********************************/
+
+/*! \class SpherixSphereTable
+    \brief World space spheres baked at sync time in structure of arrays so that they
+           can be intersected several at a time using SIMD (8-wide with AVX2 when the CPU supports it, 4-wide with SSE2).
+           Spheres whose transform is not a rotation with a uniform scale can't be expressed
+           in world space and are kept with their inverse transform to be intersected in object space.
+           Each item owns a handle to its entry so that it is updated or removed in place when the item changes,
+           the arrays staying contiguous and the handles of removed items being reused. */
+class SpherixSphereTable {
+public:
+    SpherixSphereTable() : m_count(0) {}
+
+    /*! \brief Remove all the spheres of the table */
+    void clear();
+    /*! \brief Set the sphere of an item transformed by the specified matrix
+     *  \param handle handle of the entry of the item, s_invalid_handle to add a new entry in which case it is set to the new handle
+     *  \param transform object to world transformation of the sphere
+     *  \param sphere sphere defined in object space
+     *  \param material material assigned to the sphere */
+    void set(unsigned int& handle, const GMathMatrix4x4d& transform, const SpherixSphere& sphere, const MaterialData& material);
+    /*! \brief Set the particles of an item transformed by the specified matrix
+     *  \param handle handle of the entry of the item, s_invalid_handle to add a new entry in which case it is set to the new handle
+     *  \param transform object to world transformation of the particles
+     *  \param points particles defined in object space
+     *  \param material material assigned to the particles */
+    void set(unsigned int& handle, const GMathMatrix4x4d& transform, const SpherixPointCloud& points, const MaterialData& material);
+    /*! \brief Remove the entry of an item from the table and reset its handle to s_invalid_handle */
+    void remove(unsigned int& handle);
+    /*! \brief Pad the arrays so they can be read by blocks. Must be called once the entries have been modified. */
+    void finalize();
+
+    /*! \brief Intersect the table with a world space ray and update the closest hit if a closer sphere is found
+     *  \return true if a sphere closer than closest_hit_t has been hit */
+    bool intersect(const GMathRay& ray, double& closest_hit_t, GMathVec3d& closest_hit_normal, MaterialData& closest_hit_material) const;
+
+    /*! \brief Return the materials assigned to the spheres of the table, indexed by MaterialData::index.
+     *         Slots of materials no longer assigned are null until they are reused. */
+    inline const CoreVector<ExternalMaterialShader *>& get_materials() const { return m_material_shaders; }
+
+    /*! \brief Return the number of spheres stored in the table */
+    inline unsigned int get_count() const { return m_count + m_transformed.get_count() + m_point_clouds.get_count(); }
+
+    // number of spheres processed per block which is the widest supported SIMD width
+    static const unsigned int s_block_size = 8;
+    // handle of an item which has no entry in the table
+    static const unsigned int s_invalid_handle = 0xFFFFFFFF;
+
+private:
+    // kind of storage of an entry
+    enum EntryKind {
+        ENTRY_WORLD, // world space sphere stored in the arrays
+        ENTRY_TRANSFORMED, // sphere with a non uniform transform
+        ENTRY_POINT_CLOUD // particles
+    };
+    // location of the entry of a handle in the storage of its kind
+    struct Entry {
+        EntryKind kind;
+        unsigned int index;
+    };
+
+    // return a free handle, reusing the handle of a removed entry if any
+    unsigned int allocate_handle();
+    // remove the storage of the entry of the handle, moving the last one of its kind in its slot
+    void remove_entry(const unsigned int& handle);
+    // remove the padding of the world space arrays before they are modified
+    void remove_padding();
+
+    // return the material with its index in the table, adding the material to the table if needed
+    MaterialData register_material(const MaterialData& material);
+    // release a reference to a material returned by register_material
+    void unregister_material(const MaterialData& material);
+
+    // entries indexed by handle and handles of the removed entries
+    CoreVector<Entry> m_entries;
+    CoreVector<unsigned int> m_free_handles;
+
+    // distinct materials of the spheres, their index and their number of spheres
+    CoreVector<ExternalMaterialShader *> m_material_shaders;
+    CoreVector<unsigned int> m_material_refcounts;
+    CoreVector<unsigned int> m_free_materials;
+    CoreHashTable<ExternalMaterialShader *, unsigned int> m_material_indices;
+
+    // world space spheres
+    CoreVector<float> m_center_x;
+    CoreVector<float> m_center_y;
+    CoreVector<float> m_center_z;
+    CoreVector<float> m_radius;
+    CoreVector<float> m_square_radius;
+    CoreVector<MaterialData> m_materials;
+    CoreVector<unsigned int> m_handles; // handle of each world space sphere
+    unsigned int m_count;
+
+    // spheres with a non uniform transform which are intersected in object space
+    struct TransformedSphere {
+        GMathMatrix4x4d inverse_transform;
+        SpherixSphere sphere;
+        MaterialData material;
+        unsigned int handle;
+    };
+    CoreVector<TransformedSphere> m_transformed;
+
+    // particles which are intersected in object space using their own hierarchy
+    struct TransformedPointCloud {
+        GMathMatrix4x4d inverse_transform;
+        const SpherixPointCloud *points;
+        MaterialData material;
+        unsigned int handle;
+    };
+    CoreVector<TransformedPointCloud> m_point_clouds;
+};
 
 
 /*********************************** HELPERS ***********************************/
@@ -0,0 +1,222 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+// Checks that every external shader can be evaluated concurrently by several render threads
+// by comparing the result of a render of many hits shared by all the threads to a serial one, and checks
+// the shading of the hits of a bucket grouped by material by ExternalHitBuffer and the lookup of parameters.
+
+#include <thread>
+
+#include <spherix_external_shader.h>
+
+#include <r2c_test_utils.h>
+
+// number of hits shaded by each render
+static const unsigned int s_hit_count = 4096;
+// number of threads shading the hits concurrently
+static const unsigned int s_thread_count = 8;
+// number of renders done by each thread
+static const unsigned int s_render_count = 16;
+
+/*! \brief Hits shaded by the renders stored as structure of arrays */
+struct Hits {
+    CoreVector<double> ray_direction[3];
+    CoreVector<double> normal[3];
+};
+
+/*! \brief Shaders of the scene, some of the materials being textured */
+struct Shaders {
+    Shaders()
+    {
+        static_cast<ParameterBool *>(diffuse_bool.parameters[1])->value[0] = 1.0;
+        diffuse_textured.parameters[0]->texture = &texture;
+        reflection_textured.parameters[0]->texture = &texture;
+
+        double *texture_color = static_cast<ParameterColor *>(texture.parameters[0])->value;
+        texture_color[0] = 0.25; texture_color[1] = 0.5; texture_color[2] = 0.75;
+        light.parameters[1]->value[0] = 2.0;
+
+        materials.add(&diffuse);
+        materials.add(&diffuse_bool);
+        materials.add(&diffuse_textured);
+        materials.add(&reflection);
+        materials.add(&reflection_textured);
+    }
+
+    SpherixMaterialDiffuse diffuse;
+    SpherixMaterialDiffuse diffuse_bool;
+    SpherixMaterialDiffuse diffuse_textured;
+    SpherixMaterialReflection reflection;
+    SpherixMaterialReflection reflection_textured;
+    SpherixLightDistant light;
+    SpherixTextureColor texture;
+
+    CoreVector<ExternalMaterialShader *> materials;
+};
+
+// fill the hits with normalized pseudo random directions
+static void
+make_hits(Hits& hits)
+{
+    unsigned int seed = 1;
+    for (unsigned int i = 0; i < s_hit_count; i++) {
+        CoreVector<double> *vectors[2] = { hits.ray_direction, hits.normal };
+        for (CoreVector<double> *vector : vectors) {
+            double v[3];
+            for (unsigned int k = 0; k < 3; k++) {
+                seed = seed * 1664525u + 1013904223u;
+                v[k] = (seed >> 8) / static_cast<double>(1 << 24) * 2.0 - 1.0;
+            }
+            const double length = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]) + 1e-6;
+            for (unsigned int k = 0; k < 3; k++) vector[k].add(v[k] / length);
+        }
+    }
+}
+
+// shade all the hits with every shader, one hit at a time and by batches, and store the results in colors
+static void
+render(const Shaders& shaders, const Hits& hits, CoreVector<float>& colors)
+{
+    colors.remove_all();
+    for (unsigned int i = 0; i < s_hit_count; i++) {
+        const double ray_direction[3] = { hits.ray_direction[0][i], hits.ray_direction[1][i], hits.ray_direction[2][i] };
+        const double normal[3] = { hits.normal[0][i], hits.normal[1][i], hits.normal[2][i] };
+
+        for (const ExternalMaterialShader *material : shaders.materials) {
+            const GMathVec3f color = material->evaluate(ray_direction, normal);
+            for (unsigned int k = 0; k < 3; k++) colors.add(color[k]);
+        }
+        const GMathVec3d texture_color = shaders.texture.evaluate(ExternalShadingContext(ray_direction, normal));
+        const GMathVec3f light_color = shaders.light.evaluate();
+        for (unsigned int k = 0; k < 3; k++) colors.add(static_cast<float>(texture_color[k]));
+        for (unsigned int k = 0; k < 3; k++) colors.add(light_color[k]);
+    }
+
+    CoreVector<float> batch_colors(s_hit_count * 3);
+    for (const ExternalMaterialShader *material : shaders.materials) {
+        ExternalShadingBatch batch;
+        batch.count = s_hit_count;
+        for (unsigned int k = 0; k < 3; k++) {
+            batch.ray_direction[k] = hits.ray_direction[k].get_data();
+            batch.normal[k] = hits.normal[k].get_data();
+            batch.color[k] = &batch_colors[k * s_hit_count];
+        }
+        material->evaluate_batch(batch);
+        for (unsigned int i = 0; i < batch_colors.get_count(); i++) colors.add(batch_colors[i]);
+    }
+}
+
+// shade hits spread over all the materials with ExternalHitBuffer and compare them to the evaluation of each hit
+static void
+test_hit_buffer(const Shaders& shaders, const Hits& hits)
+{
+    const unsigned int material_count = shaders.materials.get_count();
+    const GMathVec3f light_contribution(0.5f, 1.0f, 2.0f);
+    CoreVector<float> buffer(s_hit_count * 4);
+    ExternalHitBuffer hit_buffer;
+    // the buffer is reused like it is by the buckets of a render thread
+    for (unsigned int pass = 0; pass < 2; pass++) {
+        hit_buffer.clear();
+        for (unsigned int i = 0; i < buffer.get_count(); i++) buffer[i] = -1.0f;
+        // every other pixel is hit so that the pixels don't match the order of the hits
+        for (unsigned int i = pass; i < s_hit_count; i += 2) {
+            const double ray_direction[3] = { hits.ray_direction[0][i], hits.ray_direction[1][i], hits.ray_direction[2][i] };
+            const double normal[3] = { hits.normal[0][i], hits.normal[1][i], hits.normal[2][i] };
+            hit_buffer.add(s_hit_count - 1 - i, (i * 7) % material_count, ray_direction, normal);
+        }
+        CHECK(hit_buffer.get_count() == s_hit_count / 2);
+        hit_buffer.shade(shaders.materials.get_data(), material_count, light_contribution, buffer.get_data());
+
+        unsigned int mismatch_count = 0;
+        for (unsigned int i = 0; i < s_hit_count; i++) {
+            const float *pixel = &buffer[(s_hit_count - 1 - i) * 4];
+            if (i % 2 != pass) {
+                if (pixel[3] != -1.0f) mismatch_count++;
+                continue;
+            }
+            const double ray_direction[3] = { hits.ray_direction[0][i], hits.ray_direction[1][i], hits.ray_direction[2][i] };
+            const double normal[3] = { hits.normal[0][i], hits.normal[1][i], hits.normal[2][i] };
+            const GMathVec3f color = shaders.materials[(i * 7) % material_count]->evaluate(ray_direction, normal);
+            for (unsigned int k = 0; k < 3; k++) {
+                if (fabs(pixel[k] - color[k] * light_contribution[k]) > 1e-5f) mismatch_count++;
+            }
+            if (pixel[3] != 1.0f) mismatch_count++;
+        }
+        CHECK(mismatch_count == 0);
+    }
+}
+
+// resolve the parameters of shaders from their attribute name
+static void
+test_parameters()
+{
+    SpherixMaterialDiffuse diffuse;
+    SpherixLightDistant light;
+    // shaders whose class isn't registered don't have parameters
+    CHECK(light.get_parameter(CoreString("intensity")) == nullptr);
+
+    // registering classes grows the array of the parameter indices
+    ExternalShader::register_parameters(diffuse);
+    CHECK(diffuse.get_parameter(CoreString("color")) == diffuse.parameters[0]);
+    ExternalShader::register_parameters(light);
+    ExternalShader::register_parameters(light);
+    CHECK(diffuse.get_parameter(CoreString("spherix_boolean")) == diffuse.parameters[1]);
+    CHECK(diffuse.get_parameter(CoreString("intensity")) == nullptr);
+    CHECK(light.get_parameter(CoreString("intensity")) == light.parameters[1]);
+
+    // a shader created after the registration shares the index of its class but not its values
+    SpherixMaterialDiffuse other;
+    Parameter *color = other.get_parameter(CoreString("color"));
+    CHECK(color == other.parameters[0] && color->value == &other.parameter_values[0]);
+}
+
+int
+main(int argc, char **argv)
+{
+    const Shaders shaders;
+    Hits hits;
+    make_hits(hits);
+
+    CoreVector<float> reference;
+    render(shaders, hits, reference);
+    CHECK(reference.get_count() == s_hit_count * (shaders.materials.get_count() + 2) * 3 + shaders.materials.get_count() * s_hit_count * 3);
+
+    // the renders must not depend on the order in which threads evaluate the shaders
+    CoreVector<unsigned int> mismatches(s_thread_count);
+    CoreVector<std::thread *> threads;
+    for (unsigned int t = 0; t < s_thread_count; t++) {
+        mismatches[t] = 0;
+        threads.add(new std::thread([&shaders, &hits, &reference, &mismatches, t]() {
+            CoreVector<float> colors;
+            for (unsigned int r = 0; r < s_render_count; r++) {
+                render(shaders, hits, colors);
+                if (colors.get_count() != reference.get_count()) {
+                    mismatches[t]++;
+                    continue;
+                }
+                for (unsigned int i = 0; i < colors.get_count(); i++) {
+                    if (colors[i] != reference[i]) mismatches[t]++;
+                }
+            }
+        }));
+    }
+    for (std::thread *thread : threads) {
+        thread->join();
+        delete thread;
+    }
+    for (unsigned int t = 0; t < s_thread_count; t++) CHECK(mismatches[t] == 0);
+
+    test_hit_buffer(shaders, hits);
+    test_parameters();
+
+    // the textured materials must use the color of the texture
+    const double ray_direction[3] = { 0.0, 0.0, -1.0 };
+    const double normal[3] = { 0.0, 0.0, 1.0 };
+    const GMathVec3f textured = shaders.reflection_textured.evaluate(ray_direction, normal);
+    CHECK(textured[0] == 0.25f && textured[1] == 0.5f && textured[2] == 0.75f);
+    const GMathVec3f light = shaders.light.evaluate();
+    CHECK(light[0] == 2.0f && light[1] == 2.0f && light[2] == 2.0f);
+
+    return test_result();
+}
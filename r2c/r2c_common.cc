@@ -2,6 +2,7 @@
 // Copyright 2020 - present Isotropix SAS. See License.txt for license information
 //
 
+#include <core_array.h>
 #include <geometry_object.h>
 
 #include "r2c_common.h"
@@ -12,6 +13,32 @@ R2cGeometryResource::get_geometry() const
     return static_cast<const GeometryObject *>(m_id);
 }
 
+R2cTopologyFingerprint
+R2cGeometryResource::get_topology_fingerprint() const
+{
+    R2cTopologyFingerprint fingerprint;
+    const GeometryObject *geometry = get_geometry();
+    if (geometry != nullptr) {
+        CoreArray<unsigned int> indices;
+        geometry->get_primitive_indices(indices);
+        fingerprint.primitive_count = geometry->get_primitive_count();
+        fingerprint.index_count = indices.get_count();
+
+        // FNV-1a hash of the topology
+        unsigned long long hash = 14695981039346656037ULL;
+        for (unsigned int i = 0; i < fingerprint.primitive_count; i++) {
+            hash = (hash ^ geometry->get_primitive_edge_count(i)) * 1099511628211ULL;
+            hash = (hash ^ geometry->get_primitive_shading_group_index(i)) * 1099511628211ULL;
+        }
+        const unsigned int *data = indices.get_data();
+        for (unsigned int i = 0; i < fingerprint.index_count; i++) {
+            hash = (hash ^ data[i]) * 1099511628211ULL;
+        }
+        fingerprint.hash = hash;
+    }
+    return fingerprint;
+}
+
 OfObject *
 R2cItemDescriptor::get_item() const
 {
@@ -6,6 +6,7 @@
 #define R2C_COMMON_H
 
 #include <r2c_export.h>
+#include <core_array.h>
 #include <core_string.h>
 
 class OfApp;
@@ -22,6 +23,23 @@ class R2cSceneDelegate;
 typedef void *R2cItemId; /**< Define an id to a Clarisse item */
 typedef ResourceData *R2cResourceId; /**< Define an id to a Clarisse Resource */
 
+/*! \class R2cTopologyFingerprint
+    \brief Fingerprint of the topology of a geometry used to detect modifications which only move its points. */
+class R2cTopologyFingerprint {
+public:
+
+    R2cTopologyFingerprint() : primitive_count(0), index_count(0), hash(0) {}
+
+    inline bool operator==(const R2cTopologyFingerprint& other) const {
+        return primitive_count == other.primitive_count && index_count == other.index_count && hash == other.hash;
+    }
+    inline bool operator!=(const R2cTopologyFingerprint& other) const { return !(*this == other); }
+
+    unsigned int primitive_count; //!< number of primitives (faces) of the geometry
+    unsigned int index_count; //!< number of primitive vertices of the geometry
+    unsigned long long hash; //!< hash of the vertex count, shading group and point indices of each primitive
+};
+
 /*! \class R2cGeometryResource
     \brief This class implements a geometry resource which wraps a GeometryObject. */
 class R2C_EXPORT R2cGeometryResource {
@@ -36,6 +54,9 @@ public:
     /*! \brief Return the geometry associated with the resource
      *  \note May return nullptr if the resource is null */
     const GeometryObject *get_geometry() const;
+    /*! \brief Return the fingerprint of the topology of the geometry
+     *  \note The fingerprint is computed from the whole index buffer of the geometry so it should be kept rather than queried repeatedly */
+    R2cTopologyFingerprint get_topology_fingerprint() const;
 
 private:
 
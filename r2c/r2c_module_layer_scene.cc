@@ -108,4 +108,10 @@ ModuleLayerR2cScene::on_attribute_change(const OfAttr& attr, int& dirtiness, con
         // dirty current image buffer to re-evaluate the render
         dirty_layer(true);
     }
-}
\ No newline at end of file
+}
+
+void
+ModuleLayerR2cScene::refresh()
+{
+    dirty_layer(true);
+}
@@ -43,6 +43,8 @@ public:
 
     /*! \brief Returns the Scene Delegate attached to this layer. */
     R2cSceneDelegate *get_scene_delegate() { return m_scene_delegate; }
+    /*! \brief Dirty the image of the layer so that it is evaluated again. */
+    void refresh();
 
 private:
 
@@ -10,6 +10,7 @@
 #include <r2c_common.h>
 
 class ImageCanvas;
+class OfAttr;
 class OfObject;
 class ModuleLayer;
 class ModuleMaterial;
@@ -76,6 +77,13 @@ public:
      *  \note  For more information refer R2cSceneDelegate::Dirtiness */
     virtual void dirty_instancer(R2cItemDescriptor item, const int& dirtiness) = 0;
 
+    /*! \brief Called by the Scene Delegate when the render settings are modified
+     *  \param item item descriptor of the render settings
+     *  \param attr the modified attribute of the render settings or nullptr when the render settings item itself
+     *         has been replaced in which case all settings must be synchronized again
+     *  \note  Render delegates which synchronize all their settings on each render can simply ignore it */
+    virtual void dirty_render_settings(R2cItemDescriptor item, const OfAttr *attr) {}
+
     /*! \brief Called when a requested a render
      *  \param render_buffer Clarisse render buffer
      *  \param sampling_quality a percentage that defines a global multiplier to all sampling values (lights, material, AA etc...)
@@ -83,6 +91,21 @@ public:
     virtual void render(R2cRenderBuffer *render_buffer, const float& sampling_quality) = 0;
     /*! \brief Return the current rendering progress, between 0 and 1. */
     virtual float get_render_progress() const = 0;
+    /*! \brief Return true if the image must be rendered again once render() returns, for example when
+     *         data still processed in the background will refine the image. The layer is then dirtied. */
+    virtual bool is_refresh_needed() const { return false; }
+    /*! \brief Called as soon as the scene is modified, including by modifications which are only dispatched by the next sync
+     *         of the scene delegate, so that a render in progress can be interrupted right away */
+    virtual void interrupt_render() {}
+    /*! \brief Called as soon as a geometry is modified when its dirtiness is only dispatched by the next sync of the scene delegate.
+     *         The resource of the geometry may be evaluated again or released before that sync, so the render delegate must stop
+     *         reading it right away. Interrupts the render in progress by default. */
+    virtual void interrupt_geometry(R2cItemDescriptor item) { interrupt_render(); }
+    /*! \brief Return true if the render delegate updates geometries in place when they receive DIRTINESS_DEFORMATION.
+     *  \note  The topology of a modified geometry is then compared to the one taken at its previous modification by the next
+     *         sync, which reads the whole index buffer of its resource once per sync. The first modification of a geometry
+     *         has nothing to compare to and receives DIRTINESS_GEOMETRY, as do all of them otherwise. */
+    virtual bool is_deformation_supported() const { return false; }
 
     /*! \brief Return the names of the clarisse camera classes supported by the render delegate
 	 *  \param supported_cameras The list of camera classes supported by the renderer
@@ -143,9 +143,16 @@ R2cSceneDelegate::set_input(OfObject **m_input, OfObject *new_input, const CoreS
 				} else if (*m_input == m_shading_layer) {
                     dirty_shading();
                     connect(*new_input, EVT_ID_OF_OBJECT_ATTR_CHANGE, EVENT_INFO_METHOD(R2cSceneDelegate::dispatch_shading_layer_dirtiness));
+                } else if (*m_input == m_render_settings) {
+                    connect(*new_input, EVT_ID_OF_OBJECT_ATTR_CHANGE, EVENT_INFO_METHOD(R2cSceneDelegate::dispatch_render_settings_dirtiness));
                 }
             }
         }
+
+        if (m_input == &m_render_settings && m_render_delegate != nullptr) {
+            // the render settings have been replaced so they must be synchronized again
+            m_render_delegate->dirty_render_settings(get_render_settings(), nullptr);
+        }
     }
 }
 
@@ -228,6 +235,18 @@ R2cSceneDelegate::dispatch_scene_object_dirtiness(EventObject& sender, const Eve
     if (dirtiness & OfAttr::DIRTINESS_GEOMETRY) transmitted_dirtiness |=  DIRTINESS_GEOMETRY;
 
     if (descriptor.is_geometry()) { // most cases
+        if ((transmitted_dirtiness & DIRTINESS_GEOMETRY) && m_render_delegate->is_deformation_supported()) {
+            // a geometry receives many events when it's modified so its topology is only compared once by the next sync
+            int *modified_dirtiness = m_modified_geometries.is_key_exists(item);
+            if (modified_dirtiness == nullptr) {
+                m_modified_geometries.add(item, transmitted_dirtiness);
+            } else {
+                *modified_dirtiness |= transmitted_dirtiness;
+            }
+            // the render in progress and the readers of the resource don't wait for the next sync to be interrupted
+            m_render_delegate->interrupt_geometry(descriptor);
+            return;
+        }
         m_render_delegate->dirty_geometry(descriptor, transmitted_dirtiness);
     } else { // it's an instancer we have potentially quite some work to do
         if (transmitted_dirtiness & DIRTINESS_GEOMETRY) {
@@ -290,6 +309,17 @@ R2cSceneDelegate::dispatch_shading_layer_dirtiness(EventObject& sender, const Ev
     }
 }
 
+/*! \brief Forward the attribute changes of the render settings to the render delegate */
+void
+R2cSceneDelegate::dispatch_render_settings_dirtiness(EventObject& sender, const EventInfo& evtid, void *data)
+{
+    OfObject *item = static_cast<OfObject *>(&sender);
+    const OfAttr *changing_attr = item->get_changing_attr();
+    if (m_render_delegate != nullptr && changing_attr != nullptr) {
+        m_render_delegate->dirty_render_settings(get_item_descriptor(item), changing_attr);
+    }
+}
+
 /*! \brief converting Clarisse dirtiness to light dirtiness for the render delegate */
 void
 R2cSceneDelegate::dispatch_light_dirtiness(EventObject& sender, const EventInfo& evtid, void *data)
@@ -429,6 +459,8 @@ R2cSceneDelegate::remove_geometry(R2cItemId id)
             // make a copy before removal
             R2cItemDescriptor cpy(*item);
             m_render_item_dependencies.remove(id);
+            if (m_topology_fingerprints.is_key_exists(id) != nullptr) m_topology_fingerprints.remove(id);
+            if (m_modified_geometries.is_key_exists(id) != nullptr) m_modified_geometries.remove(id);
 
             if (cpy.is_geometry()) {
                 m_render_delegate->remove_geometry(cpy);
@@ -566,6 +598,35 @@ R2cSceneDelegate::sync()
         }
     }
 
+    // if the topology of a modified geometry is unchanged only its points moved so the render delegate can update it
+    // in place, even if the geometry now uses another resource. The topology of a geometry is only taken once it's modified
+    // so that inserting geometries doesn't evaluate their resources: its first modification always rebuilds it
+    CoreHashTable<R2cResourceId, R2cTopologyFingerprint> resource_fingerprints; // geometries sharing a resource only read it once
+    for (auto modified : m_modified_geometries) {
+        int dirtiness = modified.get_value();
+        R2cGeometryResource resource = get_geometry_resource(modified.get_key());
+        if (resource.get_id() != nullptr) {
+            R2cTopologyFingerprint *fingerprint = resource_fingerprints.is_key_exists(resource.get_id());
+            if (fingerprint == nullptr) {
+                resource_fingerprints.add(resource.get_id(), resource.get_topology_fingerprint());
+                fingerprint = resource_fingerprints.is_key_exists(resource.get_id());
+            }
+            R2cTopologyFingerprint *previous = m_topology_fingerprints.is_key_exists(modified.get_key());
+            if (previous == nullptr) {
+                m_topology_fingerprints.add(modified.get_key(), *fingerprint);
+            } else {
+                if (*previous == *fingerprint && fingerprint->primitive_count != 0) {
+                    dirtiness = (dirtiness & ~DIRTINESS_GEOMETRY) | DIRTINESS_DEFORMATION;
+                }
+                *previous = *fingerprint;
+            }
+        } else if (m_topology_fingerprints.is_key_exists(modified.get_key()) != nullptr) {
+            m_topology_fingerprints.remove(modified.get_key());
+        }
+        m_render_delegate->dirty_geometry(get_item_descriptor(static_cast<OfObject *>(modified.get_key())), dirtiness);
+    }
+    m_modified_geometries.remove_all();
+
     // check if our light index is dirty, otherwise there's nothing to do
     if (m_light_index_dirty) {
         sync_index(m_lights, m_light_index, m_supported_classes.lights, m_unsupported_classes.lights, inserted, removed);
@@ -672,6 +733,8 @@ R2cSceneDelegate::get_dirtiness_name(const Dirtiness& dirtiness)
             return "DIRTINESS_VISIBILITY";
         case DIRTINESS_GEOMETRY:
             return "DIRTINESS_GEOMETRY";
+        case DIRTINESS_DEFORMATION:
+            return "DIRTINESS_DEFORMATION";
         case DIRTINESS_ALL:
             return "DIRTINESS_ALL";
         default:
@@ -689,6 +752,7 @@ R2cSceneDelegate::get_dirtiness_names(CoreVector<CoreString>& names, const int&
     if (dirtiness & DIRTINESS_MATERIAL) names.add("DIRTINESS_MATERIAL");
     if (dirtiness & DIRTINESS_VISIBILITY) names.add("DIRTINESS_VISIBILITY");
     if (dirtiness & DIRTINESS_GEOMETRY) names.add("DIRTINESS_GEOMETRY");
+    if (dirtiness & DIRTINESS_DEFORMATION) names.add("DIRTINESS_DEFORMATION");
     if (dirtiness & DIRTINESS_ALL) names.add("DIRTINESS_ALL");
 }
 
@@ -743,6 +807,8 @@ R2cSceneDelegate::clear()
             delete prototypes.get_value();
         }
         m_instancer_prototypes.remove_all();
+        m_topology_fingerprints.remove_all();
+        m_modified_geometries.remove_all();
         m_render_item_dependencies.remove_all();
         m_geometry_index.remove_all();
         m_light_index.remove_all();
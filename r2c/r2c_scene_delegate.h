@@ -17,6 +17,8 @@ typedef CoreHashTable<OfObject *, bool> OfObjectIndex;
 typedef CoreHashTable<R2cItemId, R2cItemDescriptor> RenderItemDependencyMap;
 typedef CoreHashTable<OfObject *, CoreArray<OfObject *> *> InstancerPrototypesMap;
 typedef CoreHashTable<ModuleSceneObject *, unsigned int> SceneObjectIndexMap;
+typedef CoreHashTable<R2cItemId, R2cTopologyFingerprint> TopologyFingerprintMap;
+typedef CoreHashTable<R2cItemId, int> DirtinessMap;
 
 /*! \class R2cSceneDelegate
     \brief This class implements a Clarisse Scene Delegate to work along a R2cRenderDelegate which must set using R2cSceneDelegate::set_render_delegate.
@@ -33,8 +35,9 @@ public:
         DIRTINESS_MATERIAL                  = 1 << 3,   //!< The material has been modified
         DIRTINESS_VISIBILITY                = 1 << 4,   //!< The item visibility has been modified
         DIRTINESS_GEOMETRY                  = 1 << 5,   //!< The geometry has been modified
-        DIRTINESS_ALL                       = (1 << 6) - 1,
-        DIRTINESS_COUNT                     = 8
+        DIRTINESS_DEFORMATION               = 1 << 6,   //!< The points of the geometry moved but its topology is unchanged
+        DIRTINESS_ALL                       = (1 << 7) - 1,
+        DIRTINESS_COUNT                     = 9
     };
     static CoreString get_dirtiness_name(const Dirtiness& dirtiness);
     static void get_dirtiness_names(CoreVector<CoreString>& names, const int& dirtiness);
@@ -192,6 +195,7 @@ private:
     void dispatch_scene_object_dirtiness(EventObject& sender, const EventInfo& evtid, void *data);
     void dispatch_light_dirtiness(EventObject& sender, const EventInfo& evtid, void *data);
     void dispatch_shading_layer_dirtiness(EventObject& sender, const EventInfo& evtid, void *data);
+    void dispatch_render_settings_dirtiness(EventObject& sender, const EventInfo& evtid, void *data);
 
     R2cRenderDelegate *m_render_delegate;
 
@@ -219,6 +223,11 @@ private:
     // list of propotypes per instancer
     InstancerPrototypesMap m_instancer_prototypes;
 
+    // topology of each geometry taken at its last modification, used to detect the deformations of the next ones
+    TopologyFingerprintMap m_topology_fingerprints;
+    // dirtiness received since the last sync by the modified geometries whose topology is compared by the next sync
+    DirtinessMap m_modified_geometries;
+
     SceneObjectIndexMap m_scene_object_index;
     const SceneObjectShading *m_shading_table;
     bool m_shading_table_dirty;
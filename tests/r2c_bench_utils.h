@@ -0,0 +1,66 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+#ifndef R2C_BENCH_UTILS_H
+#define R2C_BENCH_UTILS_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+/*! \class BenchTimer
+    \brief Wall clock timer started at its creation. */
+class BenchTimer {
+public:
+    BenchTimer() : m_start(std::chrono::steady_clock::now()) {}
+    /*! \brief Return the time elapsed since the creation of the timer in seconds */
+    inline double get_elapsed() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count(); }
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/*! \brief Return the peak resident set size of the process in bytes or 0 where it isn't available */
+inline unsigned long long
+get_peak_rss()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+    }
+    return 0;
+}
+
+/*! \brief Reset the peak resident set size to the current one so that each run reports its own peak (Linux only) */
+inline void
+reset_peak_rss()
+{
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    if (clear_refs) clear_refs << "5";
+}
+
+/*! \brief Return the maximum number of items of a benchmark, read from its first argument */
+inline unsigned long long
+get_max_count(int argc, char **argv, const unsigned long long& default_count)
+{
+    return argc > 1 ? std::strtoull(argv[1], nullptr, 10) : default_count;
+}
+
+/*! \brief Print a result line of a benchmark */
+inline void
+print_result(const char *name, const unsigned long long& count, const double& elapsed)
+{
+    printf("  %-24s %12llu %12.2f ms %16.0f /s\n", name, count, elapsed * 1000.0, elapsed > 0.0 ? static_cast<double>(count) / elapsed : 0.0);
+}
+
+/*! \brief Print the peak resident set size since the last reset */
+inline void
+print_peak_rss()
+{
+    printf("  %-24s %12.1f MB\n", "peak RSS", static_cast<double>(get_peak_rss()) / (1024.0 * 1024.0));
+}
+
+#endif
@@ -0,0 +1,35 @@
+//
+// Copyright 2020 - present Isotropix SAS. See License.txt for license information
+//
+
+#ifndef R2C_TEST_UTILS_H
+#define R2C_TEST_UTILS_H
+
+#include <cstdio>
+
+/*! \brief Return the number of failed checks of the test */
+inline unsigned int&
+get_failure_count()
+{
+    static unsigned int count = 0;
+    return count;
+}
+
+//! Report a failure without stopping the test if the condition is false
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            get_failure_count()++; \
+        } \
+    } while (false)
+
+/*! \brief Return the exit code of the test */
+inline int
+test_result()
+{
+    if (get_failure_count() != 0) fprintf(stderr, "%u check(s) failed\n", get_failure_count());
+    return get_failure_count() == 0 ? 0 : 1;
+}
+
+#endif